@@ -92,7 +92,9 @@ uint8_t                         g_bleConnLinkNum;
 // Section: Local Variables
 // *****************************************************************************
 // *****************************************************************************
-static APP_BLE_ConnList_T       s_bleConnList[APP_BLE_MAX_LINK_NUMBER];
+static uint8_t                  s_bleMaxLinkNbr = BLE_GAP_DEFAULT_LINK_NBR;    /**< See @ref BLE_GAP_MAX_LINK_NBR. */
+static APP_BLE_ConnList_T       *sp_bleConnList = NULL;    /**< Table of APP_BLE_MAX_LINK_NUMBER entries, allocated once by APP_InitConnList(). */
+static GHashTable               *sp_bleConnByProxy = NULL; /**< Connected entries by device proxy. */
 static APP_BLE_ConnList_T       *sp_currentBleLink = NULL; /**< This pointer means the last one connected BLE link. */
 
 
@@ -104,15 +106,14 @@ static APP_BLE_ConnList_T       *sp_currentBleLink = NULL; /**< This pointer mea
 
 static void app_ClearConnListByDevProxy(DeviceProxy *p_devProxy)
 {
-    uint8_t i;
+    APP_BLE_ConnList_T *p_bleConn;
 
-    for (i = 0; i < APP_BLE_MAX_LINK_NUMBER; i++)
+    p_bleConn = g_hash_table_lookup(sp_bleConnByProxy, p_devProxy);
+    if (p_bleConn != NULL)
     {
-        if (s_bleConnList[i].p_deviceProxy == p_devProxy)
-        {
-            memset((uint8_t *)(&s_bleConnList[i]), 0, sizeof(APP_BLE_ConnList_T));
-            s_bleConnList[i].linkState = APP_BLE_STATE_STANDBY;
-        }
+        g_hash_table_remove(sp_bleConnByProxy, p_devProxy);
+        memset((uint8_t *)p_bleConn, 0, sizeof(APP_BLE_ConnList_T));
+        p_bleConn->linkState = APP_BLE_STATE_STANDBY;
     }
 }
 
@@ -123,17 +124,17 @@ static APP_BLE_ConnList_T *app_GetScanConnList(void)
     //First find the state of APP_BLE_STATE_CONNECTING
     for (i = 0; i < APP_BLE_MAX_LINK_NUMBER; i++)
     {
-        if (s_bleConnList[i].linkState == APP_BLE_STATE_CONNECTING)
+        if (sp_bleConnList[i].linkState == APP_BLE_STATE_CONNECTING)
         {
-            return (&s_bleConnList[i]);
+            return (&sp_bleConnList[i]);
         }
     }
 
     for (i = 0; i < APP_BLE_MAX_LINK_NUMBER; i++)
     {
-        if (s_bleConnList[i].linkState == APP_BLE_STATE_STANDBY)
+        if (sp_bleConnList[i].linkState == APP_BLE_STATE_STANDBY)
         {
-            return (&s_bleConnList[i]);
+            return (&sp_bleConnList[i]);
         }
     }
     
@@ -146,7 +147,7 @@ uint8_t APP_GetConnLinkNum(void)
 
     for (index = 0; index < APP_BLE_MAX_LINK_NUMBER; index++)
     {
-        if (s_bleConnList[index].linkState == APP_BLE_STATE_CONNECTED)
+        if (sp_bleConnList[index].linkState == APP_BLE_STATE_CONNECTED)
         {
             num+=1;
         }
@@ -161,9 +162,9 @@ APP_BLE_ConnList_T *APP_GetFreeConnList(void)
 
     for (i = 0; i < APP_BLE_MAX_LINK_NUMBER; i++)
     {
-        if (s_bleConnList[i].linkState == APP_BLE_STATE_STANDBY)
+        if (sp_bleConnList[i].linkState == APP_BLE_STATE_STANDBY)
         {
-            return (&s_bleConnList[i]);
+            return (&sp_bleConnList[i]);
         }
     }
     return NULL;
@@ -171,16 +172,10 @@ APP_BLE_ConnList_T *APP_GetFreeConnList(void)
 
 APP_BLE_ConnList_T *APP_GetConnInfoByDevProxy(DeviceProxy *p_devProxy)
 {
-    uint8_t i;
+    if (sp_bleConnByProxy == NULL)
+        return NULL;
 
-    for (i = 0; i < APP_BLE_MAX_LINK_NUMBER; i++)
-    {
-        if (s_bleConnList[i].p_deviceProxy == p_devProxy)
-        {
-            return (&s_bleConnList[i]);
-        }
-    }
-    return NULL;
+    return g_hash_table_lookup(sp_bleConnByProxy, p_devProxy);
 }
 
 uint8_t APP_GetRoleNumber(uint8_t role) 
@@ -190,7 +185,7 @@ uint8_t APP_GetRoleNumber(uint8_t role)
 
     for (i = 0; i < APP_BLE_MAX_LINK_NUMBER; i++)
     {
-        if (s_bleConnList[i].connData.role == role && s_bleConnList[i].linkState == APP_BLE_STATE_CONNECTED)
+        if (sp_bleConnList[i].connData.role == role && sp_bleConnList[i].linkState == APP_BLE_STATE_CONNECTED)
         {
             count++;
         }
@@ -261,6 +256,7 @@ void APP_PropertyChangedHandler(APP_PtyChanged_T ptyChangedType, void *p_param)
                         /* Update the connection parameter */
                         p_bleConn->linkState                        = APP_BLE_STATE_CONNECTED;
                         p_bleConn->p_deviceProxy                    = p_connStaChanged->p_proxy;
+                        g_hash_table_insert(sp_bleConnByProxy, p_bleConn->p_deviceProxy, p_bleConn);
                         p_bleConn->connData.role                    = p_connStaChanged->role;        // 0x00: Central, 0x01:Peripheral
                     
                         /* Save Remote Device Address */
@@ -381,8 +377,8 @@ APP_BLE_ConnList_T *APP_GetBleLinkByStates(APP_BLE_LinkState_T start, APP_BLE_Li
         
         for (i = 0; i < APP_BLE_MAX_LINK_NUMBER; i++)
         {
-            if (s_bleConnList[i].linkState == start)
-                return (&s_bleConnList[i]);
+            if (sp_bleConnList[i].linkState == start)
+                return (&sp_bleConnList[i]);
         }
         
         start+=1;
@@ -431,18 +427,43 @@ uint8_t APP_DetermineRandomAddrType(uint8_t * p_addr)
         return BLE_GAP_ADDR_TYPE_RANDOM_STATIC;
 }
 
+uint16_t APP_BLE_SetMaxLinkNumber(uint8_t linkNbr)
+{
+    if (linkNbr == 0 || linkNbr > BLE_GAP_MAX_LINK_NBR_LIMIT)
+        return APP_RES_INVALID_PARA;
+
+    if (sp_bleConnList != NULL)
+        return APP_RES_BAD_STATE;
+
+    s_bleMaxLinkNbr = linkNbr;
+
+    return APP_RES_SUCCESS;
+}
+
+uint8_t APP_BLE_GetMaxLinkNumber(void)
+{
+    return s_bleMaxLinkNbr;
+}
+
 void APP_InitConnList(void)
 {
     uint8_t i;
 
-    sp_currentBleLink = &s_bleConnList[0];
+    if (sp_bleConnList == NULL)
+    {
+        sp_bleConnList = g_new0(APP_BLE_ConnList_T, APP_BLE_MAX_LINK_NUMBER);
+        sp_bleConnByProxy = g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+    g_hash_table_remove_all(sp_bleConnByProxy);
+
+    sp_currentBleLink = &sp_bleConnList[0];
     g_bleConnLinkNum = 0;
     //s_connHandleIndex = LINK_HANDLE_INIT;
 
     for (i = 0; i < APP_BLE_MAX_LINK_NUMBER; i++)
     {
-        memset((uint8_t *)(&s_bleConnList[i]), 0, sizeof(APP_BLE_ConnList_T));
-        s_bleConnList[i].linkState = APP_BLE_STATE_STANDBY;
+        memset((uint8_t *)(&sp_bleConnList[i]), 0, sizeof(APP_BLE_ConnList_T));
+        sp_bleConnList[i].linkState = APP_BLE_STATE_STANDBY;
     }
 }
 
@@ -153,6 +153,10 @@ extern uint8_t              g_bleConnLinkNum;
 
 APP_BLE_ConnList_T *APP_GetFreeConnList(void);
 void APP_InitConnList(void);
+/**@brief Set the maximum allowed BLE GAP connections, see @ref BLE_GAP_MAX_LINK_NBR. It must be called
+ *        before APP_InitConnList(), the connection tables are not resized once allocated.
+ * @retval APP_RES_SUCCESS, APP_RES_INVALID_PARA or APP_RES_BAD_STATE if the tables are already allocated. */
+uint16_t APP_BLE_SetMaxLinkNumber(uint8_t linkNbr);
 void APP_UpdateLocalName(uint8_t devNameLen, uint8_t *p_devName);
 uint8_t APP_GetConnLinkNum(void);
 APP_BLE_LinkState_T APP_GetBleStateByLink(APP_BLE_ConnList_T *p_bleConn);
@@ -44,6 +44,17 @@
 #include "app_agent.h"
 #include "app_ble_handler.h"
 #include "app_error_defs.h"
+#include "app_log.h"
+#include "app_result.h"
+#include "app_replay.h"
+#include "app_tune.h"
+#include "app_hcimon.h"
+#include "app_mem.h"
+#include "app_trcbp.h"
+#include "app_trps.h"
+#include "app_trpc.h"
+#include "ble_trsp/ble_trsp_defs.h"
+#include "dbus_stat/dbus_stat.h"
 
 
 
@@ -76,10 +87,26 @@ static APP_CMD_Menu_T s_mainMenu = {
     { "raw",          "...",      APP_CMD_SendRawData, "Send raw data to remote peer manually. usage: raw <index> <text>" }, 
     { "txf",          "...",      APP_CMD_SendFileData, "Send file to remote peer. usage: txf <index> <file-path>" }, 
     { "rxf",          "...",      APP_CMD_ReceiveFileData, "Receive file from remote peer. usage: rxf <index> [file-path]" }, 
-    { "sw",           "<1-3>",    APP_CMD_ModeSwitch, "Transmission mode switch (1=checksum, 2=loopback, 3=fixed-pattern)" }, 
+    { "sw",           "<1-3|5-6>", APP_CMD_ModeSwitch, "Transmission mode switch (1=checksum, 2=loopback, 3=fixed-pattern, 5=reverse-loopback, 6=duplex)" },
     { "pt",           "<0-6>",    APP_CMD_PatternSelect, "Select data pattern for transmission(0=1K, 1=5K, 2=10K, 3=50K, 4=100K, 5=200L, 6=500K)" }, 
     { "b",            "<index>",  APP_CMD_BurstModeStart, "Start Burst Mode data transmission on selected device" }, 
     { "ba",           NULL,       APP_CMD_BurstModeStartAll, "Start Burst Mode data transmission on all connected devices" }, 
+    { "pi",           "[...]",    APP_CMD_SetProgressInterval, "Progress report interval, report when either limit is reached (0 0=every update). usage: pi [<ms> [<KB>]]" },
+    { "ds",           "[...]",    APP_CMD_DbusStat, "D-Bus call cost per member since last reset. usage: ds [reset|on|off]" },
+    { "rl",           "[...]",    APP_CMD_ResultLog, "Append burst mode results to a JSON lines file. usage: rl [<file>|off]" },
+    { "rb",           "<...>",    APP_CMD_ResultBaseline, "Save last run as baseline or compare against it. usage: rb save <file> | rb cmp <file> [<drop %>]" },
+    { "rec",          "[...]",    APP_CMD_Record, "Record TRP events and data for replay. usage: rec [<file>|off]" },
+    { "coc",          "[...]",    APP_CMD_Coc, "TRCBP channel over L2CAP CoC. usage: coc [psm <psm>|sdu <size>|conn <index>|disc <index>|pair <index> <index>]" },
+    { "uc",           "[...]",    APP_CMD_UartCoalesce, "UART mode packet coalescing hold time (0=off) and payload fill ratio per link. usage: uc [<0-100 ms>|reset]" },
+    { "cr",           "[...]",    APP_CMD_CreditPolicy, "TRP server receive queue depth, credit policy and credit state per link. usage: cr [fixed|adaptive] [depth <2-64>]" },
+    { "crc",          "[...]",    APP_CMD_ClientCreditReturn, "TRP client credit return low watermark (0=off), overlap with data and server zero credit time per link. usage: crc [<0-15> [overlap]|reset]" },
+    { "cz",           "[...]",    APP_CMD_Compress, "UART mode compression negotiated with the peer and ratio per link. usage: cz [on|off]" },
+    { "sr",           "[...]",    APP_CMD_SelectiveRepeat, "UART mode selective repeat over Write Without Response and counters per link. usage: sr [on|off|test <frames> <loss%>]" },
+    { "tune",         "[...]",    APP_CMD_Tune, "Sweep PHY and connection interval with fixed-pattern probes and apply the best, results per link. usage: tune [<index>|all]" },
+    { "mem",          "[...]",    APP_CMD_Memory, "Memory budget, link quota and current and peak buffered data per category and per link. usage: mem [budget <KB>|quota <KB>|reset]" },
+#ifdef ENABLE_HCI_EVT_MONITOR
+    { "hci",          "[reset]",  APP_CMD_HciMonitor, "Controller buffer occupancy, ACL packets in flight and over-the-air goodput per link since last print. usage: hci [reset]" },
+#endif
 #ifdef ENABLE_AUTO_RUN
     { "r",            "<1-65536>",APP_CMD_SetExecRuns, "[Test used only] Execute Burst Mode data transmission for configured times" }, 
 #endif
@@ -557,7 +584,7 @@ void APP_CMD_ModeSwitch(int argc, char *argv[])
     if (argc==2)
     {
         mode = atoi(argv[1]);
-        if (mode >= TRP_WMODE_CHECK_SUM && mode <= TRP_WMODE_FIX_PATTERN)
+        if ((mode >= TRP_WMODE_CHECK_SUM && mode <= TRP_WMODE_FIX_PATTERN) || (mode >= TRP_WMODE_REV_LOOPBACK && mode <= TRP_WMODE_DUPLEX))
         {
             return APP_SetWorkMode(mode);
         }
@@ -605,6 +632,499 @@ void APP_CMD_BurstModeStartAll(int argc, char *argv[])
     APP_BurstModeStartAll();
 }
 
+void APP_CMD_SetProgressInterval(int argc, char *argv[])
+{
+    uint32_t intervalMs = 0;
+    uint32_t intervalKb = 0;
+
+    if (argc == 1)
+    {
+        APP_LOG_GetProgressInterval(&intervalMs, &intervalKb);
+        bt_shell_printf("progress interval = %u ms, %u KB\n", intervalMs, intervalKb);
+        return;
+    }
+    else if (argc > 3)
+    {
+        bt_shell_printf("parameter error\n");
+        return;
+    }
+
+    intervalMs = atoi(argv[1]);
+    if (argc == 3)
+    {
+        intervalKb = atoi(argv[2]);
+    }
+
+    APP_LOG_SetProgressInterval(intervalMs, intervalKb);
+}
+
+void APP_CMD_DbusStat(int argc, char *argv[])
+{
+    const char *p_typeStr[] = {"call", "emit", "recv"};
+    const DBUS_STAT_Entry_T *p_entry;
+    DBUS_STAT_Summary_T summary;
+    uint8_t i;
+
+    if (argc == 2)
+    {
+        if (!strcmp(argv[1], "reset"))
+            DBUS_STAT_Reset();
+        else if (!strcmp(argv[1], "on"))
+            DBUS_STAT_Enable(true);
+        else if (!strcmp(argv[1], "off"))
+            DBUS_STAT_Enable(false);
+        else
+            bt_shell_printf("parameter error\n");
+        return;
+    }
+    else if (argc > 2)
+    {
+        bt_shell_printf("parameter error\n");
+        return;
+    }
+
+    DBUS_STAT_GetSummary(&summary);
+
+    bt_shell_printf("[Type][       Member       ][  Count ][ Total(ms) ][ Avg(us) ][ Max(us) ]\n");
+    bt_shell_printf("=================================================================================\n");
+    for (i = 0; (p_entry = DBUS_STAT_GetEntry(i)) != NULL; i++)
+    {
+        bt_shell_printf("[%s][%-20s][%8u][%11.3f][%9.1f][%9.1f]\n", p_typeStr[p_entry->type], p_entry->name, p_entry->count,
+            p_entry->totalNs / 1000000.0, p_entry->count ? (p_entry->totalNs / 1000.0 / p_entry->count) : 0.0, p_entry->maxNs / 1000.0);
+    }
+
+    bt_shell_printf("wall %.3f ms, process cpu %.3f ms, dbus %.3f ms (%.1f%% of cpu)",
+        summary.wallNs / 1000000.0, summary.cpuNs / 1000000.0, summary.dbusNs / 1000000.0,
+        summary.cpuNs ? (summary.dbusNs * 100.0 / summary.cpuNs) : 0.0);
+    if (summary.dropped)
+        bt_shell_printf(", %u not accounted", summary.dropped);
+    bt_shell_printf("\n");
+}
+
+void APP_CMD_ResultLog(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        bt_shell_printf("result log = %s\n", APP_RESULT_GetLogFile() ? APP_RESULT_GetLogFile() : "off");
+    }
+    else if (argc == 2)
+    {
+        APP_RESULT_SetLogFile(strcmp(argv[1], "off") ? argv[1] : NULL);
+    }
+    else
+    {
+        bt_shell_printf("parameter error\n");
+    }
+}
+
+void APP_CMD_ResultBaseline(int argc, char *argv[])
+{
+    unsigned long threshold = APP_RESULT_DEFAULT_THRESHOLD;
+    uint8_t regressions;
+    char *p_end;
+
+    if (argc == 3 && !strcmp(argv[1], "save"))
+    {
+        if (APP_RESULT_SaveBaseline(argv[2]) != APP_RES_SUCCESS)
+            bt_shell_printf("no finished run or file error\n");
+        return;
+    }
+    else if ((argc == 3 || argc == 4) && !strcmp(argv[1], "cmp"))
+    {
+        if (argc == 4)
+        {
+            threshold = strtoul(argv[3], &p_end, 10);
+            if (p_end == argv[3] || *p_end != '\0' || threshold > 100)
+            {
+                bt_shell_printf("threshold must be 0 to 100\n");
+                return;
+            }
+        }
+
+        if (APP_RESULT_Compare(argv[2], (uint8_t)threshold, &regressions) != APP_RES_SUCCESS)
+            bt_shell_printf("no finished run, no matched baseline or file error\n");
+        else
+            bt_shell_printf("%u regression(s) above %lu%%\n", regressions, threshold);
+        return;
+    }
+
+    bt_shell_printf("parameter error\n");
+}
+
+void APP_CMD_Record(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        bt_shell_printf("record = %s\n", APP_REPLAY_IsRecording() ? "on" : "off");
+    }
+    else if (argc == 2)
+    {
+        if (!strcmp(argv[1], "off"))
+            APP_REPLAY_StopRecord();
+        else if (!APP_REPLAY_StartRecord(argv[1]))
+            bt_shell_printf("Failed to create %s\n", argv[1]);
+    }
+    else
+    {
+        bt_shell_printf("parameter error\n");
+    }
+}
+
+void APP_CMD_Coc(int argc, char *argv[])
+{
+    APP_DBP_BtDev_T *p_dev = NULL, *p_peer = NULL;
+    uint16_t result = APP_RES_INVALID_PARA;
+
+    if (argc == 1)
+    {
+        bt_shell_printf("psm = 0x%04x, sdu = %d\n", APP_TRCBP_GetPsm(), APP_TRCBP_GetSdu());
+        return;
+    }
+
+    if (argc >= 3)
+        p_dev = APP_DBP_GetDevInfoByIndex(atoi(argv[2]));
+    if (argc == 4)
+        p_peer = APP_DBP_GetDevInfoByIndex(atoi(argv[3]));
+
+    if (argc == 3 && !strcmp(argv[1], "psm"))
+    {
+        result = APP_TRCBP_SetPsm((uint16_t)strtoul(argv[2], NULL, 0));
+    }
+    else if (argc == 3 && !strcmp(argv[1], "sdu"))
+    {
+        result = APP_TRCBP_SetSdu((uint16_t)strtoul(argv[2], NULL, 0));
+    }
+    else if (argc == 3 && !strcmp(argv[1], "conn") && p_dev)
+    {
+        result = APP_TRCBP_Connect(p_dev->p_devProxy);
+    }
+    else if (argc == 3 && !strcmp(argv[1], "disc") && p_dev)
+    {
+        APP_TRCBP_Disconnect(p_dev->p_devProxy);
+        result = APP_RES_SUCCESS;
+    }
+    else if (argc == 4 && !strcmp(argv[1], "pair") && p_dev && p_peer)
+    {
+        result = APP_TRCBP_LocalPair(p_dev->p_devProxy, p_peer->p_devProxy);
+    }
+
+    if (result == APP_RES_INVALID_PARA)
+        bt_shell_printf("parameter error\n");
+    else if (result != APP_RES_SUCCESS)
+        bt_shell_printf("coc %s failed(%04x)\n", argv[1], result);
+}
+
+void APP_CMD_UartCoalesce(int argc, char *argv[])
+{
+    APP_TRP_ConnList_T *p_trpConn;
+    APP_DBP_BtDev_T *p_dev;
+    uint8_t i;
+
+    if (argc == 2)
+    {
+        if (!strcmp(argv[1], "reset"))
+            APP_TRP_COMMON_ResetUartFillStat();
+        else if (!isdigit((unsigned char)argv[1][0]) || APP_TRP_COMMON_SetUartHoldTime(atoi(argv[1])) != APP_RES_SUCCESS)
+            bt_shell_printf("parameter error\n");
+        return;
+    }
+    else if (argc > 2)
+    {
+        bt_shell_printf("parameter error\n");
+        return;
+    }
+
+    bt_shell_printf("hold time = %d ms\n", APP_TRP_COMMON_GetUartHoldTime());
+    bt_shell_printf("[Index][     Address     ][ Packets ][   Bytes   ][ Fill ]\n");
+    bt_shell_printf("=================================================================================\n");
+    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    {
+        p_trpConn = APP_TRP_COMMON_GetConnListByIndex(i);
+        if (p_trpConn == NULL || p_trpConn->p_cold->uartTxPkts == 0)
+            continue;
+
+        p_dev = APP_DBP_GetDevInfoByProxy(p_trpConn->p_deviceProxy);
+        bt_shell_printf("dev#%2d\t[%17s][%9u][%11u][%5.1f%%]\n", p_dev ? p_dev->index : i, p_dev ? p_dev->p_address : "-",
+            p_trpConn->p_cold->uartTxPkts, p_trpConn->p_cold->uartTxPayload, p_trpConn->p_cold->uartTxPayload * 100.0 / p_trpConn->p_cold->uartTxRoom);
+    }
+}
+
+void APP_CMD_CreditPolicy(int argc, char *argv[])
+{
+    APP_TRP_ConnList_T *p_trpConn;
+    APP_DBP_BtDev_T *p_dev;
+    BLE_TRSPS_CreditInfo_T info;
+    uint8_t i;
+    int argi = 1;
+
+    if (argc > 1)
+    {
+        if (!strcmp(argv[argi], "fixed") || !strcmp(argv[argi], "adaptive"))
+        {
+            BLE_TRSPS_SetCreditPolicy(!strcmp(argv[argi], "fixed") ? BLE_TRSPS_CREDIT_POLICY_FIXED : BLE_TRSPS_CREDIT_POLICY_ADAPTIVE);
+            argi++;
+        }
+
+        if (argi < argc)
+        {
+            if ((argc - argi) != 2 || strcmp(argv[argi], "depth") || !isdigit((unsigned char)argv[argi + 1][0])
+                || atoi(argv[argi + 1]) > (int)BLE_TRSPS_MAX_QUEUE_DEPTH
+                || BLE_TRSPS_SetQueueDepth(atoi(argv[argi + 1])) != TRSP_RES_SUCCESS)
+            {
+                bt_shell_printf("parameter error\n");
+            }
+        }
+        return;
+    }
+
+    bt_shell_printf("policy = %s, queue depth = %d (new links)\n",
+        (BLE_TRSPS_GetCreditPolicy() == BLE_TRSPS_CREDIT_POLICY_FIXED) ? "fixed" : "adaptive", BLE_TRSPS_GetQueueDepth());
+    bt_shell_printf("[Index][     Address     ][Depth][Window][Granted][Queued][ Peak ][ Returns ][ Grows ][Shrinks]\n");
+    bt_shell_printf("=================================================================================\n");
+    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    {
+        p_trpConn = APP_TRP_COMMON_GetConnListByIndex(i);
+        if (p_trpConn == NULL || p_trpConn->trpRole != APP_TRP_SERVER_ROLE
+            || BLE_TRSPS_GetCreditInfo(p_trpConn->p_deviceProxy, &info) != TRSP_RES_SUCCESS)
+            continue;
+
+        p_dev = APP_DBP_GetDevInfoByProxy(p_trpConn->p_deviceProxy);
+        bt_shell_printf("dev#%2d\t[%17s][%5d][%6d][%7d][%6d][%6d][%9u][%7u][%7u]\n", p_dev ? p_dev->index : i,
+            p_dev ? p_dev->p_address : "-", info.queueDepth, info.window, info.grantedCredit, info.queued,
+            info.maxQueued, info.returns, info.grows, info.shrinks);
+    }
+}
+
+void APP_CMD_ClientCreditReturn(int argc, char *argv[])
+{
+    APP_TRP_ConnList_T *p_trpConn;
+    APP_DBP_BtDev_T *p_dev;
+    BLE_TRSPC_CreditStat_T stat;
+    uint8_t lowWatermark;
+    bool overlap;
+    uint8_t i;
+
+    if (argc == 2 && !strcmp(argv[1], "reset"))
+    {
+        BLE_TRSPC_ResetCreditStat();
+        return;
+    }
+    else if (argc == 2 || argc == 3)
+    {
+        if (!isdigit((unsigned char)argv[1][0]) || atoi(argv[1]) > UINT8_MAX
+            || (argc == 3 && strcmp(argv[2], "overlap"))
+            || BLE_TRSPC_SetCreditReturn(atoi(argv[1]), argc == 3) != TRSP_RES_SUCCESS)
+        {
+            bt_shell_printf("parameter error\n");
+        }
+        return;
+    }
+    else if (argc > 3)
+    {
+        bt_shell_printf("parameter error\n");
+        return;
+    }
+
+    BLE_TRSPC_GetCreditReturn(&lowWatermark, &overlap);
+    bt_shell_printf("low watermark = %d, overlap = %s\n", lowWatermark, overlap ? "on" : "off");
+    bt_shell_printf("[Index][     Address     ][Granted][ Returns ][ Zero ][ Zero ms ][ Max ms ]\n");
+    bt_shell_printf("=================================================================================\n");
+    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    {
+        p_trpConn = APP_TRP_COMMON_GetConnListByIndex(i);
+        if (p_trpConn == NULL || p_trpConn->trpRole != APP_TRP_CLIENT_ROLE
+            || BLE_TRSPC_GetCreditStat(p_trpConn->p_deviceProxy, &stat) != TRSP_RES_SUCCESS)
+            continue;
+
+        p_dev = APP_DBP_GetDevInfoByProxy(p_trpConn->p_deviceProxy);
+        bt_shell_printf("dev#%2d\t[%17s][%7d][%9u][%6u][%9.1f][%8.1f]\n", p_dev ? p_dev->index : i,
+            p_dev ? p_dev->p_address : "-", stat.grantedCredit, stat.returns, stat.zeroCount,
+            stat.zeroTimeUs / 1000.0, stat.maxZeroUs / 1000.0);
+    }
+}
+
+void APP_CMD_Compress(int argc, char *argv[])
+{
+    APP_TRP_ConnList_T *p_trpConn;
+    APP_TRP_Compress_T *p_compress;
+    APP_DBP_BtDev_T *p_dev;
+    uint8_t i;
+
+    if (argc == 2)
+    {
+        if (!strcmp(argv[1], "on"))
+            APP_TRP_COMMON_SetCompress(APP_TRP_COMPRESS_CODEC_LZ);
+        else if (!strcmp(argv[1], "off"))
+            APP_TRP_COMMON_SetCompress(APP_TRP_COMPRESS_CODEC_NONE);
+        else
+            bt_shell_printf("parameter error\n");
+        return;
+    }
+    else if (argc > 2)
+    {
+        bt_shell_printf("parameter error\n");
+        return;
+    }
+
+    bt_shell_printf("compression = %s\n", (APP_TRP_COMMON_GetCompress() == APP_TRP_COMPRESS_CODEC_NONE) ? "off" : "on");
+    bt_shell_printf("[Index][     Address     ][  Tx Raw   ][  Tx Enc   ][  Rx Raw   ][  Rx Enc   ][Errors]\n");
+    bt_shell_printf("=================================================================================\n");
+    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    {
+        p_trpConn = APP_TRP_COMMON_GetConnListByIndex(i);
+        if (p_trpConn == NULL || p_trpConn->p_cold->p_compress == NULL)
+            continue;
+
+        p_compress = p_trpConn->p_cold->p_compress;
+        p_dev = APP_DBP_GetDevInfoByProxy(p_trpConn->p_deviceProxy);
+        bt_shell_printf("dev#%2d\t[%17s][%11u][%11u][%11u][%11u][%6u]\n", p_dev ? p_dev->index : i,
+            p_dev ? p_dev->p_address : "-", p_compress->txRawLeng, p_compress->txEncLeng,
+            p_compress->rxRawLeng, p_compress->rxEncLeng, p_compress->rxErrors);
+    }
+}
+
+void APP_CMD_SelectiveRepeat(int argc, char *argv[])
+{
+    APP_TRP_ConnList_T *p_trpConn;
+    APP_SR_TestResult_T result;
+    APP_DBP_BtDev_T *p_dev;
+    uint16_t status;
+    int frames, loss;
+    uint8_t i;
+
+    if ((argc == 4) && (!strcmp(argv[1], "test")))
+    {
+        frames = atoi(argv[2]);
+        loss = atoi(argv[3]);
+        if ((frames > 0) && (loss >= 0) && (loss <= 100))
+            status = APP_SR_SelfTest(frames, loss, (uint32_t)g_get_monotonic_time(), &result);
+        else
+            status = APP_RES_INVALID_PARA;
+        if (status == APP_RES_INVALID_PARA)
+        {
+            bt_shell_printf("parameter error\n");
+            return;
+        }
+        bt_shell_printf("selective repeat test %s: delivered=%u sent=%u lost=%u acks=%u acks lost=%u timeouts=%u rounds=%u\n",
+            (status == APP_RES_SUCCESS) ? "passed" : "failed", result.delivered, result.sent, result.lost,
+            result.acks, result.acksLost, result.timeouts, result.rounds);
+        return;
+    }
+    else if (argc == 2)
+    {
+        if (!strcmp(argv[1], "on"))
+            APP_TRP_COMMON_SetSr(true);
+        else if (!strcmp(argv[1], "off"))
+            APP_TRP_COMMON_SetSr(false);
+        else
+            bt_shell_printf("parameter error\n");
+        return;
+    }
+    else if (argc > 1)
+    {
+        bt_shell_printf("parameter error\n");
+        return;
+    }
+
+    bt_shell_printf("selective repeat = %s\n", APP_TRP_COMMON_GetSr() ? "on" : "off");
+    bt_shell_printf("[Index][     Address     ][ Role ][  Frames   ][ Resent/Dup ][ Acks  ][ Timeouts ]\n");
+    bt_shell_printf("=================================================================================\n");
+    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    {
+        p_trpConn = APP_TRP_COMMON_GetConnListByIndex(i);
+        if (p_trpConn == NULL)
+            continue;
+
+        p_dev = APP_DBP_GetDevInfoByProxy(p_trpConn->p_deviceProxy);
+        if ((p_trpConn->p_cold->p_srTx != NULL) && (p_trpConn->p_cold->p_srTx->active))
+        {
+            bt_shell_printf("dev#%2d\t[%17s][  tx  ][%11u][%12u][%7u][%10u]\n", p_dev ? p_dev->index : i,
+                p_dev ? p_dev->p_address : "-", p_trpConn->p_cold->p_srTx->txFrames, p_trpConn->p_cold->p_srTx->reFrames,
+                p_trpConn->p_cold->p_srTx->acks, p_trpConn->p_cold->p_srTx->timeouts);
+        }
+        else if (p_trpConn->p_cold->p_srRx != NULL)
+        {
+            bt_shell_printf("dev#%2d\t[%17s][  rx  ][%11u][%12u][%7u][%10s]\n", p_dev ? p_dev->index : i,
+                p_dev ? p_dev->p_address : "-", p_trpConn->p_cold->p_srRx->rxFrames, p_trpConn->p_cold->p_srRx->dupFrames,
+                p_trpConn->p_cold->p_srRx->acks, "-");
+        }
+    }
+}
+
+void APP_CMD_Tune(int argc, char *argv[])
+{
+    APP_DBP_BtDev_T *p_dev;
+    APP_TRP_ConnList_T *p_trpConn;
+    uint16_t status;
+
+    if (argc == 1)
+    {
+        APP_TUNE_PrintResult();
+        return;
+    }
+    else if (argc != 2)
+    {
+        bt_shell_printf("parameter error\n");
+        return;
+    }
+
+    if (!strcmp(argv[1], "all"))
+    {
+        status = APP_TUNE_StartAll();
+    }
+    else
+    {
+        p_dev = APP_DBP_GetDevInfoByIndex(atoi(argv[1]));
+        if (p_dev == NULL)
+        {
+            bt_shell_printf("invalid parameter\n");
+            return;
+        }
+
+        p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy(p_dev->p_devProxy);
+        if (p_trpConn == NULL)
+        {
+            bt_shell_printf("invalid parameter\n");
+            return;
+        }
+        status = APP_TUNE_Start(p_trpConn);
+    }
+
+    if (status == APP_RES_BUSY)
+        bt_shell_printf("tune is busy, wait for the running test or tune to finish\n");
+    else if (status != APP_RES_SUCCESS)
+        bt_shell_printf("tune failed(0x%x)\n", status);
+}
+
+void APP_CMD_Memory(int argc, char *argv[])
+{
+    if (argc == 3 && !strcmp(argv[1], "budget"))
+        APP_MEM_SetBudget(strtoul(argv[2], NULL, 0) * 1024);
+    else if (argc == 3 && !strcmp(argv[1], "quota"))
+        APP_MEM_SetLinkQuota(strtoul(argv[2], NULL, 0) * 1024);
+    else if (argc == 2 && !strcmp(argv[1], "reset"))
+        APP_MEM_ResetPeak();
+    else if (argc != 1)
+    {
+        bt_shell_printf("parameter error\n");
+        return;
+    }
+
+    APP_MEM_Print();
+}
+
+#ifdef ENABLE_HCI_EVT_MONITOR
+void APP_CMD_HciMonitor(int argc, char *argv[])
+{
+    if (argc == 2 && !strcmp(argv[1], "reset"))
+        APP_HCIMON_Reset();
+    else if (argc == 1)
+        APP_HCIMON_Print();
+    else
+        bt_shell_printf("parameter error\n");
+}
+#endif
+
 #ifdef ENABLE_AUTO_RUN
 void APP_CMD_SetExecRuns(int argc, char *argv[])
 {
@@ -77,6 +77,22 @@ void APP_CMD_ModeSwitch(int argc, char *argv[]);
 void APP_CMD_PatternSelect(int argc, char *argv[]);
 void APP_CMD_BurstModeStart(int argc, char *argv[]);
 void APP_CMD_BurstModeStartAll(int argc, char *argv[]);
+void APP_CMD_SetProgressInterval(int argc, char *argv[]);
+void APP_CMD_DbusStat(int argc, char *argv[]);
+void APP_CMD_ResultLog(int argc, char *argv[]);
+void APP_CMD_ResultBaseline(int argc, char *argv[]);
+void APP_CMD_Record(int argc, char *argv[]);
+void APP_CMD_Coc(int argc, char *argv[]);
+void APP_CMD_UartCoalesce(int argc, char *argv[]);
+void APP_CMD_CreditPolicy(int argc, char *argv[]);
+void APP_CMD_ClientCreditReturn(int argc, char *argv[]);
+void APP_CMD_Compress(int argc, char *argv[]);
+void APP_CMD_SelectiveRepeat(int argc, char *argv[]);
+void APP_CMD_Tune(int argc, char *argv[]);
+void APP_CMD_Memory(int argc, char *argv[]);
+#ifdef ENABLE_HCI_EVT_MONITOR
+void APP_CMD_HciMonitor(int argc, char *argv[]);
+#endif
 #ifdef ENABLE_AUTO_RUN
 void APP_CMD_SetExecRuns(int argc, char *argv[]);
 #endif
@@ -51,9 +51,11 @@
 #include "app_error_defs.h"
 #include "app_mgmt.h"
 #include "app_agent.h"
+#include "app_script.h"
 #include "ble_trsp/ble_trsps.h"
 #include "ble_trsp/ble_trspc.h"
 #include "ble_trsp/ble_trsp_defs.h"
+#include "dbus_stat/dbus_stat.h"
 
 
 
@@ -126,6 +128,19 @@ static void app_dbp_SendConnStatMsg(APP_DBP_BtDev_T * p_dev, bool isSuccess);
 static void app_dbp_SortingDeviceList(void);
 
 
+static gboolean app_dbp_MethodCall(GDBusProxy *p_proxy, const char *p_method, GDBusSetupFunction setup,
+    GDBusReturnFunction reply, void *p_userData, GDBusDestroyFunction destroy)
+{
+    uint64_t startNs;
+    gboolean result;
+
+    startNs = DBUS_STAT_Begin();
+    result = g_dbus_proxy_method_call(p_proxy, p_method, setup, reply, p_userData, destroy);
+    DBUS_STAT_End(DBUS_STAT_TYPE_METHOD_CALL, p_method, startNs);
+
+    return result;
+}
+
 
 GDBusProxy * APP_DBP_GetDefaultAdapter(void)
 {
@@ -730,7 +745,7 @@ static void app_dbp_SetDiscoveryFilterReply(DBusMessage *p_message, void *p_user
         return;
     }
 
-    g_dbus_proxy_method_call(p_proxy, "StartDiscovery", NULL,
+    app_dbp_MethodCall(p_proxy, "StartDiscovery", NULL,
                     app_dbp_StartDiscoveryReply, NULL, NULL);
 }
 
@@ -763,7 +778,7 @@ uint16_t APP_DBP_StartScan(GDBusProxy * p_ctrl)
         p_scanFilterArgs->p_pattern = NULL;
     }
 
-    if (g_dbus_proxy_method_call(p_ctrl, "SetDiscoveryFilter",
+    if (app_dbp_MethodCall(p_ctrl, "SetDiscoveryFilter",
                 func, app_dbp_SetDiscoveryFilterReply,
                 p_scanFilterArgs, app_dbp_SetDiscoveryFilterDestroy) == FALSE){
         return APP_RES_FAIL;
@@ -785,7 +800,7 @@ static void  app_dbp_StopDiscoveryReply(DBusMessage *p_message, void *p_userData
 
 bool APP_DBP_StopScan(GDBusProxy * p_ctrl)
 {
-    if (g_dbus_proxy_method_call(p_ctrl, "StopDiscovery",
+    if (app_dbp_MethodCall(p_ctrl, "StopDiscovery",
                 NULL, app_dbp_StopDiscoveryReply,
                 NULL, NULL) == FALSE)
     {
@@ -915,7 +930,7 @@ bool APP_DBP_ConnectDevice(APP_DBP_BtDev_T * p_dev)
     if (p_dev->isConnected)
         return false;
 
-    if (g_dbus_proxy_method_call(p_dev->p_devProxy, "Connect", NULL, app_dbp_DeviceConnectReply,
+    if (app_dbp_MethodCall(p_dev->p_devProxy, "Connect", NULL, app_dbp_DeviceConnectReply,
                             p_dev, NULL) == FALSE) {
         return false;
     }
@@ -934,7 +949,7 @@ bool APP_DBP_DisconnectDevice(APP_DBP_BtDev_T * p_dev)
     if (!p_dev->isConnected && !p_dev->isConnInitiadted)
         return false;
 
-    if (g_dbus_proxy_method_call(p_dev->p_devProxy, "Disconnect", NULL, app_dbp_DeviceDisconnectReply, 
+    if (app_dbp_MethodCall(p_dev->p_devProxy, "Disconnect", NULL, app_dbp_DeviceDisconnectReply,
                             p_dev, NULL) == FALSE) 
     {
         printf("Failed to disconnect\n");
@@ -961,7 +976,7 @@ bool APP_DBP_RemoveDevice(APP_DBP_BtDev_T * p_dev)
 
     p_path = g_strdup(g_dbus_proxy_get_path(p_dev->p_devProxy));
 
-    if (g_dbus_proxy_method_call(s_dbpCtrl.p_controller, "RemoveDevice", 
+    if (app_dbp_MethodCall(s_dbpCtrl.p_controller, "RemoveDevice",
                 app_dbp_RemoveDeviceSetup, app_dbp_DeviceRemoveReply, 
                 p_path, g_free) == FALSE) 
     {
@@ -1287,6 +1302,24 @@ APP_DBP_BtDev_T * APP_DBP_GetDevInfoByIndex(int idx)
     return NULL;
 }
 
+APP_DBP_BtDev_T * APP_DBP_GetDevInfoByAddress(const char *p_address)
+{
+    GList *p_l;
+
+    if (p_address == NULL)
+        return NULL;
+
+    for (p_l=s_dbpCtrl.p_deviceList; p_l; p_l=g_list_next(p_l))  {
+        APP_DBP_BtDev_T * p_dev = p_l->data;
+        if (p_dev->p_address && strcasecmp(p_dev->p_address, p_address) == 0)
+        {
+            return p_dev;
+        }
+    }
+
+    return NULL;
+}
+
 
 uint16_t APP_DBP_GetAdapterAddr(BLE_GAP_Addr_T *p_addr)
 {
@@ -1364,7 +1397,7 @@ bool APP_DBP_Pair(APP_DBP_BtDev_T * p_dev)
     if (!p_dev || !p_dev->p_devProxy)
         return false;
 
-    if (g_dbus_proxy_method_call(p_dev->p_devProxy, "Pair", NULL, app_dbp_DevicePairReply,
+    if (app_dbp_MethodCall(p_dev->p_devProxy, "Pair", NULL, app_dbp_DevicePairReply,
                             p_dev, NULL) == FALSE) {
         return false;
     }
@@ -1439,6 +1472,9 @@ void APP_DBP_ProxyRemoved(GDBusProxy *p_proxy, void *p_userData)
 void APP_DBP_PropertyChanged(GDBusProxy *p_proxy, const char *p_name, DBusMessageIter *p_iter, void *p_userData)
 {
     const char *p_interface;
+    uint64_t startNs;
+
+    startNs = DBUS_STAT_Begin();
 
     BLE_TRSPC_PropertyHandler(p_proxy, p_name, p_iter);
 
@@ -1519,6 +1555,8 @@ void APP_DBP_PropertyChanged(GDBusProxy *p_proxy, const char *p_name, DBusMessag
     else if (!strcmp(p_interface, "org.bluez.GattCharacteristic1")) {
         app_dbp_GetSSF(p_proxy);
     }
+
+    DBUS_STAT_End(DBUS_STAT_TYPE_SIGNAL_RECV, p_name, startNs);
 }
 
 void APP_DBP_DBusConnectHandler(DBusConnection *p_connection, void *p_userData)
@@ -1538,7 +1576,10 @@ void APP_DBP_DBusMessageHandler(DBusConnection *p_connection, DBusMessage *p_mes
 
 void APP_DBP_ClientReady(GDBusClient *p_client, void *p_userData)
 {
-    bt_shell_attach(fileno(stdin));
+    if (APP_SCRIPT_IsEnabled())
+        APP_SCRIPT_Start();
+    else
+        bt_shell_attach(fileno(stdin));
 }
 
 
@@ -73,6 +73,7 @@ void APP_DBP_RemoveByIndex(int idx);
 void APP_DBP_RemoveDeviceList(bool includeConnectedDevices);
 APP_DBP_BtDev_T * APP_DBP_GetDevInfoByProxy(DeviceProxy *p_proxy);
 APP_DBP_BtDev_T * APP_DBP_GetDevInfoByIndex(int idx);
+APP_DBP_BtDev_T * APP_DBP_GetDevInfoByAddress(const char *p_address);
 uint16_t APP_DBP_GetAdapterAddr(BLE_GAP_Addr_T *p_addr);
 void APP_DBP_ProxyAdded(GDBusProxy *p_proxy, void *p_userData);
 void APP_DBP_ProxyRemoved(GDBusProxy *p_proxy, void *p_userData);
@@ -0,0 +1,359 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Data Plane Worker Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_dp.c
+
+  Summary:
+    This file contains the Application data plane worker functions for this project.
+
+  Description:
+    This file contains the Application data plane worker functions for this project.
+    The jobs are sharded across a pool of workers by link, the jobs of a link always run on
+    the same worker and so keep their order. Each worker has two single-producer
+    single-consumer rings: the main loop pushes to the job ring and the worker pops it, the
+    worker pushes to the done ring and the main loop pops it. Each ring is watched by a
+    GSource in the context of its consumer, the producer wakes that context up after a push.
+    No lock is taken on the data path. A submit waiting for room in a full job ring moves the
+    done jobs of the worker to a deferred list of the main loop, so that the worker is never
+    kept waiting for room in the done ring at the same time.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+#include <glib.h>
+
+#include "app_dp.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_DP_QUEUE_MASK               (APP_DP_QUEUE_SIZE - 1)
+#define APP_DP_WAIT_US                  100
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief The structure contains a job. */
+typedef struct APP_DP_Job_T
+{
+    APP_DP_JobFunc_T    p_work;         /**< Step run on the worker thread. */
+    APP_DP_JobFunc_T    p_done;         /**< Step run on the main loop, may be NULL. */
+    void                *p_data;        /**< Job data. */
+} APP_DP_Job_T;
+
+/**@brief The structure contains a single-producer single-consumer ring. */
+typedef struct APP_DP_Queue_T
+{
+    APP_DP_Job_T        jobs[APP_DP_QUEUE_SIZE];
+    gint                head;           /**< Next slot to push, written by the producer only. */
+    gint                tail;           /**< Next slot to pop, written by the consumer only. */
+    GMainContext        *p_consumer;    /**< Context woken up after a push. */
+} APP_DP_Queue_T;
+
+/**@brief The structure contains a worker. */
+typedef struct APP_DP_Worker_T
+{
+    APP_DP_Queue_T      jobQueue;
+    APP_DP_Queue_T      doneQueue;
+    GQueue              deferred;       /**< Done jobs taken from the done ring by a waiting submit, main loop only. */
+    GMainContext        *p_context;
+    GThread             *p_thread;
+} APP_DP_Worker_T;
+
+/**@brief The structure contains the source watching a ring. */
+typedef struct APP_DP_Source_T
+{
+    GSource             source;
+    APP_DP_Worker_T     *p_worker;
+    APP_DP_Queue_T      *p_queue;
+    GQueue              *p_deferred;    /**< Deferred done jobs also watched, NULL for the job ring. */
+} APP_DP_Source_T;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static APP_DP_Worker_T      s_dpWorkers[APP_DP_MAX_WORKER_NUM];
+static uint8_t              s_dpWorkerNum = 0;  /**< Started workers, 0 before APP_DP_Init(). */
+static uint8_t              s_dpReqWorkerNum = APP_DP_WORKER_NUM_AUTO;  /**< Requested pool size. */
+static uint32_t             s_dpPending;        /**< Submitted jobs whose done step has not run, main loop only. */
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static bool app_dp_QueuePush(APP_DP_Queue_T *p_queue, const APP_DP_Job_T *p_job)
+{
+    guint head = (guint)p_queue->head;
+
+    if (head - (guint)g_atomic_int_get(&p_queue->tail) >= APP_DP_QUEUE_SIZE)
+        return false;
+
+    p_queue->jobs[head & APP_DP_QUEUE_MASK] = *p_job;
+    // Publish the slot before the new head, the atomic store is a full barrier
+    g_atomic_int_set(&p_queue->head, (gint)(head + 1));
+    g_main_context_wakeup(p_queue->p_consumer);
+
+    return true;
+}
+
+static bool app_dp_QueuePop(APP_DP_Queue_T *p_queue, APP_DP_Job_T *p_job)
+{
+    guint tail = (guint)p_queue->tail;
+
+    if (tail == (guint)g_atomic_int_get(&p_queue->head))
+        return false;
+
+    *p_job = p_queue->jobs[tail & APP_DP_QUEUE_MASK];
+    g_atomic_int_set(&p_queue->tail, (gint)(tail + 1));
+
+    return true;
+}
+
+static bool app_dp_QueueReady(APP_DP_Queue_T *p_queue)
+{
+    return p_queue->tail != g_atomic_int_get(&p_queue->head);
+}
+
+static bool app_dp_SourceReady(APP_DP_Source_T *p_dpSource)
+{
+    if ((p_dpSource->p_deferred != NULL) && !g_queue_is_empty(p_dpSource->p_deferred))
+        return true;
+
+    return app_dp_QueueReady(p_dpSource->p_queue);
+}
+
+static gboolean app_dp_SourcePrepare(GSource *p_source, gint *p_timeout)
+{
+    *p_timeout = -1;
+    return app_dp_SourceReady((APP_DP_Source_T *)p_source);
+}
+
+static gboolean app_dp_SourceCheck(GSource *p_source)
+{
+    return app_dp_SourceReady((APP_DP_Source_T *)p_source);
+}
+
+static gboolean app_dp_SourceDispatch(GSource *p_source, GSourceFunc callback, gpointer p_userData)
+{
+    (void)p_source;
+
+    return callback(p_userData);
+}
+
+static GSourceFuncs s_dpSourceFuncs =
+{
+    app_dp_SourcePrepare,
+    app_dp_SourceCheck,
+    app_dp_SourceDispatch,
+    NULL,
+};
+
+static void app_dp_AttachSource(APP_DP_Worker_T *p_worker, APP_DP_Queue_T *p_queue, GQueue *p_deferred,
+    GSourceFunc callback)
+{
+    GSource *p_source;
+
+    p_source = g_source_new(&s_dpSourceFuncs, sizeof(APP_DP_Source_T));
+    ((APP_DP_Source_T *)p_source)->p_worker = p_worker;
+    ((APP_DP_Source_T *)p_source)->p_queue = p_queue;
+    ((APP_DP_Source_T *)p_source)->p_deferred = p_deferred;
+    g_source_set_callback(p_source, callback, p_worker, NULL);
+    g_source_attach(p_source, p_queue->p_consumer);
+    g_source_unref(p_source);
+}
+
+static void app_dp_RunDone(APP_DP_Job_T *p_job)
+{
+    if (p_job->p_done != NULL)
+        p_job->p_done(p_job->p_data);
+    s_dpPending--;
+}
+
+static void app_dp_DrainDone(APP_DP_Worker_T *p_worker)
+{
+    APP_DP_Job_T job, *p_job;
+
+    // The deferred jobs are older than the ones still in the ring
+    while ((p_job = g_queue_pop_head(&p_worker->deferred)) != NULL)
+    {
+        app_dp_RunDone(p_job);
+        g_free(p_job);
+    }
+
+    while (app_dp_QueuePop(&p_worker->doneQueue, &job))
+        app_dp_RunDone(&job);
+}
+
+//Make room in the done ring without running the done steps
+static void app_dp_DeferDone(APP_DP_Worker_T *p_worker)
+{
+    APP_DP_Job_T job, *p_job;
+
+    while (app_dp_QueuePop(&p_worker->doneQueue, &job))
+    {
+        p_job = g_new(APP_DP_Job_T, 1);
+        *p_job = job;
+        g_queue_push_tail(&p_worker->deferred, p_job);
+    }
+}
+
+static void app_dp_DrainAllDone(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < s_dpWorkerNum; i++)
+        app_dp_DrainDone(&s_dpWorkers[i]);
+}
+
+static gboolean app_dp_DoneProc(gpointer p_userData)
+{
+    app_dp_DrainDone((APP_DP_Worker_T *)p_userData);
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean app_dp_JobProc(gpointer p_userData)
+{
+    APP_DP_Worker_T *p_worker = (APP_DP_Worker_T *)p_userData;
+    APP_DP_Job_T job;
+
+    while (app_dp_QueuePop(&p_worker->jobQueue, &job))
+    {
+        job.p_work(job.p_data);
+
+        // The job slot is free already, a submit waiting for room in the job ring empties the done ring
+        while (!app_dp_QueuePush(&p_worker->doneQueue, &job))
+            g_usleep(APP_DP_WAIT_US);
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+static gpointer app_dp_Thread(gpointer p_data)
+{
+    APP_DP_Worker_T *p_worker = (APP_DP_Worker_T *)p_data;
+    GMainLoop *p_loop;
+
+    g_main_context_push_thread_default(p_worker->p_context);
+    p_loop = g_main_loop_new(p_worker->p_context, FALSE);
+    g_main_loop_run(p_loop);
+    g_main_loop_unref(p_loop);
+    g_main_context_pop_thread_default(p_worker->p_context);
+
+    return NULL;
+}
+
+void APP_DP_SetWorkerNum(uint8_t workerNum)
+{
+    if (workerNum != APP_DP_WORKER_NUM_AUTO && workerNum > APP_DP_MAX_WORKER_NUM)
+        workerNum = APP_DP_MAX_WORKER_NUM;
+
+    s_dpReqWorkerNum = workerNum;
+}
+
+void APP_DP_Init(void)
+{
+    APP_DP_Worker_T *p_worker;
+    char name[16];
+    uint8_t workerNum;
+
+    if (s_dpWorkerNum > 0)
+        return;
+
+    workerNum = s_dpReqWorkerNum;
+    if (workerNum == APP_DP_WORKER_NUM_AUTO)
+    {
+        // One worker per core, the main loop keeps a core of its own when there are enough
+        workerNum = g_get_num_processors() > 1 ? g_get_num_processors() - 1 : 1;
+        if (workerNum > APP_DP_MAX_WORKER_NUM)
+            workerNum = APP_DP_MAX_WORKER_NUM;
+    }
+
+    s_dpPending = 0;
+
+    for (s_dpWorkerNum = 0; s_dpWorkerNum < workerNum; s_dpWorkerNum++)
+    {
+        p_worker = &s_dpWorkers[s_dpWorkerNum];
+
+        p_worker->p_context = g_main_context_new();
+        p_worker->jobQueue.head = p_worker->jobQueue.tail = 0;
+        p_worker->jobQueue.p_consumer = p_worker->p_context;
+        p_worker->doneQueue.head = p_worker->doneQueue.tail = 0;
+        p_worker->doneQueue.p_consumer = g_main_context_default();
+        g_queue_init(&p_worker->deferred);
+
+        app_dp_AttachSource(p_worker, &p_worker->jobQueue, NULL, app_dp_JobProc);
+        app_dp_AttachSource(p_worker, &p_worker->doneQueue, &p_worker->deferred, app_dp_DoneProc);
+
+        snprintf(name, sizeof(name), "dpthread%d", s_dpWorkerNum);
+        p_worker->p_thread = g_thread_new(name, app_dp_Thread, p_worker);
+    }
+}
+
+void APP_DP_Submit(uint8_t shard, APP_DP_JobFunc_T p_work, APP_DP_JobFunc_T p_done, void *p_data)
+{
+    APP_DP_Worker_T *p_worker;
+    APP_DP_Job_T job;
+
+    job.p_work = p_work;
+    job.p_done = p_done;
+    job.p_data = p_data;
+
+    // Without the workers the job runs in place, the order of the jobs is kept either way.
+    // This is also the case of the jobs submitted before APP_DP_Init().
+    if (s_dpWorkerNum == 0)
+    {
+        p_work(p_data);
+        if (p_done != NULL)
+            p_done(p_data);
+        return;
+    }
+
+    p_worker = &s_dpWorkers[shard % s_dpWorkerNum];
+
+    // The done steps are not run here, the caller may be the state machine they report to.
+    // They are deferred instead, the worker may be waiting for room in the done ring.
+    while (!app_dp_QueuePush(&p_worker->jobQueue, &job))
+    {
+        app_dp_DeferDone(p_worker);
+        g_usleep(APP_DP_WAIT_US);
+    }
+    s_dpPending++;
+}
+
+void APP_DP_Sync(void)
+{
+    app_dp_DrainAllDone();
+
+    while (s_dpPending > 0)
+    {
+        g_usleep(APP_DP_WAIT_US);
+        app_dp_DrainAllDone();
+    }
+}
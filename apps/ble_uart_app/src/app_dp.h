@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Data Plane Worker Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_dp.h
+
+  Summary:
+    This file contains the Application data plane worker functions for this project.
+
+  Description:
+    This file contains the Application data plane worker functions for this project.
+    Blocking data work, e.g. writing received file data and verifying it, runs on a pool of
+    worker threads with their own GMainContext, off the main loop that dispatches D-Bus and
+    the shell. The links are sharded across the workers. With no worker the jobs run in place
+    on the main loop, as they would in a single thread application.
+ *******************************************************************************/
+
+#ifndef APP_DP_H
+#define APP_DP_H
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_DP_QUEUE_SIZE                       64      /**< Jobs in flight to and from a worker, a power of 2. */
+#define APP_DP_MAX_WORKER_NUM                   8       /**< Maximum number of workers in the pool. */
+#define APP_DP_WORKER_NUM_AUTO                  0xFF    /**< One worker per CPU core but the main loop one. */
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief The function type of a job step.
+ * @param[in] p_data                The data of the job.
+ */
+typedef void (*APP_DP_JobFunc_T)(void *p_data);
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Set the number of workers started by APP_DP_Init(). It has no effect once the workers are started.
+ * @param[in] workerNum             Number of workers, 0 to run the jobs in place on the main loop,
+ *                                  APP_DP_WORKER_NUM_AUTO for one per CPU core but the main loop one.
+ */
+void APP_DP_SetWorkerNum(uint8_t workerNum);
+
+/**@brief Start the worker threads. It must be called from the main loop thread. */
+void APP_DP_Init(void);
+
+/**@brief Queue a job to the worker owning the shard. The jobs of a shard run one at a time in the
+ *        order they are submitted, and so do their done steps. The job data must not be used by the
+ *        main loop until the done step. Without workers both steps run before it returns, otherwise
+ *        the done step runs later from the main loop, never from inside this function.
+ * @param[in] shard                 The shard of the job, e.g. the link index.
+ * @param[in] p_work                The step run on the worker thread.
+ * @param[in] p_done                The step run on the main loop once the work is done, may be NULL.
+ * @param[in] p_data                The data passed to both steps.
+ */
+void APP_DP_Submit(uint8_t shard, APP_DP_JobFunc_T p_work, APP_DP_JobFunc_T p_done, void *p_data);
+
+/**@brief Wait until all the submitted jobs are done, including their done steps. */
+void APP_DP_Sync(void);
+
+
+#endif
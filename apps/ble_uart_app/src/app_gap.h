@@ -49,9 +49,12 @@
 /** @} */
 
 /**@defgroup BLE_GAP_MAX_LINK_NBR Maximum connection number
- * @brief The definition of maximum allowed link number of GAP connections
+ * @brief The definition of maximum allowed link number of GAP connections. The number is chosen at startup,
+ *        before the connection tables are allocated, and does not change afterwards.
  * @{ */
-#define BLE_GAP_MAX_LINK_NBR                                    0x06        /**< Maximum allowed BLE GAP connections */
+#define BLE_GAP_DEFAULT_LINK_NBR                                0x06        /**< Default allowed BLE GAP connections */
+#define BLE_GAP_MAX_LINK_NBR_LIMIT                              0x40        /**< Upper limit of the allowed BLE GAP connections */
+#define BLE_GAP_MAX_LINK_NBR                                    (APP_BLE_GetMaxLinkNumber())    /**< Maximum allowed BLE GAP connections */
 /** @} */
 
 /**@defgroup BLE_GAP_ADV_DATA_LEN Maximum advertising data length
@@ -91,6 +94,16 @@ typedef struct BLE_GAP_Addr_T
 } BLE_GAP_Addr_T;
 
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Get the maximum allowed BLE GAP connections. See @ref BLE_GAP_MAX_LINK_NBR. */
+uint8_t APP_BLE_GetMaxLinkNumber(void);
+
+
 
 /**@} */
 #endif
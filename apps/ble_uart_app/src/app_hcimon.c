@@ -0,0 +1,744 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application HCI Monitor Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_hcimon.c
+
+  Summary:
+    This file contains the Application HCI monitor functions for this project.
+
+  Description:
+    This file contains the Application HCI monitor functions for this project.
+    The raw socket sees the ACL packets in both directions, only their header is read. A sent
+    packet is in flight until the controller reports it in Number Of Completed Packets, its
+    length is then counted as over-the-air goodput. The LE meta events keep the connection
+    interval, PHY and data length of every handle up to date.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <glib.h>
+
+#include "bluetooth/bluetooth.h"
+#include "bluetooth/hci.h"
+#include "bluetooth/hci_lib.h"
+#include "shared/shell.h"
+
+#include "application.h"
+#include "app_hcimon.h"
+#include "app_ble_handler.h"
+#include "app_dbp.h"
+#include "app_trp_common.h"
+#include "app_tune.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_HCIMON_DEV_ID               0           /**< Same controller as the one used by the management interface. */
+#define APP_HCIMON_MAX_PKT_SIZE         260         /**< Longest event, ACL packets are truncated to it. */
+#define APP_HCIMON_MAX_CONN             BLE_GAP_MAX_LINK_NBR
+#define APP_HCIMON_HANDLE_MASK          0x0FFF
+
+#define APP_HCIMON_LE_CONN_COMPLETE             0x01
+#define APP_HCIMON_LE_CONN_UPDATE_COMPLETE      0x03
+#define APP_HCIMON_LE_DATA_LENGTH_CHANGE        0x07
+#define APP_HCIMON_LE_ENH_CONN_COMPLETE         0x0A
+#define APP_HCIMON_LE_PHY_UPDATE_COMPLETE       0x0C
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief The structure contains the controller side state of a connection handle. */
+typedef struct APP_HCIMON_Conn_T
+{
+    bool                used;
+    uint16_t            handle;
+    char                address[18];        /**< Peer address, empty until known. */
+    uint16_t            interval;           /**< Connection interval in 1.25 ms units, 0 until known. */
+    uint16_t            latency;
+    uint16_t            timeout;            /**< Supervision timeout in 10 ms units. */
+    uint8_t             txPhy;              /**< 1=1M, 2=2M, 3=Coded, 0 until known. */
+    uint8_t             rxPhy;
+    uint16_t            maxTxOctets;        /**< LL data length, 0 until known. */
+    uint16_t            maxRxOctets;
+    uint16_t            sentLeng[APP_HCIMON_MAX_IN_FLIGHT]; /**< Lengths of the packets in flight, oldest first from sentHead. */
+    uint8_t             sentHead;
+    uint8_t             sentCount;
+    uint16_t            lastLeng;           /**< Length of the last completed packet. */
+    uint16_t            inFlight;           /**< ACL packets sent to the controller and not completed yet. */
+    uint16_t            maxInFlight;
+    uint32_t            txPkts;
+    uint32_t            completedPkts;
+    uint64_t            txBytes;            /**< Bytes of the completed ACL packets. */
+    uint64_t            rxBytes;            /**< Bytes of the received ACL packets. */
+    gint64              winStart;           /**< Start of the rate window, monotonic time in us. */
+    uint64_t            winTxBytes;
+    uint64_t            winRxBytes;
+    uint32_t            winAppBytes;        /**< TRP payload counters of the link at the start of the window. */
+} APP_HCIMON_Conn_T;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static guint                s_hcimonWatch;
+static int                  s_hcimonFd = -1;
+static APP_HCIMON_Conn_T    *sp_hcimonConn;         /**< Table of APP_HCIMON_MAX_CONN entries, allocated once by APP_HCIMON_Init(). */
+static uint8_t              *sp_hcimonFreeNext;     /**< Next free entry of each free entry, APP_HCIMON_MAX_CONN ends the list. */
+static uint8_t              s_hcimonFreeHead;
+static GHashTable           *sp_hcimonConnByHandle; /**< Used entries by connection handle. */
+static uint16_t             s_hcimonCtrlBufNum;     /**< LE ACL buffers of the controller, 0 if unknown. */
+static uint16_t             s_hcimonCtrlBufLen;
+static uint16_t             s_hcimonInFlight;       /**< ACL packets in flight on all the links. */
+static uint16_t             s_hcimonMaxInFlight;
+static uint32_t             s_hcimonOverflows;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static APP_HCIMON_Conn_T *app_hcimon_GetConn(uint16_t handle, bool alloc)
+{
+    APP_HCIMON_Conn_T *p_free;
+
+    p_free = g_hash_table_lookup(sp_hcimonConnByHandle, GUINT_TO_POINTER(handle));
+    if (p_free != NULL)
+        return p_free;
+
+    if (!alloc || s_hcimonFreeHead >= APP_HCIMON_MAX_CONN)
+        return NULL;
+
+    p_free = &sp_hcimonConn[s_hcimonFreeHead];
+    s_hcimonFreeHead = sp_hcimonFreeNext[s_hcimonFreeHead];
+
+    memset(p_free, 0, sizeof(APP_HCIMON_Conn_T));
+    p_free->used = true;
+    p_free->handle = handle;
+    p_free->winStart = g_get_monotonic_time();
+    g_hash_table_insert(sp_hcimonConnByHandle, GUINT_TO_POINTER(handle), p_free);
+
+    return p_free;
+}
+
+static void app_hcimon_FreeConn(APP_HCIMON_Conn_T *p_conn)
+{
+    uint8_t index = (uint8_t)(p_conn - sp_hcimonConn);
+
+    s_hcimonInFlight = (s_hcimonInFlight > p_conn->inFlight) ? s_hcimonInFlight - p_conn->inFlight : 0;
+    g_hash_table_remove(sp_hcimonConnByHandle, GUINT_TO_POINTER(p_conn->handle));
+    p_conn->used = false;
+
+    sp_hcimonFreeNext[index] = s_hcimonFreeHead;
+    s_hcimonFreeHead = index;
+}
+
+static uint32_t app_hcimon_AppBytes(APP_HCIMON_Conn_T *p_conn)
+{
+    APP_DBP_BtDev_T *p_dev;
+    APP_TRP_ConnList_T *p_trpConn;
+
+    if (p_conn->address[0] == '\0')
+        return 0;
+
+    p_dev = APP_DBP_GetDevInfoByAddress(p_conn->address);
+    if (p_dev == NULL)
+        return 0;
+
+    p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy(p_dev->p_devProxy);
+    if (p_trpConn == NULL)
+        return 0;
+
+    return p_trpConn->txTotalLeng + p_trpConn->rxAccuLeng;
+}
+
+static void app_hcimon_StartWindow(APP_HCIMON_Conn_T *p_conn)
+{
+    p_conn->winStart = g_get_monotonic_time();
+    p_conn->winTxBytes = p_conn->txBytes;
+    p_conn->winRxBytes = p_conn->rxBytes;
+    p_conn->winAppBytes = app_hcimon_AppBytes(p_conn);
+}
+
+//The links up before the monitor started have no connection complete event, find their peer from the kernel.
+static void app_hcimon_ResolveAddress(APP_HCIMON_Conn_T *p_conn)
+{
+    struct hci_conn_info_req *p_req;
+    uint8_t buf[sizeof(struct hci_conn_info_req) + sizeof(struct hci_conn_info)];
+    APP_TRP_ConnList_T *p_trpConn;
+    APP_DBP_BtDev_T *p_dev;
+    uint8_t i;
+
+    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    {
+        p_trpConn = APP_TRP_COMMON_GetConnListByIndex(i);
+        if (p_trpConn == NULL)
+            continue;
+
+        p_dev = APP_DBP_GetDevInfoByProxy(p_trpConn->p_deviceProxy);
+        if ((p_dev == NULL) || (p_dev->p_address == NULL))
+            continue;
+
+        memset(buf, 0, sizeof(buf));
+        p_req = (struct hci_conn_info_req *)buf;
+        str2ba(p_dev->p_address, &p_req->bdaddr);
+        p_req->type = LE_LINK;
+
+        if (ioctl(s_hcimonFd, HCIGETCONNINFO, (unsigned long)p_req) == 0 && p_req->conn_info->handle == p_conn->handle)
+        {
+            snprintf(p_conn->address, sizeof(p_conn->address), "%s", p_dev->p_address);
+            return;
+        }
+    }
+}
+
+static void app_hcimon_AclProc(const uint8_t *p_pkt, ssize_t len, bool incoming)
+{
+    APP_HCIMON_Conn_T *p_conn;
+    uint16_t handle, dataLeng;
+
+    if (len < 1 + HCI_ACL_HDR_SIZE)
+        return;
+
+    handle = get_le16(&p_pkt[1]) & APP_HCIMON_HANDLE_MASK;
+    dataLeng = get_le16(&p_pkt[3]);
+
+    p_conn = app_hcimon_GetConn(handle, true);
+    if (p_conn == NULL)
+        return;
+
+    if (incoming)
+    {
+        p_conn->rxBytes += dataLeng;
+        return;
+    }
+
+    //Past the ring the length is lost, the completion falls back to the last one.
+    if (p_conn->sentCount < APP_HCIMON_MAX_IN_FLIGHT)
+    {
+        p_conn->sentLeng[(p_conn->sentHead + p_conn->sentCount) & (APP_HCIMON_MAX_IN_FLIGHT - 1)] = dataLeng;
+        p_conn->sentCount++;
+    }
+    p_conn->inFlight++;
+    p_conn->txPkts++;
+    if (p_conn->inFlight > p_conn->maxInFlight)
+        p_conn->maxInFlight = p_conn->inFlight;
+
+    s_hcimonInFlight++;
+    if (s_hcimonInFlight > s_hcimonMaxInFlight)
+        s_hcimonMaxInFlight = s_hcimonInFlight;
+}
+
+static void app_hcimon_CompletedProc(uint16_t handle, uint16_t count)
+{
+    APP_HCIMON_Conn_T *p_conn;
+
+    p_conn = app_hcimon_GetConn(handle, false);
+    if (p_conn == NULL)
+        return;
+
+    p_conn->completedPkts += count;
+
+    while (count-- > 0 && p_conn->inFlight > 0)
+    {
+        if (p_conn->sentCount > 0)
+        {
+            p_conn->lastLeng = p_conn->sentLeng[p_conn->sentHead];
+            p_conn->sentHead = (p_conn->sentHead + 1) & (APP_HCIMON_MAX_IN_FLIGHT - 1);
+            p_conn->sentCount--;
+        }
+        p_conn->txBytes += p_conn->lastLeng;
+        p_conn->inFlight--;
+        if (s_hcimonInFlight > 0)
+            s_hcimonInFlight--;
+    }
+}
+
+static void app_hcimon_LeMetaProc(const uint8_t *p_evt, uint8_t len)
+{
+    APP_HCIMON_Conn_T *p_conn;
+    const uint8_t *p_addr = NULL;
+    const uint8_t *p_para = NULL;
+    uint16_t handle;
+    bdaddr_t bdaddr;
+
+    if (len < 1)
+        return;
+
+    switch (p_evt[0])
+    {
+        case APP_HCIMON_LE_CONN_COMPLETE:
+        case APP_HCIMON_LE_ENH_CONN_COMPLETE:
+        {
+            if (len < ((p_evt[0] == APP_HCIMON_LE_CONN_COMPLETE) ? 18 : 30) || p_evt[1] != 0)
+                return;
+
+            handle = get_le16(&p_evt[2]) & APP_HCIMON_HANDLE_MASK;
+            p_addr = &p_evt[6];
+            p_para = (p_evt[0] == APP_HCIMON_LE_CONN_COMPLETE) ? &p_evt[12] : &p_evt[24];
+
+            //A handle is reused once disconnected, drop whatever is left of the previous link.
+            p_conn = app_hcimon_GetConn(handle, false);
+            if (p_conn != NULL)
+                app_hcimon_FreeConn(p_conn);
+            p_conn = app_hcimon_GetConn(handle, true);
+            if (p_conn == NULL)
+                return;
+
+            memcpy(&bdaddr, p_addr, sizeof(bdaddr));
+            ba2str(&bdaddr, p_conn->address);
+            p_conn->interval = get_le16(&p_para[0]);
+            p_conn->latency = get_le16(&p_para[2]);
+            p_conn->timeout = get_le16(&p_para[4]);
+            p_conn->txPhy = p_conn->rxPhy = 1;
+        }
+        break;
+
+        case APP_HCIMON_LE_CONN_UPDATE_COMPLETE:
+        {
+            if (len < 10)
+                return;
+
+            handle = get_le16(&p_evt[2]) & APP_HCIMON_HANDLE_MASK;
+            p_conn = (p_evt[1] == 0) ? app_hcimon_GetConn(handle, true) : NULL;
+            if (p_conn != NULL)
+            {
+                p_conn->interval = get_le16(&p_evt[4]);
+                p_conn->latency = get_le16(&p_evt[6]);
+                p_conn->timeout = get_le16(&p_evt[8]);
+            }
+
+            //The tuner reads the parameters back, they are updated first
+            APP_TUNE_LinkUpdated(handle, APP_TUNE_UPDATE_CONN, p_evt[1]);
+        }
+        break;
+
+        case APP_HCIMON_LE_DATA_LENGTH_CHANGE:
+        {
+            if (len < 11)
+                return;
+
+            p_conn = app_hcimon_GetConn(get_le16(&p_evt[1]) & APP_HCIMON_HANDLE_MASK, true);
+            if (p_conn == NULL)
+                return;
+
+            p_conn->maxTxOctets = get_le16(&p_evt[3]);
+            p_conn->maxRxOctets = get_le16(&p_evt[7]);
+        }
+        break;
+
+        case APP_HCIMON_LE_PHY_UPDATE_COMPLETE:
+        {
+            if (len < 6)
+                return;
+
+            handle = get_le16(&p_evt[2]) & APP_HCIMON_HANDLE_MASK;
+            p_conn = (p_evt[1] == 0) ? app_hcimon_GetConn(handle, true) : NULL;
+            if (p_conn != NULL)
+            {
+                p_conn->txPhy = p_evt[4];
+                p_conn->rxPhy = p_evt[5];
+            }
+
+            APP_TUNE_LinkUpdated(handle, APP_TUNE_UPDATE_PHY, p_evt[1]);
+        }
+        break;
+
+        default:
+        break;
+    }
+}
+
+static void app_hcimon_EvtProc(const uint8_t *p_pkt, ssize_t len)
+{
+    APP_HCIMON_Conn_T *p_conn;
+    const uint8_t *p_evt;
+    uint8_t evtLen;
+    uint8_t i;
+
+    //Packet type, event code and parameter length come first.
+    if (len < 1 + HCI_EVENT_HDR_SIZE)
+        return;
+
+    p_evt = &p_pkt[1 + HCI_EVENT_HDR_SIZE];
+    evtLen = p_pkt[2];
+    if (len < 1 + HCI_EVENT_HDR_SIZE + evtLen)
+        return;
+
+    switch (p_pkt[1])
+    {
+        case EVT_NUM_COMP_PKTS:
+        {
+            if (evtLen < 1 || evtLen < 1 + p_evt[0] * 4)
+                return;
+
+            for (i = 0; i < p_evt[0]; i++)
+            {
+                app_hcimon_CompletedProc(get_le16(&p_evt[1 + i * 4]) & APP_HCIMON_HANDLE_MASK,
+                    get_le16(&p_evt[3 + i * 4]));
+            }
+        }
+        break;
+
+        case EVT_DISCONN_COMPLETE:
+        {
+            if (evtLen < 3 || p_evt[0] != 0)
+                return;
+
+            p_conn = app_hcimon_GetConn(get_le16(&p_evt[1]) & APP_HCIMON_HANDLE_MASK, false);
+            if (p_conn == NULL)
+                return;
+
+            //The controller flushes the packets of the link, they are never completed.
+            app_hcimon_FreeConn(p_conn);
+        }
+        break;
+
+        case EVT_LE_META_EVENT:
+        {
+            app_hcimon_LeMetaProc(p_evt, evtLen);
+        }
+        break;
+
+        case EVT_CMD_STATUS:
+        {
+            if (evtLen < EVT_CMD_STATUS_SIZE)
+                return;
+
+            //A command refused by the controller gets no completion event
+            APP_TUNE_CmdStatus(get_le16(&p_evt[2]), p_evt[0]);
+        }
+        break;
+
+        case EVT_DATA_BUFFER_OVERFLOW:
+        {
+            s_hcimonOverflows++;
+            bt_shell_printf("Data buffer overflow detected.\n");
+        }
+        break;
+
+        default:
+        break;
+    }
+}
+
+static gboolean app_hcimon_Read(GIOChannel *p_chan, GIOCondition cond, gpointer p_data)
+{
+    uint8_t buf[APP_HCIMON_MAX_PKT_SIZE];
+    uint8_t control[64];
+    struct cmsghdr *p_cmsg;
+    struct msghdr msg;
+    struct iovec iov;
+    ssize_t len;
+    int incoming;
+
+    (void)p_chan;
+    (void)p_data;
+
+    if (cond & (G_IO_HUP | G_IO_ERR | G_IO_NVAL))
+    {
+        printf("HCI event monitor stopped\n");
+        s_hcimonWatch = 0;
+        s_hcimonFd = -1;
+        return FALSE;
+    }
+
+    //Drain the socket, the watch fires again only for new packets.
+    while (1)
+    {
+        iov.iov_base = buf;
+        iov.iov_len = sizeof(buf);
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        len = recvmsg(s_hcimonFd, &msg, MSG_DONTWAIT);
+        if (len <= 0)
+            break;
+
+        if (buf[0] == HCI_EVENT_PKT)
+        {
+            app_hcimon_EvtProc(buf, len);
+            continue;
+        }
+
+        incoming = 1;
+        for (p_cmsg = CMSG_FIRSTHDR(&msg); p_cmsg != NULL; p_cmsg = CMSG_NXTHDR(&msg, p_cmsg))
+        {
+            if (p_cmsg->cmsg_level == SOL_HCI && p_cmsg->cmsg_type == HCI_CMSG_DIR)
+                memcpy(&incoming, CMSG_DATA(p_cmsg), sizeof(incoming));
+        }
+
+        if (buf[0] == HCI_ACLDATA_PKT)
+            app_hcimon_AclProc(buf, len, incoming != 0);
+    }
+
+    if (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+    {
+        perror("Failed to read HCI event");
+        s_hcimonWatch = 0;
+        s_hcimonFd = -1;
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void app_hcimon_ReadCtrlBuffer(void)
+{
+    le_read_buffer_size_rp rp;
+    struct hci_request rq;
+    struct hci_dev_info di;
+    int dd;
+
+    dd = hci_open_dev(APP_HCIMON_DEV_ID);
+    if (dd < 0)
+        return;
+
+    memset(&rp, 0, sizeof(rp));
+    memset(&rq, 0, sizeof(rq));
+    rq.ogf = OGF_LE_CTL;
+    rq.ocf = OCF_LE_READ_BUFFER_SIZE;
+    rq.rparam = &rp;
+    rq.rlen = LE_READ_BUFFER_SIZE_RP_SIZE;
+
+    if (hci_send_req(dd, &rq, 1000) == 0 && rp.status == 0 && rp.max_pkt != 0)
+    {
+        s_hcimonCtrlBufNum = rp.max_pkt;
+        s_hcimonCtrlBufLen = btohs(rp.pkt_len);
+    }
+    else if (hci_devinfo(APP_HCIMON_DEV_ID, &di) == 0)
+    {
+        //No dedicated LE buffers, LE shares the BR/EDR ones.
+        s_hcimonCtrlBufNum = di.acl_pkts;
+        s_hcimonCtrlBufLen = di.acl_mtu;
+    }
+
+    hci_close_dev(dd);
+}
+
+static int app_hcimon_OpenHciDev(uint16_t index)
+{
+    struct sockaddr_hci addr;
+    struct hci_filter flt;
+    int opt = 1;
+    int fd;
+
+    fd = socket(AF_BLUETOOTH, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, BTPROTO_HCI);
+    if (fd < 0) {
+        perror("Failed to open channel");
+        return -1;
+    }
+
+    /* Setup filter, only ACL headers and the monitored events wake the main loop up */
+    hci_filter_clear(&flt);
+    hci_filter_set_ptype(HCI_EVENT_PKT,  &flt);
+    hci_filter_set_ptype(HCI_ACLDATA_PKT,  &flt);
+    hci_filter_set_event(EVT_NUM_COMP_PKTS, &flt);
+    hci_filter_set_event(EVT_DISCONN_COMPLETE, &flt);
+    hci_filter_set_event(EVT_LE_META_EVENT, &flt);
+    hci_filter_set_event(EVT_CMD_STATUS, &flt);
+    hci_filter_set_event(EVT_DATA_BUFFER_OVERFLOW, &flt);
+
+    if (setsockopt(fd, SOL_HCI, HCI_FILTER, &flt, sizeof(flt)) < 0) {
+        perror("Failed to set HCI filter");
+        close(fd);
+        return -1;
+    }
+
+    if (setsockopt(fd, SOL_HCI, HCI_DATA_DIR, &opt, sizeof(opt)) < 0) {
+        perror("Failed to set HCI data direction");
+        close(fd);
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.hci_family = AF_BLUETOOTH;
+    addr.hci_dev = index;
+    addr.hci_channel = HCI_CHANNEL_RAW;
+
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+        perror("Failed to bind channel");
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+void APP_HCIMON_Init(void)
+{
+    GIOChannel *p_chan;
+    uint8_t i;
+
+    if (s_hcimonWatch)
+        return;
+
+    if (sp_hcimonConn == NULL)
+    {
+        sp_hcimonConn = g_new0(APP_HCIMON_Conn_T, APP_HCIMON_MAX_CONN);
+        sp_hcimonFreeNext = g_new0(uint8_t, APP_HCIMON_MAX_CONN);
+        sp_hcimonConnByHandle = g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+
+    memset(sp_hcimonConn, 0, APP_HCIMON_MAX_CONN * sizeof(APP_HCIMON_Conn_T));
+    g_hash_table_remove_all(sp_hcimonConnByHandle);
+    for (i = 0; i < APP_HCIMON_MAX_CONN; i++)
+        sp_hcimonFreeNext[i] = i + 1;
+    s_hcimonFreeHead = 0;
+    s_hcimonInFlight = 0;
+    s_hcimonMaxInFlight = 0;
+    s_hcimonOverflows = 0;
+
+    app_hcimon_ReadCtrlBuffer();
+
+    s_hcimonFd = app_hcimon_OpenHciDev(APP_HCIMON_DEV_ID);
+    if (s_hcimonFd < 0) {
+        printf("open_hci_dev fail, HCI event monitor is not started\n");
+        return;
+    }
+
+    p_chan = g_io_channel_unix_new(s_hcimonFd);
+    g_io_channel_set_close_on_unref(p_chan, TRUE);
+    g_io_channel_set_encoding(p_chan, NULL, NULL);
+    g_io_channel_set_buffered(p_chan, FALSE);
+
+    s_hcimonWatch = g_io_add_watch(p_chan, G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL, app_hcimon_Read, NULL);
+    g_io_channel_unref(p_chan);
+}
+
+bool APP_HCIMON_GetLinkParams(uint16_t handle, uint16_t *p_interval, uint8_t *p_txPhy, uint8_t *p_rxPhy)
+{
+    APP_HCIMON_Conn_T *p_conn;
+
+    if (sp_hcimonConn == NULL)
+        return false;
+
+    p_conn = app_hcimon_GetConn(handle & APP_HCIMON_HANDLE_MASK, false);
+    if (p_conn == NULL || p_conn->interval == 0 || p_conn->txPhy == 0)
+        return false;
+
+    *p_interval = p_conn->interval;
+    *p_txPhy = p_conn->txPhy;
+    *p_rxPhy = p_conn->rxPhy;
+
+    return true;
+}
+
+void APP_HCIMON_Reset(void)
+{
+    APP_HCIMON_Conn_T *p_conn;
+    uint8_t i;
+
+    if (sp_hcimonConn == NULL)
+        return;
+
+    for (i = 0; i < APP_HCIMON_MAX_CONN; i++)
+    {
+        p_conn = &sp_hcimonConn[i];
+        if (!p_conn->used)
+            continue;
+
+        p_conn->maxInFlight = p_conn->inFlight;
+        p_conn->txPkts = 0;
+        p_conn->completedPkts = 0;
+        p_conn->txBytes = 0;
+        p_conn->rxBytes = 0;
+        app_hcimon_StartWindow(p_conn);
+    }
+
+    s_hcimonMaxInFlight = s_hcimonInFlight;
+    s_hcimonOverflows = 0;
+}
+
+void APP_HCIMON_Print(void)
+{
+    static const char *phyStr[] = {"-", "1M", "2M", "LC"};
+    APP_HCIMON_Conn_T *p_conn;
+    APP_DBP_BtDev_T *p_dev;
+    uint32_t appBytes;
+    double elapsed;
+    uint8_t i;
+
+    if (!s_hcimonWatch)
+    {
+        bt_shell_printf("HCI event monitor is not running\n");
+        return;
+    }
+
+    if (s_hcimonCtrlBufNum)
+    {
+        bt_shell_printf("controller buffers = %d x %d bytes, in flight = %d (%d%%), peak = %d, overflows = %u\n",
+            s_hcimonCtrlBufNum, s_hcimonCtrlBufLen, s_hcimonInFlight, s_hcimonInFlight * 100 / s_hcimonCtrlBufNum,
+            s_hcimonMaxInFlight, s_hcimonOverflows);
+    }
+    else
+    {
+        bt_shell_printf("controller buffers = unknown, in flight = %d, peak = %d, overflows = %u\n",
+            s_hcimonInFlight, s_hcimonMaxInFlight, s_hcimonOverflows);
+    }
+
+    bt_shell_printf("[Index][     Address     ][Handle][ PHY ][Intv ms][DLE Tx/Rx][InFlight][Peak][Completed][OTA Tx kbps][OTA Rx kbps][App kbps]\n");
+    bt_shell_printf("=================================================================================\n");
+    for (i = 0; i < APP_HCIMON_MAX_CONN; i++)
+    {
+        p_conn = &sp_hcimonConn[i];
+        if (!p_conn->used)
+            continue;
+
+        if (p_conn->address[0] == '\0')
+            app_hcimon_ResolveAddress(p_conn);
+
+        p_dev = (p_conn->address[0] != '\0') ? APP_DBP_GetDevInfoByAddress(p_conn->address) : NULL;
+
+        //The TRP counters restart with every run, the window restarts with them.
+        appBytes = app_hcimon_AppBytes(p_conn);
+        if (appBytes < p_conn->winAppBytes)
+            p_conn->winAppBytes = 0;
+
+        elapsed = (g_get_monotonic_time() - p_conn->winStart) / 1000000.0;
+        if (elapsed <= 0)
+            elapsed = 1;
+
+        bt_shell_printf("dev#%2d\t[%17s][0x%04x][%2s/%2s][%7.2f][%4d/%4d][%8d][%4d][%9u][%11.1f][%11.1f][%8.1f]\n",
+            p_dev ? p_dev->index : -1, (p_conn->address[0] != '\0') ? p_conn->address : "-", p_conn->handle,
+            phyStr[(p_conn->txPhy < 4) ? p_conn->txPhy : 0], phyStr[(p_conn->rxPhy < 4) ? p_conn->rxPhy : 0],
+            p_conn->interval * 1.25, p_conn->maxTxOctets, p_conn->maxRxOctets, p_conn->inFlight, p_conn->maxInFlight,
+            p_conn->completedPkts, (p_conn->txBytes - p_conn->winTxBytes) * 8 / elapsed / 1000,
+            (p_conn->rxBytes - p_conn->winRxBytes) * 8 / elapsed / 1000,
+            (appBytes - p_conn->winAppBytes) * 8 / elapsed / 1000);
+
+        app_hcimon_StartWindow(p_conn);
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application HCI Monitor Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_hcimon.h
+
+  Summary:
+    This file contains the Application HCI monitor functions for this project.
+
+  Description:
+    This file contains the Application HCI monitor functions for this project.
+    A raw HCI socket is watched from the main loop to follow the controller side of every
+    LE link: ACL packets in flight, controller buffer occupancy, over-the-air goodput and
+    the connection parameters, PHY and data length in use.
+ *******************************************************************************/
+
+#ifndef APP_HCIMON_H
+#define APP_HCIMON_H
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_HCIMON_MAX_IN_FLIGHT                64      /**< Sent ACL packet lengths kept per link until completed, a power of 2. */
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Read the controller buffers and start watching the HCI socket. */
+void APP_HCIMON_Init(void);
+
+/**@brief Clear the counters of all links. */
+void APP_HCIMON_Reset(void);
+
+/**@brief Get the connection parameters of a link as last reported by the controller events.
+ * @param[in] handle                HCI connection handle.
+ * @param[out] p_interval           Connection interval, unit: 1.25 ms.
+ * @param[out] p_txPhy              PHY of the transmitter, 1=1M, 2=2M, 3=Coded.
+ * @param[out] p_rxPhy              PHY of the receiver.
+ * @retval true                     The parameters are known.
+ * @retval false                    The link is unknown or its parameters are not reported yet.
+ */
+bool APP_HCIMON_GetLinkParams(uint16_t handle, uint16_t *p_interval, uint8_t *p_txPhy, uint8_t *p_rxPhy);
+
+/**@brief Print the controller buffer occupancy and, per link, the controller and application metrics
+ *        since the last print. */
+void APP_HCIMON_Print(void);
+
+
+#endif
@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Log Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_log.c
+
+  Summary:
+    This file contains the Application asynchronous log sink for this project.
+
+  Description:
+    This file contains the Application asynchronous log sink for this project.
+    Messages from the data path are formatted into a lock-free bounded queue and
+    written to the terminal by a low priority idle source on the main loop, so
+    terminal I/O does not stall the transmission. It also provides the progress
+    report rate limiting.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <glib.h>
+
+#include "shared/shell.h"
+
+#include "app_log.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_LOG_QUEUE_MASK              (APP_LOG_QUEUE_SIZE - 1U)
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief The structure contains information about one slot of the log queue. */
+typedef struct APP_LOG_Slot_T
+{
+    gint                    sequence;                       /**< Slot sequence. Equals to the enqueue position when free, position + 1 when filled. */
+    uint8_t                 type;                           /**< Output path. See @ref APP_LOG_Type_T. */
+    char                    msg[APP_LOG_MSG_MAX_LEN];       /**< Formatted message. */
+} APP_LOG_Slot_T;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static APP_LOG_Slot_T       s_logQueue[APP_LOG_QUEUE_SIZE];
+static gint                 s_logEnqPos;
+static gint                 s_logDeqPos;
+static gint                 s_logDrainPending;
+static gint                 s_logDropNum;
+static GMutex               s_logDrainMutex;
+
+static uint32_t             s_progressIntervalMs = APP_LOG_PROGRESS_DEFAULT_INTERVAL;
+static uint32_t             s_progressIntervalKb;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static void app_log_Drain(void)
+{
+    APP_LOG_Slot_T *p_slot;
+    gint dropNum;
+    bool output = false;
+
+    g_mutex_lock(&s_logDrainMutex);
+
+    while (1)
+    {
+        p_slot = &s_logQueue[(guint)s_logDeqPos & APP_LOG_QUEUE_MASK];
+
+        if ((gint)((guint)g_atomic_int_get(&p_slot->sequence) - ((guint)s_logDeqPos + 1U)) < 0)
+            break;
+
+        if (p_slot->type == APP_LOG_TYPE_SHELL)
+        {
+            fflush(stdout);
+            bt_shell_printf("%s", p_slot->msg);
+        }
+        else
+        {
+            fputs(p_slot->msg, stdout);
+            output = true;
+        }
+
+        g_atomic_int_set(&p_slot->sequence, (gint)((guint)s_logDeqPos + APP_LOG_QUEUE_SIZE));
+        s_logDeqPos = (gint)((guint)s_logDeqPos + 1U);
+    }
+
+    dropNum = g_atomic_int_and((guint *)&s_logDropNum, 0);
+    if (dropNum > 0)
+    {
+        printf("\n[log] %d messages dropped\n", dropNum);
+        output = true;
+    }
+
+    if (output)
+        fflush(stdout);
+
+    g_mutex_unlock(&s_logDrainMutex);
+}
+
+static gboolean app_log_DrainIdle(gpointer p_data)
+{
+    /* Clear the flag first, messages posted during the drain schedule a new idle. */
+    g_atomic_int_set(&s_logDrainPending, 0);
+    app_log_Drain();
+
+    return G_SOURCE_REMOVE;
+}
+
+void APP_LOG_SinkInit(void)
+{
+    guint i;
+
+    for (i = 0; i < APP_LOG_QUEUE_SIZE; i++)
+    {
+        s_logQueue[i].sequence = (gint)i;
+    }
+
+    s_logEnqPos = 0;
+    s_logDeqPos = 0;
+    s_logDrainPending = 0;
+    s_logDropNum = 0;
+}
+
+void APP_LOG_Post(uint8_t type, const char *p_fmt, ...)
+{
+    APP_LOG_Slot_T *p_slot;
+    gint pos, diff;
+    va_list args;
+
+    pos = g_atomic_int_get(&s_logEnqPos);
+    while (1)
+    {
+        p_slot = &s_logQueue[(guint)pos & APP_LOG_QUEUE_MASK];
+        diff = (gint)((guint)g_atomic_int_get(&p_slot->sequence) - (guint)pos);
+
+        if (diff == 0)
+        {
+            if (g_atomic_int_compare_and_exchange(&s_logEnqPos, pos, (gint)((guint)pos + 1U)))
+                break;
+            pos = g_atomic_int_get(&s_logEnqPos);
+        }
+        else if (diff < 0)
+        {
+            /* Queue full, the terminal is slower than the data path. */
+            g_atomic_int_inc(&s_logDropNum);
+            return;
+        }
+        else
+        {
+            pos = g_atomic_int_get(&s_logEnqPos);
+        }
+    }
+
+    va_start(args, p_fmt);
+    vsnprintf(p_slot->msg, APP_LOG_MSG_MAX_LEN, p_fmt, args);
+    va_end(args);
+    p_slot->type = type;
+
+    g_atomic_int_set(&p_slot->sequence, (gint)((guint)pos + 1U));
+
+    if (g_atomic_int_compare_and_exchange(&s_logDrainPending, 0, 1))
+    {
+        g_idle_add_full(G_PRIORITY_LOW, app_log_DrainIdle, NULL, NULL);
+    }
+}
+
+void APP_LOG_Flush(void)
+{
+    app_log_Drain();
+}
+
+void APP_LOG_SetProgressInterval(uint32_t intervalMs, uint32_t intervalKb)
+{
+    s_progressIntervalMs = intervalMs;
+    s_progressIntervalKb = intervalKb;
+}
+
+void APP_LOG_GetProgressInterval(uint32_t *p_intervalMs, uint32_t *p_intervalKb)
+{
+    if (p_intervalMs != NULL)
+        *p_intervalMs = s_progressIntervalMs;
+    if (p_intervalKb != NULL)
+        *p_intervalKb = s_progressIntervalKb;
+}
+
+void APP_LOG_ThrottleReset(APP_LOG_Throttle_T *p_throttle)
+{
+    if (p_throttle == NULL)
+        return;
+
+    p_throttle->lastTime = 0;
+    p_throttle->lastBytes = 0;
+}
+
+bool APP_LOG_ProgressDue(APP_LOG_Throttle_T *p_throttle, uint32_t bytes)
+{
+    gint64 now;
+    bool due = false;
+
+    if (p_throttle == NULL)
+        return false;
+
+    now = g_get_monotonic_time();
+
+    /* A new transfer restarted the byte count */
+    if (bytes < p_throttle->lastBytes)
+        p_throttle->lastBytes = 0;
+
+    if (p_throttle->lastTime == 0)
+    {
+        due = true;
+    }
+    else if (s_progressIntervalMs == 0 && s_progressIntervalKb == 0)
+    {
+        due = true;
+    }
+    else
+    {
+        if (s_progressIntervalMs != 0 && (now - p_throttle->lastTime) >= ((gint64)s_progressIntervalMs * 1000))
+            due = true;
+        if (s_progressIntervalKb != 0 && (bytes - p_throttle->lastBytes) >= (s_progressIntervalKb * 1024U))
+            due = true;
+    }
+
+    if (due)
+    {
+        p_throttle->lastTime = now;
+        p_throttle->lastBytes = bytes;
+    }
+
+    return due;
+}
+
+
+/*******************************************************************************
+ End of File
+ */
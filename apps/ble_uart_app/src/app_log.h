@@ -3,23 +3,88 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
- 
+
 #ifndef APP_LOG_H
 #define APP_LOG_H
 
+#include <stdint.h>
+#include <stdbool.h>
 #include <syslog.h>
+#include <glib.h>
 
 #define  APP_LOG_INIT(tag) \
 	do 			\
 	{			\
 		openlog(tag, LOG_PERROR | LOG_PID, LOG_DAEMON);	\
+		APP_LOG_SinkInit();	\
 	} while(0) ;
 
 
 
 #define LOG(fmt, args...)  syslog(LOG_DEBUG, fmt, ##args)
-#define APP_LOG_ERROR(...) printf(__VA_ARGS__);
-#define APP_LOG_INFO(...) printf(__VA_ARGS__);
-#define APP_LOG_DEBUG(...) printf(__VA_ARGS__);
+#define APP_LOG_ERROR(...) APP_LOG_Post(APP_LOG_TYPE_RAW, __VA_ARGS__);
+#define APP_LOG_INFO(...) APP_LOG_Post(APP_LOG_TYPE_RAW, __VA_ARGS__);
+#define APP_LOG_DEBUG(...) APP_LOG_Post(APP_LOG_TYPE_RAW, __VA_ARGS__);
+#define APP_LOG_SHELL(...) APP_LOG_Post(APP_LOG_TYPE_SHELL, __VA_ARGS__);
+
+
+#define APP_LOG_QUEUE_SIZE                      (64U)       /**< Number of messages held by the async log sink. Must be power of 2. */
+#define APP_LOG_MSG_MAX_LEN                     (256U)      /**< Maximum length of one queued message, including the terminator. */
+#define APP_LOG_PROGRESS_DEFAULT_INTERVAL       (250U)      /**< Default progress report interval in ms. */
+
+/**@brief Output path of a queued log message. */
+typedef enum APP_LOG_Type_T
+{
+    APP_LOG_TYPE_RAW = 0x00,        /**< Written to stdout as is, used by progress lines starting with '\r'. */
+    APP_LOG_TYPE_SHELL              /**< Written through bt_shell_printf so the prompt is redrawn. */
+} APP_LOG_Type_T;
+
+/**@brief Per call site state for progress report rate limiting. */
+typedef struct APP_LOG_Throttle_T
+{
+    gint64                  lastTime;       /**< Monotonic time of the last report in us. 0 if never reported. */
+    uint32_t                lastBytes;      /**< Byte count at the last report. */
+} APP_LOG_Throttle_T;
+
+
+/**@brief Initialize the async log sink. Called by @ref APP_LOG_INIT. */
+void APP_LOG_SinkInit(void);
+
+/**@brief Format a message and queue it to the async log sink.
+ *        Safe to be called from any thread, never blocks. The message is dropped if the queue is full.
+ *        The queue is drained by a G_PRIORITY_LOW idle source on the main loop.
+ * @param[in] type                  Output path. See @ref APP_LOG_Type_T.
+ * @param[in] p_fmt                 printf style format.
+ */
+void APP_LOG_Post(uint8_t type, const char *p_fmt, ...) G_GNUC_PRINTF(2, 3);
+
+/**@brief Write out all queued messages synchronously.
+ *        Used before printing a result table so pending progress lines do not interleave with it.
+ */
+void APP_LOG_Flush(void);
+
+/**@brief Set the progress report interval.
+ *        Progress is reported when either limit is reached. If both are 0, every update is reported.
+ * @param[in] intervalMs            Minimum time between two reports in ms. 0 to disable.
+ * @param[in] intervalKb            Minimum transferred KB between two reports. 0 to disable.
+ */
+void APP_LOG_SetProgressInterval(uint32_t intervalMs, uint32_t intervalKb);
+
+/**@brief Get the progress report interval.
+ * @param[out] p_intervalMs         Time interval in ms.
+ * @param[out] p_intervalKb         Data interval in KB.
+ */
+void APP_LOG_GetProgressInterval(uint32_t *p_intervalMs, uint32_t *p_intervalKb);
+
+/**@brief Reset a progress throttle, the next check is always due. */
+void APP_LOG_ThrottleReset(APP_LOG_Throttle_T *p_throttle);
+
+/**@brief Check whether a progress report is due.
+ * @param[in] p_throttle            Throttle state of the call site.
+ * @param[in] bytes                 Accumulated transferred bytes of the call site. 0 if unknown.
+ * @retval true                     Report now, the throttle state is updated.
+ * @retval false                    Skip this report.
+ */
+bool APP_LOG_ProgressDue(APP_LOG_Throttle_T *p_throttle, uint32_t bytes);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application LZ Codec Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_lz.c
+
+  Summary:
+    This file contains the Application block compression functions for this project.
+
+  Description:
+    This file contains the Application block compression functions for this project.
+    The encoder finds matches of at least 4 bytes through a hash table of the last
+    position of every 4-byte sequence. It runs in a single pass without allocation.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <string.h>
+
+#include "app_lz.h"
+#include "app_error_defs.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_LZ_MIN_MATCH                4
+#define APP_LZ_LAST_LITERALS            5           /**< The last bytes of a block are always literals. */
+#define APP_LZ_MAX_OFFSET               0xFFFF
+#define APP_LZ_HASH_LOG                 12
+#define APP_LZ_HASH_SIZE                (1 << APP_LZ_HASH_LOG)
+#define APP_LZ_RUN_MASK                 0x0F
+#define APP_LZ_LENGTH_EXT_MAX           0xFF
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static uint32_t app_lz_Read32(const uint8_t *p_data)
+{
+    uint32_t value;
+
+    memcpy(&value, p_data, sizeof(value));
+    return value;
+}
+
+static uint16_t app_lz_Hash(uint32_t sequence)
+{
+    return (uint16_t)((sequence * 2654435761U) >> (32 - APP_LZ_HASH_LOG));
+}
+
+//Size of the token, length extension and literals of a sequence, the offset excluded
+static uint32_t app_lz_SequenceSize(uint32_t litLeng, uint32_t matchLeng)
+{
+    uint32_t size = 1 + litLeng;
+
+    if (litLeng >= APP_LZ_RUN_MASK)
+        size += (litLeng - APP_LZ_RUN_MASK) / APP_LZ_LENGTH_EXT_MAX + 1;
+    if (matchLeng >= APP_LZ_RUN_MASK)
+        size += (matchLeng - APP_LZ_RUN_MASK) / APP_LZ_LENGTH_EXT_MAX + 1;
+
+    return size;
+}
+
+static uint8_t * app_lz_PutLength(uint8_t *p_op, uint32_t leng)
+{
+    while (leng >= APP_LZ_LENGTH_EXT_MAX)
+    {
+        *p_op++ = APP_LZ_LENGTH_EXT_MAX;
+        leng -= APP_LZ_LENGTH_EXT_MAX;
+    }
+    *p_op++ = (uint8_t)leng;
+
+    return p_op;
+}
+
+static uint8_t * app_lz_PutLiterals(uint8_t *p_op, const uint8_t *p_literal, uint32_t litLeng, uint32_t matchLeng)
+{
+    uint8_t *p_token = p_op++;
+
+    *p_token = (uint8_t)(((litLeng < APP_LZ_RUN_MASK) ? litLeng : APP_LZ_RUN_MASK) << 4);
+    *p_token |= (uint8_t)((matchLeng < APP_LZ_RUN_MASK) ? matchLeng : APP_LZ_RUN_MASK);
+    if (litLeng >= APP_LZ_RUN_MASK)
+        p_op = app_lz_PutLength(p_op, litLeng - APP_LZ_RUN_MASK);
+
+    memcpy(p_op, p_literal, litLeng);
+
+    return p_op + litLeng;
+}
+
+uint16_t APP_LZ_Compress(const uint8_t *p_src, uint16_t srcLeng, uint8_t *p_dst, uint16_t dstSize)
+{
+    uint16_t hashTable[APP_LZ_HASH_SIZE];
+    const uint8_t *p_ip = p_src, *p_anchor = p_src, *p_ref, *p_match;
+    const uint8_t *p_end = p_src + srcLeng;
+    uint8_t *p_op = p_dst, *p_opEnd = p_dst + dstSize;
+    uint32_t sequence, litLeng, matchLeng, offset;
+    uint16_t hash;
+
+    if (p_src == NULL || p_dst == NULL)
+        return 0;
+
+    memset(hashTable, 0, sizeof(hashTable));
+
+    if (srcLeng > APP_LZ_MIN_MATCH + APP_LZ_LAST_LITERALS)
+    {
+        const uint8_t *p_matchLimit = p_end - APP_LZ_LAST_LITERALS;
+        const uint8_t *p_searchLimit = p_matchLimit - APP_LZ_MIN_MATCH;
+
+        while (p_ip < p_searchLimit)
+        {
+            sequence = app_lz_Read32(p_ip);
+            hash = app_lz_Hash(sequence);
+            p_ref = p_src + hashTable[hash];
+            hashTable[hash] = (uint16_t)(p_ip - p_src);
+
+            if ((p_ref >= p_ip) || ((p_ip - p_ref) > APP_LZ_MAX_OFFSET) || (app_lz_Read32(p_ref) != sequence))
+            {
+                p_ip++;
+                continue;
+            }
+
+            p_match = p_ip + APP_LZ_MIN_MATCH;
+            p_ref += APP_LZ_MIN_MATCH;
+            while ((p_match < p_matchLimit) && (*p_match == *p_ref))
+            {
+                p_match++;
+                p_ref++;
+            }
+
+            litLeng = p_ip - p_anchor;
+            matchLeng = p_match - p_ip - APP_LZ_MIN_MATCH;
+            offset = p_match - p_ref;
+            if (app_lz_SequenceSize(litLeng, matchLeng) + 2 > (uint32_t)(p_opEnd - p_op))
+                return 0;
+
+            p_op = app_lz_PutLiterals(p_op, p_anchor, litLeng, matchLeng);
+            *p_op++ = (uint8_t)offset;
+            *p_op++ = (uint8_t)(offset >> 8);
+            if (matchLeng >= APP_LZ_RUN_MASK)
+                p_op = app_lz_PutLength(p_op, matchLeng - APP_LZ_RUN_MASK);
+
+            p_ip = p_match;
+            p_anchor = p_ip;
+        }
+    }
+
+    litLeng = p_end - p_anchor;
+    if (app_lz_SequenceSize(litLeng, 0) > (uint32_t)(p_opEnd - p_op))
+        return 0;
+    p_op = app_lz_PutLiterals(p_op, p_anchor, litLeng, 0);
+
+    return (uint16_t)(p_op - p_dst);
+}
+
+static uint16_t app_lz_GetLength(const uint8_t **pp_ip, const uint8_t *p_ipEnd, uint32_t *p_leng)
+{
+    uint8_t value;
+
+    do
+    {
+        if (*pp_ip >= p_ipEnd)
+            return APP_RES_FAIL;
+        value = *(*pp_ip)++;
+        *p_leng += value;
+    } while (value == APP_LZ_LENGTH_EXT_MAX);
+
+    return APP_RES_SUCCESS;
+}
+
+uint16_t APP_LZ_Decompress(const uint8_t *p_src, uint16_t srcLeng, uint8_t *p_dst, uint16_t dstSize, uint16_t *p_dstLeng)
+{
+    const uint8_t *p_ip = p_src, *p_ipEnd = p_src + srcLeng;
+    uint8_t *p_op = p_dst, *p_opEnd = p_dst + dstSize, *p_ref;
+    uint32_t litLeng, matchLeng, offset;
+    uint8_t token;
+
+    if (p_src == NULL || p_dst == NULL || p_dstLeng == NULL || srcLeng == 0)
+        return APP_RES_FAIL;
+
+    while (p_ip < p_ipEnd)
+    {
+        token = *p_ip++;
+
+        litLeng = token >> 4;
+        if ((litLeng == APP_LZ_RUN_MASK) && (app_lz_GetLength(&p_ip, p_ipEnd, &litLeng) != APP_RES_SUCCESS))
+            return APP_RES_FAIL;
+        if ((litLeng > (uint32_t)(p_ipEnd - p_ip)) || (litLeng > (uint32_t)(p_opEnd - p_op)))
+            return APP_RES_FAIL;
+
+        memcpy(p_op, p_ip, litLeng);
+        p_ip += litLeng;
+        p_op += litLeng;
+
+        //The last sequence has no match
+        if (p_ip == p_ipEnd)
+            break;
+
+        if ((p_ipEnd - p_ip) < 2)
+            return APP_RES_FAIL;
+        offset = p_ip[0] | (p_ip[1] << 8);
+        p_ip += 2;
+        if ((offset == 0) || (offset > (uint32_t)(p_op - p_dst)))
+            return APP_RES_FAIL;
+
+        matchLeng = token & APP_LZ_RUN_MASK;
+        if ((matchLeng == APP_LZ_RUN_MASK) && (app_lz_GetLength(&p_ip, p_ipEnd, &matchLeng) != APP_RES_SUCCESS))
+            return APP_RES_FAIL;
+        matchLeng += APP_LZ_MIN_MATCH;
+        if (matchLeng > (uint32_t)(p_opEnd - p_op))
+            return APP_RES_FAIL;
+
+        //Byte by byte, a match may overlap the bytes it produces
+        p_ref = p_op - offset;
+        while (matchLeng--)
+            *p_op++ = *p_ref++;
+    }
+
+    *p_dstLeng = (uint16_t)(p_op - p_dst);
+
+    return APP_RES_SUCCESS;
+}
+
+
+/*******************************************************************************
+ End of File
+ */
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application LZ Codec Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_lz.h
+
+  Summary:
+    This file contains the Application block compression functions for this project.
+
+  Description:
+    This file contains the Application block compression functions for this project.
+    A block is encoded as LZ77 sequences in the LZ4 block layout: a token with the
+    literal and match lengths, the literals, a 16-bit little endian offset and the
+    length extension bytes. The last sequence carries literals only.
+ *******************************************************************************/
+
+#ifndef APP_LZ_H
+#define APP_LZ_H
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_LZ_MAX_BLOCK_SIZE           0xFFFF      /**< Maximum size of a block, limited by the 16-bit offset. */
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Compress a block.
+ * @param[in] p_src                 Raw data.
+ * @param[in] srcLeng               Raw data length.
+ * @param[out] p_dst                Buffer of the encoded data.
+ * @param[in] dstSize               Buffer size.
+ * @retval Length of the encoded data. 0 if it does not fit in the buffer.
+ */
+uint16_t APP_LZ_Compress(const uint8_t *p_src, uint16_t srcLeng, uint8_t *p_dst, uint16_t dstSize);
+
+/**@brief Decompress a block.
+ * @param[in] p_src                 Encoded data.
+ * @param[in] srcLeng               Encoded data length.
+ * @param[out] p_dst                Buffer of the raw data.
+ * @param[in] dstSize               Buffer size.
+ * @param[out] p_dstLeng            Length of the raw data.
+ * @retval APP_RES_SUCCESS          Decoded.
+ * @retval APP_RES_FAIL             The encoded data is corrupted or does not fit in the buffer.
+ */
+uint16_t APP_LZ_Decompress(const uint8_t *p_src, uint16_t srcLeng, uint8_t *p_dst, uint16_t dstSize, uint16_t *p_dstLeng);
+
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Memory Budget Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_mem.c
+
+  Summary:
+    This file contains the Application memory budget functions for this project.
+
+  Description:
+    This file contains the Application memory budget functions for this project.
+    Each buffer carries a small header with its size, link and category so that it is
+    released exactly. The accounting runs on the main loop thread only and takes no lock.
+    The owner of a refused allocation is told from an idle source once buffers are released.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <glib.h>
+
+#include "shared/shell.h"
+
+#include "app_mem.h"
+#include "app_gap.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief The header in front of each buffer, padded to keep the buffer aligned. */
+typedef union APP_MEM_Hdr_T
+{
+    struct
+    {
+        uint32_t        size;           /**< Size of the buffer. */
+        uint8_t         link;           /**< Link of the buffer, APP_MEM_NO_LINK for none. */
+        uint8_t         cat;            /**< Category of the buffer. */
+    } info;
+    max_align_t         align;
+} APP_MEM_Hdr_T;
+
+/**@brief The structure contains the usage of a category or a link. */
+typedef struct APP_MEM_Usage_T
+{
+    uint32_t            used;           /**< Bytes in use. */
+    uint32_t            peak;           /**< Highest bytes in use since the last reset. */
+    uint32_t            denied;         /**< Allocations refused by the budget or the quota. */
+} APP_MEM_Usage_T;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static uint32_t             s_memBudget;                                /**< Global budget in bytes, 0 for no limit. */
+static uint32_t             s_memLinkQuota;                             /**< Quota of each link in bytes, 0 for no limit. */
+static APP_MEM_Usage_T      s_memTotal;
+static APP_MEM_Usage_T      s_memCat[APP_MEM_CAT_END];
+static APP_MEM_Usage_T      s_memLink[BLE_GAP_MAX_LINK_NBR_LIMIT];
+static APP_MEM_ReleaseCb_T  s_memReleaseCb;
+static bool                 s_memReleaseWait;                           /**< An allocation was refused since the last notification. */
+static bool                 s_memReleasePending;                        /**< The notification is scheduled. */
+
+static const char *         s_memCatStr[APP_MEM_CAT_END] = {
+    "uart queue",
+    "le queue",
+    "loopback",
+    "raw data"
+};
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static void app_mem_Add(APP_MEM_Usage_T *p_usage, uint32_t size)
+{
+    p_usage->used += size;
+    if (p_usage->used > p_usage->peak)
+        p_usage->peak = p_usage->used;
+}
+
+static gboolean app_mem_ReleaseIdle(gpointer p_data)
+{
+    /* Clear the flags first, allocations refused in the callback wait for the next release. */
+    s_memReleasePending = false;
+    s_memReleaseWait = false;
+
+    if (s_memReleaseCb != NULL)
+        s_memReleaseCb();
+
+    return G_SOURCE_REMOVE;
+}
+
+void APP_MEM_SetBudget(uint32_t budget)
+{
+    s_memBudget = budget;
+}
+
+void APP_MEM_SetLinkQuota(uint32_t quota)
+{
+    s_memLinkQuota = quota;
+}
+
+void *APP_MEM_Alloc(uint8_t link, APP_MEM_Cat_T cat, uint32_t size)
+{
+    APP_MEM_Hdr_T *p_hdr;
+
+    if (cat >= APP_MEM_CAT_END)
+        return NULL;
+
+    if (link >= BLE_GAP_MAX_LINK_NBR)
+        link = APP_MEM_NO_LINK;
+
+    if ((s_memBudget > 0 && (uint64_t)s_memTotal.used + size > s_memBudget) ||
+        (s_memLinkQuota > 0 && link != APP_MEM_NO_LINK && (uint64_t)s_memLink[link].used + size > s_memLinkQuota))
+    {
+        s_memTotal.denied++;
+        s_memCat[cat].denied++;
+        if (link != APP_MEM_NO_LINK)
+            s_memLink[link].denied++;
+        s_memReleaseWait = true;
+        return NULL;
+    }
+
+    p_hdr = malloc(sizeof(APP_MEM_Hdr_T) + size);
+    if (p_hdr == NULL)
+        return NULL;
+
+    p_hdr->info.size = size;
+    p_hdr->info.link = link;
+    p_hdr->info.cat = cat;
+
+    app_mem_Add(&s_memTotal, size);
+    app_mem_Add(&s_memCat[cat], size);
+    if (link != APP_MEM_NO_LINK)
+        app_mem_Add(&s_memLink[link], size);
+
+    return p_hdr + 1;
+}
+
+void APP_MEM_Free(void *p_mem)
+{
+    APP_MEM_Hdr_T *p_hdr;
+
+    if (p_mem == NULL)
+        return;
+
+    p_hdr = (APP_MEM_Hdr_T *)p_mem - 1;
+
+    s_memTotal.used -= p_hdr->info.size;
+    s_memCat[p_hdr->info.cat].used -= p_hdr->info.size;
+    if (p_hdr->info.link != APP_MEM_NO_LINK)
+        s_memLink[p_hdr->info.link].used -= p_hdr->info.size;
+
+    free(p_hdr);
+
+    if (s_memReleaseWait && !s_memReleasePending && s_memReleaseCb != NULL)
+    {
+        s_memReleasePending = true;
+        g_idle_add(app_mem_ReleaseIdle, NULL);
+    }
+}
+
+void APP_MEM_SetReleaseCb(APP_MEM_ReleaseCb_T p_cb)
+{
+    s_memReleaseCb = p_cb;
+}
+
+void APP_MEM_ResetPeak(void)
+{
+    uint8_t i;
+
+    s_memTotal.peak = s_memTotal.used;
+    s_memTotal.denied = 0;
+
+    for (i = 0; i < APP_MEM_CAT_END; i++)
+    {
+        s_memCat[i].peak = s_memCat[i].used;
+        s_memCat[i].denied = 0;
+    }
+
+    for (i = 0; i < BLE_GAP_MAX_LINK_NBR_LIMIT; i++)
+    {
+        s_memLink[i].peak = s_memLink[i].used;
+        s_memLink[i].denied = 0;
+    }
+}
+
+void APP_MEM_Print(void)
+{
+    uint8_t i;
+
+    if (s_memBudget > 0)
+        bt_shell_printf("budget = %u bytes", s_memBudget);
+    else
+        bt_shell_printf("budget = none");
+
+    if (s_memLinkQuota > 0)
+        bt_shell_printf(", link quota = %u bytes\n", s_memLinkQuota);
+    else
+        bt_shell_printf(", link quota = none\n");
+
+    bt_shell_printf("[  Category  ][   Used   ][   Peak   ][Denied]\n");
+    bt_shell_printf("=============================================\n");
+    for (i = 0; i < APP_MEM_CAT_END; i++)
+    {
+        bt_shell_printf("[%12s][%10u][%10u][%6u]\n", s_memCatStr[i], s_memCat[i].used, s_memCat[i].peak, s_memCat[i].denied);
+    }
+    bt_shell_printf("[%12s][%10u][%10u][%6u]\n", "total", s_memTotal.used, s_memTotal.peak, s_memTotal.denied);
+
+    bt_shell_printf("[ Link ][   Used   ][   Peak   ][Denied]\n");
+    bt_shell_printf("=======================================\n");
+    for (i = 0; i < BLE_GAP_MAX_LINK_NBR_LIMIT; i++)
+    {
+        if (s_memLink[i].peak == 0 && s_memLink[i].denied == 0)
+            continue;
+
+        bt_shell_printf("[%6d][%10u][%10u][%6u]\n", i, s_memLink[i].used, s_memLink[i].peak, s_memLink[i].denied);
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Memory Budget Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_mem.h
+
+  Summary:
+    This file contains the Application memory budget functions for this project.
+
+  Description:
+    This file contains the Application memory budget functions for this project.
+    The buffered data of the links, i.e. the queued packets, the loopback receive buffers and
+    the raw data chunks, is allocated against a global byte budget and a per-link quota. The
+    current and peak usage is kept per category and per link.
+ *******************************************************************************/
+
+#ifndef APP_MEM_H
+#define APP_MEM_H
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_MEM_NO_LINK                         0xFF    /**< Link of a buffer counted against the global budget only. */
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Enumeration type of the buffer categories. */
+typedef enum APP_MEM_Cat_T
+{
+    APP_MEM_CAT_UART_QUEUE = 0x00,      /**< Packets queued from the data source to LE. */
+    APP_MEM_CAT_LE_QUEUE,               /**< Packets received from LE and queued to the output. */
+    APP_MEM_CAT_LOOPBACK_BUF,           /**< Loopback receive buffers, the size of the pattern. */
+    APP_MEM_CAT_RAW_DATA_BUF,           /**< Raw data file chunks and text mode buffers. */
+
+    APP_MEM_CAT_END
+} APP_MEM_Cat_T;
+
+/**@brief The function called once buffers are released after an allocation was refused. */
+typedef void (*APP_MEM_ReleaseCb_T)(void);
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Set the global byte budget of the buffered data.
+ * @param[in] budget                Budget in bytes, 0 for no limit.
+ */
+void APP_MEM_SetBudget(uint32_t budget);
+
+/**@brief Set the byte quota of the buffered data of each link.
+ * @param[in] quota                 Quota in bytes, 0 for no limit.
+ */
+void APP_MEM_SetLinkQuota(uint32_t quota);
+
+/**@brief Allocate a buffer if it fits in the global budget and the quota of the link.
+ *        It must be called from the main loop thread.
+ * @param[in] link                  Index of the link, APP_MEM_NO_LINK for none. An index out of the
+ *                                  links, e.g. for a device without a file transfer record, is
+ *                                  counted against the global budget only.
+ * @param[in] cat                   Category of the buffer. See @ref APP_MEM_Cat_T.
+ * @param[in] size                  Size in bytes.
+ *
+ * @return The buffer, NULL if it does not fit or the allocation fails.
+ */
+void *APP_MEM_Alloc(uint8_t link, APP_MEM_Cat_T cat, uint32_t size);
+
+/**@brief Free a buffer allocated by APP_MEM_Alloc(). It must be called from the main loop thread.
+ * @param[in] p_mem                 The buffer, may be NULL.
+ */
+void APP_MEM_Free(void *p_mem);
+
+/**@brief Register the function called once buffers are released after an allocation was refused.
+ *        It is called from an idle source of the main loop, never from APP_MEM_Free().
+ * @param[in] p_cb                  The function, NULL for none.
+ */
+void APP_MEM_SetReleaseCb(APP_MEM_ReleaseCb_T p_cb);
+
+/**@brief Restart the peak usage from the current usage. */
+void APP_MEM_ResetPeak(void);
+
+/**@brief Print the budget, the quota and the current and peak usage per category and per link. */
+void APP_MEM_Print(void);
+
+
+#endif
@@ -75,6 +75,7 @@ static struct mgmt *sp_mgmtPrimary = NULL;
 static uint16_t s_mgmtIndex = 0;
 static uint8_t s_mgmtVersion = 0;
 static uint8_t s_mgmtRevision = 0;
+static uint32_t s_mgmtSelectedPhys = 0;
 static char s_localNameComplete[MGMT_MAX_NAME_LENGTH];
 static char s_localNameShort[MGMT_MAX_SHORT_NAME_LENGTH];
 
@@ -303,6 +304,10 @@ void APP_MGMT_Init(void)
     }
 
 
+    /* Cache the selected PHYs for the result log */
+    mgmt_send(sp_mgmtPrimary, MGMT_OP_GET_PHY_CONFIGURATION, s_mgmtIndex, 0, NULL,
+              app_mgmt_GetPhyRsp, GUINT_TO_POINTER(1), NULL);
+
     mgmt_register(sp_mgmtPrimary, MGMT_EV_DEVICE_CONNECTED, s_mgmtIndex, app_mgmt_DevConnCb, NULL, NULL);
     mgmt_register(sp_mgmtPrimary, MGMT_EV_DEVICE_DISCONNECTED, s_mgmtIndex, app_mgmt_DevDisconnCb, NULL, NULL);
     mgmt_register(sp_mgmtPrimary, MGMT_EV_ADVERTISING_ADDED, s_mgmtIndex, app_mgmt_AdvAdded, NULL, NULL);
@@ -572,7 +577,11 @@ static void app_mgmt_GetPhyRsp(uint8_t status, uint16_t len, const void *p_param
     }
 
     selected_phys = get_le32(&p_rp->selected_phys);
-    bt_shell_printf("Selected phys: %s\n", phys2str(selected_phys));
+    s_mgmtSelectedPhys = selected_phys;
+
+    /* Query issued at init is not reported */
+    if (p_userData == NULL)
+        bt_shell_printf("Selected phys: %s\n", phys2str(selected_phys));
 }
 
 
@@ -620,6 +629,17 @@ uint16_t APP_MGMT_GetPhySupport(void)
     return APP_RES_SUCCESS;
 }
 
+uint32_t APP_MGMT_GetSelectedPhys(void)
+{
+    return s_mgmtSelectedPhys;
+}
+
+void APP_MGMT_GetVersion(uint8_t *p_version, uint8_t *p_revision)
+{
+    *p_version = s_mgmtVersion;
+    *p_revision = s_mgmtRevision;
+}
+
 uint16_t APP_MGMT_RemoveBonding(const char *p_bdaddr, const char * p_bdaddrType)
 {
     struct mgmt_cp_unpair_device cp;
@@ -66,6 +66,8 @@ uint16_t APP_MGMT_SetExtAdvData(struct mgmt_cp_add_ext_adv_data *p_advDataParam)
 uint16_t APP_MGMT_SetExtAdvEnable(bool enable);
 uint16_t APP_MGMT_SetPhySupport(uint32_t phySupport);
 uint16_t APP_MGMT_GetPhySupport(void);
+uint32_t APP_MGMT_GetSelectedPhys(void);
+void APP_MGMT_GetVersion(uint8_t *p_version, uint8_t *p_revision);
 uint16_t APP_MGMT_RemoveBonding(const char *p_bdaddr, const char * p_bdaddrType);
 uint16_t APP_MGMT_SetSecureConnection(uint8_t mode);
 uint16_t APP_MGMT_ReadControllerSetting(void);
@@ -0,0 +1,858 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application TRP Record and Replay Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_replay.c
+
+  Summary:
+    This file contains the Application TRP record and replay functions for this project.
+
+  Description:
+    This file contains the Application TRP record and replay functions for this project.
+    File layout: "TRPR", version (1), reserved (3), followed by the records. See
+    @ref APP_REPLAY_RecType_T for the record layout.
+    During replay every link is represented by a placeholder proxy. It is only a key to
+    look the link up by and is never dereferenced: the TRP modules stub every profile call
+    while replaying. Data packets are returned from the DATA records of the link, outbound
+    sends complete with the result in the SEND records of the link and the downlink flow
+    control follows the replayed downlink status.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "shared/shell.h"
+#include "shared/mainloop.h"
+
+#include "application.h"
+#include "app_replay.h"
+#include "app_ble_handler.h"
+#include "app_trp_common.h"
+#include "app_trps.h"
+#include "app_trpc.h"
+#include "app_error_defs.h"
+#include "ble_trsp/ble_trsp_defs.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_REPLAY_FILE_HDR_LEN         8
+#define APP_REPLAY_REC_HDR_LEN          9
+#define APP_REPLAY_INVALID_LINK         0xFF
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief The structure contains a parsed record header. */
+typedef struct APP_REPLAY_Rec_T
+{
+    uint32_t                deltaUs;            /**< Time since the previous record in us. */
+    uint8_t                 type;               /**< See @ref APP_REPLAY_RecType_T. */
+    uint8_t                 id;                 /**< Event ID or link event. */
+    uint8_t                 link;               /**< Link index. */
+    uint16_t                length;             /**< Payload length. */
+    uint8_t                 *p_payload;         /**< Payload in the loaded file. */
+} APP_REPLAY_Rec_T;
+
+/**@brief The structure contains the replay state. */
+typedef struct APP_REPLAY_Ctrl_T
+{
+    char                    *p_path;                                /**< File to replay. */
+    double                  speed;                                  /**< Timing factor, 0 for as fast as possible. */
+    bool                    replaying;                              /**< Replay in progress. */
+    uint8_t                 *p_buf;                                 /**< Loaded file. */
+    gsize                   bufLen;                                 /**< Length of the loaded file. */
+    gsize                   offset;                                 /**< Offset of the next dispatched record. */
+    gsize                   dataCursor[BLE_GAP_MAX_LINK_NBR_LIMIT]; /**< Offset to search the next DATA record from. */
+    gsize                   sendCursor[BLE_GAP_MAX_LINK_NBR_LIMIT]; /**< Offset to search the next SEND record from. */
+    uint8_t                 dlStatus[BLE_GAP_MAX_LINK_NBR_LIMIT];   /**< Last replayed downlink status. See @ref BLE_TRSPC_DL_STATUS. */
+    uint64_t                timeUs;                                 /**< Accumulated record time. */
+    int64_t                 startUs;                                /**< Monotonic time when the replay started. */
+    uint32_t                events;                                 /**< Dispatched event and link records. */
+    uint32_t                packets;                                /**< Delivered data packets. */
+    uint32_t                bytes;                                  /**< Delivered data bytes. */
+    uint32_t                misses;                                 /**< Data fetches without a matching record. */
+    int                     exitCode;                               /**< Process exit code. */
+} APP_REPLAY_Ctrl_T;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static FILE *               sp_replayRecFile;
+static int64_t              s_replayRecLastUs;
+static DeviceProxy *        sp_replayRecProxy[BLE_GAP_MAX_LINK_NBR_LIMIT];
+static APP_REPLAY_Ctrl_T    s_replayCtrl;
+static uint8_t              s_replayDev[BLE_GAP_MAX_LINK_NBR_LIMIT];       /**< Placeholder proxies, only their addresses are used. */
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static uint8_t app_replay_GetRecLink(DeviceProxy *p_devProxy, bool alloc)
+{
+    uint8_t i;
+
+    if (p_devProxy == NULL)
+        return APP_REPLAY_INVALID_LINK;
+
+    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    {
+        if (sp_replayRecProxy[i] == p_devProxy)
+            return i;
+    }
+
+    if (!alloc)
+        return APP_REPLAY_INVALID_LINK;
+
+    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    {
+        if (sp_replayRecProxy[i] == NULL)
+        {
+            sp_replayRecProxy[i] = p_devProxy;
+            return i;
+        }
+    }
+
+    return APP_REPLAY_INVALID_LINK;
+}
+
+static void app_replay_Write(uint8_t type, uint8_t id, uint8_t link, uint16_t length, const uint8_t *p_payload)
+{
+    uint8_t header[APP_REPLAY_REC_HDR_LEN];
+    int64_t now;
+    uint32_t deltaUs;
+
+    now = g_get_monotonic_time();
+    deltaUs = (s_replayRecLastUs == 0 || now - s_replayRecLastUs > UINT32_MAX) ? 0 : (uint32_t)(now - s_replayRecLastUs);
+    s_replayRecLastUs = now;
+
+    header[0] = (uint8_t)deltaUs;
+    header[1] = (uint8_t)(deltaUs >> 8);
+    header[2] = (uint8_t)(deltaUs >> 16);
+    header[3] = (uint8_t)(deltaUs >> 24);
+    header[4] = type;
+    header[5] = id;
+    header[6] = link;
+    header[7] = (uint8_t)length;
+    header[8] = (uint8_t)(length >> 8);
+
+    if (fwrite(header, 1, sizeof(header), sp_replayRecFile) != sizeof(header)
+        || (length > 0 && fwrite(p_payload, 1, length, sp_replayRecFile) != length))
+    {
+        bt_shell_printf("Recording failed, stopped\n");
+        APP_REPLAY_StopRecord();
+    }
+}
+
+bool APP_REPLAY_StartRecord(const char *p_path)
+{
+    uint8_t header[APP_REPLAY_FILE_HDR_LEN] = {0};
+
+    APP_REPLAY_StopRecord();
+
+    sp_replayRecFile = fopen(p_path, "wb");
+    if (sp_replayRecFile == NULL)
+        return false;
+
+    memcpy(header, APP_REPLAY_MAGIC, 4);
+    header[4] = APP_REPLAY_VERSION;
+    fwrite(header, 1, sizeof(header), sp_replayRecFile);
+
+    s_replayRecLastUs = 0;
+    memset(sp_replayRecProxy, 0, sizeof(sp_replayRecProxy));
+
+    return true;
+}
+
+void APP_REPLAY_StopRecord(void)
+{
+    if (sp_replayRecFile == NULL)
+        return;
+
+    fclose(sp_replayRecFile);
+    sp_replayRecFile = NULL;
+}
+
+bool APP_REPLAY_IsRecording(void)
+{
+    return (sp_replayRecFile != NULL);
+}
+
+void APP_REPLAY_RecordTrpsEvt(BLE_TRSPS_Event_T *p_event)
+{
+    uint8_t status;
+
+    if (sp_replayRecFile == NULL)
+        return;
+
+    switch (p_event->eventId)
+    {
+        case BLE_TRSPS_EVT_CTRL_STATUS:
+        {
+            status = p_event->eventField.onCtrlStatus.status;
+            app_replay_Write(APP_REPLAY_REC_TRPS_EVT, p_event->eventId, APP_REPLAY_INVALID_LINK, 1, &status);
+        }
+        break;
+
+        case BLE_TRSPS_EVT_TX_STATUS:
+        {
+            status = p_event->eventField.onTxStatus.status;
+            app_replay_Write(APP_REPLAY_REC_TRPS_EVT, p_event->eventId, APP_REPLAY_INVALID_LINK, 1, &status);
+        }
+        break;
+
+        case BLE_TRSPS_EVT_CBFC_ENABLED:
+        case BLE_TRSPS_EVT_CBFC_CREDIT:
+        {
+            app_replay_Write(APP_REPLAY_REC_TRPS_EVT, p_event->eventId,
+                app_replay_GetRecLink(p_event->eventField.onCbfcEnabled.p_dev, false), 0, NULL);
+        }
+        break;
+
+        case BLE_TRSPS_EVT_RECEIVE_DATA:
+        {
+            app_replay_Write(APP_REPLAY_REC_TRPS_EVT, p_event->eventId,
+                app_replay_GetRecLink(p_event->eventField.onReceiveData.p_dev, false), 0, NULL);
+        }
+        break;
+
+        case BLE_TRSPS_EVT_VENDOR_CMD:
+        {
+            app_replay_Write(APP_REPLAY_REC_TRPS_EVT, p_event->eventId,
+                app_replay_GetRecLink(p_event->eventField.onVendorCmd.p_dev, false),
+                p_event->eventField.onVendorCmd.length, p_event->eventField.onVendorCmd.p_payLoad);
+        }
+        break;
+
+        default:
+        {
+            app_replay_Write(APP_REPLAY_REC_TRPS_EVT, p_event->eventId, APP_REPLAY_INVALID_LINK, 0, NULL);
+        }
+        break;
+    }
+}
+
+void APP_REPLAY_RecordTrpcEvt(BLE_TRSPC_Event_T *p_event)
+{
+    uint8_t payload[2];
+
+    if (sp_replayRecFile == NULL)
+        return;
+
+    switch (p_event->eventId)
+    {
+        case BLE_TRSPC_EVT_UL_STATUS:
+        {
+            payload[0] = p_event->eventField.onUplinkStatus.status;
+            app_replay_Write(APP_REPLAY_REC_TRPC_EVT, p_event->eventId,
+                app_replay_GetRecLink(p_event->eventField.onUplinkStatus.p_dev, false), 1, payload);
+        }
+        break;
+
+        case BLE_TRSPC_EVT_DL_STATUS:
+        {
+            payload[0] = p_event->eventField.onDownlinkStatus.status;
+            payload[1] = p_event->eventField.onDownlinkStatus.currentCreditNumber;
+            app_replay_Write(APP_REPLAY_REC_TRPC_EVT, p_event->eventId,
+                app_replay_GetRecLink(p_event->eventField.onDownlinkStatus.p_dev, false), 2, payload);
+        }
+        break;
+
+        case BLE_TRSPC_EVT_RECEIVE_DATA:
+        {
+            app_replay_Write(APP_REPLAY_REC_TRPC_EVT, p_event->eventId,
+                app_replay_GetRecLink(p_event->eventField.onReceiveData.p_dev, false), 0, NULL);
+        }
+        break;
+
+        case BLE_TRSPC_EVT_VENDOR_CMD:
+        {
+            app_replay_Write(APP_REPLAY_REC_TRPC_EVT, p_event->eventId,
+                app_replay_GetRecLink(p_event->eventField.onVendorCmd.p_dev, false),
+                p_event->eventField.onVendorCmd.payloadLength, p_event->eventField.onVendorCmd.p_payLoad);
+        }
+        break;
+
+        case BLE_TRSPC_EVT_VENDOR_CMD_RSP:
+        {
+            payload[0] = p_event->eventField.onVendorCmdRsp.result;
+            app_replay_Write(APP_REPLAY_REC_TRPC_EVT, p_event->eventId,
+                app_replay_GetRecLink(p_event->eventField.onVendorCmdRsp.p_dev, false), 1, payload);
+        }
+        break;
+
+        case BLE_TRSPC_EVT_DATA_RSP:
+        {
+            payload[0] = p_event->eventField.onDataRsp.result;
+            app_replay_Write(APP_REPLAY_REC_TRPC_EVT, p_event->eventId,
+                app_replay_GetRecLink(p_event->eventField.onDataRsp.p_dev, false), 1, payload);
+        }
+        break;
+
+        case BLE_TRSPC_EVT_DISC_COMPLETE:
+        {
+            app_replay_Write(APP_REPLAY_REC_TRPC_EVT, p_event->eventId,
+                app_replay_GetRecLink(p_event->eventField.onDiscComplete.p_dev, false), 0, NULL);
+        }
+        break;
+
+        default:
+        {
+            app_replay_Write(APP_REPLAY_REC_TRPC_EVT, p_event->eventId, APP_REPLAY_INVALID_LINK, 0, NULL);
+        }
+        break;
+    }
+}
+
+void APP_REPLAY_RecordLink(DeviceProxy *p_devProxy, uint8_t linkEvt, uint16_t value)
+{
+    uint8_t link, payload[2];
+
+    if (sp_replayRecFile == NULL)
+        return;
+
+    link = app_replay_GetRecLink(p_devProxy, (linkEvt == APP_REPLAY_LINK_CONNECTED));
+    if (link == APP_REPLAY_INVALID_LINK)
+        return;
+
+    payload[0] = (uint8_t)value;
+    payload[1] = (uint8_t)(value >> 8);
+
+    switch (linkEvt)
+    {
+        case APP_REPLAY_LINK_CONNECTED:
+            app_replay_Write(APP_REPLAY_REC_LINK, linkEvt, link, 1, payload);
+            break;
+
+        case APP_REPLAY_LINK_DISCONNECTED:
+            app_replay_Write(APP_REPLAY_REC_LINK, linkEvt, link, 0, NULL);
+            sp_replayRecProxy[link] = NULL;
+            break;
+
+        case APP_REPLAY_LINK_MTU:
+        case APP_REPLAY_LINK_TRCBP:
+            app_replay_Write(APP_REPLAY_REC_LINK, linkEvt, link, 2, payload);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void APP_REPLAY_RecordData(DeviceProxy *p_devProxy, uint16_t length, uint8_t *p_data)
+{
+    if (sp_replayRecFile == NULL || length == 0)
+        return;
+
+    app_replay_Write(APP_REPLAY_REC_DATA, 0, app_replay_GetRecLink(p_devProxy, false), length, p_data);
+}
+
+void APP_REPLAY_RecordSend(DeviceProxy *p_devProxy, uint16_t status)
+{
+    uint8_t payload[2];
+
+    if (sp_replayRecFile == NULL)
+        return;
+
+    payload[0] = (uint8_t)status;
+    payload[1] = (uint8_t)(status >> 8);
+    app_replay_Write(APP_REPLAY_REC_SEND, 0, app_replay_GetRecLink(p_devProxy, false), 2, payload);
+}
+
+static bool app_replay_Parse(gsize offset, APP_REPLAY_Rec_T *p_rec)
+{
+    uint8_t *p_hdr;
+
+    if (offset + APP_REPLAY_REC_HDR_LEN > s_replayCtrl.bufLen)
+        return false;
+
+    p_hdr = s_replayCtrl.p_buf + offset;
+    p_rec->deltaUs = (uint32_t)p_hdr[0] | ((uint32_t)p_hdr[1] << 8) | ((uint32_t)p_hdr[2] << 16) | ((uint32_t)p_hdr[3] << 24);
+    p_rec->type = p_hdr[4];
+    p_rec->id = p_hdr[5];
+    p_rec->link = p_hdr[6];
+    p_rec->length = (uint16_t)(p_hdr[7] | (p_hdr[8] << 8));
+    p_rec->p_payload = p_hdr + APP_REPLAY_REC_HDR_LEN;
+
+    if (offset + APP_REPLAY_REC_HDR_LEN + p_rec->length > s_replayCtrl.bufLen)
+        return false;
+
+    return true;
+}
+
+static DeviceProxy * app_replay_GetProxy(uint8_t link)
+{
+    if (link >= APP_TRP_MAX_LINK_NUMBER)
+        return NULL;
+
+    return (DeviceProxy *)&s_replayDev[link];
+}
+
+static uint8_t app_replay_GetLink(DeviceProxy *p_devProxy)
+{
+    uint8_t *p_dev = (uint8_t *)p_devProxy;
+
+    if (p_dev < s_replayDev || p_dev >= s_replayDev + APP_TRP_MAX_LINK_NUMBER)
+        return APP_REPLAY_INVALID_LINK;
+
+    return (uint8_t)(p_dev - s_replayDev);
+}
+
+/* Find the next record of the type on the link from the cursor. The cursor is left on the found record. */
+static bool app_replay_Find(gsize *p_cursor, uint8_t type, uint8_t link, APP_REPLAY_Rec_T *p_rec)
+{
+    while (app_replay_Parse(*p_cursor, p_rec))
+    {
+        if (p_rec->type == type && p_rec->link == link)
+            return true;
+
+        *p_cursor += APP_REPLAY_REC_HDR_LEN + p_rec->length;
+    }
+
+    return false;
+}
+
+void APP_REPLAY_SetReplayFile(const char *p_path, double speed)
+{
+    g_free(s_replayCtrl.p_path);
+    s_replayCtrl.p_path = g_strdup(p_path);
+    s_replayCtrl.speed = speed;
+}
+
+bool APP_REPLAY_IsEnabled(void)
+{
+    return (s_replayCtrl.p_path != NULL);
+}
+
+bool APP_REPLAY_IsReplaying(void)
+{
+    return s_replayCtrl.replaying;
+}
+
+int APP_REPLAY_GetExitCode(void)
+{
+    return s_replayCtrl.exitCode;
+}
+
+void APP_REPLAY_GetDataLength(DeviceProxy *p_devProxy, uint16_t *p_dataLeng)
+{
+    uint8_t link;
+    APP_REPLAY_Rec_T rec;
+
+    *p_dataLeng = 0;
+
+    link = app_replay_GetLink(p_devProxy);
+    if (link == APP_REPLAY_INVALID_LINK)
+        return;
+
+    if (app_replay_Find(&s_replayCtrl.dataCursor[link], APP_REPLAY_REC_DATA, link, &rec))
+        *p_dataLeng = rec.length;
+}
+
+uint16_t APP_REPLAY_GetData(DeviceProxy *p_devProxy, uint8_t *p_data)
+{
+    uint8_t link;
+    APP_REPLAY_Rec_T rec;
+
+    link = app_replay_GetLink(p_devProxy);
+    if (link == APP_REPLAY_INVALID_LINK || !app_replay_Find(&s_replayCtrl.dataCursor[link], APP_REPLAY_REC_DATA, link, &rec))
+    {
+        s_replayCtrl.misses++;
+        return APP_RES_FAIL;
+    }
+
+    memcpy(p_data, rec.p_payload, rec.length);
+    s_replayCtrl.dataCursor[link] += APP_REPLAY_REC_HDR_LEN + rec.length;
+    s_replayCtrl.packets++;
+    s_replayCtrl.bytes += rec.length;
+
+    return APP_RES_SUCCESS;
+}
+
+uint16_t APP_REPLAY_GetSendResult(DeviceProxy *p_devProxy)
+{
+    uint8_t link;
+    APP_REPLAY_Rec_T rec;
+
+    link = app_replay_GetLink(p_devProxy);
+    if (link == APP_REPLAY_INVALID_LINK || !app_replay_Find(&s_replayCtrl.sendCursor[link], APP_REPLAY_REC_SEND, link, &rec)
+        || rec.length < 2)
+        return TRSP_RES_SUCCESS;
+
+    s_replayCtrl.sendCursor[link] += APP_REPLAY_REC_HDR_LEN + rec.length;
+
+    return (uint16_t)(rec.p_payload[0] | (rec.p_payload[1] << 8));
+}
+
+bool APP_REPLAY_IsDlCreditBased(DeviceProxy *p_devProxy)
+{
+    uint8_t link;
+
+    link = app_replay_GetLink(p_devProxy);
+    if (link == APP_REPLAY_INVALID_LINK)
+        return false;
+
+    return ((s_replayCtrl.dlStatus[link] & BLE_TRSPC_DL_STATUS_CBFCENABLED) != 0U);
+}
+
+static void app_replay_DispatchTrps(APP_REPLAY_Rec_T *p_rec)
+{
+    BLE_TRSPS_Event_T event;
+
+    memset(&event, 0, sizeof(event));
+    event.eventId = p_rec->id;
+
+    switch (p_rec->id)
+    {
+        case BLE_TRSPS_EVT_CTRL_STATUS:
+            event.eventField.onCtrlStatus.status = p_rec->length ? p_rec->p_payload[0] : 0;
+            break;
+
+        case BLE_TRSPS_EVT_TX_STATUS:
+            event.eventField.onTxStatus.status = p_rec->length ? p_rec->p_payload[0] : 0;
+            break;
+
+        case BLE_TRSPS_EVT_CBFC_ENABLED:
+        case BLE_TRSPS_EVT_CBFC_CREDIT:
+            event.eventField.onCbfcEnabled.p_dev = app_replay_GetProxy(p_rec->link);
+            break;
+
+        case BLE_TRSPS_EVT_RECEIVE_DATA:
+            event.eventField.onReceiveData.p_dev = app_replay_GetProxy(p_rec->link);
+            break;
+
+        case BLE_TRSPS_EVT_VENDOR_CMD:
+        {
+            if (p_rec->length == 0)
+                return;
+            event.eventField.onVendorCmd.p_dev = app_replay_GetProxy(p_rec->link);
+            event.eventField.onVendorCmd.length = p_rec->length;
+            event.eventField.onVendorCmd.p_payLoad = p_rec->p_payload;
+        }
+        break;
+
+        default:
+            break;
+    }
+
+    APP_TRPS_EventHandler(&event);
+}
+
+static void app_replay_DispatchTrpc(APP_REPLAY_Rec_T *p_rec)
+{
+    BLE_TRSPC_Event_T event;
+    DeviceProxy *p_devProxy;
+
+    memset(&event, 0, sizeof(event));
+    event.eventId = p_rec->id;
+    p_devProxy = app_replay_GetProxy(p_rec->link);
+
+    switch (p_rec->id)
+    {
+        case BLE_TRSPC_EVT_UL_STATUS:
+        {
+            event.eventField.onUplinkStatus.p_dev = p_devProxy;
+            event.eventField.onUplinkStatus.status = p_rec->length ? p_rec->p_payload[0] : 0;
+        }
+        break;
+
+        case BLE_TRSPC_EVT_DL_STATUS:
+        {
+            event.eventField.onDownlinkStatus.p_dev = p_devProxy;
+            if (p_rec->length >= 2)
+            {
+                event.eventField.onDownlinkStatus.status = p_rec->p_payload[0];
+                event.eventField.onDownlinkStatus.currentCreditNumber = p_rec->p_payload[1];
+            }
+            if (p_devProxy != NULL)
+                s_replayCtrl.dlStatus[p_rec->link] = event.eventField.onDownlinkStatus.status;
+        }
+        break;
+
+        case BLE_TRSPC_EVT_RECEIVE_DATA:
+            event.eventField.onReceiveData.p_dev = p_devProxy;
+            break;
+
+        case BLE_TRSPC_EVT_VENDOR_CMD:
+        {
+            if (p_rec->length == 0 || p_rec->length > UINT8_MAX)
+                return;
+            event.eventField.onVendorCmd.p_dev = p_devProxy;
+            event.eventField.onVendorCmd.payloadLength = p_rec->length;
+            event.eventField.onVendorCmd.p_payLoad = p_rec->p_payload;
+        }
+        break;
+
+        case BLE_TRSPC_EVT_VENDOR_CMD_RSP:
+        {
+            event.eventField.onVendorCmdRsp.p_dev = p_devProxy;
+            event.eventField.onVendorCmdRsp.result = p_rec->length ? p_rec->p_payload[0] : 0;
+        }
+        break;
+
+        case BLE_TRSPC_EVT_DATA_RSP:
+        {
+            event.eventField.onDataRsp.p_dev = p_devProxy;
+            event.eventField.onDataRsp.result = p_rec->length ? p_rec->p_payload[0] : 0;
+        }
+        break;
+
+        case BLE_TRSPC_EVT_DISC_COMPLETE:
+            event.eventField.onDiscComplete.p_dev = p_devProxy;
+            break;
+
+        default:
+            break;
+    }
+
+    APP_TRPC_EventHandler(&event);
+}
+
+//A server run still going when the link is lost fails, as on a live disconnect
+static void app_replay_ReportRun(DeviceProxy *p_devProxy, uint8_t link)
+{
+    APP_TRP_ConnList_T *p_trpConn;
+
+    p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy(p_devProxy);
+    if ((p_trpConn == NULL) || (p_trpConn->trpRole != APP_TRP_SERVER_ROLE) || (p_trpConn->p_cold->testStage == APP_TEST_IDLE))
+        return;
+
+    printf("Replay link %d disconnected, run %s\n", link,
+        (p_trpConn->p_cold->testStage == APP_TEST_PASSED) ? "passed" : "failed");
+    APP_TRPS_ReportRunResult(p_trpConn);
+}
+
+static void app_replay_DispatchLink(APP_REPLAY_Rec_T *p_rec, gsize offset)
+{
+    DeviceProxy *p_devProxy;
+
+    p_devProxy = app_replay_GetProxy(p_rec->link);
+    if (p_devProxy == NULL)
+        return;
+
+    switch (p_rec->id)
+    {
+        case APP_REPLAY_LINK_CONNECTED:
+        {
+            if (p_rec->length == 0)
+                return;
+            s_replayCtrl.dataCursor[p_rec->link] = offset;
+            s_replayCtrl.sendCursor[p_rec->link] = offset;
+            s_replayCtrl.dlStatus[p_rec->link] = BLE_TRSPC_DL_STATUS_DISABLED;
+            APP_TRP_COMMON_ConnEvtProc(p_devProxy, p_rec->p_payload[0]);
+        }
+        break;
+
+        case APP_REPLAY_LINK_DISCONNECTED:
+        {
+            app_replay_ReportRun(p_devProxy, p_rec->link);
+            APP_TRP_COMMON_DiscEvtProc(p_devProxy);
+        }
+        break;
+
+        case APP_REPLAY_LINK_MTU:
+        {
+            if (p_rec->length < 2)
+                return;
+            APP_TRP_COMMON_UpdateMtu(p_devProxy, (uint16_t)(p_rec->p_payload[0] | (p_rec->p_payload[1] << 8)));
+        }
+        break;
+
+        case APP_REPLAY_LINK_TRCBP:
+        {
+            uint16_t sdu;
+
+            if (p_rec->length < 2)
+                return;
+            sdu = (uint16_t)(p_rec->p_payload[0] | (p_rec->p_payload[1] << 8));
+            APP_TRP_COMMON_TrcbpChOpenProc(p_devProxy, (sdu != 0), sdu);
+        }
+        break;
+
+        default:
+            break;
+    }
+}
+
+static void app_replay_Finish(bool complete)
+{
+    double elapsed;
+
+    elapsed = (g_get_monotonic_time() - s_replayCtrl.startUs) / 1000000.0;
+
+    printf("Replay %s: %u events, %u packets, %u bytes, %u misses, %.3f s, %.0f bytes/s (recorded %.3f s)\n",
+        complete ? "done" : "aborted", s_replayCtrl.events, s_replayCtrl.packets, s_replayCtrl.bytes,
+        s_replayCtrl.misses, elapsed, elapsed > 0 ? s_replayCtrl.bytes / elapsed : 0,
+        s_replayCtrl.timeUs / 1000000.0);
+
+    s_replayCtrl.exitCode = (complete && s_replayCtrl.misses == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    s_replayCtrl.replaying = false;
+
+    g_free(s_replayCtrl.p_buf);
+    s_replayCtrl.p_buf = NULL;
+
+    mainloop_quit();
+}
+
+static gboolean app_replay_Step(gpointer p_userData);
+
+/* Skip the DATA and SEND records and schedule the next dispatched record. */
+static void app_replay_Schedule(void)
+{
+    APP_REPLAY_Rec_T rec;
+    int64_t delayUs;
+
+    while (app_replay_Parse(s_replayCtrl.offset, &rec))
+    {
+        s_replayCtrl.timeUs += rec.deltaUs;
+
+        if (rec.type != APP_REPLAY_REC_DATA && rec.type != APP_REPLAY_REC_SEND)
+        {
+            delayUs = 0;
+            if (s_replayCtrl.speed > 0)
+            {
+                delayUs = s_replayCtrl.startUs + (int64_t)(s_replayCtrl.timeUs / s_replayCtrl.speed)
+                    - g_get_monotonic_time();
+            }
+
+            if (delayUs >= 1000)
+                g_timeout_add(delayUs / 1000, app_replay_Step, NULL);
+            else
+                g_idle_add(app_replay_Step, NULL);
+            return;
+        }
+
+        s_replayCtrl.offset += APP_REPLAY_REC_HDR_LEN + rec.length;
+    }
+
+    app_replay_Finish(s_replayCtrl.offset == s_replayCtrl.bufLen);
+}
+
+static gboolean app_replay_Step(gpointer p_userData)
+{
+    APP_REPLAY_Rec_T rec;
+    gsize offset;
+
+    offset = s_replayCtrl.offset;
+    if (!app_replay_Parse(offset, &rec))
+    {
+        app_replay_Finish(false);
+        return FALSE;
+    }
+
+    s_replayCtrl.offset += APP_REPLAY_REC_HDR_LEN + rec.length;
+    s_replayCtrl.events++;
+
+    switch (rec.type)
+    {
+        case APP_REPLAY_REC_TRPS_EVT:
+            app_replay_DispatchTrps(&rec);
+            break;
+
+        case APP_REPLAY_REC_TRPC_EVT:
+            app_replay_DispatchTrpc(&rec);
+            break;
+
+        case APP_REPLAY_REC_LINK:
+            app_replay_DispatchLink(&rec, offset);
+            break;
+
+        default:
+            break;
+    }
+
+    app_replay_Schedule();
+
+    return FALSE;
+}
+
+static gboolean app_replay_Begin(gpointer p_userData)
+{
+    s_replayCtrl.startUs = g_get_monotonic_time();
+    app_replay_Schedule();
+
+    return FALSE;
+}
+
+bool APP_REPLAY_Start(void)
+{
+    GError *p_error = NULL;
+    gchar *p_buf;
+    gsize bufLen;
+    uint8_t i;
+
+    if (s_replayCtrl.p_path == NULL)
+        return false;
+
+    if (!g_file_get_contents(s_replayCtrl.p_path, &p_buf, &bufLen, &p_error))
+    {
+        fprintf(stderr, "Failed to load replay file: %s\n", p_error->message);
+        g_error_free(p_error);
+        return false;
+    }
+
+    if (bufLen < APP_REPLAY_FILE_HDR_LEN || memcmp(p_buf, APP_REPLAY_MAGIC, 4) != 0
+        || (uint8_t)p_buf[4] != APP_REPLAY_VERSION)
+    {
+        fprintf(stderr, "Invalid replay file %s\n", s_replayCtrl.p_path);
+        g_free(p_buf);
+        return false;
+    }
+
+    APP_REPLAY_StopRecord();
+
+    s_replayCtrl.p_buf = (uint8_t *)p_buf;
+    s_replayCtrl.bufLen = bufLen;
+    s_replayCtrl.offset = APP_REPLAY_FILE_HDR_LEN;
+    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    {
+        s_replayCtrl.dataCursor[i] = APP_REPLAY_FILE_HDR_LEN;
+        s_replayCtrl.sendCursor[i] = APP_REPLAY_FILE_HDR_LEN;
+        s_replayCtrl.dlStatus[i] = BLE_TRSPC_DL_STATUS_DISABLED;
+    }
+    s_replayCtrl.timeUs = 0;
+    s_replayCtrl.events = 0;
+    s_replayCtrl.packets = 0;
+    s_replayCtrl.bytes = 0;
+    s_replayCtrl.misses = 0;
+    s_replayCtrl.exitCode = EXIT_FAILURE;
+    s_replayCtrl.replaying = true;
+
+    g_idle_add(app_replay_Begin, NULL);
+
+    return true;
+}
+
+
+/*******************************************************************************
+ End of File
+ */
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application TRP Record and Replay Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_replay.h
+
+  Summary:
+    This file contains the Application TRP record and replay functions for this project.
+
+  Description:
+    This file contains the Application TRP record and replay functions for this project.
+    The inbound TRSPS/TRSPC events, link events, fetched data packets and the results of
+    outbound sends are recorded with timestamps into a binary file. The file can be
+    replayed into APP_TRPS_EventHandler/APP_TRPC_EventHandler without BlueZ, either as
+    fast as possible or with the original timing.
+ *******************************************************************************/
+
+#ifndef APP_REPLAY_H
+#define APP_REPLAY_H
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "app_dbp.h"
+#include "ble_trsp/ble_trsps.h"
+#include "ble_trsp/ble_trspc.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_REPLAY_MAGIC                        "TRPR"      /**< File signature. */
+#define APP_REPLAY_VERSION                      (1U)        /**< File format version. */
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Enumeration type of record type.
+ *        A record is a 9 bytes little endian header, delta time in us (4), type (1), id (1), link (1), length (2),
+ *        followed by length bytes of payload. */
+typedef enum APP_REPLAY_RecType_T
+{
+    APP_REPLAY_REC_TRPS_EVT = 0x01,     /**< TRSPS event. id is @ref BLE_TRSPS_EventId_T. */
+    APP_REPLAY_REC_TRPC_EVT,            /**< TRSPC event. id is @ref BLE_TRSPC_EventId_T. */
+    APP_REPLAY_REC_LINK,                /**< Link event. id is @ref APP_REPLAY_LinkEvt_T. */
+    APP_REPLAY_REC_DATA,                /**< Data packet fetched from the profile. */
+    APP_REPLAY_REC_SEND                 /**< Result of an outbound send, 2 bytes. */
+} APP_REPLAY_RecType_T;
+
+/**@brief Enumeration type of link event. */
+typedef enum APP_REPLAY_LinkEvt_T
+{
+    APP_REPLAY_LINK_CONNECTED = 0x00,   /**< Payload is the GAP role, 1 byte. */
+    APP_REPLAY_LINK_DISCONNECTED,       /**< No payload. */
+    APP_REPLAY_LINK_MTU,                /**< Payload is the exchanged MTU, 2 bytes. */
+    APP_REPLAY_LINK_TRCBP               /**< Payload is the TRCBP SDU size, 2 bytes, 0 if the channel is closed. */
+} APP_REPLAY_LinkEvt_T;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Start recording into a file. A previous recording is stopped.
+ * @param[in] p_path                File path.
+ * @retval true                     Recording.
+ * @retval false                    The file can not be created.
+ */
+bool APP_REPLAY_StartRecord(const char *p_path);
+
+/**@brief Stop recording and close the file. */
+void APP_REPLAY_StopRecord(void);
+
+/**@brief Check whether recording is active. */
+bool APP_REPLAY_IsRecording(void);
+
+/**@brief Set the file to replay. The replay is started by @ref APP_REPLAY_Start.
+ * @param[in] p_path                File path.
+ * @param[in] speed                 Timing factor, 1 for the original timing, 0 for as fast as possible.
+ */
+void APP_REPLAY_SetReplayFile(const char *p_path, double speed);
+
+/**@brief Check whether the application runs in replay mode. */
+bool APP_REPLAY_IsEnabled(void);
+
+/**@brief Check whether a replay is in progress. Outbound traffic is not sent to BlueZ during replay. */
+bool APP_REPLAY_IsReplaying(void);
+
+/**@brief Load the file and start the replay on the main loop. The main loop quits when done.
+ * @retval true                     Started.
+ * @retval false                    The file can not be loaded.
+ */
+bool APP_REPLAY_Start(void);
+
+/**@brief Get the process exit code of the replay. 0 if the whole file is replayed. */
+int APP_REPLAY_GetExitCode(void);
+
+/**@brief Record a TRSPS event. */
+void APP_REPLAY_RecordTrpsEvt(BLE_TRSPS_Event_T *p_event);
+
+/**@brief Record a TRSPC event. */
+void APP_REPLAY_RecordTrpcEvt(BLE_TRSPC_Event_T *p_event);
+
+/**@brief Record a link event.
+ * @param[in] p_devProxy            Device proxy.
+ * @param[in] linkEvt               See @ref APP_REPLAY_LinkEvt_T.
+ * @param[in] value                 GAP role for connected, MTU for MTU event, SDU size for TRCBP event.
+ */
+void APP_REPLAY_RecordLink(DeviceProxy *p_devProxy, uint8_t linkEvt, uint16_t value);
+
+/**@brief Record a data packet fetched from the profile. */
+void APP_REPLAY_RecordData(DeviceProxy *p_devProxy, uint16_t length, uint8_t *p_data);
+
+/**@brief Record the result of an outbound send. */
+void APP_REPLAY_RecordSend(DeviceProxy *p_devProxy, uint16_t status);
+
+/**@brief Get the length of the next replayed data packet of a link.
+ * @param[in] p_devProxy            Device proxy.
+ * @param[out] p_dataLeng           Data length, 0 if none.
+ */
+void APP_REPLAY_GetDataLength(DeviceProxy *p_devProxy, uint16_t *p_dataLeng);
+
+/**@brief Get the next replayed data packet of a link.
+ * @param[in] p_devProxy            Device proxy.
+ * @param[out] p_data               Buffer of the length returned by @ref APP_REPLAY_GetDataLength.
+ * @retval APP_RES_SUCCESS          Copied.
+ * @retval APP_RES_FAIL             No data.
+ */
+uint16_t APP_REPLAY_GetData(DeviceProxy *p_devProxy, uint8_t *p_data);
+
+/**@brief Get the recorded result of the next outbound send of a link. Success if none is recorded. */
+uint16_t APP_REPLAY_GetSendResult(DeviceProxy *p_devProxy);
+
+/**@brief Check whether the replayed downlink of a link is credit based, from the last replayed downlink status. */
+bool APP_REPLAY_IsDlCreditBased(DeviceProxy *p_devProxy);
+
+
+#endif
@@ -0,0 +1,432 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Result Log Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_result.c
+
+  Summary:
+    This file contains the Application burst mode result log functions for this project.
+
+  Description:
+    This file contains the Application burst mode result log functions for this project.
+    One JSON object is written per link and run, e.g.
+    {"time":"2024-05-01T10:00:00+0800","kernel":"6.1.55","mgmt":"1.22","run":1,"mode":"loopback",
+     "links":1,"address":"...","name":"...","mtu":247,"phy":"LE2M","bytes":5120,
+     "durationSec":1.234,"throughputBps":33192,"result":"Passed"}
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/utsname.h>
+#include <glib.h>
+
+#include "bluetooth/bluetooth.h"
+#include "bluetooth/mgmt.h"
+#include "shared/shell.h"
+
+#include "application.h"
+#include "app_result.h"
+#include "app_gap.h"
+#include "app_mgmt.h"
+#include "app_error_defs.h"
+#include "app_trp_common.h"
+#include "app_utility.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_RESULT_ADDR_LEN             18
+#define APP_RESULT_NAME_MAX_LEN         32
+#define APP_RESULT_LINE_MAX_LEN         512
+#define APP_RESULT_MAX_GROUP_NUM        32
+
+#define APP_RESULT_PHY_LE_1M            (1U << 9)
+#define APP_RESULT_PHY_LE_2M            (1U << 11)
+#define APP_RESULT_PHY_LE_CODED         (1U << 13)
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief The structure contains the result of one link in a run. */
+typedef struct APP_RESULT_Record_T
+{
+    char                    address[APP_RESULT_ADDR_LEN];   /**< Peer address. */
+    char                    name[APP_RESULT_NAME_MAX_LEN];  /**< Peer name. */
+    uint8_t                 workMode;                       /**< See @ref APP_TRP_WMODE_T. */
+    uint8_t                 testStage;                      /**< See @ref APP_TRP_TestStage_T. */
+    uint16_t                mtu;                            /**< ATT MTU. */
+    uint32_t                bytes;                          /**< Transferred payload bytes. */
+    double                  elapsed;                        /**< Elapsed time in seconds. */
+} APP_RESULT_Record_T;
+
+/**@brief The structure contains the results of the last run. */
+typedef struct APP_RESULT_Run_T
+{
+    bool                    finished;                       /**< The run is complete, next report starts a new run. */
+    uint16_t                runIndex;                       /**< Iteration index, from 1. */
+    uint8_t                 recordNum;                      /**< Number of reported links. */
+    APP_RESULT_Record_T     record[BLE_GAP_MAX_LINK_NBR_LIMIT];
+} APP_RESULT_Run_T;
+
+/**@brief The structure contains the average throughput of the runs with the same mode, link count and bytes. */
+typedef struct APP_RESULT_Group_T
+{
+    char                    mode[16];                       /**< Work mode string. */
+    uint8_t                 links;                          /**< Number of links. */
+    uint32_t                bytes;                          /**< Transferred payload bytes per link. */
+    double                  sum;                            /**< Sum of throughput of the links in bps, 0 for a failed link. */
+    uint32_t                count;                          /**< Number of links. */
+} APP_RESULT_Group_T;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static char *               sp_resultLogPath;
+static APP_RESULT_Run_T     s_resultRun;
+static uint16_t             s_resultRunCount;               /**< Number of finished runs. */
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static double app_result_Throughput(const APP_RESULT_Record_T *p_record)
+{
+    if (p_record->testStage != APP_TEST_PASSED || p_record->elapsed <= 0)
+        return 0;
+
+    return p_record->bytes * 8.0 / p_record->elapsed;
+}
+
+static const char * app_result_PhyStr(void)
+{
+    uint32_t phys = APP_MGMT_GetSelectedPhys();
+    static char str[32];
+
+    str[0] = '\0';
+    if (phys & APP_RESULT_PHY_LE_1M)
+        strcat(str, " LE1M");
+    if (phys & APP_RESULT_PHY_LE_2M)
+        strcat(str, " LE2M");
+    if (phys & APP_RESULT_PHY_LE_CODED)
+        strcat(str, " LECODED");
+
+    return (str[0] != '\0') ? &str[1] : NULL;
+}
+
+static void app_result_WriteRun(FILE *p_file)
+{
+    uint8_t i, version, revision;
+    struct utsname uts;
+    GDateTime *p_now;
+    gchar *p_time;
+    APP_RESULT_Record_T *p_record;
+
+    p_now = g_date_time_new_now_local();
+    p_time = g_date_time_format(p_now, "%Y-%m-%dT%H:%M:%S%z");
+    g_date_time_unref(p_now);
+
+    if (uname(&uts) != 0)
+        strcpy(uts.release, "unknown");
+    APP_MGMT_GetVersion(&version, &revision);
+
+    for (i = 0; i < s_resultRun.recordNum; i++)
+    {
+        p_record = &s_resultRun.record[i];
+
+        fprintf(p_file, "{\"time\":\"%s\",\"kernel\":", p_time);
+        APP_UTILITY_WriteJsonString(p_file, uts.release);
+        fprintf(p_file, ",\"mgmt\":\"%u.%u\",\"run\":%u,\"mode\":\"%s\",\"links\":%u,\"address\":\"%s\",\"name\":",
+            version, revision, s_resultRun.runIndex, APP_TRP_WorkModeStr[p_record->workMode],
+            s_resultRun.recordNum, p_record->address);
+        APP_UTILITY_WriteJsonString(p_file, p_record->name);
+        fprintf(p_file, ",\"mtu\":%u,\"phy\":", p_record->mtu);
+        APP_UTILITY_WriteJsonString(p_file, app_result_PhyStr());
+        fprintf(p_file, ",\"bytes\":%u,\"durationSec\":%.3f,\"throughputBps\":%.0f,\"result\":\"%s\"}\n",
+            p_record->bytes, p_record->elapsed, app_result_Throughput(p_record), APP_TRP_TestStageStr[p_record->testStage]);
+    }
+
+    g_free(p_time);
+}
+
+//Find a top level key, skipping the string values, so a key inside a value such as the name never matches
+static const char * app_result_FindKey(const char *p_line, const char *p_key)
+{
+    const char *p_pos = p_line;
+    size_t keyLen = strlen(p_key);
+    bool isKey = false;
+
+    while (*p_pos != '\0')
+    {
+        if (*p_pos == '{' || *p_pos == ',')
+        {
+            isKey = true;
+            p_pos++;
+        }
+        else if (*p_pos == '"')
+        {
+            if (isKey && !strncmp(p_pos + 1, p_key, keyLen) && p_pos[keyLen + 1] == '"' && p_pos[keyLen + 2] == ':')
+                return p_pos + keyLen + 3;
+
+            /* Skip the string, its escaped characters included */
+            for (p_pos++; *p_pos != '\0' && *p_pos != '"'; p_pos++)
+            {
+                if (*p_pos == '\\' && p_pos[1] != '\0')
+                    p_pos++;
+            }
+            if (*p_pos == '"')
+                p_pos++;
+            isKey = false;
+        }
+        else
+        {
+            if (*p_pos != ' ')
+                isKey = false;
+            p_pos++;
+        }
+    }
+
+    return NULL;
+}
+
+static bool app_result_GetField(const char *p_line, const char *p_key, char *p_value, size_t len)
+{
+    const char *p_start;
+    size_t i = 0;
+
+    p_start = app_result_FindKey(p_line, p_key);
+    if (p_start == NULL)
+        return false;
+
+    if (*p_start == '"')
+        p_start++;
+
+    while (p_start[i] != '\0' && p_start[i] != '"' && p_start[i] != ',' && p_start[i] != '}' && i < len - 1)
+    {
+        p_value[i] = p_start[i];
+        i++;
+    }
+    p_value[i] = '\0';
+
+    return true;
+}
+
+static APP_RESULT_Group_T * app_result_GetGroup(APP_RESULT_Group_T *p_groups, uint8_t *p_groupNum,
+    const char *p_mode, uint8_t links, uint32_t bytes, bool alloc)
+{
+    uint8_t i;
+    APP_RESULT_Group_T *p_group;
+
+    for (i = 0; i < *p_groupNum; i++)
+    {
+        if (!strcmp(p_groups[i].mode, p_mode) && p_groups[i].links == links && p_groups[i].bytes == bytes)
+            return &p_groups[i];
+    }
+
+    if (!alloc || *p_groupNum >= APP_RESULT_MAX_GROUP_NUM)
+        return NULL;
+
+    p_group = &p_groups[(*p_groupNum)++];
+    memset(p_group, 0, sizeof(APP_RESULT_Group_T));
+    snprintf(p_group->mode, sizeof(p_group->mode), "%s", p_mode);
+    p_group->links = links;
+    p_group->bytes = bytes;
+
+    return p_group;
+}
+
+void APP_RESULT_SetLogFile(const char *p_path)
+{
+    g_free(sp_resultLogPath);
+    sp_resultLogPath = g_strdup(p_path);
+}
+
+const char * APP_RESULT_GetLogFile(void)
+{
+    return sp_resultLogPath;
+}
+
+void APP_RESULT_LinkResult(DeviceProxy *p_devProxy, uint8_t workMode, uint8_t testStage, double elapsed, uint32_t bytes, uint16_t mtu)
+{
+    APP_RESULT_Record_T *p_record;
+    APP_DBP_BtDev_T *p_dev;
+
+    if (s_resultRun.finished)
+    {
+        memset(&s_resultRun, 0, sizeof(APP_RESULT_Run_T));
+    }
+
+    if (s_resultRun.recordNum >= BLE_GAP_MAX_LINK_NBR || workMode >= TRP_WMODE_END)
+        return;
+
+    p_record = &s_resultRun.record[s_resultRun.recordNum++];
+    memset(p_record, 0, sizeof(APP_RESULT_Record_T));
+
+    p_dev = APP_DBP_GetDevInfoByProxy(p_devProxy);
+    if (p_dev != NULL)
+    {
+        snprintf(p_record->address, sizeof(p_record->address), "%s", p_dev->p_address ? p_dev->p_address : "");
+        snprintf(p_record->name, sizeof(p_record->name), "%s", p_dev->p_name ? p_dev->p_name : "");
+    }
+    p_record->workMode = workMode;
+    p_record->testStage = testStage;
+    p_record->elapsed = elapsed;
+    p_record->bytes = bytes;
+    p_record->mtu = mtu;
+}
+
+void APP_RESULT_RunFinished(void)
+{
+    FILE *p_file;
+
+    if (s_resultRun.recordNum == 0)
+        return;
+
+    s_resultRun.finished = true;
+    s_resultRun.runIndex = ++s_resultRunCount;
+
+    if (sp_resultLogPath == NULL)
+        return;
+
+    p_file = fopen(sp_resultLogPath, "a");
+    if (p_file == NULL)
+    {
+        bt_shell_printf("Failed to open result log %s\n", sp_resultLogPath);
+        return;
+    }
+
+    app_result_WriteRun(p_file);
+    fclose(p_file);
+}
+
+uint16_t APP_RESULT_SaveBaseline(const char *p_path)
+{
+    FILE *p_file;
+
+    if (!s_resultRun.finished || p_path == NULL)
+        return APP_RES_FAIL;
+
+    p_file = fopen(p_path, "w");
+    if (p_file == NULL)
+        return APP_RES_FAIL;
+
+    app_result_WriteRun(p_file);
+    fclose(p_file);
+
+    return APP_RES_SUCCESS;
+}
+
+uint16_t APP_RESULT_Compare(const char *p_path, uint8_t threshold, uint8_t *p_regressions)
+{
+    FILE *p_file;
+    char line[APP_RESULT_LINE_MAX_LEN];
+    char mode[16], links[8], bytes[16], throughput[24];
+    APP_RESULT_Group_T baseGroups[APP_RESULT_MAX_GROUP_NUM];
+    APP_RESULT_Group_T currGroups[APP_RESULT_MAX_GROUP_NUM];
+    APP_RESULT_Group_T *p_group, *p_base;
+    APP_RESULT_Record_T *p_record;
+    uint8_t baseNum = 0, currNum = 0, matched = 0, i;
+    double baseAvg, currAvg, drop;
+
+    *p_regressions = 0;
+
+    if (!s_resultRun.finished || p_path == NULL)
+        return APP_RES_FAIL;
+
+    p_file = fopen(p_path, "r");
+    if (p_file == NULL)
+        return APP_RES_FAIL;
+
+    while (fgets(line, sizeof(line), p_file) != NULL)
+    {
+        if (!app_result_GetField(line, "mode", mode, sizeof(mode))
+            || !app_result_GetField(line, "links", links, sizeof(links))
+            || !app_result_GetField(line, "bytes", bytes, sizeof(bytes))
+            || !app_result_GetField(line, "throughputBps", throughput, sizeof(throughput)))
+            continue;
+
+        /* The log has a zero throughput for a failed link, it is averaged as in the current run */
+        p_group = app_result_GetGroup(baseGroups, &baseNum, mode, atoi(links), strtoul(bytes, NULL, 10), true);
+        if (p_group != NULL)
+        {
+            p_group->sum += atof(throughput);
+            p_group->count++;
+        }
+    }
+    fclose(p_file);
+
+    for (i = 0; i < s_resultRun.recordNum; i++)
+    {
+        p_record = &s_resultRun.record[i];
+        p_group = app_result_GetGroup(currGroups, &currNum, APP_TRP_WorkModeStr[p_record->workMode],
+            s_resultRun.recordNum, p_record->bytes, true);
+        if (p_group != NULL)
+        {
+            /* A failed link counts as zero throughput */
+            p_group->sum += app_result_Throughput(p_record);
+            p_group->count++;
+        }
+    }
+
+    bt_shell_printf("[    Mode    ][Links][  Bytes  ][Baseline(bps)][Current(bps)][ Drop ][Result]\n");
+    bt_shell_printf("=================================================================================\n");
+
+    for (i = 0; i < currNum; i++)
+    {
+        p_group = &currGroups[i];
+        p_base = app_result_GetGroup(baseGroups, &baseNum, p_group->mode, p_group->links, p_group->bytes, false);
+        if (p_base == NULL || p_base->count == 0)
+        {
+            bt_shell_printf("[%-12s][%5u][%9u][%13s][%12.0f][%6s][ N/A  ]\n", p_group->mode, p_group->links, p_group->bytes,
+                "-", p_group->sum / p_group->count, "-");
+            continue;
+        }
+
+        matched++;
+        baseAvg = p_base->sum / p_base->count;
+        currAvg = p_group->sum / p_group->count;
+        drop = (baseAvg > 0) ? ((baseAvg - currAvg) * 100.0 / baseAvg) : 0;
+        if (drop > threshold)
+            (*p_regressions)++;
+
+        bt_shell_printf("[%-12s][%5u][%9u][%13.0f][%12.0f][%5.1f%%][%s]\n", p_group->mode, p_group->links, p_group->bytes,
+            baseAvg, currAvg, drop, (drop > threshold) ? "REGRES" : "  OK  ");
+    }
+
+    if (matched == 0)
+        return APP_RES_FAIL;
+
+    return APP_RES_SUCCESS;
+}
+
+
+/*******************************************************************************
+ End of File
+ */
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Result Log Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_result.h
+
+  Summary:
+    This file contains the Application burst mode result log functions for this project.
+
+  Description:
+    This file contains the Application burst mode result log functions for this project.
+    The per-link results of every run are appended to a JSON lines file and the last
+    run can be saved as a baseline or compared against one.
+ *******************************************************************************/
+
+#ifndef APP_RESULT_H
+#define APP_RESULT_H
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "app_dbp.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_RESULT_DEFAULT_THRESHOLD            10          /**< Default throughput drop threshold in percent. */
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Set the result log file. Records are appended to it after every run.
+ * @param[in] p_path                File path. NULL to disable the log.
+ */
+void APP_RESULT_SetLogFile(const char *p_path);
+
+/**@brief Get the result log file. NULL if disabled. */
+const char * APP_RESULT_GetLogFile(void);
+
+/**@brief Report the result of one link in the finished run.
+ * @param[in] p_devProxy            Device proxy of the link.
+ * @param[in] workMode              Work mode. See @ref APP_TRP_WMODE_T.
+ * @param[in] testStage             Test result. See @ref APP_TRP_TestStage_T.
+ * @param[in] elapsed               Elapsed time of the run in seconds.
+ * @param[in] bytes                 Transferred payload bytes in the run.
+ * @param[in] mtu                   ATT MTU of the link.
+ */
+void APP_RESULT_LinkResult(DeviceProxy *p_devProxy, uint8_t workMode, uint8_t testStage, double elapsed, uint32_t bytes, uint16_t mtu);
+
+/**@brief Complete the run, write the reported links to the result log.
+ *        The runs are numbered from 1 in the order they finish, passed or not.
+ */
+void APP_RESULT_RunFinished(void);
+
+/**@brief Save the last run as a baseline file.
+ * @param[in] p_path                File path.
+ * @retval APP_RES_SUCCESS          Saved.
+ * @retval APP_RES_FAIL             No run or the file can not be written.
+ */
+uint16_t APP_RESULT_SaveBaseline(const char *p_path);
+
+/**@brief Compare the last run against a baseline file and print the result.
+ *        Runs are matched by work mode, link count and bytes; the average throughput
+ *        of the links is compared on both sides, a failed link counts as zero.
+ * @param[in] p_path                Baseline file path, in the result log format.
+ * @param[in] threshold             Allowed throughput drop in percent.
+ * @param[out] p_regressions        Number of matched groups dropped above the threshold.
+ * @retval APP_RES_SUCCESS          Compared.
+ * @retval APP_RES_FAIL             No run, no matched group or the file can not be read.
+ */
+uint16_t APP_RESULT_Compare(const char *p_path, uint8_t threshold, uint8_t *p_regressions);
+
+
+#endif
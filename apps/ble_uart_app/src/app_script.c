@@ -0,0 +1,987 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Headless Script Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_script.c
+
+  Summary:
+    This file contains the Application headless script functions for this project.
+
+  Description:
+    This file contains the Application headless script functions for this project.
+    In central role it scans with the peer filter, connects the configured number
+    of peers, runs burst mode for the configured iterations and exits with a JSON
+    summary. In peripheral role it advertises and exits once all peers are gone.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <glib.h>
+
+#include "shared/shell.h"
+#include "shared/mainloop.h"
+
+#include "application.h"
+#include "app_script.h"
+#include "app_gap.h"
+#include "app_ble_handler.h"
+#include "app_sm.h"
+#include "app_scan.h"
+#include "app_timer.h"
+#include "app_dbp.h"
+#include "app_trp_common.h"
+#include "app_trps.h"
+#include "app_utility.h"
+#include "app_result.h"
+#include "app_replay.h"
+#include "app_tune.h"
+#include "app_dp.h"
+#include "app_mem.h"
+#include "app_error_defs.h"
+#include "ble_trsp/ble_trsps.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_SCRIPT_LINE_MAX_LEN         256
+#define APP_SCRIPT_MEM_MAX_KB           0x3FFFFF    /**< Largest memory budget in KB that fits in 32 bits once in bytes. */
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Enumeration type of headless run state. */
+typedef enum APP_SCRIPT_State_T
+{
+    APP_SCRIPT_STATE_IDLE,
+    APP_SCRIPT_STATE_SCANNING,
+    APP_SCRIPT_STATE_CONNECTING,
+    APP_SCRIPT_STATE_STARTING,
+    APP_SCRIPT_STATE_TUNING,
+    APP_SCRIPT_STATE_RUNNING,
+    APP_SCRIPT_STATE_ADVERTISING,
+    APP_SCRIPT_STATE_DONE
+} APP_SCRIPT_State_T;
+
+/**@brief The structure contains the statistics of one link. */
+typedef struct APP_SCRIPT_Link_T
+{
+    bool                    used;               /**< The record is in use. */
+    DeviceProxy             *p_devProxy;        /**< Device proxy, NULL once disconnected. */
+    char                    *p_address;         /**< Peer address. */
+    char                    *p_name;            /**< Peer name. */
+    bool                    connected;          /**< Link is connected. */
+    bool                    ready;              /**< TRP is established. */
+    uint16_t                runs;               /**< Number of reported runs. */
+    uint16_t                passed;             /**< Number of passed runs. */
+    uint16_t                failed;             /**< Number of failed runs. */
+    uint16_t                disconnections;     /**< Number of unexpected disconnections. */
+    uint64_t                bytes;              /**< Accumulated payload bytes of passed runs. */
+    double                  elapsed;            /**< Accumulated elapsed time of passed runs in seconds. */
+    double                  minElapsed;         /**< Minimum elapsed time of one run. */
+    double                  maxElapsed;         /**< Maximum elapsed time of one run. */
+    gint64                  connectTime;        /**< Monotonic time when connected in us. */
+    gint64                  connDuration;       /**< Connection duration in us. */
+} APP_SCRIPT_Link_T;
+
+/**@brief The structure contains the headless run configuration and state. */
+typedef struct APP_SCRIPT_Ctrl_T
+{
+    bool                    enabled;            /**< Headless mode is enabled. */
+    uint8_t                 role;               /**< BLE_GAP_ROLE_CENTRAL or BLE_GAP_ROLE_PERIPHERAL. */
+    char                    *p_filter;          /**< Peer filter, name or address pattern. */
+    int                     rssi;               /**< RSSI filter. */
+    uint8_t                 links;              /**< Number of peers. */
+    uint8_t                 workMode;           /**< Work mode. See @ref APP_TRP_WMODE_T. */
+    uint8_t                 pattern;            /**< Pattern file. See @ref APP_PATTERN_FILE. */
+    uint16_t                iterations;         /**< Number of burst mode runs. */
+    uint32_t                runTimeout;         /**< Timeout of the whole run in seconds. */
+    char                    *p_jsonPath;        /**< JSON summary output file, NULL for stdout. */
+    char                    *p_baselinePath;    /**< Baseline file to compare against, NULL if none. */
+    uint8_t                 threshold;          /**< Allowed throughput drop against the baseline in percent. */
+    uint8_t                 regressions;        /**< Number of regressions found against the baseline. */
+    char                    *p_replayPath;      /**< Recorded file to replay, NULL if none. */
+    double                  replaySpeed;        /**< Replay timing factor, 0 for as fast as possible. */
+    bool                    autoTune;           /**< Tune PHY and connection interval of the links before the first run. */
+    APP_SCRIPT_State_T      state;              /**< Run state. */
+    int8_t                  devIndex;           /**< Device list index being connected. */
+    uint8_t                 readyLinks;         /**< Number of links with TRP established. */
+    uint16_t                completedRuns;      /**< Number of finished runs. */
+    const char              *p_result;          /**< Overall result string. */
+    char                    *p_error;           /**< Error description, NULL if none. */
+    int                     exitCode;           /**< Process exit code. */
+    gint64                  startTime;          /**< Monotonic time of the start in us. */
+    APP_SCRIPT_Link_T       linkList[BLE_GAP_MAX_LINK_NBR_LIMIT];
+} APP_SCRIPT_Ctrl_T;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static APP_SCRIPT_Ctrl_T    s_scriptCtrl;
+
+static const char *         sp_optScript;
+static const char *         sp_optRole;
+static const char *         sp_optFilter;
+static const char *         sp_optRssi;
+static const char *         sp_optLinks;
+static const char *         sp_optMode;
+static const char *         sp_optPattern;
+static const char *         sp_optIterations;
+static const char *         sp_optTimeout;
+static const char *         sp_optJson;
+static const char *         sp_optResultLog;
+static const char *         sp_optBaseline;
+static const char *         sp_optThreshold;
+static const char *         sp_optRecord;
+static const char *         sp_optReplay;
+static const char *         sp_optReplaySpeed;
+static const char *         sp_optCreditPolicy;
+static const char *         sp_optQueueDepth;
+static const char *         sp_optAutoTune;
+static const char *         sp_optDpWorkers;
+static const char *         sp_optMaxLinks;
+static const char *         sp_optMemBudget;
+static const char *         sp_optLinkQuota;
+
+static struct option s_scriptOptions[] = {
+    { "script",         required_argument, 0, 'S' },
+    { "role",           required_argument, 0, 'R' },
+    { "filter",         required_argument, 0, 'F' },
+    { "rssi",           required_argument, 0, 'I' },
+    { "links",          required_argument, 0, 'L' },
+    { "mode",           required_argument, 0, 'W' },
+    { "pattern",        required_argument, 0, 'P' },
+    { "iterations",     required_argument, 0, 'N' },
+    { "run-timeout",    required_argument, 0, 'T' },
+    { "json",           required_argument, 0, 'J' },
+    { "result-log",     required_argument, 0, 'O' },
+    { "baseline",       required_argument, 0, 'B' },
+    { "threshold",      required_argument, 0, 'D' },
+    { "record",         required_argument, 0, 'C' },
+    { "replay",         required_argument, 0, 'Y' },
+    { "replay-speed",   required_argument, 0, 'X' },
+    { "credit-policy",  required_argument, 0, 'A' },
+    { "queue-depth",    required_argument, 0, 'Q' },
+    { "auto-tune",      required_argument, 0, 'U' },
+    { "dp-workers",     required_argument, 0, 'K' },
+    { "max-links",      required_argument, 0, 'M' },
+    { "mem-budget",     required_argument, 0, 'E' },
+    { "link-quota",     required_argument, 0, 'Z' },
+    { 0, 0, 0, 0 }
+};
+
+static const char **s_scriptOptArgs[] = {
+    &sp_optScript,
+    &sp_optRole,
+    &sp_optFilter,
+    &sp_optRssi,
+    &sp_optLinks,
+    &sp_optMode,
+    &sp_optPattern,
+    &sp_optIterations,
+    &sp_optTimeout,
+    &sp_optJson,
+    &sp_optResultLog,
+    &sp_optBaseline,
+    &sp_optThreshold,
+    &sp_optRecord,
+    &sp_optReplay,
+    &sp_optReplaySpeed,
+    &sp_optCreditPolicy,
+    &sp_optQueueDepth,
+    &sp_optAutoTune,
+    &sp_optDpWorkers,
+    &sp_optMaxLinks,
+    &sp_optMemBudget,
+    &sp_optLinkQuota,
+};
+
+static const char *s_scriptHelp[] = {
+    "Headless mode script file, one <option>=<value> per line",
+    "Headless mode role (central|peripheral)",
+    "Peer name or address pattern used as scan filter",
+    "Peer RSSI threshold used as scan filter",
+    "Number of peers to connect (central role)",
+    "Work mode (1=checksum, 2=loopback, 3=fixed-pattern, 5=reverse-loopback, 6=duplex)",
+    "Pattern file (0=1K, 1=5K, 2=10K, 3=50K, 4=100K, 5=200K, 6=500K)",
+    "Number of burst mode runs",
+    "Timeout of the whole headless run in seconds",
+    "Write the JSON summary to file instead of stdout",
+    "Append the per-run results to a JSON lines file",
+    "Compare the last run against a baseline file, see 'rb' command",
+    "Allowed throughput drop against the baseline in percent",
+    "Record TRP events and data to file, see 'rec' command",
+    "Replay a recorded file without BlueZ and exit",
+    "Replay timing factor (0=as fast as possible, 1=original timing)",
+    "TRP server credit policy (fixed|adaptive), see 'cr' command",
+    "TRP server receive queue depth (2-64), see 'cr' command",
+    "Tune PHY and connection interval before the first run (on|off), see 'tune' command",
+    "Number of data plane worker threads the links are shared across (auto=one per CPU core, 0=none)",
+    "Maximum number of links the connection tables are allocated for (1-64)",
+    "Global budget of the buffered data in KB (0=no limit), see 'mem' command",
+    "Budget of the buffered data of each link in KB (0=no limit), see 'mem' command",
+};
+
+static const struct bt_shell_opt s_scriptShellOpt = {
+    .options = s_scriptOptions,
+    .optno = sizeof(s_scriptOptions) / sizeof(struct option) - 1,
+    .optstr = "S:R:F:I:L:W:P:N:T:J:O:B:D:C:Y:X:A:Q:U:K:M:E:Z:",
+    .optarg = s_scriptOptArgs,
+    .help = s_scriptHelp,
+};
+
+static const char * s_scriptPatternStr[] = {
+    "1K",
+    "5K",
+    "10K",
+    "50K",
+    "100K",
+    "200K",
+    "500K",
+};
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static APP_SCRIPT_Link_T * app_script_GetLink(DeviceProxy *p_devProxy, bool alloc)
+{
+    uint8_t i;
+
+    for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
+    {
+        if (s_scriptCtrl.linkList[i].p_devProxy == p_devProxy)
+            return &s_scriptCtrl.linkList[i];
+    }
+
+    if (!alloc)
+        return NULL;
+
+    for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
+    {
+        if (!s_scriptCtrl.linkList[i].used)
+        {
+            APP_DBP_BtDev_T *p_dev = APP_DBP_GetDevInfoByProxy(p_devProxy);
+
+            memset(&s_scriptCtrl.linkList[i], 0, sizeof(APP_SCRIPT_Link_T));
+            s_scriptCtrl.linkList[i].used = true;
+            s_scriptCtrl.linkList[i].p_devProxy = p_devProxy;
+            if (p_dev != NULL)
+            {
+                s_scriptCtrl.linkList[i].p_address = g_strdup(p_dev->p_address);
+                s_scriptCtrl.linkList[i].p_name = g_strdup(p_dev->p_name);
+            }
+            return &s_scriptCtrl.linkList[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void app_script_WriteSummary(FILE *p_file)
+{
+    uint8_t i;
+    bool first = true;
+    APP_SCRIPT_Link_T *p_link;
+
+    fprintf(p_file, "{\n");
+    fprintf(p_file, "  \"role\": \"%s\",\n", (s_scriptCtrl.role == BLE_GAP_ROLE_CENTRAL) ? "central" : "peripheral");
+    fprintf(p_file, "  \"result\": \"%s\",\n", s_scriptCtrl.p_result);
+    fprintf(p_file, "  \"error\": ");
+    APP_UTILITY_WriteJsonString(p_file, s_scriptCtrl.p_error);
+    fprintf(p_file, ",\n");
+    if (s_scriptCtrl.role == BLE_GAP_ROLE_CENTRAL)
+    {
+        fprintf(p_file, "  \"mode\": \"%s\",\n", APP_TRP_WorkModeStr[s_scriptCtrl.workMode]);
+        fprintf(p_file, "  \"pattern\": \"%s\",\n", s_scriptPatternStr[s_scriptCtrl.pattern]);
+        fprintf(p_file, "  \"iterations\": %u,\n", s_scriptCtrl.iterations);
+        fprintf(p_file, "  \"completedRuns\": %u,\n", s_scriptCtrl.completedRuns);
+        if (s_scriptCtrl.p_baselinePath != NULL)
+            fprintf(p_file, "  \"regressions\": %u,\n", s_scriptCtrl.regressions);
+    }
+    fprintf(p_file, "  \"durationSec\": %.3f,\n", (g_get_monotonic_time() - s_scriptCtrl.startTime) / 1000000.0);
+    fprintf(p_file, "  \"links\": [");
+
+    for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
+    {
+        p_link = &s_scriptCtrl.linkList[i];
+        if (!p_link->used)
+            continue;
+
+        fprintf(p_file, "%s\n    {\"address\": ", first ? "" : ",");
+        APP_UTILITY_WriteJsonString(p_file, p_link->p_address);
+        fprintf(p_file, ", \"name\": ");
+        APP_UTILITY_WriteJsonString(p_file, p_link->p_name);
+        fprintf(p_file, ", \"runs\": %u, \"passed\": %u, \"failed\": %u, \"disconnections\": %u",
+            p_link->runs, p_link->passed, p_link->failed, p_link->disconnections);
+        fprintf(p_file, ", \"bytes\": %llu, \"elapsedSec\": %.3f", (unsigned long long)p_link->bytes, p_link->elapsed);
+        fprintf(p_file, ", \"minSec\": %.3f, \"maxSec\": %.3f", p_link->minElapsed, p_link->maxElapsed);
+        fprintf(p_file, ", \"throughputBps\": %.0f", (p_link->elapsed > 0) ? (p_link->bytes * 8.0 / p_link->elapsed) : 0.0);
+        fprintf(p_file, ", \"connectedSec\": %.3f}",
+            (p_link->connected ? (g_get_monotonic_time() - p_link->connectTime) : p_link->connDuration) / 1000000.0);
+        first = false;
+    }
+
+    fprintf(p_file, "%s]\n}\n", first ? "" : "\n  ");
+}
+
+static void app_script_Finish(const char *p_result, const char *p_error)
+{
+    FILE *p_file = stdout;
+
+    if (s_scriptCtrl.state == APP_SCRIPT_STATE_DONE)
+        return;
+
+    s_scriptCtrl.state = APP_SCRIPT_STATE_DONE;
+
+    if (s_scriptCtrl.p_baselinePath != NULL && !strcmp(p_result, "passed"))
+    {
+        if (APP_RESULT_Compare(s_scriptCtrl.p_baselinePath, s_scriptCtrl.threshold, &s_scriptCtrl.regressions) != APP_RES_SUCCESS)
+        {
+            p_result = "error";
+            p_error = "no matched baseline";
+        }
+        else if (s_scriptCtrl.regressions > 0)
+        {
+            p_result = "regression";
+            p_error = "throughput dropped above threshold";
+        }
+    }
+
+    s_scriptCtrl.p_result = p_result;
+    if (p_error != NULL)
+        s_scriptCtrl.p_error = g_strdup(p_error);
+    s_scriptCtrl.exitCode = strcmp(p_result, "passed") ? EXIT_FAILURE : EXIT_SUCCESS;
+
+    APP_TIMER_StopTimer(APP_TIMER_SCRIPT_STEP, 0);
+    APP_TIMER_StopTimer(APP_TIMER_SCRIPT_TIMEOUT, 0);
+
+    if (s_scriptCtrl.p_jsonPath != NULL)
+    {
+        p_file = fopen(s_scriptCtrl.p_jsonPath, "w");
+        if (p_file == NULL)
+        {
+            fprintf(stderr, "Failed to open JSON summary file %s\n", s_scriptCtrl.p_jsonPath);
+            p_file = stdout;
+        }
+    }
+
+    fflush(stdout);
+    app_script_WriteSummary(p_file);
+
+    if (p_file != stdout)
+        fclose(p_file);
+    else
+        fflush(stdout);
+
+    mainloop_quit();
+}
+
+static void app_script_ConnectNext(void)
+{
+    APP_DBP_BtDev_T *p_dev;
+
+    if (s_scriptCtrl.state == APP_SCRIPT_STATE_DONE)
+        return;
+
+    while (1)
+    {
+        s_scriptCtrl.devIndex++;
+        p_dev = APP_DBP_GetDevInfoByIndex(s_scriptCtrl.devIndex);
+        if (p_dev == NULL || p_dev->isValid == false)
+            break;
+
+        if (p_dev->isConnected)
+            continue;
+
+        s_scriptCtrl.state = APP_SCRIPT_STATE_CONNECTING;
+        APP_DBP_ConnectByIndex(s_scriptCtrl.devIndex);
+        APP_TIMER_SetTimer(APP_TIMER_SCRIPT_STEP, 0, NULL, APP_SCRIPT_CONNECT_TIMEOUT);
+        return;
+    }
+
+    /* No more candidates, run with the links we have */
+    if (s_scriptCtrl.readyLinks > 0)
+    {
+        s_scriptCtrl.state = APP_SCRIPT_STATE_STARTING;
+        APP_TIMER_SetTimer(APP_TIMER_SCRIPT_STEP, 0, NULL, APP_SCRIPT_START_DELAY);
+    }
+    else
+    {
+        app_script_Finish("error", "no peer found");
+    }
+}
+
+static bool app_script_ParseNumber(const char *p_name, const char *p_value, long min, long max, long *p_result)
+{
+    char *p_end;
+    long value;
+
+    value = strtol(p_value, &p_end, 0);
+    if (*p_value == '\0' || *p_end != '\0' || value < min || value > max)
+    {
+        fprintf(stderr, "invalid %s: %s (%ld-%ld)\n", p_name, p_value, min, max);
+        return false;
+    }
+
+    *p_result = value;
+    return true;
+}
+
+static bool app_script_SetOption(const char *p_name, const char *p_value)
+{
+    long value;
+
+    if (!strcmp(p_name, "role"))
+    {
+        if (!strcmp(p_value, "central"))
+            s_scriptCtrl.role = BLE_GAP_ROLE_CENTRAL;
+        else if (!strcmp(p_value, "peripheral"))
+            s_scriptCtrl.role = BLE_GAP_ROLE_PERIPHERAL;
+        else
+        {
+            fprintf(stderr, "invalid role: %s\n", p_value);
+            return false;
+        }
+        s_scriptCtrl.enabled = true;
+    }
+    else if (!strcmp(p_name, "filter"))
+    {
+        g_free(s_scriptCtrl.p_filter);
+        s_scriptCtrl.p_filter = g_strdup(p_value);
+    }
+    else if (!strcmp(p_name, "rssi"))
+    {
+        if (!app_script_ParseNumber(p_name, p_value, -127, 20, &value))
+            return false;
+        s_scriptCtrl.rssi = value;
+    }
+    else if (!strcmp(p_name, "links"))
+    {
+        if (!app_script_ParseNumber(p_name, p_value, 1, BLE_GAP_MAX_LINK_NBR_LIMIT, &value))
+            return false;
+        s_scriptCtrl.links = value;
+    }
+    else if (!strcmp(p_name, "mode"))
+    {
+        if (!app_script_ParseNumber(p_name, p_value, TRP_WMODE_CHECK_SUM, TRP_WMODE_DUPLEX, &value))
+            return false;
+        if (value == TRP_WMODE_UART)
+        {
+            fprintf(stderr, "invalid mode: %s\n", p_value);
+            return false;
+        }
+        s_scriptCtrl.workMode = value;
+    }
+    else if (!strcmp(p_name, "pattern"))
+    {
+        if (!app_script_ParseNumber(p_name, p_value, APP_PATTERN_FILE_TYPE_1K, APP_PATTERN_FILE_TYPE_MAX - 1, &value))
+            return false;
+        s_scriptCtrl.pattern = value;
+    }
+    else if (!strcmp(p_name, "iterations"))
+    {
+        if (!app_script_ParseNumber(p_name, p_value, 1, 65535, &value))
+            return false;
+        s_scriptCtrl.iterations = value;
+    }
+    else if (!strcmp(p_name, "run-timeout"))
+    {
+        if (!app_script_ParseNumber(p_name, p_value, 1, 86400, &value))
+            return false;
+        s_scriptCtrl.runTimeout = value;
+    }
+    else if (!strcmp(p_name, "result-log"))
+    {
+        APP_RESULT_SetLogFile(p_value);
+    }
+    else if (!strcmp(p_name, "baseline"))
+    {
+        g_free(s_scriptCtrl.p_baselinePath);
+        s_scriptCtrl.p_baselinePath = g_strdup(p_value);
+    }
+    else if (!strcmp(p_name, "threshold"))
+    {
+        if (!app_script_ParseNumber(p_name, p_value, 0, 100, &value))
+            return false;
+        s_scriptCtrl.threshold = value;
+    }
+    else if (!strcmp(p_name, "record"))
+    {
+        if (!APP_REPLAY_StartRecord(p_value))
+        {
+            fprintf(stderr, "Failed to create record file %s\n", p_value);
+            return false;
+        }
+    }
+    else if (!strcmp(p_name, "replay"))
+    {
+        g_free(s_scriptCtrl.p_replayPath);
+        s_scriptCtrl.p_replayPath = g_strdup(p_value);
+    }
+    else if (!strcmp(p_name, "replay-speed"))
+    {
+        char *p_end;
+
+        s_scriptCtrl.replaySpeed = strtod(p_value, &p_end);
+        if (*p_value == '\0' || *p_end != '\0' || s_scriptCtrl.replaySpeed < 0)
+        {
+            fprintf(stderr, "invalid %s: %s\n", p_name, p_value);
+            return false;
+        }
+    }
+    else if (!strcmp(p_name, "credit-policy"))
+    {
+        if (!strcmp(p_value, "fixed"))
+            BLE_TRSPS_SetCreditPolicy(BLE_TRSPS_CREDIT_POLICY_FIXED);
+        else if (!strcmp(p_value, "adaptive"))
+            BLE_TRSPS_SetCreditPolicy(BLE_TRSPS_CREDIT_POLICY_ADAPTIVE);
+        else
+        {
+            fprintf(stderr, "invalid %s: %s\n", p_name, p_value);
+            return false;
+        }
+    }
+    else if (!strcmp(p_name, "queue-depth"))
+    {
+        if (!app_script_ParseNumber(p_name, p_value, BLE_TRSPS_MIN_QUEUE_DEPTH, BLE_TRSPS_MAX_QUEUE_DEPTH, &value))
+            return false;
+        BLE_TRSPS_SetQueueDepth(value);
+    }
+    else if (!strcmp(p_name, "auto-tune"))
+    {
+        if (!strcmp(p_value, "on"))
+            s_scriptCtrl.autoTune = true;
+        else if (!strcmp(p_value, "off"))
+            s_scriptCtrl.autoTune = false;
+        else
+        {
+            fprintf(stderr, "invalid %s: %s\n", p_name, p_value);
+            return false;
+        }
+    }
+    else if (!strcmp(p_name, "dp-workers"))
+    {
+        if (!strcmp(p_value, "auto"))
+            value = APP_DP_WORKER_NUM_AUTO;
+        else if (!app_script_ParseNumber(p_name, p_value, 0, APP_DP_MAX_WORKER_NUM, &value))
+            return false;
+        APP_DP_SetWorkerNum(value);
+    }
+    else if (!strcmp(p_name, "max-links"))
+    {
+        if (!app_script_ParseNumber(p_name, p_value, 1, BLE_GAP_MAX_LINK_NBR_LIMIT, &value))
+            return false;
+        APP_BLE_SetMaxLinkNumber(value);
+    }
+    else if (!strcmp(p_name, "mem-budget"))
+    {
+        if (!app_script_ParseNumber(p_name, p_value, 0, APP_SCRIPT_MEM_MAX_KB, &value))
+            return false;
+        APP_MEM_SetBudget(value * 1024);
+    }
+    else if (!strcmp(p_name, "link-quota"))
+    {
+        if (!app_script_ParseNumber(p_name, p_value, 0, APP_SCRIPT_MEM_MAX_KB, &value))
+            return false;
+        APP_MEM_SetLinkQuota(value * 1024);
+    }
+    else if (!strcmp(p_name, "json"))
+    {
+        g_free(s_scriptCtrl.p_jsonPath);
+        s_scriptCtrl.p_jsonPath = g_strdup(p_value);
+    }
+    else
+    {
+        fprintf(stderr, "unknown option: %s\n", p_name);
+        return false;
+    }
+
+    return true;
+}
+
+static bool app_script_LoadFile(const char *p_path)
+{
+    FILE *p_file;
+    char line[APP_SCRIPT_LINE_MAX_LEN];
+    char *p_key, *p_value;
+    bool result = true;
+
+    p_file = fopen(p_path, "r");
+    if (p_file == NULL)
+    {
+        fprintf(stderr, "Failed to open script file %s\n", p_path);
+        return false;
+    }
+
+    while (result && fgets(line, sizeof(line), p_file) != NULL)
+    {
+        p_key = g_strstrip(line);
+        if (*p_key == '\0' || *p_key == '#')
+            continue;
+
+        p_value = strchr(p_key, '=');
+        if (p_value == NULL)
+        {
+            fprintf(stderr, "invalid script line: %s\n", p_key);
+            result = false;
+            break;
+        }
+
+        *p_value++ = '\0';
+        result = app_script_SetOption(g_strstrip(p_key), g_strstrip(p_value));
+    }
+
+    fclose(p_file);
+
+    return result;
+}
+
+const struct bt_shell_opt * APP_SCRIPT_GetShellOpt(void)
+{
+    return &s_scriptShellOpt;
+}
+
+bool APP_SCRIPT_Init(void)
+{
+    uint8_t i;
+    const char *p_names[] = {"role", "filter", "rssi", "links", "mode", "pattern", "iterations", "run-timeout", "json",
+        "result-log", "baseline", "threshold", "record", "replay", "replay-speed", "credit-policy", "queue-depth",
+        "auto-tune", "dp-workers", "max-links", "mem-budget", "link-quota"};
+    const char **pp_values[] = {&sp_optRole, &sp_optFilter, &sp_optRssi, &sp_optLinks, &sp_optMode,
+        &sp_optPattern, &sp_optIterations, &sp_optTimeout, &sp_optJson,
+        &sp_optResultLog, &sp_optBaseline, &sp_optThreshold, &sp_optRecord, &sp_optReplay, &sp_optReplaySpeed,
+        &sp_optCreditPolicy, &sp_optQueueDepth, &sp_optAutoTune, &sp_optDpWorkers, &sp_optMaxLinks,
+        &sp_optMemBudget, &sp_optLinkQuota};
+
+    memset(&s_scriptCtrl, 0, sizeof(s_scriptCtrl));
+    s_scriptCtrl.role = BLE_GAP_ROLE_CENTRAL;
+    s_scriptCtrl.rssi = APP_SCAN_DEFAULT_FILTER_RSSI;
+    s_scriptCtrl.links = APP_SCRIPT_DEFAULT_LINKS;
+    s_scriptCtrl.workMode = TRP_WMODE_FIX_PATTERN;
+    s_scriptCtrl.pattern = APP_PATTERN_FILE_TYPE_50K;
+    s_scriptCtrl.iterations = APP_SCRIPT_DEFAULT_ITERATIONS;
+    s_scriptCtrl.runTimeout = APP_SCRIPT_DEFAULT_RUN_TIMEOUT;
+    s_scriptCtrl.threshold = APP_RESULT_DEFAULT_THRESHOLD;
+    s_scriptCtrl.devIndex = -1;
+
+    /* Script file first, command line options override it */
+    if (sp_optScript != NULL && !app_script_LoadFile(sp_optScript))
+        return false;
+
+    for (i = 0; i < sizeof(p_names) / sizeof(p_names[0]); i++)
+    {
+        if (*pp_values[i] != NULL && !app_script_SetOption(p_names[i], *pp_values[i]))
+            return false;
+    }
+
+    if (s_scriptCtrl.links > BLE_GAP_MAX_LINK_NBR)
+    {
+        fprintf(stderr, "links %d exceeds max-links %d\n", s_scriptCtrl.links, BLE_GAP_MAX_LINK_NBR);
+        return false;
+    }
+
+    if (s_scriptCtrl.p_replayPath != NULL)
+    {
+        if (s_scriptCtrl.enabled)
+        {
+            fprintf(stderr, "replay can not be combined with a headless role\n");
+            return false;
+        }
+        APP_REPLAY_SetReplayFile(s_scriptCtrl.p_replayPath, s_scriptCtrl.replaySpeed);
+    }
+    else if (sp_optScript != NULL && !s_scriptCtrl.enabled)
+    {
+        fprintf(stderr, "headless mode requires a role\n");
+        return false;
+    }
+
+#ifndef ENABLE_AUTO_RUN
+    if (s_scriptCtrl.iterations > 1)
+    {
+        fprintf(stderr, "iterations > 1 requires ENABLE_AUTO_RUN\n");
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+bool APP_SCRIPT_IsEnabled(void)
+{
+    return s_scriptCtrl.enabled;
+}
+
+int APP_SCRIPT_GetExitCode(void)
+{
+    return s_scriptCtrl.exitCode;
+}
+
+void APP_SCRIPT_Start(void)
+{
+    APP_SCAN_Filter_T scanFilter;
+
+    if (!s_scriptCtrl.enabled || s_scriptCtrl.state != APP_SCRIPT_STATE_IDLE)
+        return;
+
+    s_scriptCtrl.startTime = g_get_monotonic_time();
+    APP_TIMER_SetTimer(APP_TIMER_SCRIPT_TIMEOUT, 0, NULL, s_scriptCtrl.runTimeout * 1000);
+
+    if (s_scriptCtrl.role == BLE_GAP_ROLE_PERIPHERAL)
+    {
+        s_scriptCtrl.state = APP_SCRIPT_STATE_ADVERTISING;
+        APP_SM_Handler(APP_SM_EVENT_ADV_ON);
+        return;
+    }
+
+    APP_SetWorkMode(s_scriptCtrl.workMode);
+    APP_PreparePatternData(s_scriptCtrl.pattern);
+#ifdef ENABLE_AUTO_RUN
+    APP_SetExecIterations(s_scriptCtrl.iterations);
+#endif
+
+    memset(&scanFilter, 0, sizeof(APP_SCAN_Filter_T));
+    scanFilter.rssi = s_scriptCtrl.rssi;
+    scanFilter.p_pattern = s_scriptCtrl.p_filter;
+    APP_SCAN_ClearFilter();
+    if (s_scriptCtrl.p_filter != NULL || s_scriptCtrl.rssi != APP_SCAN_DEFAULT_FILTER_RSSI)
+    {
+        APP_SCAN_SetFilter(&scanFilter);
+    }
+
+    s_scriptCtrl.state = APP_SCRIPT_STATE_SCANNING;
+    APP_DBP_RemoveDeviceList(false);
+    APP_SCAN_Start();
+}
+
+void APP_SCRIPT_ScanCompleted(void)
+{
+    if (!s_scriptCtrl.enabled || s_scriptCtrl.state != APP_SCRIPT_STATE_SCANNING)
+        return;
+
+    app_script_ConnectNext();
+}
+
+void APP_SCRIPT_LinkConnected(DeviceProxy *p_devProxy)
+{
+    APP_SCRIPT_Link_T *p_link;
+
+    if (!s_scriptCtrl.enabled || s_scriptCtrl.state == APP_SCRIPT_STATE_DONE)
+        return;
+
+    p_link = app_script_GetLink(p_devProxy, true);
+    if (p_link == NULL)
+        return;
+
+    p_link->connected = true;
+    p_link->connectTime = g_get_monotonic_time();
+}
+
+void APP_SCRIPT_LinkDisconnected(DeviceProxy *p_devProxy)
+{
+    uint8_t i;
+    APP_SCRIPT_Link_T *p_link;
+
+    if (!s_scriptCtrl.enabled || s_scriptCtrl.state == APP_SCRIPT_STATE_DONE)
+        return;
+
+    p_link = app_script_GetLink(p_devProxy, false);
+    if (p_link == NULL)
+        return;
+
+    /* The last run of the client is over with the link, it failed if it was in progress */
+    if (s_scriptCtrl.role == BLE_GAP_ROLE_PERIPHERAL)
+        APP_TRPS_ReportRunResult(APP_TRP_COMMON_GetConnListByDevProxy(p_devProxy));
+
+    p_link->connected = false;
+    p_link->connDuration = g_get_monotonic_time() - p_link->connectTime;
+    /* Keep the record but release the proxy, it is freed by BlueZ client */
+    p_link->p_devProxy = NULL;
+
+    if (s_scriptCtrl.role == BLE_GAP_ROLE_PERIPHERAL)
+    {
+        for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
+        {
+            if (s_scriptCtrl.linkList[i].connected)
+                return;
+        }
+        for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
+        {
+            if (s_scriptCtrl.linkList[i].failed > 0)
+            {
+                app_script_Finish("failed", "verification failed");
+                return;
+            }
+        }
+        app_script_Finish("passed", NULL);
+        return;
+    }
+
+    p_link->disconnections++;
+    if (p_link->ready)
+    {
+        p_link->ready = false;
+        s_scriptCtrl.readyLinks--;
+    }
+
+    if (s_scriptCtrl.state == APP_SCRIPT_STATE_RUNNING || s_scriptCtrl.state == APP_SCRIPT_STATE_STARTING
+        || s_scriptCtrl.state == APP_SCRIPT_STATE_TUNING)
+    {
+        app_script_Finish("failed", "link disconnected during the run");
+    }
+    else if (s_scriptCtrl.state == APP_SCRIPT_STATE_CONNECTING)
+    {
+        APP_TIMER_StopTimer(APP_TIMER_SCRIPT_STEP, 0);
+        app_script_ConnectNext();
+    }
+}
+
+void APP_SCRIPT_LinkReady(DeviceProxy *p_devProxy)
+{
+    APP_SCRIPT_Link_T *p_link;
+
+    if (!s_scriptCtrl.enabled || s_scriptCtrl.state != APP_SCRIPT_STATE_CONNECTING)
+        return;
+
+    p_link = app_script_GetLink(p_devProxy, true);
+    if (p_link == NULL || p_link->ready)
+        return;
+
+    p_link->ready = true;
+    s_scriptCtrl.readyLinks++;
+    APP_TIMER_StopTimer(APP_TIMER_SCRIPT_STEP, 0);
+
+    if (s_scriptCtrl.readyLinks < s_scriptCtrl.links)
+    {
+        app_script_ConnectNext();
+    }
+    else
+    {
+        s_scriptCtrl.state = APP_SCRIPT_STATE_STARTING;
+        APP_TIMER_SetTimer(APP_TIMER_SCRIPT_STEP, 0, NULL, APP_SCRIPT_START_DELAY);
+    }
+}
+
+void APP_SCRIPT_LinkResult(DeviceProxy *p_devProxy, uint8_t testStage, double elapsed, uint32_t bytes)
+{
+    APP_SCRIPT_Link_T *p_link;
+
+    /* In peripheral role the runs are driven by the clients while advertising */
+    if (!s_scriptCtrl.enabled || (s_scriptCtrl.state != APP_SCRIPT_STATE_RUNNING
+        && (s_scriptCtrl.role != BLE_GAP_ROLE_PERIPHERAL || s_scriptCtrl.state != APP_SCRIPT_STATE_ADVERTISING)))
+        return;
+
+    p_link = app_script_GetLink(p_devProxy, false);
+    if (p_link == NULL)
+        return;
+
+    p_link->runs++;
+    if (testStage == APP_TEST_PASSED)
+    {
+        p_link->passed++;
+        p_link->bytes += bytes;
+        p_link->elapsed += elapsed;
+        if (p_link->minElapsed == 0 || elapsed < p_link->minElapsed)
+            p_link->minElapsed = elapsed;
+        if (elapsed > p_link->maxElapsed)
+            p_link->maxElapsed = elapsed;
+    }
+    else
+    {
+        p_link->failed++;
+    }
+}
+
+void APP_SCRIPT_RunFinished(uint8_t countPass)
+{
+    if (!s_scriptCtrl.enabled || s_scriptCtrl.state != APP_SCRIPT_STATE_RUNNING)
+        return;
+
+    s_scriptCtrl.completedRuns++;
+
+    /* Next run is only scheduled by APP_GoNextRun if all links passed */
+    if (countPass != s_scriptCtrl.readyLinks)
+    {
+        app_script_Finish("failed", "verification failed");
+    }
+    else if (s_scriptCtrl.completedRuns >= s_scriptCtrl.iterations)
+    {
+        app_script_Finish("passed", NULL);
+    }
+}
+
+void APP_SCRIPT_Step(void)
+{
+    switch (s_scriptCtrl.state)
+    {
+        case APP_SCRIPT_STATE_CONNECTING:
+        {
+            bt_shell_printf("headless: connect timeout on device#%d\n", s_scriptCtrl.devIndex);
+            APP_DBP_DisconnectByIndex(s_scriptCtrl.devIndex);
+            app_script_ConnectNext();
+        }
+        break;
+
+        case APP_SCRIPT_STATE_STARTING:
+        {
+            if (s_scriptCtrl.autoTune && (APP_TUNE_StartAll() == APP_RES_SUCCESS))
+            {
+                s_scriptCtrl.state = APP_SCRIPT_STATE_TUNING;
+                break;
+            }
+            s_scriptCtrl.state = APP_SCRIPT_STATE_RUNNING;
+            APP_BurstModeStartAll();
+        }
+        break;
+
+        default:
+        break;
+    }
+}
+
+void APP_SCRIPT_TuneFinished(void)
+{
+    if (!s_scriptCtrl.enabled || s_scriptCtrl.state != APP_SCRIPT_STATE_TUNING)
+        return;
+
+    s_scriptCtrl.state = APP_SCRIPT_STATE_RUNNING;
+    APP_BurstModeStartAll();
+}
+
+void APP_SCRIPT_Timeout(void)
+{
+    app_script_Finish("timeout", "run timeout");
+}
+
+
+/*******************************************************************************
+ End of File
+ */
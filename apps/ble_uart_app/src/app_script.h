@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Headless Script Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_script.h
+
+  Summary:
+    This file contains the Application headless script functions for this project.
+
+  Description:
+    This file contains the Application headless script functions for this project.
+    The headless mode runs the burst mode test without readline, driven by
+    command line options or a script file, and exits with a JSON summary.
+ *******************************************************************************/
+
+#ifndef APP_SCRIPT_H
+#define APP_SCRIPT_H
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "shared/shell.h"
+#include "app_dbp.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_SCRIPT_DEFAULT_LINKS                1           /**< Default number of peers to connect in central role. */
+#define APP_SCRIPT_DEFAULT_ITERATIONS           1           /**< Default number of burst mode runs. */
+#define APP_SCRIPT_DEFAULT_RUN_TIMEOUT          600         /**< Default timeout of the whole run in seconds. */
+#define APP_SCRIPT_CONNECT_TIMEOUT              20000       /**< Timeout of one connection until TRP is established in ms. */
+#define APP_SCRIPT_START_DELAY                  1000        /**< Delay between TRP established and burst mode start in ms. */
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Get the command line options of headless mode. Pass it to bt_shell_init. */
+const struct bt_shell_opt * APP_SCRIPT_GetShellOpt(void);
+
+/**@brief Parse the script file and command line options. Must be called after bt_shell_init.
+ * @retval true                     Options are valid.
+ * @retval false                    Options are invalid, the error is printed.
+ */
+bool APP_SCRIPT_Init(void);
+
+/**@brief Check whether the application is running in headless mode. */
+bool APP_SCRIPT_IsEnabled(void);
+
+/**@brief Start the headless run. Called once the DBus client is ready. */
+void APP_SCRIPT_Start(void);
+
+/**@brief Get the process exit code of the headless run. 0 if all runs passed. */
+int APP_SCRIPT_GetExitCode(void);
+
+/**@brief Notify discovery is stopped. */
+void APP_SCRIPT_ScanCompleted(void);
+
+/**@brief Notify a device is connected. */
+void APP_SCRIPT_LinkConnected(DeviceProxy *p_devProxy);
+
+/**@brief Notify a device is disconnected. */
+void APP_SCRIPT_LinkDisconnected(DeviceProxy *p_devProxy);
+
+/**@brief Notify TRP is established on a link and it is ready for burst mode. */
+void APP_SCRIPT_LinkReady(DeviceProxy *p_devProxy);
+
+/**@brief Report the result of one link in the finished run.
+ * @param[in] p_devProxy            Device proxy of the link.
+ * @param[in] testStage             Test result. See @ref APP_TRP_TestStage_T.
+ * @param[in] elapsed               Elapsed time of the run in seconds.
+ * @param[in] bytes                 Transferred payload bytes in the run.
+ */
+void APP_SCRIPT_LinkResult(DeviceProxy *p_devProxy, uint8_t testStage, double elapsed, uint32_t bytes);
+
+/**@brief Notify a burst mode run of all links is finished.
+ * @param[in] countPass             Number of passed links.
+ */
+void APP_SCRIPT_RunFinished(uint8_t countPass);
+
+/**@brief Handle the APP_TIMER_SCRIPT_STEP timer. */
+void APP_SCRIPT_Step(void);
+
+/**@brief Notify the auto-tune of all links is finished, the burst mode runs start. */
+void APP_SCRIPT_TuneFinished(void);
+
+/**@brief Handle the APP_TIMER_SCRIPT_TIMEOUT timer. */
+void APP_SCRIPT_Timeout(void);
+
+
+#endif
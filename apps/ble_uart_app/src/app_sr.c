@@ -0,0 +1,456 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Selective Repeat Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_sr.c
+
+  Summary:
+    This file contains the Application selective repeat functions for this project.
+
+  Description:
+    This file contains the Application selective repeat functions for this project.
+    A frame reported missing by an acknowledgement is sent again once. If it is lost
+    again, the retransmission timeout of the caller sends all the frames not
+    acknowledged.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdlib.h>
+#include <string.h>
+
+#include "app_sr.h"
+#include "app_error_defs.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_SR_SEQ_HALF                 0x80        /**< Half of the sequence space, a sequence number behind is an old one. */
+#define APP_SR_TEST_MAX_PAYLOAD         0xF4
+#define APP_SR_TEST_MAX_LOSS            90
+#define APP_SR_TEST_RTO_ROUNDS          0x04        /**< Rounds without progress before the retransmission timeout. */
+#define APP_SR_TEST_MAX_ROUNDS_PER_FRAME    0x100
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static APP_SR_TxSlot_T * app_sr_TxSlot(APP_SR_Tx_T *p_tx, uint8_t seq)
+{
+    return &p_tx->slot[seq % APP_SR_WINDOW_SIZE];
+}
+
+static APP_SR_RxSlot_T * app_sr_RxSlot(APP_SR_Rx_T *p_rx, uint8_t seq)
+{
+    return &p_rx->slot[seq % APP_SR_WINDOW_SIZE];
+}
+
+void APP_SR_TxInit(APP_SR_Tx_T *p_tx)
+{
+    memset(p_tx, 0, sizeof(APP_SR_Tx_T));
+    p_tx->window = APP_SR_WINDOW_SIZE;
+}
+
+uint8_t APP_SR_TxInFlight(APP_SR_Tx_T *p_tx)
+{
+    return (uint8_t)(p_tx->sndNext - p_tx->sndUna);
+}
+
+uint16_t APP_SR_TxFrame(APP_SR_Tx_T *p_tx, const uint8_t *p_data, uint16_t leng, uint8_t **pp_frame, uint16_t *p_frameLeng)
+{
+    APP_SR_TxSlot_T *p_slot;
+
+    if ((p_data == NULL) || (leng == 0) || (leng > APP_SR_MAX_FRAME_SIZE - APP_SR_HDR_SIZE))
+        return APP_RES_INVALID_PARA;
+
+    if (APP_SR_TxInFlight(p_tx) >= p_tx->window)
+        return APP_RES_NO_RESOURCE;
+
+    p_slot = app_sr_TxSlot(p_tx, p_tx->sndNext);
+    p_slot->frame[0] = p_tx->sndNext;
+    memcpy(&p_slot->frame[APP_SR_HDR_SIZE], p_data, leng);
+    p_slot->leng = leng + APP_SR_HDR_SIZE;
+    p_slot->acked = false;
+    p_slot->resend = false;
+    p_slot->nacked = false;
+
+    *pp_frame = p_slot->frame;
+    *p_frameLeng = p_slot->leng;
+
+    return APP_RES_SUCCESS;
+}
+
+void APP_SR_TxCommit(APP_SR_Tx_T *p_tx)
+{
+    p_tx->sndNext++;
+    p_tx->txFrames++;
+}
+
+uint16_t APP_SR_TxGetResend(APP_SR_Tx_T *p_tx, uint8_t **pp_frame, uint16_t *p_frameLeng)
+{
+    APP_SR_TxSlot_T *p_slot;
+    uint8_t seq;
+
+    for (seq = p_tx->sndUna; seq != p_tx->sndNext; seq++)
+    {
+        p_slot = app_sr_TxSlot(p_tx, seq);
+        if (p_slot->resend)
+        {
+            *pp_frame = p_slot->frame;
+            *p_frameLeng = p_slot->leng;
+            return APP_RES_SUCCESS;
+        }
+    }
+
+    return APP_RES_FAIL;
+}
+
+void APP_SR_TxResent(APP_SR_Tx_T *p_tx, uint8_t seq)
+{
+    if ((uint8_t)(seq - p_tx->sndUna) >= APP_SR_TxInFlight(p_tx))
+        return;
+
+    app_sr_TxSlot(p_tx, seq)->resend = false;
+    p_tx->reFrames++;
+}
+
+uint16_t APP_SR_TxAck(APP_SR_Tx_T *p_tx, const uint8_t *p_ack, uint16_t leng)
+{
+    APP_SR_TxSlot_T *p_slot;
+    uint32_t bitmap;
+    uint8_t ackSeq, seq, i, gapEnd = 0;
+
+    if ((p_ack == NULL) || (leng < APP_SR_ACK_SIZE))
+        return APP_RES_INVALID_PARA;
+
+    ackSeq = p_ack[0];
+    if ((uint8_t)(ackSeq - p_tx->sndUna) > APP_SR_TxInFlight(p_tx))
+        return APP_RES_INVALID_PARA;
+
+    p_tx->acks++;
+
+    // Release the frames received in order
+    while (p_tx->sndUna != ackSeq)
+    {
+        p_slot = app_sr_TxSlot(p_tx, p_tx->sndUna);
+        p_slot->leng = 0;
+        p_slot->resend = false;
+        p_tx->sndUna++;
+    }
+
+    p_tx->window = (p_ack[1] < APP_SR_WINDOW_SIZE) ? p_ack[1] : APP_SR_WINDOW_SIZE;
+
+    // Bit i is the frame ackSeq + 1 + i
+    bitmap = p_ack[2] | (p_ack[3] << 8) | (p_ack[4] << 16) | ((uint32_t)p_ack[5] << 24);
+    for (i = 0; i < APP_SR_BITMAP_SIZE * 8; i++)
+    {
+        seq = ackSeq + 1 + i;
+        if ((uint8_t)(seq - p_tx->sndUna) >= APP_SR_TxInFlight(p_tx))
+            break;
+        if (bitmap & (1UL << i))
+        {
+            p_slot = app_sr_TxSlot(p_tx, seq);
+            p_slot->acked = true;
+            p_slot->resend = false;
+            gapEnd = i + 1;
+        }
+    }
+
+    // The frames missing before the last received one are lost, a gap is only reported once
+    for (i = 0; i < gapEnd; i++)
+    {
+        p_slot = app_sr_TxSlot(p_tx, (uint8_t)(ackSeq + i));
+        if ((!p_slot->acked) && (!p_slot->nacked))
+        {
+            p_slot->resend = true;
+            p_slot->nacked = true;
+        }
+    }
+
+    return APP_RES_SUCCESS;
+}
+
+void APP_SR_TxTimeout(APP_SR_Tx_T *p_tx)
+{
+    APP_SR_TxSlot_T *p_slot;
+    uint8_t seq;
+
+    for (seq = p_tx->sndUna; seq != p_tx->sndNext; seq++)
+    {
+        p_slot = app_sr_TxSlot(p_tx, seq);
+        if (!p_slot->acked)
+        {
+            p_slot->resend = true;
+            p_slot->nacked = true;
+        }
+    }
+
+    p_tx->timeouts++;
+}
+
+void APP_SR_RxInit(APP_SR_Rx_T *p_rx)
+{
+    memset(p_rx, 0, sizeof(APP_SR_Rx_T));
+    p_rx->window = APP_SR_WINDOW_SIZE;
+}
+
+uint16_t APP_SR_RxFrame(APP_SR_Rx_T *p_rx, const uint8_t *p_frame, uint16_t leng)
+{
+    APP_SR_RxSlot_T *p_slot;
+    uint8_t seq;
+
+    if ((p_frame == NULL) || (leng <= APP_SR_HDR_SIZE) || (leng > APP_SR_MAX_FRAME_SIZE))
+        return APP_RES_INVALID_PARA;
+
+    seq = p_frame[0];
+    p_rx->rxFrames++;
+
+    // The sender did not get the acknowledgement, send it again
+    p_rx->ackPending = true;
+
+    if ((uint8_t)(seq - p_rx->rcvNext) >= APP_SR_SEQ_HALF)
+    {
+        p_rx->dupFrames++;
+        return APP_RES_SUCCESS;
+    }
+
+    if ((uint8_t)(seq - p_rx->readSeq) >= APP_SR_WINDOW_SIZE)
+    {
+        p_rx->dropFrames++;
+        return APP_RES_SUCCESS;
+    }
+
+    p_slot = app_sr_RxSlot(p_rx, seq);
+    if (p_slot->valid)
+    {
+        p_rx->dupFrames++;
+        return APP_RES_SUCCESS;
+    }
+
+    memcpy(p_slot->data, &p_frame[APP_SR_HDR_SIZE], leng - APP_SR_HDR_SIZE);
+    p_slot->leng = leng - APP_SR_HDR_SIZE;
+    p_slot->valid = true;
+    p_rx->newFrames++;
+
+    while (((uint8_t)(p_rx->rcvNext - p_rx->readSeq) < APP_SR_WINDOW_SIZE) && (app_sr_RxSlot(p_rx, p_rx->rcvNext)->valid))
+    {
+        p_rx->rcvNext++;
+    }
+
+    return APP_RES_SUCCESS;
+}
+
+uint16_t APP_SR_RxGetLength(APP_SR_Rx_T *p_rx)
+{
+    if (p_rx->readSeq == p_rx->rcvNext)
+        return 0;
+
+    return app_sr_RxSlot(p_rx, p_rx->readSeq)->leng;
+}
+
+uint16_t APP_SR_RxGet(APP_SR_Rx_T *p_rx, uint8_t *p_data)
+{
+    APP_SR_RxSlot_T *p_slot;
+
+    if ((p_data == NULL) || (p_rx->readSeq == p_rx->rcvNext))
+        return APP_RES_FAIL;
+
+    p_slot = app_sr_RxSlot(p_rx, p_rx->readSeq);
+    memcpy(p_data, p_slot->data, p_slot->leng);
+    p_slot->valid = false;
+    p_slot->leng = 0;
+    p_rx->readSeq++;
+
+    // Reopen a window the sender sees almost closed
+    if (p_rx->window < APP_SR_WINDOW_SIZE / 2)
+        p_rx->ackPending = true;
+
+    return APP_RES_SUCCESS;
+}
+
+bool APP_SR_RxAckDue(APP_SR_Rx_T *p_rx)
+{
+    return (p_rx->newFrames >= APP_SR_WINDOW_SIZE / 2);
+}
+
+void APP_SR_RxBuildAck(APP_SR_Rx_T *p_rx, uint8_t *p_ack)
+{
+    uint32_t bitmap = 0;
+    uint8_t seq, i;
+
+    for (i = 0; i < APP_SR_BITMAP_SIZE * 8; i++)
+    {
+        seq = p_rx->rcvNext + 1 + i;
+        if ((uint8_t)(seq - p_rx->readSeq) >= APP_SR_WINDOW_SIZE)
+            break;
+        if (app_sr_RxSlot(p_rx, seq)->valid)
+            bitmap |= (1UL << i);
+    }
+
+    p_rx->window = APP_SR_WINDOW_SIZE - (uint8_t)(p_rx->rcvNext - p_rx->readSeq);
+
+    p_ack[0] = p_rx->rcvNext;
+    p_ack[1] = p_rx->window;
+    p_ack[2] = (uint8_t)bitmap;
+    p_ack[3] = (uint8_t)(bitmap >> 8);
+    p_ack[4] = (uint8_t)(bitmap >> 16);
+    p_ack[5] = (uint8_t)(bitmap >> 24);
+
+    p_rx->newFrames = 0;
+    p_rx->ackPending = false;
+    p_rx->acks++;
+}
+
+static bool app_sr_TestDrop(uint32_t *p_state, uint8_t lossPercent)
+{
+    //xorshift32
+    *p_state ^= *p_state << 13;
+    *p_state ^= *p_state >> 17;
+    *p_state ^= *p_state << 5;
+
+    return ((*p_state % 100) < lossPercent);
+}
+
+static uint16_t app_sr_TestPayload(uint32_t index, uint8_t *p_payload)
+{
+    uint16_t leng, i;
+
+    leng = 1 + (uint16_t)((index * 37) % APP_SR_TEST_MAX_PAYLOAD);
+    for (i = 0; i < leng; i++)
+        p_payload[i] = (uint8_t)(index + i);
+
+    return leng;
+}
+
+static void app_sr_TestSend(APP_SR_Rx_T *p_rx, uint8_t *p_frame, uint16_t leng, uint8_t lossPercent,
+    uint32_t *p_state, APP_SR_TestResult_T *p_result)
+{
+    p_result->sent++;
+    if (app_sr_TestDrop(p_state, lossPercent))
+    {
+        p_result->lost++;
+        return;
+    }
+
+    APP_SR_RxFrame(p_rx, p_frame, leng);
+}
+
+uint16_t APP_SR_SelfTest(uint32_t frames, uint8_t lossPercent, uint32_t seed, APP_SR_TestResult_T *p_result)
+{
+    APP_SR_Tx_T *p_tx;
+    APP_SR_Rx_T *p_rx;
+    uint8_t payload[APP_SR_TEST_MAX_PAYLOAD], rxData[APP_SR_TEST_MAX_PAYLOAD], ack[APP_SR_ACK_SIZE];
+    uint8_t *p_frame, sndUna, idleRounds = 0;
+    uint16_t frameLeng, leng, status = APP_RES_SUCCESS;
+    uint32_t nextTx = 0, maxRounds, state;
+
+    if ((p_result == NULL) || (lossPercent > APP_SR_TEST_MAX_LOSS))
+        return APP_RES_INVALID_PARA;
+
+    memset(p_result, 0, sizeof(APP_SR_TestResult_T));
+
+    p_tx = malloc(sizeof(APP_SR_Tx_T));
+    p_rx = malloc(sizeof(APP_SR_Rx_T));
+    if ((p_tx == NULL) || (p_rx == NULL))
+    {
+        free(p_tx);
+        free(p_rx);
+        return APP_RES_OOM;
+    }
+
+    APP_SR_TxInit(p_tx);
+    APP_SR_RxInit(p_rx);
+    state = (seed != 0) ? seed : 1;
+    maxRounds = (frames + APP_SR_WINDOW_SIZE) * APP_SR_TEST_MAX_ROUNDS_PER_FRAME;
+
+    while ((p_result->delivered < frames) && (p_result->rounds < maxRounds))
+    {
+        p_result->rounds++;
+        sndUna = p_tx->sndUna;
+
+        // Retransmissions first, then the new frames the window allows
+        while (APP_SR_TxGetResend(p_tx, &p_frame, &frameLeng) == APP_RES_SUCCESS)
+        {
+            APP_SR_TxResent(p_tx, p_frame[0]);
+            app_sr_TestSend(p_rx, p_frame, frameLeng, lossPercent, &state, p_result);
+        }
+
+        while (nextTx < frames)
+        {
+            leng = app_sr_TestPayload(nextTx, payload);
+            if (APP_SR_TxFrame(p_tx, payload, leng, &p_frame, &frameLeng) != APP_RES_SUCCESS)
+                break;
+            APP_SR_TxCommit(p_tx);
+            nextTx++;
+            app_sr_TestSend(p_rx, p_frame, frameLeng, lossPercent, &state, p_result);
+        }
+
+        // The receiver delivers in order, check each payload
+        while ((frameLeng = APP_SR_RxGetLength(p_rx)) > 0)
+        {
+            APP_SR_RxGet(p_rx, rxData);
+            leng = app_sr_TestPayload(p_result->delivered, payload);
+            if ((frameLeng != leng) || (memcmp(rxData, payload, leng) != 0))
+            {
+                status = APP_RES_FAIL;
+                break;
+            }
+            p_result->delivered++;
+        }
+
+        if (status != APP_RES_SUCCESS)
+            break;
+
+        if (p_rx->ackPending)
+        {
+            APP_SR_RxBuildAck(p_rx, ack);
+            p_result->acks++;
+            if (app_sr_TestDrop(&state, lossPercent))
+                p_result->acksLost++;
+            else
+                APP_SR_TxAck(p_tx, ack, sizeof(ack));
+        }
+
+        if ((p_tx->sndUna != sndUna) || (APP_SR_TxInFlight(p_tx) == 0))
+        {
+            idleRounds = 0;
+        }
+        else if (++idleRounds >= APP_SR_TEST_RTO_ROUNDS)
+        {
+            APP_SR_TxTimeout(p_tx);
+            idleRounds = 0;
+        }
+    }
+
+    p_result->timeouts = p_tx->timeouts;
+    if (p_result->delivered != frames)
+        status = APP_RES_FAIL;
+
+    free(p_tx);
+    free(p_rx);
+
+    return status;
+}
+
+
+/*******************************************************************************
+ End of File
+ */
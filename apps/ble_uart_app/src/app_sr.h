@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Selective Repeat Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_sr.h
+
+  Summary:
+    This file contains the Application selective repeat functions for this project.
+
+  Description:
+    This file contains the Application selective repeat functions for this project.
+    Every frame starts with an 8-bit sequence number. The sender retains the frames
+    until they are acknowledged, the receiver reorders them and acknowledges them with
+    the next expected sequence number, its free window and a bitmap of the frames
+    received after the gap. The functions do not depend on the transport.
+ *******************************************************************************/
+
+#ifndef APP_SR_H
+#define APP_SR_H
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_SR_HDR_SIZE                 0x01        /**< Size of the sequence number header. */
+#define APP_SR_WINDOW_SIZE              0x20        /**< Maximum number of frames not acknowledged. */
+#define APP_SR_MAX_FRAME_SIZE           0x0200      /**< Maximum size of a frame, header included. */
+#define APP_SR_BITMAP_SIZE              0x04        /**< Size of the bitmap of the frames received after the gap. */
+#define APP_SR_ACK_SIZE                 (0x02 + APP_SR_BITMAP_SIZE)     /**< Size of an acknowledgement. */
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief The structure contains a frame retained by the sender. */
+typedef struct APP_SR_TxSlot_T
+{
+    uint16_t        leng;                               /**< Frame length, header included. */
+    bool            acked;                              /**< Received after a gap, it is not sent again. */
+    bool            resend;                             /**< Waiting for retransmission. */
+    bool            nacked;                             /**< A gap already asked for it. */
+    uint8_t         frame[APP_SR_MAX_FRAME_SIZE];       /**< Frame. */
+} APP_SR_TxSlot_T;
+
+/**@brief The structure contains the sender. */
+typedef struct APP_SR_Tx_T
+{
+    bool            active;                             /**< The peer accepted the framing. */
+    bool            answered;                           /**< The peer answered the offer. */
+    uint8_t         window;                             /**< Window of the peer. */
+    uint8_t         sndUna;                             /**< Oldest frame not acknowledged. */
+    uint8_t         sndNext;                            /**< Sequence number of the next new frame. */
+    uint32_t        txFrames;                           /**< Number of new frames sent. */
+    uint32_t        reFrames;                           /**< Number of frames sent again. */
+    uint32_t        acks;                               /**< Number of acknowledgements received. */
+    uint32_t        timeouts;                           /**< Number of retransmission timeouts. */
+    APP_SR_TxSlot_T slot[APP_SR_WINDOW_SIZE];           /**< Retained frames, indexed by sequence number. */
+} APP_SR_Tx_T;
+
+/**@brief The structure contains a frame held by the receiver. */
+typedef struct APP_SR_RxSlot_T
+{
+    uint16_t        leng;                               /**< Payload length. */
+    bool            valid;                              /**< The frame is received. */
+    uint8_t         data[APP_SR_MAX_FRAME_SIZE - APP_SR_HDR_SIZE];  /**< Payload. */
+} APP_SR_RxSlot_T;
+
+/**@brief The structure contains the receiver. */
+typedef struct APP_SR_Rx_T
+{
+    bool            ackPending;                         /**< The state changed since the last acknowledgement. */
+    bool            ackScheduled;                       /**< An acknowledgement timer is running. */
+    uint8_t         newFrames;                          /**< Number of frames received since the last acknowledgement. */
+    uint8_t         window;                             /**< Window in the last acknowledgement. */
+    uint8_t         readSeq;                            /**< Next frame to deliver. */
+    uint8_t         rcvNext;                            /**< Next frame expected in order. */
+    uint32_t        rxFrames;                           /**< Number of frames received. */
+    uint32_t        dupFrames;                          /**< Number of duplicated frames. */
+    uint32_t        dropFrames;                         /**< Number of frames beyond the window. */
+    uint32_t        acks;                               /**< Number of acknowledgements built. */
+    APP_SR_RxSlot_T slot[APP_SR_WINDOW_SIZE];           /**< Held frames, indexed by sequence number. */
+} APP_SR_Rx_T;
+
+/**@brief The structure contains the result of the self test. */
+typedef struct APP_SR_TestResult_T
+{
+    uint32_t        delivered;                          /**< Number of frames delivered in order and intact. */
+    uint32_t        sent;                               /**< Number of frames sent, retransmissions included. */
+    uint32_t        lost;                               /**< Number of frames dropped by the transport. */
+    uint32_t        acks;                               /**< Number of acknowledgements sent. */
+    uint32_t        acksLost;                           /**< Number of acknowledgements dropped by the transport. */
+    uint32_t        timeouts;                           /**< Number of retransmission timeouts. */
+    uint32_t        rounds;                             /**< Number of transport rounds. */
+} APP_SR_TestResult_T;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Initialize a sender.
+ * @param[in] p_tx                  Sender.
+ */
+void APP_SR_TxInit(APP_SR_Tx_T *p_tx);
+
+/**@brief Build the next new frame. The frame is retained only once @ref APP_SR_TxCommit is called.
+ * @param[in] p_tx                  Sender.
+ * @param[in] p_data                Payload.
+ * @param[in] leng                  Payload length.
+ * @param[out] pp_frame             Frame to send.
+ * @param[out] p_frameLeng          Frame length.
+ * @retval APP_RES_SUCCESS          The frame is built.
+ * @retval APP_RES_NO_RESOURCE      The window is full.
+ * @retval APP_RES_INVALID_PARA     The payload does not fit in a frame.
+ */
+uint16_t APP_SR_TxFrame(APP_SR_Tx_T *p_tx, const uint8_t *p_data, uint16_t leng, uint8_t **pp_frame, uint16_t *p_frameLeng);
+
+/**@brief Retain the frame built by @ref APP_SR_TxFrame once it is sent.
+ * @param[in] p_tx                  Sender.
+ */
+void APP_SR_TxCommit(APP_SR_Tx_T *p_tx);
+
+/**@brief Get the oldest frame waiting for retransmission.
+ * @param[in] p_tx                  Sender.
+ * @param[out] pp_frame             Frame to send.
+ * @param[out] p_frameLeng          Frame length.
+ * @retval APP_RES_SUCCESS          A frame is waiting.
+ * @retval APP_RES_FAIL             No frame is waiting.
+ */
+uint16_t APP_SR_TxGetResend(APP_SR_Tx_T *p_tx, uint8_t **pp_frame, uint16_t *p_frameLeng);
+
+/**@brief Clear the retransmission of a frame once it is sent again.
+ * @param[in] p_tx                  Sender.
+ * @param[in] seq                   Sequence number of the frame.
+ */
+void APP_SR_TxResent(APP_SR_Tx_T *p_tx, uint8_t seq);
+
+/**@brief Process an acknowledgement. The frames missing before the last received one are sent again.
+ * @param[in] p_tx                  Sender.
+ * @param[in] p_ack                 Acknowledgement.
+ * @param[in] leng                  Acknowledgement length.
+ * @retval APP_RES_SUCCESS          Processed.
+ * @retval APP_RES_INVALID_PARA     The acknowledgement is malformed or out of the window.
+ */
+uint16_t APP_SR_TxAck(APP_SR_Tx_T *p_tx, const uint8_t *p_ack, uint16_t leng);
+
+/**@brief Send again all the frames not acknowledged after the retransmission timeout.
+ * @param[in] p_tx                  Sender.
+ */
+void APP_SR_TxTimeout(APP_SR_Tx_T *p_tx);
+
+/**@brief Get the number of frames not acknowledged.
+ * @param[in] p_tx                  Sender.
+ * @retval Number of frames.
+ */
+uint8_t APP_SR_TxInFlight(APP_SR_Tx_T *p_tx);
+
+/**@brief Initialize a receiver.
+ * @param[in] p_rx                  Receiver.
+ */
+void APP_SR_RxInit(APP_SR_Rx_T *p_rx);
+
+/**@brief Process a received frame.
+ * @param[in] p_rx                  Receiver.
+ * @param[in] p_frame               Frame.
+ * @param[in] leng                  Frame length.
+ * @retval APP_RES_SUCCESS          Processed, a duplicated frame or one beyond the window is dropped.
+ * @retval APP_RES_INVALID_PARA     The frame is malformed.
+ */
+uint16_t APP_SR_RxFrame(APP_SR_Rx_T *p_rx, const uint8_t *p_frame, uint16_t leng);
+
+/**@brief Get the payload length of the next frame in order.
+ * @param[in] p_rx                  Receiver.
+ * @retval Payload length. 0 if the next frame is not received yet.
+ */
+uint16_t APP_SR_RxGetLength(APP_SR_Rx_T *p_rx);
+
+/**@brief Get the payload of the next frame in order.
+ * @param[in] p_rx                  Receiver.
+ * @param[out] p_data               Buffer of the payload, see @ref APP_SR_RxGetLength.
+ * @retval APP_RES_SUCCESS          The payload is copied.
+ * @retval APP_RES_FAIL             The next frame is not received yet.
+ */
+uint16_t APP_SR_RxGet(APP_SR_Rx_T *p_rx, uint8_t *p_data);
+
+/**@brief Check whether enough frames are received to acknowledge them at once.
+ * @param[in] p_rx                  Receiver.
+ * @retval true                     Half of the window is received since the last acknowledgement.
+ */
+bool APP_SR_RxAckDue(APP_SR_Rx_T *p_rx);
+
+/**@brief Build an acknowledgement.
+ * @param[in] p_rx                  Receiver.
+ * @param[out] p_ack                Buffer of @ref APP_SR_ACK_SIZE bytes.
+ */
+void APP_SR_RxBuildAck(APP_SR_Rx_T *p_rx, uint8_t *p_ack);
+
+/**@brief Run a sender and a receiver over an in-memory transport dropping frames and acknowledgements.
+ * @param[in] frames                Number of frames to deliver.
+ * @param[in] lossPercent           Drop rate of the transport, 0 to 90.
+ * @param[in] seed                  Seed of the drop pattern.
+ * @param[out] p_result             Result.
+ * @retval APP_RES_SUCCESS          All the frames are delivered in order and intact.
+ * @retval APP_RES_FAIL             The delivery failed.
+ * @retval APP_RES_OOM              No available memory.
+ * @retval APP_RES_INVALID_PARA     The drop rate is out of range.
+ */
+uint16_t APP_SR_SelfTest(uint32_t frames, uint8_t lossPercent, uint32_t seed, APP_SR_TestResult_T *p_result);
+
+
+#endif
@@ -19,6 +19,9 @@
   Description:
     This file contains the Application Timer functions for this project.
     Including the Set/Stop timer and timer expired handler.
+    The timers are owned by the main loop thread, which sets and stops them without any lock.
+    The requests of the other threads are pushed to a lock-free mailbox and carried out by
+    the main loop.
  *******************************************************************************/
 
 // *****************************************************************************
@@ -39,6 +42,8 @@
 #include "app_dbp.h"
 #include "app_trpc.h"
 #include "app_trps.h"
+#include "app_script.h"
+#include "app_tune.h"
 
 
 
@@ -66,6 +71,17 @@ typedef struct APP_TIMER_Elem_T
     void            *p_tmrParam;         /**< timer parameter */
 } APP_TIMER_Elem_T;
 
+/**@brief The structure contains a timer request of a thread other than the main loop one. */
+typedef struct APP_TIMER_Req_T
+{
+    struct APP_TIMER_Req_T  *p_next;
+    bool                    isSet;          /**< Set the timer, else stop it. */
+    APP_TIMER_TimerId_T     tmrId;
+    uint8_t                 instance;
+    void                    *p_tmrParam;
+    uint32_t                timeout;
+} APP_TIMER_Req_T;
+
 
 
 
@@ -74,8 +90,9 @@ typedef struct APP_TIMER_Elem_T
 // Section: Local Variables
 // *****************************************************************************
 // *****************************************************************************
-static GList  *sp_timerList;
-static GMutex  s_mutex;
+static GHashTable      *sp_timerTable;      /**< Running timers by timer Id and instance, main loop thread only. */
+static GThread         *sp_timerThread;     /**< The main loop thread, NULL before APP_TIMER_Init(). */
+static gpointer         sp_timerMailbox;    /**< Pushed requests of the other threads, the last pushed first. */
 
 
 
@@ -87,21 +104,7 @@ static GMutex  s_mutex;
 
 static void app_timer_RemoveTimer(APP_TIMER_TimerId_T tmrId, uint8_t instance)
 {
-    GList *p_l;
-    APP_TIMER_Elem_T *p_tmr;
-    uint16_t idInst = APP_TMR_ID_INST(tmrId, instance);
-
-    g_mutex_lock(&s_mutex);
-    for (p_l=sp_timerList; p_l; p_l=g_list_next(p_l))  {
-        p_tmr = p_l->data;
-        if (p_tmr->tmrIdInst == idInst)
-        {
-            sp_timerList = g_list_remove(sp_timerList, p_tmr);
-            break;
-        }
-    }
-
-    g_mutex_unlock(&s_mutex);
+    g_hash_table_remove(sp_timerTable, GUINT_TO_POINTER(APP_TMR_ID_INST(tmrId, instance)));
 }
 
 
@@ -124,6 +127,10 @@ static int APP_TIMER_TimeoutHandle(gpointer userData)
             {
                 APP_TRPC_ProtocolErrRsp(p_trpConn);
             }
+            else if (p_trpConn != NULL)
+            {
+                APP_TRPS_ProtocolTimeout(p_trpConn);
+            }
         }
         break;
 
@@ -175,7 +182,9 @@ static int APP_TIMER_TimeoutHandle(gpointer userData)
                     APP_TRP_ConnList_T *p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy((DeviceProxy *)p_tmr->p_tmrParam);
 
                     bt_shell_printf("Sending data to remote peer.\n");
-                    APP_TIMER_SetTimer(APP_TIMER_RAW_DATA_FETCH, APP_TMR_ID(p_tmr->tmrIdInst), p_tmr->p_tmrParam, APP_TIMER_1MS);
+                    // A file is sent once the receiver answers with the offset to resume from
+                    if (APP_RawDataTxNegotiate(p_tmr->p_tmrParam) == false)
+                        APP_TIMER_SetTimer(APP_TIMER_RAW_DATA_FETCH, APP_TMR_ID(p_tmr->tmrIdInst), p_tmr->p_tmrParam, APP_TIMER_1MS);
                     if (p_trpConn != NULL && p_trpConn->trpRole == APP_TRP_SERVER_ROLE)
                     {
                         p_trpConn->workModeEn = true;
@@ -232,23 +241,34 @@ static int APP_TIMER_TimeoutHandle(gpointer userData)
 
         case APP_TIMER_LOOPBACK_RX_CHECK:
         {
-            bt_shell_printf("Loopback Rx timeout\n");
             APP_FileWriteTimeout(p_tmr->p_tmrParam);
         }
         break;
 
         case APP_TIMER_RAW_DATA_RX_CHECK:
         {
-            bt_shell_printf("\nRaw Data Rx finished\n");
             APP_RawDataFileWriteTimeout(p_tmr->p_tmrParam);
         }
         break;
+
+        case APP_TIMER_RAW_DATA_RESUME:
+        {
+            APP_RawDataResumeTimeout(p_tmr->p_tmrParam);
+        }
+        break;
+
+        case APP_TIMER_TUNE:
+        {
+            APP_TUNE_Timeout((APP_TRP_ConnList_T *)p_tmr->p_tmrParam);
+        }
+        break;
         
         case APP_TIMER_SCAN:
         {
             bt_shell_printf("Discovery stopped\n");
             APP_SCAN_Stop();
             APP_DBP_PrintDeviceList();
+            APP_SCRIPT_ScanCompleted();
         }
         break;
 
@@ -270,15 +290,39 @@ static int APP_TIMER_TimeoutHandle(gpointer userData)
         }
         break;
 
-        case APP_TIMER_DATA_BUFFER_OVERFLOW_EVT:
+        case APP_TIMER_AUTO_NEXT_RUN:
         {
-            bt_shell_printf("Data buffer overflow detected.\n");
+            APP_BurstModeStartAll();
         }
         break;
 
-        case APP_TIMER_AUTO_NEXT_RUN:
+        case APP_TIMER_SCRIPT_STEP:
         {
-            APP_BurstModeStartAll();
+            APP_SCRIPT_Step();
+        }
+        break;
+
+        case APP_TIMER_SCRIPT_TIMEOUT:
+        {
+            APP_SCRIPT_Timeout();
+        }
+        break;
+
+        case APP_TIMER_UART_HOLD:
+        {
+            APP_TRP_COMMON_UartHoldTimeout(p_tmr->p_tmrParam);
+        }
+        break;
+
+        case APP_TIMER_SR_RTO:
+        {
+            APP_TRPC_SrRtoTimeout(p_tmr->p_tmrParam);
+        }
+        break;
+
+        case APP_TIMER_SR_ACK:
+        {
+            APP_TRP_COMMON_SrAckTimeout(p_tmr->p_tmrParam);
         }
         break;
         
@@ -298,46 +342,33 @@ static int APP_TIMER_TimeoutHandle(gpointer userData)
 
 }
 
-uint16_t APP_TIMER_StopTimer(APP_TIMER_TimerId_T tmrId, uint8_t instance)
+static uint16_t app_timer_StopTimer(APP_TIMER_TimerId_T tmrId, uint8_t instance)
 {
-    GList *p_l;
-    bool isFound = false;
     APP_TIMER_Elem_T *p_tmr;
-    uint16_t idInst = APP_TMR_ID_INST(tmrId, instance);
-
+    gpointer key = GUINT_TO_POINTER(APP_TMR_ID_INST(tmrId, instance));
 
-    g_mutex_lock(&s_mutex);
-    for (p_l=sp_timerList; p_l; p_l=g_list_next(p_l))  {
-        p_tmr = p_l->data;
-        if (p_tmr->tmrIdInst == idInst)
-        {
-            if (p_tmr->tmrHandle)
-                g_source_remove(p_tmr->tmrHandle);
-            
-            sp_timerList = g_list_remove(sp_timerList, p_tmr);
-            g_free(p_tmr);
-            isFound = true;
-            break;
-        }
-    }
+    p_tmr = g_hash_table_lookup(sp_timerTable, key);
+    if (p_tmr == NULL)
+        return APP_RES_FAIL;
 
-    g_mutex_unlock(&s_mutex);
+    if (p_tmr->tmrHandle)
+        g_source_remove(p_tmr->tmrHandle);
 
-    if (isFound)
-        return APP_RES_SUCCESS;
+    g_hash_table_remove(sp_timerTable, key);
+    g_free(p_tmr);
 
-    return APP_RES_FAIL;
+    return APP_RES_SUCCESS;
 }
 
-uint16_t APP_TIMER_SetTimer(APP_TIMER_TimerId_T tmrId, uint8_t instance, void *p_tmrParam, uint32_t timeout)
+static uint16_t app_timer_SetTimer(APP_TIMER_TimerId_T tmrId, uint8_t instance, void *p_tmrParam, uint32_t timeout)
 {
     guint tmrHandle;
     APP_TIMER_Elem_T *p_tmrNew;
 
     //Stop and remove the timer if it already exists.
-    APP_TIMER_StopTimer(tmrId, instance);
+    app_timer_StopTimer(tmrId, instance);
 
-    //Append the new timer to the list
+    //Add the new timer to the table
     p_tmrNew = g_new0(APP_TIMER_Elem_T, 1);
     if (p_tmrNew == NULL)
         return APP_RES_OOM;
@@ -353,11 +384,119 @@ uint16_t APP_TIMER_SetTimer(APP_TIMER_TimerId_T tmrId, uint8_t instance, void *p
     }
 
     p_tmrNew->tmrHandle = tmrHandle;
-    g_mutex_lock(&s_mutex);
-    sp_timerList = g_list_append(sp_timerList, p_tmrNew);
-    g_mutex_unlock(&s_mutex);
+    g_hash_table_insert(sp_timerTable, GUINT_TO_POINTER(p_tmrNew->tmrIdInst), p_tmrNew);
+
+    return APP_RES_SUCCESS;
+}
 
+static uint16_t app_timer_PostRequest(bool isSet, APP_TIMER_TimerId_T tmrId, uint8_t instance, void *p_tmrParam, uint32_t timeout)
+{
+    APP_TIMER_Req_T *p_req;
+
+    p_req = g_new0(APP_TIMER_Req_T, 1);
+    if (p_req == NULL)
+        return APP_RES_OOM;
+
+    p_req->isSet = isSet;
+    p_req->tmrId = tmrId;
+    p_req->instance = instance;
+    p_req->p_tmrParam = p_tmrParam;
+    p_req->timeout = timeout;
+
+    do
+    {
+        p_req->p_next = g_atomic_pointer_get(&sp_timerMailbox);
+    } while (!g_atomic_pointer_compare_and_exchange(&sp_timerMailbox, p_req->p_next, p_req));
+
+    g_main_context_wakeup(NULL);
 
     return APP_RES_SUCCESS;
 }
 
+static gboolean app_timer_MailboxPrepare(GSource *p_source, gint *p_timeout)
+{
+    (void)p_source;
+
+    *p_timeout = -1;
+    return g_atomic_pointer_get(&sp_timerMailbox) != NULL;
+}
+
+static gboolean app_timer_MailboxCheck(GSource *p_source)
+{
+    (void)p_source;
+
+    return g_atomic_pointer_get(&sp_timerMailbox) != NULL;
+}
+
+static gboolean app_timer_MailboxDispatch(GSource *p_source, GSourceFunc callback, gpointer p_userData)
+{
+    APP_TIMER_Req_T *p_req, *p_next, *p_ordered = NULL;
+
+    (void)p_source;
+    (void)callback;
+    (void)p_userData;
+
+    // Take all the pushed requests at once, then carry them out in the order they were pushed
+    do
+    {
+        p_req = g_atomic_pointer_get(&sp_timerMailbox);
+    } while (!g_atomic_pointer_compare_and_exchange(&sp_timerMailbox, p_req, NULL));
+
+    for (; p_req != NULL; p_req = p_next)
+    {
+        p_next = p_req->p_next;
+        p_req->p_next = p_ordered;
+        p_ordered = p_req;
+    }
+
+    for (p_req = p_ordered; p_req != NULL; p_req = p_next)
+    {
+        p_next = p_req->p_next;
+        if (p_req->isSet)
+            app_timer_SetTimer(p_req->tmrId, p_req->instance, p_req->p_tmrParam, p_req->timeout);
+        else
+            app_timer_StopTimer(p_req->tmrId, p_req->instance);
+        g_free(p_req);
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs s_timerMailboxFuncs =
+{
+    app_timer_MailboxPrepare,
+    app_timer_MailboxCheck,
+    app_timer_MailboxDispatch,
+    NULL,
+};
+
+void APP_TIMER_Init(void)
+{
+    GSource *p_source;
+
+    if (sp_timerThread != NULL)
+        return;
+
+    sp_timerThread = g_thread_self();
+    sp_timerTable = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    p_source = g_source_new(&s_timerMailboxFuncs, sizeof(GSource));
+    g_source_attach(p_source, NULL);
+    g_source_unref(p_source);
+}
+
+uint16_t APP_TIMER_StopTimer(APP_TIMER_TimerId_T tmrId, uint8_t instance)
+{
+    if (g_thread_self() != sp_timerThread)
+        return app_timer_PostRequest(false, tmrId, instance, NULL, 0);
+
+    return app_timer_StopTimer(tmrId, instance);
+}
+
+uint16_t APP_TIMER_SetTimer(APP_TIMER_TimerId_T tmrId, uint8_t instance, void *p_tmrParam, uint32_t timeout)
+{
+    if (g_thread_self() != sp_timerThread)
+        return app_timer_PostRequest(true, tmrId, instance, p_tmrParam, timeout);
+
+    return app_timer_SetTimer(tmrId, instance, p_tmrParam, timeout);
+}
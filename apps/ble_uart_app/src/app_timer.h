@@ -62,7 +62,13 @@ typedef enum APP_TIMER_TimerId_T
     APP_TIMER_TRPS_PROGRESS_CHECK,          /**< The timer to check TRP burst mode activity is inprogress. */
     APP_TIMER_TRPC_RCV_CREDIT,              /**< The timer triggered by TRP client when credit has received. */
     APP_TIMER_AUTO_NEXT_RUN,
-    APP_TIMER_DATA_BUFFER_OVERFLOW_EVT,
+    APP_TIMER_SCRIPT_STEP,                  /**< The timer of headless mode connection watchdog and burst mode start delay. */
+    APP_TIMER_SCRIPT_TIMEOUT,               /**< The timer of headless mode whole run timeout. */
+    APP_TIMER_UART_HOLD,                    /**< The timer to send a partial UART packet held for coalescing. */
+    APP_TIMER_SR_RTO,                       /**< The timer to send again the selective repeat frames not acknowledged. */
+    APP_TIMER_SR_ACK,                       /**< The timer to send a delayed selective repeat acknowledgement. */
+    APP_TIMER_RAW_DATA_RESUME,              /**< The timer to wait for the resume offset of a raw data file. */
+    APP_TIMER_TUNE,                         /**< The timer to let a link settle on the configuration applied by the auto-tune. */
 
     APP_TIMER_PERIODIC_START = 0xA0,
     //periodic timer define here
@@ -101,10 +107,16 @@ typedef enum APP_TIMER_TimerId_T
 // *****************************************************************************
 // *****************************************************************************
 
+/**@brief Take the calling thread as the main loop one and start watching the requests of the other threads.
+ *        It must be called from the main loop thread before any timer is set.
+ */
+void APP_TIMER_Init(void);
+
 /**@brief The function is used to set and start a timer. 
           Callers can use the same Timer ID with different Timer Instances to produce distinguishable timers.
           When trying to stop a specific timer, use the Timer ID plus the correct Timer Instance.
           Note that if you set a same Timer ID with same Timer Instance, it will stop the previous one and then create a new one.
+          Called from another thread, the request is queued to the main loop and APP_RES_SUCCESS only means it is queued.
  *@param[in] tmrId                            Timer ID. See @ref APP_TIMER_TimerId_T.
  *@param[in] instance                         Timer Instance.
  *@param[in] p_tmrParam                       User data.
@@ -118,6 +130,7 @@ typedef enum APP_TIMER_TimerId_T
 uint16_t APP_TIMER_SetTimer(APP_TIMER_TimerId_T tmrId, uint8_t instance, void *p_tmrParam, uint32_t timeout);
 
 /**@brief The function is used to stop a timer.
+          Called from another thread, the request is queued to the main loop and APP_RES_SUCCESS only means it is queued.
  *@param[in] tmrId                            Timer ID. See @ref APP_TIMER_TimerId_T.
  *@param[in] instance                         Timer Instance. 
  *
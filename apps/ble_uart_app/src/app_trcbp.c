@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Transparent Credit Based Profile Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_trcbp.c
+
+  Summary:
+    This file contains the Application Transparent Credit Based Profile functions for this project.
+
+  Description:
+    This file contains the Application Transparent Credit Based Profile functions for this project.
+    The LE credits of the channel are handled by the kernel. A send blocked by the channel
+    completes when the socket is writable again, which is reported to the server as a CBFC
+    credit event and to the client as a data response.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <string.h>
+#include "application.h"
+#include "app_error_defs.h"
+#include "app_dbp.h"
+#include "app_trps.h"
+#include "app_trpc.h"
+#include "app_trcbp.h"
+#include "app_replay.h"
+#include "ble_trsp/ble_trsp_defs.h"
+
+#include "shared/shell.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static uint16_t s_trcbpPsm = BLE_TRCBP_DEFAULT_PSM;
+static uint16_t s_trcbpSdu = BLE_TRCBP_DEFAULT_SDU;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static void app_trcbp_Listen(void)
+{
+    uint16_t status;
+
+    status = BLE_TRCBP_Listen(s_trcbpPsm, s_trcbpSdu);
+    if (status != TRSP_RES_SUCCESS)
+    {
+        bt_shell_printf("TRCBP listen on PSM 0x%04x failed(%04x)\n", s_trcbpPsm, status);
+    }
+}
+
+void APP_TRCBP_Init(void)
+{
+    BLE_TRCBP_Init();
+
+    //No L2CAP socket during replay
+    if (!APP_REPLAY_IsEnabled())
+    {
+        app_trcbp_Listen();
+    }
+}
+
+void APP_TRCBP_EventHandler(BLE_TRCBP_Event_T *p_event)
+{
+    APP_TRP_ConnList_T *p_trpConn = NULL;
+
+    switch (p_event->eventId)
+    {
+        case BLE_TRCBP_EVT_CONN_IND:
+        {
+            APP_DBP_BtDev_T *p_dev = APP_DBP_GetDevInfoByAddress(p_event->eventField.onConnInd.p_address);
+
+            if ((p_dev != NULL) && (p_dev->isConnected) &&
+                (APP_TRP_COMMON_GetConnListByDevProxy(p_dev->p_devProxy) != NULL))
+            {
+                p_event->eventField.onConnInd.p_dev = p_dev->p_devProxy;
+            }
+            else
+            {
+                bt_shell_printf("TRCBP channel from %s is rejected\n", p_event->eventField.onConnInd.p_address);
+            }
+        }
+        break;
+
+        case BLE_TRCBP_EVT_CONNECTED:
+        {
+            APP_TRP_COMMON_TrcbpChOpenProc(p_event->eventField.onConnected.p_dev, true, p_event->eventField.onConnected.txSdu);
+            bt_shell_printf("TRCBP data channel is established (SDU=%d/%d)\n",
+                p_event->eventField.onConnected.txSdu, p_event->eventField.onConnected.rxSdu);
+        }
+        break;
+
+        case BLE_TRCBP_EVT_DISCONNECTED:
+        {
+            APP_TRP_COMMON_TrcbpChOpenProc(p_event->eventField.onDisconnected.p_dev, false, 0);
+            bt_shell_printf("TRCBP data channel is closed\n");
+        }
+        break;
+
+        case BLE_TRCBP_EVT_RECEIVE_DATA:
+        {
+            p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy(p_event->eventField.onReceiveData.p_dev);
+            if (p_trpConn == NULL)
+                break;
+
+            if (p_trpConn->trpRole == APP_TRP_SERVER_ROLE)
+            {
+                BLE_TRSPS_Event_T trpsEvt;
+
+                trpsEvt.eventId = BLE_TRSPS_EVT_RECEIVE_DATA;
+                trpsEvt.eventField.onReceiveData.p_dev = p_trpConn->p_deviceProxy;
+                APP_TRPS_EventHandler(&trpsEvt);
+            }
+            else
+            {
+                BLE_TRSPC_Event_T trpcEvt;
+
+                trpcEvt.eventId = BLE_TRSPC_EVT_RECEIVE_DATA;
+                trpcEvt.eventField.onReceiveData.p_dev = p_trpConn->p_deviceProxy;
+                APP_TRPC_EventHandler(&trpcEvt);
+            }
+        }
+        break;
+
+        case BLE_TRCBP_EVT_TX_COMPLETE:
+        case BLE_TRCBP_EVT_CREDIT:
+        {
+            p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy(p_event->eventField.onCredit.p_dev);
+            if (p_trpConn == NULL)
+                break;
+
+            if (p_trpConn->trpRole == APP_TRP_SERVER_ROLE)
+            {
+                //The server keeps sending until the channel is blocked
+                if (p_event->eventId == BLE_TRCBP_EVT_CREDIT)
+                {
+                    BLE_TRSPS_Event_T trpsEvt;
+
+                    trpsEvt.eventId = BLE_TRSPS_EVT_CBFC_CREDIT;
+                    trpsEvt.eventField.onCbfcEnabled.p_dev = p_trpConn->p_deviceProxy;
+                    APP_TRPS_EventHandler(&trpsEvt);
+                }
+            }
+            else if ((p_event->eventId == BLE_TRCBP_EVT_CREDIT) || (p_trpConn->gattcRspWait))
+            {
+                BLE_TRSPC_Event_T trpcEvt;
+
+                trpcEvt.eventId = BLE_TRSPC_EVT_DATA_RSP;
+                trpcEvt.eventField.onDataRsp.p_dev = p_trpConn->p_deviceProxy;
+                trpcEvt.eventField.onDataRsp.result = BLE_TRSPC_SEND_RESULT_SUCCESS;
+                APP_TRPC_EventHandler(&trpcEvt);
+            }
+        }
+        break;
+
+        case BLE_TRCBP_EVT_ERR_NO_MEM:
+        {
+            bt_shell_printf("TRCBP error: out of memory\n");
+        }
+        break;
+
+        default:
+            break;
+    }
+}
+
+uint16_t APP_TRCBP_LeTxData(APP_TRP_ConnList_T *p_trpConn, uint16_t len, uint8_t *p_data)
+{
+    uint16_t status = TRSP_RES_SUCCESS;
+
+    if (p_trpConn == NULL || p_data == NULL || len == 0)
+        return APP_RES_FAIL;
+
+    if (len > p_trpConn->p_cold->fixPattTrcbpMtu)
+        return APP_RES_OOM;
+
+    if (p_trpConn->trpRole == APP_TRP_CLIENT_ROLE && p_trpConn->gattcRspWait)
+        return APP_RES_BUSY;
+
+    if (APP_REPLAY_IsReplaying())
+    {
+        status = APP_REPLAY_GetSendResult(p_trpConn->p_deviceProxy);
+    }
+    else
+    {
+        status = BLE_TRCBP_SendData(p_trpConn->p_deviceProxy, len, p_data);
+        APP_REPLAY_RecordSend(p_trpConn->p_deviceProxy, status);
+    }
+    if (status == TRSP_RES_NO_RESOURCE)
+        return APP_RES_NO_RESOURCE;
+    else if (status != TRSP_RES_SUCCESS)
+        return APP_RES_FAIL;
+
+    //The client waits for the TX complete event as it does for the GATT write response
+    if (p_trpConn->trpRole == APP_TRP_CLIENT_ROLE)
+        p_trpConn->gattcRspWait = APP_TRP_SEND_DATA_FAIL;
+
+    return APP_RES_SUCCESS;
+}
+
+uint16_t APP_TRCBP_SetPsm(uint16_t psm)
+{
+    s_trcbpPsm = psm;
+    if (APP_REPLAY_IsEnabled())
+        return APP_RES_SUCCESS;
+
+    return (BLE_TRCBP_Listen(s_trcbpPsm, s_trcbpSdu) == TRSP_RES_SUCCESS) ? APP_RES_SUCCESS : APP_RES_FAIL;
+}
+
+uint16_t APP_TRCBP_GetPsm(void)
+{
+    return s_trcbpPsm;
+}
+
+uint16_t APP_TRCBP_SetSdu(uint16_t sdu)
+{
+    if (sdu < BLE_TRCBP_MIN_SDU)
+        return APP_RES_INVALID_PARA;
+
+    s_trcbpSdu = sdu;
+    if (APP_REPLAY_IsEnabled() || s_trcbpPsm == 0)
+        return APP_RES_SUCCESS;
+
+    return (BLE_TRCBP_Listen(s_trcbpPsm, s_trcbpSdu) == TRSP_RES_SUCCESS) ? APP_RES_SUCCESS : APP_RES_FAIL;
+}
+
+uint16_t APP_TRCBP_GetSdu(void)
+{
+    return s_trcbpSdu;
+}
+
+uint16_t APP_TRCBP_Connect(DeviceProxy *p_devProxy)
+{
+    APP_DBP_BtDev_T *p_dev;
+    APP_TRP_ConnList_T *p_trpConn;
+    uint16_t status;
+
+    p_dev = APP_DBP_GetDevInfoByProxy(p_devProxy);
+    p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy(p_devProxy);
+    if (p_dev == NULL || p_trpConn == NULL || !p_dev->isConnected)
+        return APP_RES_BAD_STATE;
+
+    if (p_trpConn->trpRole != APP_TRP_CLIENT_ROLE)
+        return APP_RES_INVALID_PARA;
+
+    status = BLE_TRCBP_Connect(p_devProxy, p_dev->p_address,
+        (p_dev->p_addressType != NULL && !strcmp(p_dev->p_addressType, "random")),
+        (s_trcbpPsm != 0) ? s_trcbpPsm : BLE_TRCBP_DEFAULT_PSM, s_trcbpSdu);
+    if (status == TRSP_RES_NO_RESOURCE)
+        return APP_RES_NO_RESOURCE;
+    else if (status == TRSP_RES_BAD_STATE)
+        return APP_RES_BAD_STATE;
+    else if (status != TRSP_RES_SUCCESS)
+        return APP_RES_FAIL;
+
+    return APP_RES_SUCCESS;
+}
+
+void APP_TRCBP_Disconnect(DeviceProxy *p_devProxy)
+{
+    BLE_TRCBP_Disconnect(p_devProxy);
+}
+
+//Connect two links back to back over a socketpair, the data sent on one link is received on the other
+uint16_t APP_TRCBP_LocalPair(DeviceProxy *p_devProxyA, DeviceProxy *p_devProxyB)
+{
+    if (APP_TRP_COMMON_GetConnListByDevProxy(p_devProxyA) == NULL ||
+        APP_TRP_COMMON_GetConnListByDevProxy(p_devProxyB) == NULL)
+        return APP_RES_BAD_STATE;
+
+    if (BLE_TRCBP_CreateLocalPair(p_devProxyA, p_devProxyB, s_trcbpSdu) != TRSP_RES_SUCCESS)
+        return APP_RES_FAIL;
+
+    return APP_RES_SUCCESS;
+}
+
+
+/*******************************************************************************
+ End of File
+ */
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Transparent Credit Based Profile Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_trcbp.h
+
+  Summary:
+    This file contains the Application Transparent Credit Based Profile functions for this project.
+
+  Description:
+    This file contains the Application Transparent Credit Based Profile functions for this project.
+    The TRCBP channel carries the data of a TRP link while the work mode commands stay on the
+    TRP control channel. The channel events are delivered to the TRPS/TRPC state machines as
+    the equivalent TRSPS/TRSPC events.
+ *******************************************************************************/
+
+#ifndef APP_TRCBP_H
+#define APP_TRCBP_H
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include "app_trp_common.h"
+#include "ble_trcbp/ble_trcbp.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+void APP_TRCBP_Init(void);
+void APP_TRCBP_EventHandler(BLE_TRCBP_Event_T *p_event);
+uint16_t APP_TRCBP_LeTxData(APP_TRP_ConnList_T *p_trpConn, uint16_t len, uint8_t *p_data);
+uint16_t APP_TRCBP_SetPsm(uint16_t psm);
+uint16_t APP_TRCBP_GetPsm(void);
+uint16_t APP_TRCBP_SetSdu(uint16_t sdu);
+uint16_t APP_TRCBP_GetSdu(void);
+uint16_t APP_TRCBP_Connect(DeviceProxy *p_devProxy);
+void APP_TRCBP_Disconnect(DeviceProxy *p_devProxy);
+uint16_t APP_TRCBP_LocalPair(DeviceProxy *p_devProxyA, DeviceProxy *p_devProxyB);
+
+
+
+#endif
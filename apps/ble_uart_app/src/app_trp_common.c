@@ -31,9 +31,17 @@
 #include "app_error_defs.h"
 #include "app_trps.h"
 #include "app_trpc.h"
+#include "app_trcbp.h"
 #include "app_log.h"
 #include "app_trp_common.h"
 #include "app_timer.h"
+#include "app_script.h"
+#include "app_result.h"
+#include "app_replay.h"
+#include "app_lz.h"
+#include "app_tune.h"
+#include "app_mem.h"
+#include "app_dp.h"
 
 #include "shared/util.h"
 #include "shared/shell.h"
@@ -43,7 +51,9 @@
 // Section: Macros
 // *****************************************************************************
 // *****************************************************************************
-
+#define APP_TRP_COMPRESS_BLOCK_STORED       0x00    /**< The block is sent as is, it does not compress. */
+#define APP_TRP_COMPRESS_BLOCK_LZ           0x01
+#define APP_TRP_WMODE_COMPRESS_PL_NUM       0x03
 
 // *****************************************************************************
 // *****************************************************************************
@@ -51,6 +61,38 @@
 // *****************************************************************************
 // *****************************************************************************
 
+/**@brief Enumeration type of the received data check jobs. */
+typedef enum APP_TRP_RX_CHECK_T
+{
+    APP_TRP_RX_CHECK_PATTERN = 0x00,    /**< Check the numbers of the fixed pattern. */
+    APP_TRP_RX_CHECK_SUM,               /**< Add the data to the check sum. */
+    APP_TRP_RX_CHECK_FLUSH              /**< No data, report once the data queued before is checked. */
+} APP_TRP_RX_CHECK_T;
+
+/**@brief The structure contains the received data check state of a link. It is only touched by the data plane worker of the link. */
+typedef struct APP_TRP_RxCheck_T
+{
+    uint32_t                runId;              /**< Run of the state, the first job of a new run starts it over. */
+    uint32_t                rxAccuLeng;         /**< Received length. */
+    uint32_t                checkSum;           /**< Sum of the received bytes. */
+    uint16_t                rxLastNumber;       /**< Next number expected in the fixed pattern. */
+    bool                    failed;             /**< A number mismatched, the rest of the run is not checked. */
+} APP_TRP_RxCheck_T;
+
+/**@brief The structure contains a received data check job. */
+typedef struct APP_TRP_RxCheckJob_T
+{
+    uint8_t                 link;               /**< Index of the link, the shard of the job. */
+    uint8_t                 type;               /**< See @ref APP_TRP_RX_CHECK_T. */
+    uint32_t                runId;              /**< Run of the link when the job was queued. */
+    uint32_t                dataLeng;
+    uint8_t                 *p_data;            /**< Received data, owned by the job. */
+    APP_TRP_RxCheckCb_T     p_cb;               /**< Result callback, may be NULL. */
+    APP_TRP_RxCheck_T       result;             /**< State of the link once the job is done. */
+    bool                    mismatch;           /**< The job found the first number mismatch of the run. */
+    uint16_t                mismatchNumber;     /**< Number received in place of result.rxLastNumber. */
+} APP_TRP_RxCheckJob_T;
+
 
 // *****************************************************************************
 // *****************************************************************************
@@ -67,16 +109,40 @@ const char * APP_TRP_TestStageStr[] = {
     "Failed"
 };
 
+const char * APP_TRP_WorkModeStr[] = {
+    "null",
+    "checksum",
+    "loopback",
+    "fixed-pattern",
+    "uart",
+    "rev-loopback",
+    "duplex"
+};
+
 
 // *****************************************************************************
 // *****************************************************************************
 // Section: Local Variables
 // *****************************************************************************
 // *****************************************************************************
-static APP_TRP_GenData_T        s_trpInputData[BLE_GAP_MAX_LINK_NBR];
-static APP_TRP_ConnList_T       s_trpConnList[APP_TRP_MAX_LINK_NUMBER];
+static APP_TRP_GenData_T        *sp_trpInputData;          /**< Table of BLE_GAP_MAX_LINK_NBR entries, allocated once by APP_TRP_COMMON_Init(). */
+static APP_TRP_ConnList_T       *sp_trpConnList;           /**< Table of APP_TRP_MAX_LINK_NUMBER entries, allocated once by APP_TRP_COMMON_Init(). */
+static APP_TRP_ConnCold_T       *sp_trpConnCold;           /**< Cold descriptors of sp_trpConnList, same index. */
+static APP_TRP_RxCheck_T        *sp_trpRxCheck;            /**< Table of APP_TRP_MAX_LINK_NUMBER entries, an entry belongs to the data plane worker of the link. */
+static uint32_t                 s_trpRxCheckRunId;
+static uint8_t                  *sp_trpFreeNext;           /**< Next free link of each free link, APP_TRP_MAX_LINK_NUMBER ends the list. */
+static uint8_t                  s_trpFreeHead;             /**< First free link, APP_TRP_MAX_LINK_NUMBER when all the links are used. */
+static GHashTable               *sp_trpConnByProxy;        /**< Used links by device proxy. */
+static uint64_t                 s_trpLinkMask;             /**< Bit per connected link, walked by the schedulers instead of the table. BLE_GAP_MAX_LINK_NBR_LIMIT fits in 64 bits. */
+static uint64_t                 s_trpRoleMask[APP_TRP_CLIENT_ROLE + 1];   /**< Connected links by transparent role. */
+static uint64_t                 s_trpMemStallMask;         /**< Links waiting for buffers to move the received data to the output. */
 static uint8_t s_trpsChannelEn;
 static APP_TRP_TYPE_T s_trpsType;
+static APP_LOG_Throttle_T       s_trpcProgressThrottle;
+static uint16_t                 s_trpUartHoldMs;
+static APP_TRP_COMPRESS_CODEC_T s_trpCompressCodec;
+static bool                     s_trpSrEnable;
+static uint8_t                  s_trpSrFrame[BLE_ATT_MAX_MTU_LEN];
 
 
 // *****************************************************************************
@@ -85,6 +151,8 @@ static APP_TRP_TYPE_T s_trpsType;
 // *****************************************************************************
 // *****************************************************************************
 static void app_trp_common_LinkClear(APP_TRP_ConnList_T *p_trpConn);
+static void app_trp_common_ResetUartFillStat(APP_TRP_ConnList_T *p_trpConn);
+static void app_trp_common_MemReleased(void);
 static uint16_t app_trp_common_SendLeData(APP_TRP_ConnList_T *p_trpConn, uint16_t len, uint8_t *p_data);
 
 
@@ -92,15 +160,33 @@ void APP_TRP_COMMON_Init(void)
 {
     uint8_t i;
 
+    if (sp_trpConnList == NULL)
+    {
+        sp_trpConnList = g_new0(APP_TRP_ConnList_T, APP_TRP_MAX_LINK_NUMBER);
+        sp_trpConnCold = g_new0(APP_TRP_ConnCold_T, APP_TRP_MAX_LINK_NUMBER);
+        for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+            sp_trpConnList[i].p_cold = &sp_trpConnCold[i];
+        sp_trpRxCheck = g_new0(APP_TRP_RxCheck_T, APP_TRP_MAX_LINK_NUMBER);
+        sp_trpInputData = g_new0(APP_TRP_GenData_T, BLE_GAP_MAX_LINK_NBR);
+        sp_trpFreeNext = g_new0(uint8_t, APP_TRP_MAX_LINK_NUMBER);
+        sp_trpConnByProxy = g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+
+    g_hash_table_remove_all(sp_trpConnByProxy);
+    s_trpLinkMask = 0;
+    s_trpMemStallMask = 0;
+    memset(s_trpRoleMask, 0, sizeof(s_trpRoleMask));
     for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
     {
-        app_trp_common_LinkClear(&s_trpConnList[i]);
+        app_trp_common_LinkClear(&sp_trpConnList[i]);
+        sp_trpFreeNext[i] = i + 1;
     }
+    s_trpFreeHead = 0;
 
-    memset((uint8_t *) &s_trpInputData, 0, BLE_GAP_MAX_LINK_NBR*sizeof(APP_TRP_GenData_T));
+    memset((uint8_t *) sp_trpInputData, 0, BLE_GAP_MAX_LINK_NBR*sizeof(APP_TRP_GenData_T));
     s_trpsChannelEn = 0;
     s_trpsType = APP_TRP_TYPE_UNKNOWN;
-
+    APP_MEM_SetReleaseCb(app_trp_common_MemReleased);
 }
 
 bool APP_TRP_COMMON_CheckValidTopology(uint8_t trpRole)
@@ -115,8 +201,7 @@ bool APP_TRP_COMMON_CheckValidTopology(uint8_t trpRole)
     
     for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
     {
-        if (s_trpConnList[i].connState == APP_TRP_STATE_CONNECTED &&
-            s_trpConnList[i].workMode != TRP_WMODE_UART)
+        if ((s_trpLinkMask & (1ULL << i)) && sp_trpConnList[i].workMode != TRP_WMODE_UART)
         {
             return false;
         }
@@ -127,32 +212,18 @@ bool APP_TRP_COMMON_CheckValidTopology(uint8_t trpRole)
 
 APP_TRP_ConnList_T *APP_TRP_COMMON_GetConnListByDevProxy(DeviceProxy *p_devProxy)
 {
-    uint8_t index;
-
-    for (index = 0; index < APP_TRP_MAX_LINK_NUMBER; index++)
-    {
-        if (s_trpConnList[index].p_deviceProxy == p_devProxy)
-        {
-            return &s_trpConnList[index];
-        }
-    }
+    if (sp_trpConnByProxy == NULL)
+        return NULL;
 
-    return NULL;
+    return g_hash_table_lookup(sp_trpConnByProxy, p_devProxy);
 }
 
 uint8_t APP_TRP_COMMON_GetConnIndex(APP_TRP_ConnList_T *p_trpConn)
 {
-    uint8_t index;
-
-    for (index = 0; index < APP_TRP_MAX_LINK_NUMBER; index++)
-    {
-        if (&s_trpConnList[index] == p_trpConn)
-        {
-            return index;
-        }
-    }
+    if (p_trpConn < sp_trpConnList || p_trpConn >= sp_trpConnList + APP_TRP_MAX_LINK_NUMBER)
+        return APP_TRP_MAX_LINK_NUMBER;
 
-    return APP_TRP_MAX_LINK_NUMBER;
+    return (uint8_t)(p_trpConn - sp_trpConnList);
 }
 
 
@@ -170,44 +241,67 @@ static uint16_t app_trp_common_CheckCtrlChannel(APP_TRP_ConnList_T *p_trpConn)
 
 void APP_TRP_COMMON_ConnEvtProc(DeviceProxy *p_devProxy, uint8_t gapRole)
 {
-    uint8_t i;
+    APP_TRP_ConnList_T *p_trpConn;
 
-    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    APP_REPLAY_RecordLink(p_devProxy, APP_REPLAY_LINK_CONNECTED, gapRole);
+
+    if (s_trpFreeHead >= APP_TRP_MAX_LINK_NUMBER)
+        return;
+
+    p_trpConn = &sp_trpConnList[s_trpFreeHead];
+    s_trpFreeHead = sp_trpFreeNext[s_trpFreeHead];
+
+    p_trpConn->connState = APP_TRP_STATE_CONNECTED;
+    p_trpConn->p_deviceProxy = p_devProxy;
+    p_trpConn->trpRole = (gapRole == BLE_GAP_ROLE_CENTRAL ? APP_TRP_CLIENT_ROLE : APP_TRP_SERVER_ROLE);
+    if (gapRole == BLE_GAP_ROLE_PERIPHERAL)
     {
-        if (s_trpConnList[i].connState == APP_TRP_STATE_IDLE)
-        {
-            s_trpConnList[i].connState = APP_TRP_STATE_CONNECTED;
-            s_trpConnList[i].p_deviceProxy = p_devProxy;
-            s_trpConnList[i].trpRole = (gapRole == BLE_GAP_ROLE_CENTRAL ? APP_TRP_CLIENT_ROLE : APP_TRP_SERVER_ROLE);
-            if (gapRole == BLE_GAP_ROLE_PERIPHERAL)
-            {
-                s_trpConnList[i].workMode = TRP_WMODE_UART; //default mode is UART.
-                s_trpConnList[i].channelEn = s_trpsChannelEn;
-                s_trpConnList[i].type = s_trpsType;
-            }
-            break;
-        }
+        p_trpConn->workMode = TRP_WMODE_UART; //default mode is UART.
+        p_trpConn->channelEn = s_trpsChannelEn;
+        p_trpConn->type = s_trpsType;
     }
+    g_hash_table_insert(sp_trpConnByProxy, p_devProxy, p_trpConn);
+
+    s_trpLinkMask |= 1ULL << APP_TRP_COMMON_GetConnIndex(p_trpConn);
+    s_trpRoleMask[p_trpConn->trpRole] |= 1ULL << APP_TRP_COMMON_GetConnIndex(p_trpConn);
 }
 
 void APP_TRP_COMMON_DiscEvtProc(DeviceProxy *p_devProxy)
 {
     APP_TRP_ConnList_T *p_trpConnLink = NULL;
+    uint8_t index;
     
+    APP_REPLAY_RecordLink(p_devProxy, APP_REPLAY_LINK_DISCONNECTED, 0);
+
     p_trpConnLink = APP_TRP_COMMON_GetConnListByDevProxy(p_devProxy);
+    if (p_trpConnLink == NULL)
+        return;
+
+    APP_TUNE_LinkDisconnected(p_trpConnLink);
+    g_hash_table_remove(sp_trpConnByProxy, p_devProxy);
+
+    index = APP_TRP_COMMON_GetConnIndex(p_trpConnLink);
+    s_trpLinkMask &= ~(1ULL << index);
+    s_trpRoleMask[p_trpConnLink->trpRole] &= ~(1ULL << index);
+    s_trpMemStallMask &= ~(1ULL << index);
     app_trp_common_LinkClear(p_trpConnLink);
+
+    sp_trpFreeNext[index] = s_trpFreeHead;
+    s_trpFreeHead = index;
 }
 
 void APP_TRP_COMMON_UpdateMtu(DeviceProxy *p_devProxy, uint16_t exchangedMTU)
 {
     APP_TRP_ConnList_T *p_trpConnLink = NULL;
     
+    APP_REPLAY_RecordLink(p_devProxy, APP_REPLAY_LINK_MTU, exchangedMTU);
+
     p_trpConnLink = APP_TRP_COMMON_GetConnListByDevProxy(p_devProxy);
     
     if(p_trpConnLink != NULL)
     {
-        p_trpConnLink->exchangedMTU = exchangedMTU;
-        p_trpConnLink->txMTU = p_trpConnLink->exchangedMTU - ATT_HANDLE_VALUE_HEADER_SIZE;
+        p_trpConnLink->p_cold->exchangedMTU = exchangedMTU;
+        p_trpConnLink->txMTU = p_trpConnLink->p_cold->exchangedMTU - ATT_HANDLE_VALUE_HEADER_SIZE;
     }
 }
 
@@ -227,9 +321,9 @@ void APP_TRP_COMMON_CtrlChOpenProc(bool isOpen)
 
     for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
     {
-        if (s_trpConnList[i].trpRole == APP_TRP_SERVER_ROLE)
+        if (sp_trpConnList[i].trpRole == APP_TRP_SERVER_ROLE)
         {
-            s_trpConnList[i].channelEn = s_trpsChannelEn;
+            sp_trpConnList[i].channelEn = s_trpsChannelEn | (sp_trpConnList[i].channelEn & APP_TRCBP_DATA_CHAN_ENABLE);
         }
     }
 
@@ -254,10 +348,47 @@ void APP_TRP_COMMON_TxChOpenProc(bool isOpen)
 
     for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
     {
-        if (s_trpConnList[i].trpRole == APP_TRP_SERVER_ROLE)
+        if (sp_trpConnList[i].trpRole == APP_TRP_SERVER_ROLE)
+        {
+            sp_trpConnList[i].channelEn = s_trpsChannelEn | (sp_trpConnList[i].channelEn & APP_TRCBP_DATA_CHAN_ENABLE);
+            if (sp_trpConnList[i].type != APP_TRP_TYPE_TRCBP)
+            {
+                sp_trpConnList[i].type = s_trpsType;
+            }
+        }
+    }
+}
+
+//The TRCBP data channel is opened per link, the control channel stays on the TRP service
+void APP_TRP_COMMON_TrcbpChOpenProc(DeviceProxy *p_devProxy, bool isOpen, uint16_t sdu)
+{
+    APP_TRP_ConnList_T *p_trpConnLink = NULL;
+
+    APP_REPLAY_RecordLink(p_devProxy, APP_REPLAY_LINK_TRCBP, isOpen ? sdu : 0);
+
+    p_trpConnLink = APP_TRP_COMMON_GetConnListByDevProxy(p_devProxy);
+    if (p_trpConnLink == NULL)
+        return;
+
+    if (isOpen)
+    {
+        p_trpConnLink->channelEn |= APP_TRCBP_DATA_CHAN_ENABLE;
+        p_trpConnLink->p_cold->fixPattTrcbpMtu = sdu;
+        p_trpConnLink->lePktLeng = sdu;
+        p_trpConnLink->type = APP_TRP_TYPE_TRCBP;
+    }
+    else
+    {
+        p_trpConnLink->channelEn &= APP_TRCBP_DATA_CHAN_DISABLE;
+        p_trpConnLink->p_cold->fixPattTrcbpMtu = 0;
+        p_trpConnLink->lePktLeng = 0;
+        if (p_trpConnLink->trpRole == APP_TRP_SERVER_ROLE)
+        {
+            p_trpConnLink->type = s_trpsType;
+        }
+        else
         {
-            s_trpConnList[i].channelEn = s_trpsChannelEn;
-            s_trpConnList[i].type = s_trpsType;
+            p_trpConnLink->type = APP_TRP_TYPE_LEGACY;
         }
     }
 }
@@ -266,7 +397,11 @@ static uint16_t app_trp_common_SendLeData(APP_TRP_ConnList_T *p_trpConn, uint16_
 {
     uint16_t status = APP_RES_FAIL;
 
-    if (p_trpConn->trpRole == APP_TRP_SERVER_ROLE)
+    if ((p_trpConn->type == APP_TRP_TYPE_TRCBP) && (p_trpConn->channelEn & APP_TRCBP_DATA_CHAN_ENABLE))
+    {
+        status = APP_TRCBP_LeTxData(p_trpConn, len, p_data);
+    }
+    else if (p_trpConn->trpRole == APP_TRP_SERVER_ROLE)
     {
         if ((p_trpConn->channelEn & APP_TRP_DATA_CHAN_ENABLE))
         {
@@ -287,21 +422,63 @@ static uint16_t app_trp_common_SendLeData(APP_TRP_ConnList_T *p_trpConn, uint16_
     return status;
 }
 
+static void app_trp_common_UartQueueMark(APP_UTILITY_CircQueue_T *p_circQ, bool isHigh, void *p_param)
+{
+    APP_TRP_ConnList_T *p_trpConn = (APP_TRP_ConnList_T *)p_param;
+    APP_TIMER_TimerId_T tmrId;
+    uint8_t transIndex;
+
+    (void)p_circQ;
+
+    if (p_trpConn->p_deviceProxy == NULL || p_trpConn->workModeEn == false)
+        return;
+
+    if (p_trpConn->workMode == TRP_WMODE_LOOPBACK)
+        tmrId = APP_TIMER_FILE_FETCH;
+    else if (p_trpConn->workMode == TRP_WMODE_UART)
+        tmrId = APP_TIMER_RAW_DATA_FETCH;
+    else
+        return;
+
+    transIndex = APP_GetFileTransIndex(p_trpConn->p_deviceProxy);
+    if (transIndex >= APP_BLE_MAX_LINK_NUMBER)
+        return;
+
+    // Pause the data source while the queue is full, fetch again as soon as it is drained to the low mark
+    if (isHigh)
+        APP_TIMER_StopTimer(tmrId, transIndex);
+    else
+        APP_TIMER_SetTimer(tmrId, transIndex, (void *)p_trpConn->p_deviceProxy, 0);
+}
+
 static void app_trp_common_LinkClear(APP_TRP_ConnList_T *p_trpConn)
 {
+    APP_TRP_ConnCold_T *p_cold;
+
     if (p_trpConn == NULL) return;
 
-    if (p_trpConn->p_transTimer)
+    if (p_trpConn->p_cold->p_transTimer)
     {
-        g_timer_destroy(p_trpConn->p_transTimer);
+        g_timer_destroy(p_trpConn->p_cold->p_transTimer);
     }
+    APP_TRP_COMMON_StopCompress(p_trpConn);
+    APP_TRP_COMMON_StopSr(p_trpConn);
+    // A held partial packet of the link is not sent any more
+    APP_TIMER_StopTimer(APP_TIMER_UART_HOLD, APP_TRP_COMMON_GetConnIndex(p_trpConn));
 
+    p_cold = p_trpConn->p_cold;
     memset(p_trpConn, 0, sizeof(APP_TRP_ConnList_T));
-    p_trpConn->exchangedMTU = BLE_ATT_DEFAULT_MTU_LEN;
+    memset(p_cold, 0, sizeof(APP_TRP_ConnCold_T));
+    p_trpConn->p_cold = p_cold;
+    app_trp_common_ResetUartFillStat(p_trpConn);
+    p_trpConn->rxCheckRunId = ++s_trpRxCheckRunId;
+    p_trpConn->p_cold->exchangedMTU = BLE_ATT_DEFAULT_MTU_LEN;
     p_trpConn->txMTU = BLE_ATT_DEFAULT_MTU_LEN - ATT_HANDLE_VALUE_HEADER_SIZE;
-    p_trpConn->p_transTimer = g_timer_new();
+    p_trpConn->p_cold->p_transTimer = g_timer_new();
 
     APP_UTILITY_InitCircQueue(&(p_trpConn->uartCircQueue), APP_UTILITY_MAX_QUEUE_NUM);
+    APP_UTILITY_SetCircQueueMark(&(p_trpConn->uartCircQueue), APP_TRP_UART_QUEUE_HIGH_MARK, APP_TRP_UART_QUEUE_LOW_MARK,
+        app_trp_common_UartQueueMark, p_trpConn);
     APP_UTILITY_InitCircQueue(&(p_trpConn->leCircQueue), APP_TRP_LE_MAX_QUEUE_NUM);
 }
 
@@ -317,7 +494,7 @@ static APP_TRP_GenData_T * app_trp_common_GetInputData(DeviceProxy *p_devProxy)
         return NULL;
     }
     
-    return &s_trpInputData[bleLinkIdx];
+    return &sp_trpInputData[bleLinkIdx];
 }
 
 
@@ -343,6 +520,9 @@ uint16_t app_trp_common_SendVendorCmd(APP_TRP_ConnList_T *p_trpConn, uint16_t le
 {
     uint16_t result = APP_RES_FAIL;
 
+    if (APP_REPLAY_IsReplaying())
+        return APP_REPLAY_GetSendResult(p_trpConn->p_deviceProxy);
+
     if (p_trpConn->trpRole == APP_TRP_SERVER_ROLE)
     {
         if (p_trpConn->channelEn & APP_TRP_CTRL_CHAN_ENABLE)   //Legacy TRP
@@ -352,12 +532,13 @@ uint16_t app_trp_common_SendVendorCmd(APP_TRP_ConnList_T *p_trpConn, uint16_t le
     }
     else if (p_trpConn->trpRole == APP_TRP_CLIENT_ROLE)
     {
-        if (p_trpConn->type == APP_TRP_TYPE_LEGACY)  //Legacy TRP
+        if (p_trpConn->type != APP_TRP_TYPE_UNKNOWN)  //Legacy TRP, or TRCBP controlled over TRP
         {
             result = BLE_TRSPC_SendVendorCommand(p_trpConn->p_deviceProxy, APP_TRP_VENDOR_OPCODE_BLE_UART, length, p_payload);
         }
     }
 
+    APP_REPLAY_RecordSend(p_trpConn->p_deviceProxy, result);
 
     return result;
 }
@@ -406,6 +587,10 @@ uint16_t APP_TRP_COMMON_SendModeCommand(APP_TRP_ConnList_T *p_trpConn, uint8_t g
             case TRP_GRPID_REV_LOOPBACK:
                 rspFlag = APP_TRP_SEND_GID_REV_LB_FAIL;
                 break;
+
+            case TRP_GRPID_DUPLEX:
+                rspFlag = APP_TRP_SEND_GID_DUPLEX_FAIL;
+                break;
             default:
                 break;
         }
@@ -442,6 +627,59 @@ uint16_t APP_TRP_COMMON_SendLengthCommand(APP_TRP_ConnList_T *p_trpConn, uint32_
     return result;
 }
 
+// The length command extended with the file identifier, a peer reading only the length ignores the rest
+#define APP_TRP_WMODE_TX_FILE_LENGTH_PL_NUM 0x0A
+uint16_t APP_TRP_COMMON_SendFileLengthCommand(APP_TRP_ConnList_T *p_trpConn, uint32_t length, uint32_t fileId)
+{
+    uint8_t payload[APP_TRP_WMODE_TX_FILE_LENGTH_PL_NUM], idx;
+    uint16_t result = APP_RES_FAIL;
+
+    result = app_trp_common_CheckCtrlChannel(p_trpConn);
+    if (result == APP_RES_SUCCESS)
+    {
+        if(app_trp_common_CheckCtrlRspFg(p_trpConn))
+            return APP_RES_FAIL;
+
+        idx = 0;
+        payload[idx++] = TRP_GRPID_TRANSMIT;
+        payload[idx++] = APP_TRP_WMODE_TX_DATA_LENGTH;
+        put_be32(length, &payload[idx]);
+        idx += 4;
+        put_be32(fileId, &payload[idx]);
+
+        result = app_trp_common_SendVendorCmd(p_trpConn, APP_TRP_WMODE_TX_FILE_LENGTH_PL_NUM, payload);
+        app_trp_common_SetCtrlRspFg(p_trpConn, result, APP_TRP_SEND_LENGTH_FAIL);
+    }
+
+    return result;
+}
+
+#define APP_TRP_WMODE_TX_OFFSET_PL_NUM      0x0A
+uint16_t APP_TRP_COMMON_SendOffsetCommand(APP_TRP_ConnList_T *p_trpConn, uint32_t fileId, uint32_t offset)
+{
+    uint8_t payload[APP_TRP_WMODE_TX_OFFSET_PL_NUM], idx;
+    uint16_t result = APP_RES_FAIL;
+
+    result = app_trp_common_CheckCtrlChannel(p_trpConn);
+    if (result == APP_RES_SUCCESS)
+    {
+        if(app_trp_common_CheckCtrlRspFg(p_trpConn))
+            return APP_RES_FAIL;
+
+        idx = 0;
+        payload[idx++] = TRP_GRPID_TRANSMIT;
+        payload[idx++] = APP_TRP_WMODE_TX_DATA_OFFSET;
+        put_be32(fileId, &payload[idx]);
+        idx += 4;
+        put_be32(offset, &payload[idx]);
+
+        result = app_trp_common_SendVendorCmd(p_trpConn, APP_TRP_WMODE_TX_OFFSET_PL_NUM, payload);
+        app_trp_common_SetCtrlRspFg(p_trpConn, result, APP_TRP_SEND_LENGTH_FAIL);
+    }
+
+    return result;
+}
+
 #define APP_TRP_WMODE_TX_TYPE_PL_NUM        0x03
 uint16_t APP_TRP_COMMON_SendTypeCommand(APP_TRP_ConnList_T *p_trpConn)
 {
@@ -570,13 +808,70 @@ uint16_t APP_TRP_COMMON_SendUpConnParaStatus(APP_TRP_ConnList_T *p_trpConn, uint
     return result;
 }
     
+static void app_trp_common_SrScheduleAck(APP_TRP_ConnList_T *p_trpConn)
+{
+    APP_SR_Rx_T *p_srRx = p_trpConn->p_cold->p_srRx;
+
+    if (!p_srRx->ackPending)
+        return;
+
+    // Acknowledge half a window at once so the client does not stall on a full window
+    if (APP_SR_RxAckDue(p_srRx))
+    {
+        APP_TRP_COMMON_SendSrCommand(p_trpConn, APP_TRP_WMODE_SR_ACK);
+        if (!p_srRx->ackPending)
+            return;
+    }
+
+    if (!p_srRx->ackScheduled)
+    {
+        p_srRx->ackScheduled = true;
+        APP_TIMER_SetTimer(APP_TIMER_SR_ACK, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, APP_TRP_SR_ACK_DELAY);
+    }
+}
+
+//Move the frames of the profile queue to the reorder buffer
+static void app_trp_common_SrRxFrames(APP_TRP_ConnList_T *p_trpConn)
+{
+    uint16_t frameLeng = 0;
+
+    BLE_TRSPS_GetDataLength(p_trpConn->p_deviceProxy, &frameLeng);
+    while ((frameLeng > 0) && (frameLeng <= sizeof(s_trpSrFrame)))
+    {
+        if (BLE_TRSPS_GetData(p_trpConn->p_deviceProxy, s_trpSrFrame) != APP_RES_SUCCESS)
+            break;
+
+        APP_SR_RxFrame(p_trpConn->p_cold->p_srRx, s_trpSrFrame, frameLeng);
+        BLE_TRSPS_GetDataLength(p_trpConn->p_deviceProxy, &frameLeng);
+    }
+
+    app_trp_common_SrScheduleAck(p_trpConn);
+}
+
 uint16_t APP_TRP_COMMON_GetTrpDataLength(APP_TRP_ConnList_T *p_trpConn, uint16_t *p_dataLeng)
 {
     uint16_t status = APP_RES_INVALID_PARA;
     
-    if (p_trpConn->trpRole == APP_TRP_SERVER_ROLE)
+    if (APP_REPLAY_IsReplaying())
     {
-        if (p_trpConn->type == APP_TRP_TYPE_LEGACY)
+        APP_REPLAY_GetDataLength(p_trpConn->p_deviceProxy, p_dataLeng);
+        return APP_RES_SUCCESS;
+    }
+
+    if (p_trpConn->type == APP_TRP_TYPE_TRCBP)
+    {
+        BLE_TRCBP_GetDataLength(p_trpConn->p_deviceProxy, p_dataLeng);
+        status = APP_RES_SUCCESS;
+    }
+    else if (p_trpConn->trpRole == APP_TRP_SERVER_ROLE)
+    {
+        if ((p_trpConn->type == APP_TRP_TYPE_LEGACY) && (p_trpConn->p_cold->p_srRx != NULL))
+        {
+            app_trp_common_SrRxFrames(p_trpConn);
+            *p_dataLeng = APP_SR_RxGetLength(p_trpConn->p_cold->p_srRx);
+            status = APP_RES_SUCCESS;
+        }
+        else if (p_trpConn->type == APP_TRP_TYPE_LEGACY)
         {
             BLE_TRSPS_GetDataLength(p_trpConn->p_deviceProxy, p_dataLeng);
             status = APP_RES_SUCCESS;
@@ -596,14 +891,29 @@ uint16_t APP_TRP_COMMON_GetTrpDataLength(APP_TRP_ConnList_T *p_trpConn, uint16_t
 
 uint16_t APP_TRP_COMMON_GetTrpData(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_data)
 {
-    uint16_t status = APP_RES_FAIL;
+    uint16_t status = APP_RES_FAIL, dataLeng = 0;
 
     if (p_data == NULL)
         return status;
     
-    if (p_trpConn->trpRole == APP_TRP_SERVER_ROLE)
+    if (APP_REPLAY_IsReplaying())
+        return APP_REPLAY_GetData(p_trpConn->p_deviceProxy, p_data);
+
+    if (APP_REPLAY_IsRecording())
+        APP_TRP_COMMON_GetTrpDataLength(p_trpConn, &dataLeng);
+
+    if (p_trpConn->type == APP_TRP_TYPE_TRCBP)
     {
-        if (p_trpConn->type == APP_TRP_TYPE_LEGACY)
+        status = BLE_TRCBP_GetData(p_trpConn->p_deviceProxy, p_data);
+    }
+    else if (p_trpConn->trpRole == APP_TRP_SERVER_ROLE)
+    {
+        if ((p_trpConn->type == APP_TRP_TYPE_LEGACY) && (p_trpConn->p_cold->p_srRx != NULL))
+        {
+            status = APP_SR_RxGet(p_trpConn->p_cold->p_srRx, p_data);
+            app_trp_common_SrScheduleAck(p_trpConn);
+        }
+        else if (p_trpConn->type == APP_TRP_TYPE_LEGACY)
         {
             status = BLE_TRSPS_GetData(p_trpConn->p_deviceProxy, p_data);
         }
@@ -616,9 +926,29 @@ uint16_t APP_TRP_COMMON_GetTrpData(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_dat
         }
     }
     
+    if (status == APP_RES_SUCCESS)
+        APP_REPLAY_RecordData(p_trpConn->p_deviceProxy, dataLeng, p_data);
+
     return status;
 }
 
+bool APP_TRP_COMMON_IsDlCreditBased(APP_TRP_ConnList_T *p_trpConn)
+{
+    if (APP_REPLAY_IsReplaying())
+        return APP_REPLAY_IsDlCreditBased(p_trpConn->p_deviceProxy);
+
+    return BLE_TRSPC_IsDlCreditBased(p_trpConn->p_deviceProxy);
+}
+
+void APP_TRP_COMMON_SetDataWriteCommand(APP_TRP_ConnList_T *p_trpConn, bool enable)
+{
+    //The write type only matters to BlueZ, the replayed sends complete with the recorded result
+    if (APP_REPLAY_IsReplaying())
+        return;
+
+    BLE_TRSPC_SetDataWriteCommand(p_trpConn->p_deviceProxy, enable);
+}
+
 uint16_t APP_TRP_COMMON_FreeLeData(APP_TRP_ConnList_T *p_trpConn)
 {
     uint16_t dataLeng = 0, status = APP_RES_SUCCESS;
@@ -667,44 +997,152 @@ void APP_TRP_COMMON_DelAllLeCircData(APP_UTILITY_CircQueue_T *p_circQueue)
     }
 }
 
-uint32_t APP_TRP_COMMON_CalculateCheckSum(uint32_t checkSum, uint32_t *p_dataLeng, APP_TRP_ConnList_T *p_trpConn)
+//Data plane worker side, the state of the link is only touched by its worker.
+static void app_trp_common_RxCheckWork(void *p_data)
 {
-    uint16_t tmpLeng, status;
+    APP_TRP_RxCheckJob_T *p_job = (APP_TRP_RxCheckJob_T *)p_data;
+    APP_TRP_RxCheck_T *p_check = &sp_trpRxCheck[p_job->link];
+    uint16_t fixPatternData;
     uint32_t i;
-    uint8_t *p_data = NULL;
 
-    if (((*p_dataLeng) == 0) || (p_trpConn == NULL))
-        return checkSum;
+    if (p_check->runId != p_job->runId)
+    {
+        memset(p_check, 0, sizeof(APP_TRP_RxCheck_T));
+        p_check->runId = p_job->runId;
+    }
 
-    status = APP_TRP_COMMON_GetTrpDataLength(p_trpConn, &tmpLeng);
-    if (status != APP_RES_SUCCESS)
-        return checkSum;
+    p_check->rxAccuLeng += p_job->dataLeng;
 
-    while (tmpLeng > 0)
+    if (p_job->type == APP_TRP_RX_CHECK_SUM)
     {
-        p_data = malloc(tmpLeng);
-        if (p_data != NULL)
+        for (i = 0; i < p_job->dataLeng; i++)
+            p_check->checkSum += p_job->p_data[i];
+    }
+    else if ((p_job->type == APP_TRP_RX_CHECK_PATTERN) && !p_check->failed)
+    {
+        for (i = 0; i + 1 < p_job->dataLeng; i += 2)
         {
-            status = APP_TRP_COMMON_GetTrpData(p_trpConn, p_data);
-            if (status == APP_RES_SUCCESS)
+            fixPatternData = get_be16(&p_job->p_data[i]);
+
+            if (p_check->rxLastNumber != fixPatternData)
             {
-                for (i = 0; i < tmpLeng; i++)
-                    checkSum += p_data[i];
-                if ((*p_dataLeng) > tmpLeng)
-                    *p_dataLeng -= tmpLeng;
-                else
-                    *p_dataLeng = 0;
-            }
-            free(p_data);
-            if ((*p_dataLeng) == 0)
+                //Reported by the done step, the worker does not print
+                p_job->mismatch = true;
+                p_job->mismatchNumber = fixPatternData;
+                p_check->failed = true;
                 break;
-            status = APP_TRP_COMMON_GetTrpDataLength(p_trpConn, &tmpLeng);
-            if (status != APP_RES_SUCCESS)
-                return checkSum;
+            }
+            else
+                (p_check->rxLastNumber)++;
         }
+    }
+
+    p_job->result = *p_check;
+}
+
+static void app_trp_common_RxCheckDone(void *p_data)
+{
+    APP_TRP_RxCheckJob_T *p_job = (APP_TRP_RxCheckJob_T *)p_data;
+    APP_TRP_ConnList_T *p_trpConn;
+
+    if (p_job->mismatch)
+        printf("number mismatch[%04x, %04x]\n", p_job->result.rxLastNumber, p_job->mismatchNumber);
+
+    //The link is gone or a new run started while the job was queued
+    p_trpConn = APP_TRP_COMMON_GetConnListByIndex(p_job->link);
+    if ((p_trpConn != NULL) && (p_trpConn->rxCheckRunId == p_job->runId))
+    {
+        p_trpConn->rxLastNunber = p_job->result.rxLastNumber;
+        p_trpConn->rxAccuLeng = p_job->result.rxAccuLeng;
+        if (p_job->type == APP_TRP_RX_CHECK_SUM)
+            p_trpConn->checkSum = p_job->result.checkSum;
+
+        if (p_job->p_cb != NULL)
+            p_job->p_cb(p_trpConn, p_job->result.failed ? APP_RES_FAIL : APP_RES_SUCCESS, p_job->dataLeng);
+    }
+
+    free(p_job->p_data);
+    free(p_job);
+}
+
+static void app_trp_common_SubmitRxCheck(APP_TRP_ConnList_T *p_trpConn, uint8_t type, uint8_t *p_data, uint32_t dataLeng,
+    APP_TRP_RxCheckCb_T p_cb)
+{
+    APP_TRP_RxCheckJob_T *p_job;
+
+    p_job = calloc(1, sizeof(APP_TRP_RxCheckJob_T));
+    if (p_job == NULL)
+    {
+        free(p_data);
+        if (p_cb != NULL)
+            p_cb(p_trpConn, APP_RES_OOM, 0);
+        return;
+    }
+
+    p_job->link = APP_TRP_COMMON_GetConnIndex(p_trpConn);
+    p_job->type = type;
+    p_job->runId = p_trpConn->rxCheckRunId;
+    p_job->dataLeng = dataLeng;
+    p_job->p_data = p_data;
+    p_job->p_cb = p_cb;
+
+    APP_DP_Submit(p_job->link, app_trp_common_RxCheckWork, app_trp_common_RxCheckDone, p_job);
+}
+
+//Move the received data of the link out of the profile into one buffer, until maxLeng bytes are taken.
+static uint8_t *app_trp_common_PullTrpData(APP_TRP_ConnList_T *p_trpConn, uint32_t maxLeng, uint32_t *p_leng)
+{
+    uint8_t *p_buf = NULL, *p_newBuf;
+    uint16_t tmpLeng;
+
+    *p_leng = 0;
+
+    while ((*p_leng < maxLeng) && (APP_TRP_COMMON_GetTrpDataLength(p_trpConn, &tmpLeng) == APP_RES_SUCCESS)
+        && (tmpLeng > 0))
+    {
+        p_newBuf = realloc(p_buf, *p_leng + tmpLeng);
+        if (p_newBuf == NULL)
+            break;
+        p_buf = p_newBuf;
+
+        if (APP_TRP_COMMON_GetTrpData(p_trpConn, p_buf + *p_leng) != APP_RES_SUCCESS)
+            break;
+        *p_leng += tmpLeng;
+    }
+
+    return p_buf;
+}
+
+void APP_TRP_COMMON_ResetRxCheck(APP_TRP_ConnList_T *p_trpConn)
+{
+    //The worker of the link starts its state over with the first job of the new run
+    p_trpConn->rxCheckRunId = ++s_trpRxCheckRunId;
+    p_trpConn->rxLastNunber = 0;
+    p_trpConn->rxAccuLeng = 0;
+    p_trpConn->checkSum = 0;
+}
+
+void APP_TRP_COMMON_CalculateCheckSum(uint32_t *p_dataLeng, APP_TRP_ConnList_T *p_trpConn, APP_TRP_RxCheckCb_T p_cb)
+{
+    uint8_t *p_data;
+    uint32_t leng;
+
+    if (((*p_dataLeng) == 0) || (p_trpConn == NULL))
+        return;
+
+    p_data = app_trp_common_PullTrpData(p_trpConn, *p_dataLeng, &leng);
+    if (leng > 0)
+    {
+        if ((*p_dataLeng) > leng)
+            *p_dataLeng -= leng;
         else
-            return checkSum;
+            *p_dataLeng = 0;
+
+        //The callback gets the check sum once the last byte is added
+        app_trp_common_SubmitRxCheck(p_trpConn, APP_TRP_RX_CHECK_SUM, p_data, leng, (*p_dataLeng == 0) ? p_cb : NULL);
     }
+    else
+        free(p_data);
 
     //Start a timer then reset the timer every time the device receives the data
     //If timeout occurs, send out current checksum directly.
@@ -712,8 +1150,6 @@ uint32_t APP_TRP_COMMON_CalculateCheckSum(uint32_t checkSum, uint32_t *p_dataLen
     {
         APP_TIMER_SetTimer(APP_TIMER_PROTOCOL_RSP, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, APP_TIMER_3S);
     }
-
-    return checkSum;
 }
 
 uint8_t * APP_TRP_COMMON_GenFixPattern(uint16_t *p_startSeqNum, uint16_t *p_patternLeng,
@@ -760,24 +1196,24 @@ uint16_t APP_TRP_COMMON_UpdateFixPatternLen(APP_TRP_ConnList_T *p_trpConn)
 
     if (p_trpConn->type == APP_TRP_TYPE_LEGACY)   //Legacy TRPS
     {
-        if (p_trpConn->fixPattMaxSize > p_trpConn->txMTU)
+        if (p_trpConn->p_cold->fixPattMaxSize > p_trpConn->txMTU)
         {
             patternLeng = p_trpConn->txMTU;
         }
         else
         {
-            patternLeng = p_trpConn->fixPattMaxSize;
+            patternLeng = p_trpConn->p_cold->fixPattMaxSize;
         }
     }
     else if (p_trpConn->channelEn & APP_TRCBP_DATA_CHAN_ENABLE)       //TRCBPS
     {
-        if (p_trpConn->fixPattMaxSize > p_trpConn->fixPattTrcbpMtu)
+        if (p_trpConn->p_cold->fixPattMaxSize > p_trpConn->p_cold->fixPattTrcbpMtu)
         {
-            patternLeng = p_trpConn->fixPattTrcbpMtu;
+            patternLeng = p_trpConn->p_cold->fixPattTrcbpMtu;
         }
         else
         {
-            patternLeng = p_trpConn->fixPattMaxSize;
+            patternLeng = p_trpConn->p_cold->fixPattMaxSize;
         }
     }
 
@@ -786,10 +1222,9 @@ uint16_t APP_TRP_COMMON_UpdateFixPatternLen(APP_TRP_ConnList_T *p_trpConn)
 
 void APP_TRP_COMMON_InitFixPatternParam(APP_TRP_ConnList_T *p_trpConn)
 {
-    p_trpConn->fixPattMaxSize = APP_TRP_WMODE_TX_MAX_SIZE;
+    p_trpConn->p_cold->fixPattMaxSize = APP_TRP_WMODE_TX_MAX_SIZE;
     p_trpConn->lastNumber = 0;
-    p_trpConn->rxLastNunber = 0;
-    p_trpConn->checkSum = 0;
+    APP_TRP_COMMON_ResetRxCheck(p_trpConn);
 }
 
 uint16_t APP_TRP_COMMON_SendFixPatternFirstPkt(APP_TRP_ConnList_T *p_trpConn)
@@ -800,12 +1235,12 @@ uint16_t APP_TRP_COMMON_SendFixPatternFirstPkt(APP_TRP_ConnList_T *p_trpConn)
     if (p_trpConn->type == APP_TRP_TYPE_LEGACY)
     {
         p_trsBuf = APP_TRP_COMMON_GenFixPattern(&(p_trpConn->lastNumber), &(p_trpConn->txMTU), 
-            &(p_trpConn->fixPattMaxSize), &(p_trpConn->checkSum));
+            &(p_trpConn->p_cold->fixPattMaxSize), &(p_trpConn->checkSum));
     }
     else if (p_trpConn->channelEn & APP_TRCBP_DATA_CHAN_ENABLE)
     {
-        p_trsBuf = APP_TRP_COMMON_GenFixPattern(&(p_trpConn->lastNumber), &(p_trpConn->fixPattTrcbpMtu), 
-            &(p_trpConn->fixPattMaxSize), &(p_trpConn->checkSum));
+        p_trsBuf = APP_TRP_COMMON_GenFixPattern(&(p_trpConn->lastNumber), &(p_trpConn->p_cold->fixPattTrcbpMtu),
+            &(p_trpConn->p_cold->fixPattMaxSize), &(p_trpConn->checkSum));
     }
 
     if (p_trsBuf == NULL)
@@ -817,7 +1252,7 @@ uint16_t APP_TRP_COMMON_SendFixPatternFirstPkt(APP_TRP_ConnList_T *p_trpConn)
     }
     else if (p_trpConn->channelEn & APP_TRCBP_DATA_CHAN_ENABLE)
     {
-        dataLength = p_trpConn->fixPattTrcbpMtu;
+        dataLength = p_trpConn->p_cold->fixPattTrcbpMtu;
     }
     
     status = app_trp_common_SendLeData(p_trpConn, dataLength, p_trsBuf);
@@ -825,7 +1260,7 @@ uint16_t APP_TRP_COMMON_SendFixPatternFirstPkt(APP_TRP_ConnList_T *p_trpConn)
     if (status != APP_RES_SUCCESS)
     {
         p_trpConn->lastNumber = 0;
-        p_trpConn->fixPattMaxSize = APP_TRP_WMODE_TX_MAX_SIZE;
+        p_trpConn->p_cold->fixPattMaxSize = APP_TRP_WMODE_TX_MAX_SIZE;
     }
 
     free(p_trsBuf);
@@ -843,10 +1278,10 @@ uint16_t APP_TRP_COMMON_SendFixPattern(APP_TRP_ConnList_T *p_trpConn)
     patternLeng = APP_TRP_COMMON_UpdateFixPatternLen(p_trpConn);
 
     lastNum = p_trpConn->lastNumber;
-    leftSize = p_trpConn->fixPattMaxSize;
+    leftSize = p_trpConn->p_cold->fixPattMaxSize;
     lastCheckSum = p_trpConn->checkSum;
 
-    p_data = APP_TRP_COMMON_GenFixPattern(&(p_trpConn->lastNumber), &(patternLeng), &(p_trpConn->fixPattMaxSize),
+    p_data = APP_TRP_COMMON_GenFixPattern(&(p_trpConn->lastNumber), &(patternLeng), &(p_trpConn->p_cold->fixPattMaxSize),
         &(p_trpConn->checkSum));
 
     if (p_data == NULL)
@@ -861,7 +1296,7 @@ uint16_t APP_TRP_COMMON_SendFixPattern(APP_TRP_ConnList_T *p_trpConn)
         if (status == APP_RES_SUCCESS)
         {
             validNum--;
-            if (p_trpConn->fixPattMaxSize == 0)
+            if (p_trpConn->p_cold->fixPattMaxSize == 0)
             {
                 status |= APP_RES_COMPLETE;
                 return status;
@@ -873,11 +1308,11 @@ uint16_t APP_TRP_COMMON_SendFixPattern(APP_TRP_ConnList_T *p_trpConn)
                     patternLeng = APP_TRP_COMMON_UpdateFixPatternLen(p_trpConn);
 
                     lastNum = p_trpConn->lastNumber;
-                    leftSize = p_trpConn->fixPattMaxSize;
+                    leftSize = p_trpConn->p_cold->fixPattMaxSize;
                     lastCheckSum = p_trpConn->checkSum;
 
                     p_data = APP_TRP_COMMON_GenFixPattern(&(p_trpConn->lastNumber), &(patternLeng), 
-                        &(p_trpConn->fixPattMaxSize), &(p_trpConn->checkSum));
+                        &(p_trpConn->p_cold->fixPattMaxSize), &(p_trpConn->checkSum));
 
                     if (p_data == NULL)
                         return APP_RES_OOM;
@@ -892,7 +1327,7 @@ uint16_t APP_TRP_COMMON_SendFixPattern(APP_TRP_ConnList_T *p_trpConn)
         else
         {
             p_trpConn->lastNumber = lastNum;
-            p_trpConn->fixPattMaxSize = leftSize;
+            p_trpConn->p_cold->fixPattMaxSize = leftSize;
             p_trpConn->checkSum = lastCheckSum;
 
             break;
@@ -914,10 +1349,10 @@ uint16_t APP_TRP_COMMON_SendMultiLinkFixPattern(APP_TRP_TrafficPriority_T *p_con
     
     patternLeng = APP_TRP_COMMON_UpdateFixPatternLen(p_trpConn);
     lastNum = p_trpConn->lastNumber;
-    leftSize = p_trpConn->fixPattMaxSize;
+    leftSize = p_trpConn->p_cold->fixPattMaxSize;
     lastCheckSum = p_trpConn->checkSum;
 
-    p_data = APP_TRP_COMMON_GenFixPattern(&(p_trpConn->lastNumber), &(patternLeng), &(p_trpConn->fixPattMaxSize), &(p_trpConn->checkSum));
+    p_data = APP_TRP_COMMON_GenFixPattern(&(p_trpConn->lastNumber), &(patternLeng), &(p_trpConn->p_cold->fixPattMaxSize), &(p_trpConn->checkSum));
 
     if (p_data != NULL)
     {
@@ -930,7 +1365,7 @@ uint16_t APP_TRP_COMMON_SendMultiLinkFixPattern(APP_TRP_TrafficPriority_T *p_con
             p_connToken->validNumber--;
             p_trpConn->maxAvailTxNumber--;
             
-            if (p_trpConn->fixPattMaxSize == 0)
+            if (p_trpConn->p_cold->fixPattMaxSize == 0)
             {
                 status |= APP_RES_COMPLETE;
                 return status;
@@ -939,7 +1374,7 @@ uint16_t APP_TRP_COMMON_SendMultiLinkFixPattern(APP_TRP_TrafficPriority_T *p_con
         else
         {
             p_trpConn->lastNumber = lastNum;
-            p_trpConn->fixPattMaxSize = leftSize;
+            p_trpConn->p_cold->fixPattMaxSize = leftSize;
             p_trpConn->checkSum = lastCheckSum;
         }
     }
@@ -949,63 +1384,149 @@ uint16_t APP_TRP_COMMON_SendMultiLinkFixPattern(APP_TRP_TrafficPriority_T *p_con
     return status;
 }
 
-uint16_t APP_TRP_COMMON_CheckFixPatternData(APP_TRP_ConnList_T *p_trpConn)
+//The data is checked by the data plane worker of the link, the callback gets the result on the main loop.
+void APP_TRP_COMMON_CheckFixPatternData(APP_TRP_ConnList_T *p_trpConn, APP_TRP_RxCheckCb_T p_cb)
 {
-    uint16_t tmpLeng, status = APP_RES_SUCCESS, i, fixPatternData;
-    uint8_t *p_data = NULL;
+    uint8_t *p_data;
+    uint32_t dataLeng;
 
     if (p_trpConn == NULL)
-        return APP_RES_INVALID_PARA;
-
-    status = APP_TRP_COMMON_GetTrpDataLength(p_trpConn, &tmpLeng);
-    
-    if (status != APP_RES_SUCCESS)
-        return status;
+        return;
 
-    while (tmpLeng > 0)
+    p_data = app_trp_common_PullTrpData(p_trpConn, UINT32_MAX, &dataLeng);
+    if (dataLeng == 0)
     {
-        p_trpConn->rxAccuLeng += tmpLeng;
-        p_data = malloc(tmpLeng);
-        
-        if (p_data != NULL)
+        free(p_data);
+        return;
+    }
+
+    app_trp_common_SubmitRxCheck(p_trpConn, APP_TRP_RX_CHECK_PATTERN, p_data, dataLeng, p_cb);
+}
+
+void APP_TRP_COMMON_FlushRxCheck(APP_TRP_ConnList_T *p_trpConn, APP_TRP_RxCheckCb_T p_cb)
+{
+    app_trp_common_SubmitRxCheck(p_trpConn, APP_TRP_RX_CHECK_FLUSH, NULL, 0, p_cb);
+}
+
+
+//Reassemble the received blocks and write the decoded data to the console.
+//The data is consumed in any case, a corrupted block is dropped.
+static uint16_t app_trp_common_DecodeUartData(APP_TRP_ConnList_T *p_trpConn, uint16_t dataLeng, uint8_t *p_rxBuf)
+{
+    APP_TRP_Compress_T *p_compress = p_trpConn->p_cold->p_compress;
+    uint16_t copyLen, needLen, rawLeng, encLeng, decLeng = 0;
+    uint16_t status;
+
+    while (dataLeng > 0)
+    {
+        if (p_compress->rxBlockLeng < APP_TRP_COMPRESS_BLOCK_HDR_SIZE)
         {
-            status = APP_TRP_COMMON_GetTrpData(p_trpConn, p_data);
-            
-            if (status == APP_RES_SUCCESS)
-            {
-                for (i = 0; i < tmpLeng; i += 2)
-                {
-                    fixPatternData = p_data[i];
-                    fixPatternData = (fixPatternData << 8) | p_data[i+1];
-                    
-                    if (p_trpConn->rxLastNunber != fixPatternData)
-                    {
-                        printf("number mismatch[%04x, %04x]\n", p_trpConn->rxLastNunber, fixPatternData);
-                        status = APP_RES_FAIL;
-                        break;
-                    }
-                    else
-                        (p_trpConn->rxLastNunber)++;
-                }
-            }
-            
-            free(p_data);
+            needLen = APP_TRP_COMPRESS_BLOCK_HDR_SIZE - p_compress->rxBlockLeng;
+        }
+        else
+        {
+            encLeng = get_be16(&p_compress->rxBlock[3]);
+            needLen = APP_TRP_COMPRESS_BLOCK_HDR_SIZE + encLeng - p_compress->rxBlockLeng;
+        }
 
-            if (status != APP_RES_SUCCESS)
-                break;
-            
-            status = APP_TRP_COMMON_GetTrpDataLength(p_trpConn, &tmpLeng);
-            
-            if (status != APP_RES_SUCCESS)
-                return status;
+        copyLen = (dataLeng < needLen) ? dataLeng : needLen;
+        memcpy(&p_compress->rxBlock[p_compress->rxBlockLeng], p_rxBuf, copyLen);
+        p_compress->rxBlockLeng += copyLen;
+        p_rxBuf += copyLen;
+        dataLeng -= copyLen;
+
+        if (p_compress->rxBlockLeng < APP_TRP_COMPRESS_BLOCK_HDR_SIZE)
+            break;
+
+        rawLeng = get_be16(&p_compress->rxBlock[1]);
+        encLeng = get_be16(&p_compress->rxBlock[3]);
+        if ((p_compress->rxBlock[0] > APP_TRP_COMPRESS_BLOCK_LZ) || (rawLeng == 0)
+            || (rawLeng > APP_TRP_COMPRESS_BLOCK_SIZE) || (encLeng == 0) || (encLeng > APP_TRP_COMPRESS_BLOCK_SIZE))
+        {
+            APP_LOG_ERROR("Compressed block header error, %d bytes dropped\n", dataLeng + copyLen);
+            p_compress->rxErrors++;
+            p_compress->rxBlockLeng = 0;
+            break;
+        }
+
+        if (p_compress->rxBlockLeng < APP_TRP_COMPRESS_BLOCK_HDR_SIZE + encLeng)
+            continue;
+
+        p_compress->rxBlockLeng = 0;
+        p_compress->rxEncLeng += APP_TRP_COMPRESS_BLOCK_HDR_SIZE + encLeng;
+        if (p_compress->rxBlock[0] == APP_TRP_COMPRESS_BLOCK_STORED)
+        {
+            status = (encLeng == rawLeng) ? APP_RES_SUCCESS : APP_RES_FAIL;
+            memcpy(p_compress->rxRaw, &p_compress->rxBlock[APP_TRP_COMPRESS_BLOCK_HDR_SIZE], encLeng);
+            decLeng = encLeng;
         }
         else
-            return APP_RES_OOM;
+        {
+            status = APP_LZ_Decompress(&p_compress->rxBlock[APP_TRP_COMPRESS_BLOCK_HDR_SIZE], encLeng,
+                p_compress->rxRaw, APP_TRP_COMPRESS_BLOCK_SIZE, &decLeng);
+        }
+
+        if ((status != APP_RES_SUCCESS) || (decLeng != rawLeng))
+        {
+            APP_LOG_ERROR("Compressed block error, %d bytes dropped\n", encLeng);
+            p_compress->rxErrors++;
+            continue;
+        }
+
+        p_compress->rxRawLeng += rawLeng;
+        if (APP_ConsoleWrite(p_trpConn->p_deviceProxy, rawLeng, p_compress->rxRaw) != APP_RES_SUCCESS)
+        {
+            APP_LOG_ERROR("Decoded block of %d bytes is not written\n", rawLeng);
+        }
     }
 
-    return status;
+    return APP_RES_SUCCESS;
 }
 
+//Serve the encoded blocks to the packetizer, the next block is encoded once the current one is sent
+static uint16_t app_trp_common_EncodeUartData(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_buffer, uint16_t len)
+{
+    APP_TRP_Compress_T *p_compress = p_trpConn->p_cold->p_compress;
+    uint16_t copyLen, readLen = 0, rawLeng, encLeng;
+    uint8_t blockType;
+
+    while (readLen < len)
+    {
+        if (p_compress->txBlockOffset == p_compress->txBlockLeng)
+        {
+            rawLeng = APP_ConsoleRead(p_trpConn->p_deviceProxy, p_compress->txRaw, APP_TRP_COMPRESS_BLOCK_SIZE);
+            if (rawLeng == 0)
+                break;
+
+            blockType = APP_TRP_COMPRESS_BLOCK_LZ;
+            encLeng = APP_LZ_Compress(p_compress->txRaw, rawLeng, &p_compress->txBlock[APP_TRP_COMPRESS_BLOCK_HDR_SIZE],
+                rawLeng - 1);
+            if (encLeng == 0)
+            {
+                blockType = APP_TRP_COMPRESS_BLOCK_STORED;
+                memcpy(&p_compress->txBlock[APP_TRP_COMPRESS_BLOCK_HDR_SIZE], p_compress->txRaw, rawLeng);
+                encLeng = rawLeng;
+            }
+
+            p_compress->txBlock[0] = blockType;
+            put_be16(rawLeng, &p_compress->txBlock[1]);
+            put_be16(encLeng, &p_compress->txBlock[3]);
+            p_compress->txBlockLeng = APP_TRP_COMPRESS_BLOCK_HDR_SIZE + encLeng;
+            p_compress->txBlockOffset = 0;
+            p_compress->txRawLeng += rawLeng;
+            p_compress->txEncLeng += p_compress->txBlockLeng;
+        }
+
+        copyLen = p_compress->txBlockLeng - p_compress->txBlockOffset;
+        if (copyLen > len - readLen)
+            copyLen = len - readLen;
+        memcpy(p_buffer + readLen, &p_compress->txBlock[p_compress->txBlockOffset], copyLen);
+        p_compress->txBlockOffset += copyLen;
+        readLen += copyLen;
+    }
+
+    return readLen;
+}
 
 uint16_t APP_TRP_COMMON_SendLeDataToFile(APP_TRP_ConnList_T *p_trpConn, uint16_t dataLeng, uint8_t *p_rxBuf)
 {
@@ -1019,7 +1540,10 @@ uint16_t APP_TRP_COMMON_SendLeDataToFile(APP_TRP_ConnList_T *p_trpConn, uint16_t
         }
         else if (p_trpConn->workMode == TRP_WMODE_UART)
         {
-            status = APP_ConsoleWrite(p_trpConn->p_deviceProxy, dataLeng, p_rxBuf);
+            if ((p_trpConn->p_cold->p_compress != NULL) && (p_trpConn->p_cold->p_compress->rxEn))
+                status = app_trp_common_DecodeUartData(p_trpConn, dataLeng, p_rxBuf);
+            else
+                status = APP_ConsoleWrite(p_trpConn->p_deviceProxy, dataLeng, p_rxBuf);
         }
     }
 
@@ -1076,7 +1600,7 @@ void APP_TRP_COMMON_SendTrpProfileDataToUART(APP_TRP_ConnList_T *p_trpConn)
             {
                 if (dataLeng)
                 {
-                    p_data = malloc(dataLeng);
+                    p_data = APP_MEM_Alloc(APP_GetFileTransIndex(p_trpConn->p_deviceProxy), APP_MEM_CAT_LE_QUEUE, dataLeng);
                     
                     if (p_data != NULL)
                     {
@@ -1088,7 +1612,7 @@ void APP_TRP_COMMON_SendTrpProfileDataToUART(APP_TRP_ConnList_T *p_trpConn)
 
                             if (status == APP_RES_SUCCESS)
                             {
-                                free(p_data);
+                                APP_MEM_Free(p_data);
                                 validNum--;
                             }
                             else
@@ -1114,24 +1638,28 @@ void APP_TRP_COMMON_SendTrpProfileDataToUART(APP_TRP_ConnList_T *p_trpConn)
                                     }
                                     else
                                     {
-                                        free(p_data);
+                                        APP_MEM_Free(p_data);
                                     }
                                 }
                                 else
                                 {
-                                    free(p_data);
+                                    APP_MEM_Free(p_data);
                                 }
                                 return;
                             }
                         }
                         else
                         {
-                            free(p_data);
+                            APP_MEM_Free(p_data);
                             validNum--;
                         }
                     }
                     else
+                    {
+                        // Out of budget, the data waits in the profile queue until buffers are released
+                        s_trpMemStallMask |= 1ULL << trpIdx;
                         return;
+                    }
                 }
                 else
                     return;
@@ -1149,11 +1677,28 @@ void APP_TRP_COMMON_SendTrpProfileDataToUART(APP_TRP_ConnList_T *p_trpConn)
     }
 }
 
+//Buffers are released, resume the links stalled out of budget. A link refused again stalls again.
+static void app_trp_common_MemReleased(void)
+{
+    uint64_t stallMask = s_trpMemStallMask & s_trpLinkMask;
+    uint8_t index;
+
+    s_trpMemStallMask = 0;
+    while (stallMask != 0)
+    {
+        index = (uint8_t)__builtin_ctzll(stallMask);
+        stallMask &= stallMask - 1;
+        APP_TRP_COMMON_SendTrpProfileDataToUART(&sp_trpConnList[index]);
+    }
+}
+
 uint16_t APP_TRP_COMMON_InsertUartDataToCircQueue(APP_TRP_ConnList_T *p_trpConn, 
     APP_TRP_GenData_T *p_rxData)
 {
     uint16_t status = APP_RES_SUCCESS;
 
+    uint16_t dataLeng = p_rxData->srcOffset;
+
     status = APP_UTILITY_InsertDataToCircQueue(p_rxData->srcOffset, p_rxData->p_srcData, &(p_trpConn->uartCircQueue));
     if (status == APP_RES_NO_RESOURCE)
     {
@@ -1161,8 +1706,15 @@ uint16_t APP_TRP_COMMON_InsertUartDataToCircQueue(APP_TRP_ConnList_T *p_trpConn,
     }
     else
     {
+        if ((status == APP_RES_SUCCESS) && (p_trpConn->workMode == TRP_WMODE_UART))
+        {
+            p_trpConn->p_cold->uartTxPkts++;
+            p_trpConn->p_cold->uartTxPayload += dataLeng;
+            p_trpConn->p_cold->uartTxRoom += p_trpConn->lePktLeng;
+        }
+
         if ((status == APP_RES_INVALID_PARA) && (p_rxData->p_srcData != NULL))
-            free(p_rxData->p_srcData);
+            APP_MEM_Free(p_rxData->p_srcData);
         
         p_rxData->p_srcData = NULL;
         p_rxData->srcOffset = 0;
@@ -1174,7 +1726,7 @@ uint16_t APP_TRP_COMMON_InsertUartDataToCircQueue(APP_TRP_ConnList_T *p_trpConn,
 uint16_t APP_TRP_COMMON_CopyUartRxData(APP_TRP_ConnList_T *p_trpConn, APP_TRP_GenData_T *p_rxData)
 { 
     uint16_t status = APP_RES_SUCCESS, readLeng, dataLeng;
-    bool insertDataFlag;
+    bool insertDataFlag, holdFlag = false;
 
     //printf("CopyUartRxData(%d,%d,%d)\n", p_rxData->srcOffset, p_rxData->rxLeng, p_trpConn->lePktLeng);
     
@@ -1185,7 +1737,9 @@ uint16_t APP_TRP_COMMON_CopyUartRxData(APP_TRP_ConnList_T *p_trpConn, APP_TRP_Ge
     }
     else if (p_rxData->rxLeng > 0)
     {
-        insertDataFlag = true;
+        // Hold a partial UART packet until it is full or the hold time expires
+        holdFlag = ((s_trpUartHoldMs > 0) && (p_trpConn->workMode == TRP_WMODE_UART));
+        insertDataFlag = !holdFlag;
         dataLeng = p_rxData->rxLeng;
     }
     else
@@ -1197,6 +1751,18 @@ uint16_t APP_TRP_COMMON_CopyUartRxData(APP_TRP_ConnList_T *p_trpConn, APP_TRP_Ge
     {
         readLeng = APP_FileRead(p_trpConn->p_deviceProxy, p_rxData->p_srcData + p_rxData->srcOffset, dataLeng);
     }
+    else if ((p_trpConn->workMode == TRP_WMODE_UART) && (p_trpConn->p_cold->p_compress != NULL) && (p_trpConn->p_cold->p_compress->txEn))
+    {
+        readLeng = app_trp_common_EncodeUartData(p_trpConn, p_rxData->p_srcData + p_rxData->srcOffset, dataLeng);
+
+        // The encoded data may be shorter than requested at the end of the raw data
+        if (readLeng < dataLeng)
+        {
+            p_rxData->rxLeng = readLeng;
+            if ((readLeng == 0) && (p_rxData->srcOffset == 0))
+                return APP_RES_SUCCESS;
+        }
+    }
     else if (p_trpConn->workMode == TRP_WMODE_UART)
     {
         readLeng = APP_ConsoleRead(p_trpConn->p_deviceProxy, p_rxData->p_srcData + p_rxData->srcOffset, dataLeng);
@@ -1206,12 +1772,22 @@ uint16_t APP_TRP_COMMON_CopyUartRxData(APP_TRP_ConnList_T *p_trpConn, APP_TRP_Ge
         return APP_RES_FAIL;
     }
     
+    // The hold time is counted from the first byte of the packet
+    if (holdFlag && (p_rxData->srcOffset == 0) && (readLeng > 0))
+    {
+        APP_TIMER_SetTimer(APP_TIMER_UART_HOLD, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, s_trpUartHoldMs);
+    }
+
     p_rxData->rxLeng -= readLeng;
     p_rxData->srcOffset += readLeng;
 
     if (insertDataFlag)
     {
         status = APP_TRP_COMMON_InsertUartDataToCircQueue(p_trpConn, p_rxData);
+
+        // The held packet is queued full, the hold timer is only kept to retry a packet not queued
+        if ((status != APP_RES_NO_RESOURCE) && (p_trpConn->workMode == TRP_WMODE_UART))
+            APP_TIMER_StopTimer(APP_TIMER_UART_HOLD, APP_TRP_COMMON_GetConnIndex(p_trpConn));
     }
 
     return status;
@@ -1315,7 +1891,7 @@ uint16_t APP_TRP_COMMON_SendMultiLinkLeDataTrpProfile(APP_TRP_TrafficPriority_T
         
         if (dataLeng)
         {
-            p_data = malloc(dataLeng);
+            p_data = APP_MEM_Alloc(APP_GetFileTransIndex(p_trpConn->p_deviceProxy), APP_MEM_CAT_LE_QUEUE, dataLeng);
             
             if (p_data != NULL)
             {
@@ -1329,7 +1905,7 @@ uint16_t APP_TRP_COMMON_SendMultiLinkLeDataTrpProfile(APP_TRP_TrafficPriority_T
                     {
                         p_connToken->validNumber--;
                         p_trpConn->maxAvailTxNumber--;
-                        free(p_data);
+                        APP_MEM_Free(p_data);
                     }
                     else
                     {            
@@ -1344,7 +1920,7 @@ uint16_t APP_TRP_COMMON_SendMultiLinkLeDataTrpProfile(APP_TRP_TrafficPriority_T
                             {
                                 p_connToken->validNumber--;
                                 p_trpConn->maxAvailTxNumber--;
-                                free(p_data);
+                                APP_MEM_Free(p_data);
                                 toTree = true;
                             }
                         }
@@ -1352,7 +1928,7 @@ uint16_t APP_TRP_COMMON_SendMultiLinkLeDataTrpProfile(APP_TRP_TrafficPriority_T
                         {
                             p_connToken->validNumber--;
                             p_trpConn->maxAvailTxNumber--;
-                            free(p_data);
+                            APP_MEM_Free(p_data);
                             toTree = true;
                         }
                         APP_LOG_ERROR("LE Tx err2(0x%x,%d)\n", status, toTree);
@@ -1361,7 +1937,7 @@ uint16_t APP_TRP_COMMON_SendMultiLinkLeDataTrpProfile(APP_TRP_TrafficPriority_T
                 else
                 {
                     //can't find current link or there is no data in the queue.
-                    free(p_data);
+                    APP_MEM_Free(p_data);
                     p_trpConn->maxAvailTxNumber = 0; //change link
                 }
             }
@@ -1395,7 +1971,9 @@ uint16_t APP_TRP_COMMON_UartRxData(APP_TRP_GenData_T *p_rxData, APP_TRP_ConnList
     
     if (p_trpConn->lePktLeng == 0)
     {
-        if (p_trpConn->txMTU > 0)
+        if ((p_trpConn->txMTU > 0) && (p_trpConn->p_cold->p_srTx != NULL) && (p_trpConn->p_cold->p_srTx->active))
+            p_trpConn->lePktLeng = p_trpConn->txMTU - APP_SR_HDR_SIZE;
+        else if (p_trpConn->txMTU > 0)
             p_trpConn->lePktLeng = p_trpConn->txMTU;
         else
             p_trpConn->lePktLeng = BLE_ATT_MAX_MTU_LEN - ATT_HANDLE_VALUE_HEADER_SIZE;
@@ -1417,7 +1995,8 @@ uint16_t APP_TRP_COMMON_UartRxData(APP_TRP_GenData_T *p_rxData, APP_TRP_ConnList
             if (validNum > 0)   // Limit transmission number
             {
                 // Get Rx buffer.
-                p_rxData->p_srcData = malloc(p_trpConn->lePktLeng);
+                p_rxData->p_srcData = APP_MEM_Alloc(APP_GetFileTransIndex(p_trpConn->p_deviceProxy), APP_MEM_CAT_UART_QUEUE,
+                    p_trpConn->lePktLeng);
                 if (p_rxData->p_srcData == NULL)
                 {
                     status = APP_RES_OOM;
@@ -1474,12 +2053,259 @@ void APP_TRP_COMMON_FetchTxData(DeviceProxy *p_devProxy, uint16_t dataLeng)
 }
 
 
+uint16_t APP_TRP_COMMON_SetUartHoldTime(uint16_t holdMs)
+{
+    if (holdMs > APP_TRP_UART_HOLD_MAX_MS)
+        return APP_RES_INVALID_PARA;
+
+    s_trpUartHoldMs = holdMs;
+
+    return APP_RES_SUCCESS;
+}
+
+uint16_t APP_TRP_COMMON_GetUartHoldTime(void)
+{
+    return s_trpUartHoldMs;
+}
+
+void APP_TRP_COMMON_UartHoldTimeout(APP_TRP_ConnList_T *p_trpConn)
+{
+    APP_TRP_GenData_T *p_genData = NULL;
+    uint16_t status = APP_RES_SUCCESS;
+
+    if ((p_trpConn == NULL) || (p_trpConn->p_deviceProxy == NULL))
+        return;
+
+    p_genData = app_trp_common_GetInputData(p_trpConn->p_deviceProxy);
+    if (p_genData == NULL)
+        return;
+
+    if ((p_genData->p_srcData != NULL) && (p_genData->srcOffset > 0))
+    {
+        status = APP_TRP_COMMON_InsertUartDataToCircQueue(p_trpConn, p_genData);
+    }
+
+    if (p_trpConn->uartCircQueue.usedNum > 0)
+    {
+        APP_TRP_COMMON_SendLeDataUartCircQueue(p_trpConn);
+    }
+
+    // Retry when the packet can not be queued or sent yet
+    if ((status == APP_RES_NO_RESOURCE) || (p_trpConn->uartCircQueue.usedNum > 0))
+    {
+        APP_TIMER_SetTimer(APP_TIMER_UART_HOLD, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, APP_TIMER_18MS);
+    }
+}
+
+static void app_trp_common_ResetUartFillStat(APP_TRP_ConnList_T *p_trpConn)
+{
+    p_trpConn->p_cold->uartTxPkts = 0;
+    p_trpConn->p_cold->uartTxPayload = 0;
+    p_trpConn->p_cold->uartTxRoom = 0;
+}
+
+void APP_TRP_COMMON_ResetUartFillStat(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    {
+        app_trp_common_ResetUartFillStat(&sp_trpConnList[i]);
+    }
+}
+
+uint16_t APP_TRP_COMMON_SetCompress(APP_TRP_COMPRESS_CODEC_T codec)
+{
+    if (codec >= APP_TRP_COMPRESS_CODEC_END)
+        return APP_RES_INVALID_PARA;
+
+    s_trpCompressCodec = codec;
+
+    return APP_RES_SUCCESS;
+}
+
+APP_TRP_COMPRESS_CODEC_T APP_TRP_COMMON_GetCompress(void)
+{
+    return s_trpCompressCodec;
+}
+
+uint16_t APP_TRP_COMMON_SendCompressCommand(APP_TRP_ConnList_T *p_trpConn, uint8_t commandId)
+{
+    uint8_t payload[APP_TRP_WMODE_COMPRESS_PL_NUM], idx;
+    uint16_t result = APP_RES_FAIL;
+
+    result = app_trp_common_CheckCtrlChannel(p_trpConn);
+    if (result == APP_RES_SUCCESS)
+    {
+        if (app_trp_common_CheckCtrlRspFg(p_trpConn))
+            return APP_RES_FAIL;
+
+        idx = 0;
+        payload[idx++] = TRP_GRPID_COMPRESS;
+        payload[idx++] = commandId;
+        payload[idx] = s_trpCompressCodec;
+
+        result = app_trp_common_SendVendorCmd(p_trpConn, APP_TRP_WMODE_COMPRESS_PL_NUM, payload);
+        app_trp_common_SetCtrlRspFg(p_trpConn, result, APP_TRP_SEND_GID_COMPRESS_FAIL);
+    }
+
+    return result;
+}
+
+uint16_t APP_TRP_COMMON_StartCompress(APP_TRP_ConnList_T *p_trpConn)
+{
+    if (p_trpConn == NULL)
+        return APP_RES_INVALID_PARA;
+
+    APP_TRP_COMMON_StopCompress(p_trpConn);
+
+    p_trpConn->p_cold->p_compress = calloc(1, sizeof(APP_TRP_Compress_T));
+    if (p_trpConn->p_cold->p_compress == NULL)
+        return APP_RES_OOM;
+
+    return APP_RES_SUCCESS;
+}
+
+void APP_TRP_COMMON_StopCompress(APP_TRP_ConnList_T *p_trpConn)
+{
+    if ((p_trpConn == NULL) || (p_trpConn->p_cold->p_compress == NULL))
+        return;
+
+    free(p_trpConn->p_cold->p_compress);
+    p_trpConn->p_cold->p_compress = NULL;
+}
+
+uint32_t APP_TRP_COMMON_GetCompressPending(APP_TRP_ConnList_T *p_trpConn)
+{
+    if ((p_trpConn == NULL) || (p_trpConn->p_cold->p_compress == NULL))
+        return 0;
+
+    return p_trpConn->p_cold->p_compress->txBlockLeng - p_trpConn->p_cold->p_compress->txBlockOffset;
+}
+
+void APP_TRP_COMMON_SetSr(bool enable)
+{
+    s_trpSrEnable = enable;
+}
+
+bool APP_TRP_COMMON_GetSr(void)
+{
+    return s_trpSrEnable;
+}
+
+#define APP_TRP_WMODE_SR_PL_NUM             0x02
+uint16_t APP_TRP_COMMON_SendSrCommand(APP_TRP_ConnList_T *p_trpConn, uint8_t commandId)
+{
+    uint8_t payload[APP_TRP_WMODE_SR_PL_NUM + APP_SR_ACK_SIZE], idx;
+    uint16_t result = APP_RES_FAIL;
+
+    result = app_trp_common_CheckCtrlChannel(p_trpConn);
+    if (result == APP_RES_SUCCESS)
+    {
+        if (app_trp_common_CheckCtrlRspFg(p_trpConn))
+            return APP_RES_FAIL;
+
+        idx = 0;
+        payload[idx++] = TRP_GRPID_SR;
+        payload[idx++] = commandId;
+        if ((commandId == APP_TRP_WMODE_SR_ACK) && (p_trpConn->p_cold->p_srRx != NULL))
+        {
+            APP_SR_RxBuildAck(p_trpConn->p_cold->p_srRx, &payload[idx]);
+            idx += APP_SR_ACK_SIZE;
+        }
+
+        result = app_trp_common_SendVendorCmd(p_trpConn, idx, payload);
+        app_trp_common_SetCtrlRspFg(p_trpConn, result, APP_TRP_SEND_GID_SR_FAIL);
+
+        // Send it again on the next acknowledgement timeout
+        if ((result != APP_RES_SUCCESS) && (commandId == APP_TRP_WMODE_SR_ACK) && (p_trpConn->p_cold->p_srRx != NULL))
+            p_trpConn->p_cold->p_srRx->ackPending = true;
+    }
+
+    return result;
+}
+
+uint16_t APP_TRP_COMMON_StartSr(APP_TRP_ConnList_T *p_trpConn)
+{
+    if (p_trpConn == NULL)
+        return APP_RES_INVALID_PARA;
+
+    APP_TRP_COMMON_StopSr(p_trpConn);
+
+    // The client sends the frames and the server receives them
+    if (p_trpConn->trpRole == APP_TRP_CLIENT_ROLE)
+    {
+        p_trpConn->p_cold->p_srTx = malloc(sizeof(APP_SR_Tx_T));
+        if (p_trpConn->p_cold->p_srTx == NULL)
+            return APP_RES_OOM;
+        APP_SR_TxInit(p_trpConn->p_cold->p_srTx);
+    }
+    else
+    {
+        p_trpConn->p_cold->p_srRx = malloc(sizeof(APP_SR_Rx_T));
+        if (p_trpConn->p_cold->p_srRx == NULL)
+            return APP_RES_OOM;
+        APP_SR_RxInit(p_trpConn->p_cold->p_srRx);
+    }
+
+    return APP_RES_SUCCESS;
+}
+
+void APP_TRP_COMMON_StopSr(APP_TRP_ConnList_T *p_trpConn)
+{
+    APP_TRP_GenData_T *p_genData = NULL;
+    uint8_t trpIdx;
+
+    if ((p_trpConn == NULL) || ((p_trpConn->p_cold->p_srTx == NULL) && (p_trpConn->p_cold->p_srRx == NULL)))
+        return;
+
+    trpIdx = APP_TRP_COMMON_GetConnIndex(p_trpConn);
+
+    if (p_trpConn->p_cold->p_srTx != NULL)
+    {
+        if (p_trpConn->p_cold->p_srTx->active)
+        {
+            APP_TRP_COMMON_SetDataWriteCommand(p_trpConn, false);
+
+            // Restore the packet size unless a shorter packet is being filled
+            if (p_trpConn->p_deviceProxy != NULL)
+                p_genData = app_trp_common_GetInputData(p_trpConn->p_deviceProxy);
+            if ((p_genData != NULL) && (p_genData->p_srcData == NULL))
+                p_trpConn->lePktLeng = 0;
+        }
+        APP_TIMER_StopTimer(APP_TIMER_SR_RTO, trpIdx);
+        free(p_trpConn->p_cold->p_srTx);
+        p_trpConn->p_cold->p_srTx = NULL;
+    }
+
+    if (p_trpConn->p_cold->p_srRx != NULL)
+    {
+        APP_TIMER_StopTimer(APP_TIMER_SR_ACK, trpIdx);
+        free(p_trpConn->p_cold->p_srRx);
+        p_trpConn->p_cold->p_srRx = NULL;
+    }
+}
+
+void APP_TRP_COMMON_SrAckTimeout(APP_TRP_ConnList_T *p_trpConn)
+{
+    if ((p_trpConn == NULL) || (p_trpConn->p_cold->p_srRx == NULL))
+        return;
+
+    p_trpConn->p_cold->p_srRx->ackScheduled = false;
+    if (p_trpConn->p_cold->p_srRx->ackPending)
+    {
+        APP_TRP_COMMON_SendSrCommand(p_trpConn, APP_TRP_WMODE_SR_ACK);
+        app_trp_common_SrScheduleAck(p_trpConn);
+    }
+}
+
+
 APP_TRP_ConnList_T *APP_TRP_COMMON_GetConnListByIndex(uint8_t index)
 {
     if (index < APP_TRPC_MAX_LINK_NUMBER)
     {
-        if (s_trpConnList[index].connState != APP_TRP_STATE_IDLE)
-            return &s_trpConnList[index];
+        if (s_trpLinkMask & (1ULL << index))
+            return &sp_trpConnList[index];
     }
     
     return NULL;
@@ -1488,83 +2314,63 @@ APP_TRP_ConnList_T *APP_TRP_COMMON_GetConnListByIndex(uint8_t index)
 
 void APP_TRP_COMMON_AssignToken(APP_TRP_ConnList_T *p_trpConn, APP_TRP_LINK_TYPE_T linkType, APP_TRP_TrafficPriority_T *p_connToken)
 {
-    uint8_t i;
-    
-    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    uint8_t i = APP_TRP_COMMON_GetConnIndex(p_trpConn);
+
+    if (i >= APP_TRP_MAX_LINK_NUMBER)
+        return;
+
+    if (linkType == APP_TRP_LINK_TYPE_TX)
     {
-        if (p_trpConn == &s_trpConnList[i])
-        {
-            if (linkType == APP_TRP_LINK_TYPE_TX)
-            {
-                p_connToken->txToken = i;
-            }
-            else if (linkType == APP_TRP_LINK_TYPE_RX)
-            {
-                p_connToken->rxToken = i;
-            }
-            return;
-        }
+        p_connToken->txToken = i;
+    }
+    else if (linkType == APP_TRP_LINK_TYPE_RX)
+    {
+        p_connToken->rxToken = i;
     }
 }
 
 APP_TRP_ConnList_T *APP_TRP_COMMON_ChangeNextLink(uint8_t trpRole, APP_TRP_LINK_TYPE_T linkType, APP_TRP_TrafficPriority_T *p_connToken)
 {
-    uint8_t i = 0, index = 0;
+    uint8_t index = 0;
     
-    if (p_connToken == NULL)
+    if (p_connToken == NULL || trpRole > APP_TRP_CLIENT_ROLE)
         return NULL;
     
     if (linkType == APP_TRP_LINK_TYPE_TX)
     {
-        index = p_connToken->txToken;
-        
-        for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
-        {
-            index++;
-            
-            if (index > (APP_TRP_MAX_LINK_NUMBER - 1))
-                index = 0;
-            
-            if (s_trpConnList[index].connState != APP_TRP_STATE_IDLE && s_trpConnList[index].trpRole == trpRole)
-                break;
-        }
+        index = APP_UTILITY_NextInMask(s_trpRoleMask[trpRole], p_connToken->txToken);
         
+        if (index >= APP_TRP_MAX_LINK_NUMBER)
+            index = 0;
+
         p_connToken->txToken = index;
 
-        if (s_trpConnList[index].connState == APP_TRP_STATE_IDLE)
+        if (sp_trpConnList[index].connState == APP_TRP_STATE_IDLE)
         {
             return NULL;
         }
         else
         {
-            return &(s_trpConnList[index]);
+            return &(sp_trpConnList[index]);
         }
         
     }
     else if (linkType == APP_TRP_LINK_TYPE_RX)
     {
-        index = p_connToken->rxToken;
-        
-        for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
-        {
-            index++;
-            
-            if (index > (APP_TRP_MAX_LINK_NUMBER - 1))
-                index = 0;
-            
-            if (s_trpConnList[index].connState != APP_TRP_STATE_IDLE)
-                break;
-        }
+        index = APP_UTILITY_NextInMask(s_trpLinkMask, p_connToken->rxToken);
         
+        if (index >= APP_TRP_MAX_LINK_NUMBER)
+            index = 0;
+
         p_connToken->rxToken = index;
 
-        if (s_trpConnList[index].connState == APP_TRP_STATE_IDLE && s_trpConnList[index].trpRole == trpRole)
+        if (sp_trpConnList[index].connState == APP_TRP_STATE_IDLE && sp_trpConnList[index].trpRole == trpRole)
         {
             return NULL;
         }
         else
         {
-            return &(s_trpConnList[index]);
+            return &(sp_trpConnList[index]);
         }
         
     }
@@ -1578,7 +2384,7 @@ bool APP_TRP_COMMON_IsWorkModeExist(uint8_t trpRole, APP_TRP_WMODE_T workMode)
     
     for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
     {
-        if (s_trpConnList[i].workMode == workMode && s_trpConnList[i].trpRole == trpRole)
+        if (sp_trpConnList[i].workMode == workMode && sp_trpConnList[i].trpRole == trpRole)
             return true;
     }
 
@@ -1588,26 +2394,17 @@ bool APP_TRP_COMMON_IsWorkModeExist(uint8_t trpRole, APP_TRP_WMODE_T workMode)
 
 uint8_t APP_TRP_COMMON_GetRoleNum(uint8_t gapRole)
 {
-    uint8_t i;
-    uint8_t count = 0;
+    if (gapRole > APP_TRP_CLIENT_ROLE)
+        return 0;
 
-    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
-    {
-        if (s_trpConnList[i].connState == APP_TRP_STATE_CONNECTED)
-        {
-            if (s_trpConnList[i].trpRole == gapRole)
-            {
-                count++;
-            }
-        }
-    }
-
-    return count;
+    return (uint8_t)__builtin_popcountll(s_trpRoleMask[gapRole]);
 }
 
 #define APP_TRP_WM_LOOPBACK_STR         "Loopback"
 #define APP_TRP_WM_CHECKSUM_STR         "Checksum"
 #define APP_TRP_WM_FIXPATTERN_STR       "Fixed-pattern"
+#define APP_TRP_WM_REV_LOOPBACK_STR     "Reverse-loopback"
+#define APP_TRP_WM_DUPLEX_STR           "Duplex"
 #define APP_TRP_WM_PROGRESS_STR         "progressing"
 #define APP_TRP_WM_START_STR            "start"
 
@@ -1616,12 +2413,15 @@ void APP_TRP_COMMON_StartLog(APP_TRP_ConnList_T *p_trpConn)
     if (p_trpConn == NULL)
         return;
 
-    p_trpConn->progress = 0;
-    p_trpConn->testStage = APP_TEST_PROGRESS;
+    p_trpConn->p_cold->progress = 0;
+    p_trpConn->p_cold->testStage = APP_TEST_PROGRESS;
+    APP_LOG_ThrottleReset(&p_trpConn->p_cold->progressThrottle);
+
+    g_timer_start(p_trpConn->p_cold->p_transTimer);
 
     if (p_trpConn->trpRole == APP_TRP_CLIENT_ROLE)
     {
-        g_timer_start(p_trpConn->p_transTimer);
+        APP_LOG_ThrottleReset(&s_trpcProgressThrottle);
     }
     else
     {
@@ -1642,6 +2442,16 @@ void APP_TRP_COMMON_StartLog(APP_TRP_ConnList_T *p_trpConn)
                 bt_shell_printf("%s %s\n", APP_TRP_WM_CHECKSUM_STR, APP_TRP_WM_START_STR);
             }
             break;
+            case TRP_WMODE_REV_LOOPBACK:
+            {
+                bt_shell_printf("%s %s\n", APP_TRP_WM_REV_LOOPBACK_STR, APP_TRP_WM_START_STR);
+            }
+            break;
+            case TRP_WMODE_DUPLEX:
+            {
+                bt_shell_printf("%s %s\n", APP_TRP_WM_DUPLEX_STR, APP_TRP_WM_START_STR);
+            }
+            break;
             default:
             break;
         }
@@ -1652,9 +2462,12 @@ void APP_TRP_COMMON_ProgressingLog(APP_TRP_ConnList_T *p_trpConn)
 {
 
     uint8_t i;
-    uint16_t progress;
+    uint32_t totalLeng = 0;
     uint32_t patternRemainSize;
+    const char *p_modeStr;
     APP_DBP_BtDev_T *p_dev;
+    char logBuf[APP_LOG_MSG_MAX_LEN];
+    int logLeng;
 
 
     if (p_trpConn == NULL)
@@ -1662,116 +2475,136 @@ void APP_TRP_COMMON_ProgressingLog(APP_TRP_ConnList_T *p_trpConn)
 
     if (p_trpConn->trpRole == APP_TRP_SERVER_ROLE)
     {
-        progress = p_trpConn->progress + 1;
-        
         switch (p_trpConn->workMode)
         {
             case TRP_WMODE_FIX_PATTERN:
-            {
-                if(progress >= 100)
-                    progress = 0;
-                else if(progress == 50)
-                    printf("\r%s %s \\", APP_TRP_WM_FIXPATTERN_STR, APP_TRP_WM_PROGRESS_STR);
-                else if(progress == 1)
-                    printf("\r%s %s /", APP_TRP_WM_FIXPATTERN_STR, APP_TRP_WM_PROGRESS_STR);
-            }
+                p_modeStr = APP_TRP_WM_FIXPATTERN_STR;
             break;
             case TRP_WMODE_LOOPBACK:
-            {
-                if(progress >= 100)
-                    progress = 0;
-                else if(progress == 50)
-                    printf("\r%s %s \\", APP_TRP_WM_LOOPBACK_STR, APP_TRP_WM_PROGRESS_STR);
-                else if(progress == 1)
-                    printf("\r%s %s /", APP_TRP_WM_LOOPBACK_STR, APP_TRP_WM_PROGRESS_STR);
-            }
+                p_modeStr = APP_TRP_WM_LOOPBACK_STR;
             break;
             case TRP_WMODE_CHECK_SUM:
-            {
-                if(progress >= 100)
-                    progress = 0;
-                else if(progress == 50)
-                    printf("\r%s %s \\", APP_TRP_WM_CHECKSUM_STR, APP_TRP_WM_PROGRESS_STR);
-                else if(progress == 1)
-                    printf("\r%s %s /", APP_TRP_WM_CHECKSUM_STR, APP_TRP_WM_PROGRESS_STR);
-            }
+                p_modeStr = APP_TRP_WM_CHECKSUM_STR;
             break;
-            default:
+            case TRP_WMODE_REV_LOOPBACK:
+                p_modeStr = APP_TRP_WM_REV_LOOPBACK_STR;
             break;
+            case TRP_WMODE_DUPLEX:
+                p_modeStr = APP_TRP_WM_DUPLEX_STR;
+            break;
+            default:
+                return;
         }
 
-        p_trpConn->progress = progress;
+        if (!APP_LOG_ProgressDue(&p_trpConn->p_cold->progressThrottle, 0))
+            return;
 
+        p_trpConn->p_cold->progress++;
+        APP_LOG_Post(APP_LOG_TYPE_RAW, "\r%s %s %c", p_modeStr, APP_TRP_WM_PROGRESS_STR, (p_trpConn->p_cold->progress & 0x01) ? '/' : '\\');
     }
     else
     {
-        switch (p_trpConn->workMode)
+        if (p_trpConn->workMode != TRP_WMODE_FIX_PATTERN && p_trpConn->workMode != TRP_WMODE_CHECK_SUM
+            && p_trpConn->workMode != TRP_WMODE_DUPLEX)
+            return;
+
+        for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
         {
-            case TRP_WMODE_FIX_PATTERN:
+            if (sp_trpConnList[i].p_deviceProxy != NULL && sp_trpConnList[i].p_cold->testStage >= APP_TEST_PROGRESS)
             {
-                printf("\rProgressing: ");
-                for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
-                {
-                    if (s_trpConnList[i].p_deviceProxy != NULL && s_trpConnList[i].testStage >= APP_TEST_PROGRESS)
-                    {
-                        p_dev = APP_DBP_GetDevInfoByProxy(s_trpConnList[i].p_deviceProxy);
-                        if (p_dev == NULL)
-                            continue;
-                        
-                        printf("[%s: %3d%%]", p_dev->p_name, s_trpConnList[i].rxAccuLeng*100/APP_TRP_WMODE_TX_MAX_SIZE);
-                    }
-                }
+                if (p_trpConn->workMode == TRP_WMODE_FIX_PATTERN)
+                    totalLeng += sp_trpConnList[i].rxAccuLeng;
+                else if (p_trpConn->workMode == TRP_WMODE_DUPLEX)
+                    totalLeng += sp_trpConnList[i].rxAccuLeng + APP_TRP_WMODE_TX_MAX_SIZE - sp_trpConnList[i].p_cold->fixPattMaxSize;
+                else
+                    totalLeng += APP_TRP_WMODE_TX_MAX_SIZE - sp_trpConnList[i].p_cold->fixPattMaxSize;
             }
-            break;
-            case TRP_WMODE_CHECK_SUM:
+        }
+
+        if (!APP_LOG_ProgressDue(&s_trpcProgressThrottle, totalLeng))
+            return;
+
+        logLeng = snprintf(logBuf, sizeof(logBuf), "\rProgressing: ");
+        for (i=0; i<BLE_GAP_MAX_LINK_NBR && logLeng < (int)sizeof(logBuf); i++)
+        {
+            if (sp_trpConnList[i].p_deviceProxy != NULL && sp_trpConnList[i].p_cold->testStage >= APP_TEST_PROGRESS)
             {
-                printf("\rProgressing: ");
-                for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
-                {
-                    if (s_trpConnList[i].p_deviceProxy != NULL && s_trpConnList[i].testStage >= APP_TEST_PROGRESS)
-                    {
-                        p_dev = APP_DBP_GetDevInfoByProxy(s_trpConnList[i].p_deviceProxy);
-                        if (p_dev == NULL)
-                            continue;
+                p_dev = APP_DBP_GetDevInfoByProxy(sp_trpConnList[i].p_deviceProxy);
+                if (p_dev == NULL)
+                    continue;
 
-                        patternRemainSize = APP_TRP_WMODE_TX_MAX_SIZE - s_trpConnList[i].fixPattMaxSize;
-                        printf("[%s: %3d%%]", p_dev->p_name, patternRemainSize*100/APP_TRP_WMODE_TX_MAX_SIZE);
-                    }
+                if (p_trpConn->workMode == TRP_WMODE_FIX_PATTERN)
+                {
+                    logLeng += snprintf(&logBuf[logLeng], sizeof(logBuf) - logLeng, "[%s: %3d%%]",
+                        p_dev->p_name, sp_trpConnList[i].rxAccuLeng*100/APP_TRP_WMODE_TX_MAX_SIZE);
+                }
+                else if (p_trpConn->workMode == TRP_WMODE_DUPLEX)
+                {
+                    patternRemainSize = APP_TRP_WMODE_TX_MAX_SIZE - sp_trpConnList[i].p_cold->fixPattMaxSize;
+                    logLeng += snprintf(&logBuf[logLeng], sizeof(logBuf) - logLeng, "[%s: Tx %3d%% Rx %3d%%]",
+                        p_dev->p_name, patternRemainSize*100/APP_TRP_WMODE_TX_MAX_SIZE,
+                        sp_trpConnList[i].rxAccuLeng*100/APP_TRP_WMODE_TX_MAX_SIZE);
+                }
+                else
+                {
+                    patternRemainSize = APP_TRP_WMODE_TX_MAX_SIZE - sp_trpConnList[i].p_cold->fixPattMaxSize;
+                    logLeng += snprintf(&logBuf[logLeng], sizeof(logBuf) - logLeng, "[%s: %3d%%]",
+                        p_dev->p_name, patternRemainSize*100/APP_TRP_WMODE_TX_MAX_SIZE);
                 }
-
             }
-            break;
-            default:
-            break;
+        }
+
+        APP_LOG_Post(APP_LOG_TYPE_RAW, "%s", logBuf);
+    }
+}
+
+//Tx is from the client to the server, both directions are timed from the start of the run
+static void app_trp_common_DuplexLog(APP_TRP_ConnList_T *p_trpConn)
+{
+    const char *p_dirStr[] = {"Tx", "Rx"};
+    double doneTime[] = {p_trpConn->p_cold->txDoneTime, p_trpConn->p_cold->rxDoneTime};
+    uint8_t i;
+
+    for (i = 0; i < 2; i++)
+    {
+        if (doneTime[i] > 0)
+        {
+            printf("\t[%s][%d bytes][%f s][%.0f bps]\n", p_dirStr[i], APP_TRP_WMODE_TX_MAX_SIZE, doneTime[i],
+                APP_TRP_WMODE_TX_MAX_SIZE * 8.0 / doneTime[i]);
+        }
+        else
+        {
+            printf("\t[%s][incomplete]\n", p_dirStr[i]);
         }
     }
-    
-    fflush(stdout);
 }
 
 void APP_TRP_COMMON_FinishLog(APP_TRP_ConnList_T *p_trpConn)
 {
     uint8_t i;
     uint8_t countPass = 0;
+    uint32_t bytes;
     gdouble elapseTime;
     APP_DBP_BtDev_T *p_dev;
 
-    g_timer_stop(p_trpConn->p_transTimer);
+    g_timer_stop(p_trpConn->p_cold->p_transTimer);
 
     for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
     {
-        if (s_trpConnList[i].p_deviceProxy != NULL)
+        if (sp_trpConnList[i].p_deviceProxy != NULL)
         {
-            if (s_trpConnList[i].testStage == APP_TEST_PROGRESS)
+            if (sp_trpConnList[i].p_cold->testStage == APP_TEST_PROGRESS)
                 return;
             //the final step is return to NULL state
-            if (s_trpConnList[i].trpState != 0)
+            if (sp_trpConnList[i].trpState != 0)
                 return;
-            if (s_trpConnList[i].testStage == APP_TEST_PASSED)
+            if (sp_trpConnList[i].p_cold->testStage == APP_TEST_PASSED)
                 countPass++;
         }
     }
 
+    APP_LOG_Flush();
+
 #ifdef ENABLE_AUTO_RUN
     printf("\nTest result(%d runs):\n", APP_GetPassedRun());
 #else
@@ -1783,19 +2616,39 @@ void APP_TRP_COMMON_FinishLog(APP_TRP_ConnList_T *p_trpConn)
 
     for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
     {
-        if (s_trpConnList[i].testStage == APP_TEST_IDLE)
+        if (sp_trpConnList[i].p_cold->testStage == APP_TEST_IDLE)
             continue;
             
-        p_dev = APP_DBP_GetDevInfoByProxy(s_trpConnList[i].p_deviceProxy);
-        elapseTime = g_timer_elapsed(s_trpConnList[i].p_transTimer, NULL);
+        p_dev = APP_DBP_GetDevInfoByProxy(sp_trpConnList[i].p_deviceProxy);
+        elapseTime = g_timer_elapsed(sp_trpConnList[i].p_cold->p_transTimer, NULL);
         
-        printf("dev#%2d\t[%s][%s][%s][%f s]\n", p_dev->index, p_dev->p_address, p_dev->p_name, 
-            APP_TRP_TestStageStr[s_trpConnList[i].testStage], elapseTime);
+        if (p_dev != NULL)
+        {
+            printf("dev#%2d\t[%s][%s][%s][%f s]\n", p_dev->index, p_dev->p_address, p_dev->p_name,
+                APP_TRP_TestStageStr[sp_trpConnList[i].p_cold->testStage], elapseTime);
+        }
+        else
+        {
+            //replayed link, no BlueZ device
+            printf("link#%2d\t[%s][%f s]\n", i, APP_TRP_TestStageStr[sp_trpConnList[i].p_cold->testStage], elapseTime);
+        }
+
+        bytes = APP_TRP_WMODE_TX_MAX_SIZE;
+        if (sp_trpConnList[i].workMode == TRP_WMODE_DUPLEX)
+        {
+            app_trp_common_DuplexLog(&sp_trpConnList[i]);
+            bytes *= 2;
+        }
+        APP_SCRIPT_LinkResult(sp_trpConnList[i].p_deviceProxy, sp_trpConnList[i].p_cold->testStage, elapseTime, bytes);
+        APP_RESULT_LinkResult(sp_trpConnList[i].p_deviceProxy, APP_GetWorkMode(), sp_trpConnList[i].p_cold->testStage, elapseTime,
+            bytes, sp_trpConnList[i].p_cold->exchangedMTU);
 
-        s_trpConnList[i].testStage = APP_TEST_IDLE;
+        sp_trpConnList[i].p_cold->testStage = APP_TEST_IDLE;
     }
 
     bt_shell_printf("\n");
+    APP_RESULT_RunFinished();
+    APP_SCRIPT_RunFinished(countPass);
     
 #ifdef ENABLE_AUTO_RUN
     APP_GoNextRun(countPass);
@@ -32,6 +32,8 @@
 #include "app_utility.h"
 #include "app_timer.h"
 #include "app_dbp.h"
+#include "app_log.h"
+#include "app_sr.h"
 #include <sys/time.h>
 
 #include "gdbus/gdbus.h"
@@ -57,6 +59,7 @@
 #define APP_TRP_VENDOR_OPCODE_BLE_UART      0x80    /**< Opcode for BLE UART */
 
 #define APP_TRP_WMODE_TX_MAX_SIZE           (500 * 0x400) // 500k bytes
+#define APP_TRP_UART_HOLD_MAX_MS            0x64    /**< Maximum hold time of a partial UART packet. */
 #define APP_TRP_WMODE_ERROR_RSP             0x03
 
 
@@ -74,13 +77,24 @@
 #define APP_TRP_SEND_STATUS_FLAG            0x400
 #define APP_TRP_SEND_GID_REV_LB_FAIL        0x800
 #define APP_TRP_SEND_DATA_FAIL              0x1000
+#define APP_TRP_SEND_GID_COMPRESS_FAIL      0x2000
+#define APP_TRP_SEND_GID_SR_FAIL            0x4000
+#define APP_TRP_SEND_GID_DUPLEX_FAIL        0x8000
 
 #define APP_TRP_SERVER_UART                 0x01
 #define APP_TRP_CLIENT_UART                 0x02
 
 #define APP_TRP_LE_MAX_QUEUE_NUM            0x02
+#define APP_TRP_UART_QUEUE_HIGH_MARK        APP_UTILITY_MAX_QUEUE_NUM           /**< UART queue level pausing the data source. */
+#define APP_TRP_UART_QUEUE_LOW_MARK         (APP_UTILITY_MAX_QUEUE_NUM / 2)     /**< UART queue level resuming the data source. */
 #define APP_TRP_ML_MAX_QUEUE_NUM            0x04
 
+#define APP_TRP_COMPRESS_BLOCK_SIZE         0x800   /**< Raw data size of a compressed UART mode block. */
+#define APP_TRP_COMPRESS_BLOCK_HDR_SIZE     0x05    /**< Block type, raw length and encoded length. */
+
+#define APP_TRP_SR_ACK_DELAY                APP_TIMER_20MS  /**< Delay of the selective repeat acknowledgement. */
+#define APP_TRP_SR_RTO                      0xC8    /**< Selective repeat retransmission timeout in ms. */
+
 
 /**@brief Enumeration type of BLE transparent type. */
 typedef enum APP_TRP_TYPE_T
@@ -103,6 +117,9 @@ enum APP_TRP_GRPID_T
     TRP_GRPID_UPDATE_CONN_PARA,
     TRP_GRPID_WMODE_SELECTION,
     TRP_GRPID_REV_LOOPBACK,
+    TRP_GRPID_COMPRESS,
+    TRP_GRPID_SR,
+    TRP_GRPID_DUPLEX,
     TRP_GRPID_END
 };
 
@@ -113,7 +130,8 @@ typedef enum APP_TRP_WMODE_T
     TRP_WMODE_LOOPBACK          = TRP_GRPID_LOOPBACK,
     TRP_WMODE_FIX_PATTERN       = TRP_GRPID_FIX_PATTERN,
     TRP_WMODE_UART              = TRP_GRPID_UART,
-    //TRP_WMODE_REV_LOOPBACK      = TRP_GRPID_REV_LOOPBACK,
+    TRP_WMODE_REV_LOOPBACK,                                 /**< Sent as TRP_GRPID_REV_LOOPBACK. */
+    TRP_WMODE_DUPLEX,                                       /**< Sent as TRP_GRPID_DUPLEX. */
     
     TRP_WMODE_END
 } APP_TRP_WMODE_T;
@@ -158,7 +176,8 @@ enum
     APP_TRP_WMODE_TX_DATA_START       = 0x01,
     APP_TRP_WMODE_TX_DATA_LENGTH      = 0x02,
     //APP_TRP_WMODE_ERROR_RSP           0x03
-    APP_TRP_WMODE_TX_TYPE             = 0x04
+    APP_TRP_WMODE_TX_TYPE             = 0x04,
+    APP_TRP_WMODE_TX_DATA_OFFSET      = 0x05
 };
 
 //TRP_GRPID_UPDATE_CONN_PARA
@@ -176,6 +195,39 @@ enum
     //APP_TRP_WMODE_ERROR_RSP           0x03
 };
 
+//TRP_GRPID_COMPRESS
+enum
+{
+    APP_TRP_WMODE_COMPRESS_DISABLE    = 0x00,
+    APP_TRP_WMODE_COMPRESS_ENABLE     = 0x01,
+    APP_TRP_WMODE_COMPRESS_ACCEPT     = 0x02
+};
+
+//TRP_GRPID_SR
+enum
+{
+    APP_TRP_WMODE_SR_DISABLE          = 0x00,
+    APP_TRP_WMODE_SR_ENABLE           = 0x01,
+    APP_TRP_WMODE_SR_ACK              = 0x02
+};
+
+//TRP_GRPID_DUPLEX
+enum
+{
+    APP_TRP_WMODE_DUPLEX_DISABLE      = 0x00,
+    APP_TRP_WMODE_DUPLEX_ENABLE       = 0x01
+    //APP_TRP_WMODE_ERROR_RSP           0x03
+};
+
+/**@brief Enumeration type of UART mode compression codec. */
+typedef enum APP_TRP_COMPRESS_CODEC_T
+{
+    APP_TRP_COMPRESS_CODEC_NONE = 0x00,             /**< No compression. */
+    APP_TRP_COMPRESS_CODEC_LZ,                      /**< LZ77 blocks, see app_lz.h. */
+
+    APP_TRP_COMPRESS_CODEC_END
+} APP_TRP_COMPRESS_CODEC_T;
+
 
 
 
@@ -218,36 +270,87 @@ typedef enum APP_TRP_Role_T
 } APP_TRP_Role_T;
 
 
-/**@brief The structure contains information about APP transparent connection parameters for recording connection information. */
+/**@brief The structure contains the UART mode compression context of a link. */
+typedef struct APP_TRP_Compress_T
+{
+    APP_TRP_COMPRESS_CODEC_T codec;             /**< Codec accepted by the peer. APP_TRP_COMPRESS_CODEC_NONE while negotiating. */
+    bool                    answered;           /**< The server answered the offer of the client. */
+    bool                    rxEn;               /**< Decode the received data. */
+    bool                    txEn;               /**< Encode the data to send. */
+    uint16_t                txBlockLeng;        /**< Length of the encoded block being sent. */
+    uint16_t                txBlockOffset;      /**< Sent length of the encoded block. */
+    uint16_t                rxBlockLeng;        /**< Received length of the block being reassembled. */
+    uint32_t                txRawLeng;          /**< Raw bytes encoded. */
+    uint32_t                txEncLeng;          /**< Encoded bytes sent, block headers included. */
+    uint32_t                rxRawLeng;          /**< Raw bytes decoded. */
+    uint32_t                rxEncLeng;          /**< Encoded bytes received, block headers included. */
+    uint32_t                rxErrors;           /**< Corrupted blocks dropped. */
+    uint8_t                 txRaw[APP_TRP_COMPRESS_BLOCK_SIZE];
+    uint8_t                 txBlock[APP_TRP_COMPRESS_BLOCK_HDR_SIZE + APP_TRP_COMPRESS_BLOCK_SIZE];
+    uint8_t                 rxBlock[APP_TRP_COMPRESS_BLOCK_HDR_SIZE + APP_TRP_COMPRESS_BLOCK_SIZE];
+    uint8_t                 rxRaw[APP_TRP_COMPRESS_BLOCK_SIZE];
+} APP_TRP_Compress_T;
+
+/**@brief The structure contains the configuration, test and statistics fields of a link. They are kept apart from
+ *        @ref APP_TRP_ConnList_T so that the per packet path does not pull them into the cache. */
+typedef struct APP_TRP_ConnCold_T
+{
+    uint16_t                exchangedMTU;       /**< Exchange MTU size */
+    uint16_t                fixPattTrcbpMtu;    /**< The fix pattern MTU value for fix pattern mode over L2CAP CoC. */
+    uint32_t                fixPattMaxSize;     /**< The total pattern length for fix pattern mode */
+    uint16_t                peerLastNumber;     /**< The last number reported by the peer, compared once the received data is checked. */
+    APP_TRP_TestStage_T     testStage;          /**< Test Stage in Burst Mode*/
+    uint32_t                runBytes;           /**< Payload bytes of the run of the client, reported once it is over. Server role only. */
+    uint16_t                progress;
+    GTimer                 *p_transTimer;      /**< Data Transmission timer used in Burst Mode for elapsed time calculation. */
+    APP_LOG_Throttle_T      progressThrottle;   /**< Rate limiting of the server progress log. */
+    uint32_t                uartTxPkts;         /**< Number of UART mode packets queued to LE. */
+    uint32_t                uartTxPayload;      /**< Payload bytes of the queued UART mode packets. */
+    uint32_t                uartTxRoom;         /**< Packet size sum of the queued UART mode packets, for the fill ratio. */
+    APP_TRP_Compress_T     *p_compress;         /**< UART mode compression context, NULL if not negotiated. */
+    APP_SR_Tx_T            *p_srTx;             /**< Selective repeat sender of the client, NULL if not negotiated. */
+    APP_SR_Rx_T            *p_srRx;             /**< Selective repeat receiver of the server, NULL if not negotiated. */
+    double                  txDoneTime;         /**< Elapsed time when the peer verified all the sent pattern in duplex mode, 0 if not yet. */
+    double                  rxDoneTime;         /**< Elapsed time when all the pattern of the peer is verified in duplex mode, 0 if not yet. */
+} APP_TRP_ConnCold_T;
+
+/**@brief The structure contains information about APP transparent connection parameters for recording connection information.
+ *        It only holds the fields touched on every packet, the others are in the cold descriptor of the link. */
 typedef struct APP_TRP_ConnList_T
 {
     APP_TRP_State_T         connState;          /**< Connection state. */
     APP_TRP_Role_T          trpRole;            /**< Transparent Role for APP_TRP_SERVER_ROLE or APP_TRP_CLIENT_ROLE */
-    uint8_t                 channelEn;          /**< Channel enable for control channel and data channel. */
-    uint16_t                exchangedMTU;       /**< Exchange MTU size */
     APP_TRP_WMODE_T         workMode;           /**< Work active mode */
+    APP_TRP_TYPE_T          type;               /**< Transparent type. See @ref APP_TRP_TYPE_T. */
+    uint8_t                 channelEn;          /**< Channel enable for control channel and data channel. */
     uint8_t                 workModeEn;         /**< Enable work mode procedure */
     uint8_t                 trpState;           /**< Transparent state */
-    uint32_t                checkSum;           /**< Check sum value for check sum mode */
+    uint8_t                 maxAvailTxNumber;   /**< The maximum available number of transmission packets. */
+    uint16_t                txMTU;              /**< The Tx MTU value to transmit data by GATT */
+    uint16_t                lePktLeng;          /**< The LE packet length and it could be TRP or TRCBP packet size. */
     uint16_t                lastNumber;         /**< The last number value for fix pattern mode */
     uint16_t                rxLastNunber;       /**< The received last number value for fix pattern check */
-    uint16_t                txMTU;              /**< The Tx MTU value to transmit data by GATT */
-    uint32_t                fixPattMaxSize;     /**< The total pattern length for fix pattern mode */
-    uint16_t                fixPattTrcbpMtu;    /**< The fix pattern MTU value for fix pattern mode over L2CAP CoC. */
-    APP_TRP_TYPE_T          type;               /**< Transparent type. See @ref APP_TRP_TYPE_T. */
     uint16_t                gattcRspWait;       /**< Wait for GATT client write response*/
+    uint32_t                checkSum;           /**< Check sum value for check sum mode */
     uint32_t                txTotalLeng;        /**< The transmission total length */
-    uint16_t                lePktLeng;          /**< The LE packet length and it could be TRP or TRCBP packet size. */
-    uint8_t                 maxAvailTxNumber;   /**< The maximum available number of transmission packets. */
+    uint32_t                rxAccuLeng;
+    uint32_t                rxCheckRunId;       /**< Run of the received data check, the results of an older run are dropped. */
+    DeviceProxy            *p_deviceProxy;     /**< DBus device proxy */
+    APP_TRP_ConnCold_T     *p_cold;             /**< Cold descriptor of the link, see @ref APP_TRP_ConnCold_T. Never NULL. */
     APP_UTILITY_CircQueue_T leCircQueue;        /**< The circular queue to store LE data */
     APP_UTILITY_CircQueue_T uartCircQueue;      /**< The circular queue to store UART data */
-    DeviceProxy            *p_deviceProxy;     /**< DBus device proxy */
-    APP_TRP_TestStage_T     testStage;          /**< Test Stage in Burst Mode*/
-    GTimer                 *p_transTimer;      /**< Data Transmission timer used in Burst Mode for elapsed time calculation. */
-    uint32_t                rxAccuLeng;
-    uint16_t                progress;
 } APP_TRP_ConnList_T;
 
+/**@brief The function type of the result of a received data check, run on the main loop once the data
+ *        plane worker of the link checked the data. The rxLastNunber, rxAccuLeng and, for the check sum,
+ *        checkSum fields of the link are updated before it is called.
+ * @param[in] p_trpConn             The link.
+ * @param[in] status                APP_RES_SUCCESS, APP_RES_FAIL if the data of the run mismatched so far,
+ *                                  APP_RES_OOM if the data could not be checked.
+ * @param[in] checkedLeng           Length of the data checked by this job.
+ */
+typedef void (*APP_TRP_RxCheckCb_T)(APP_TRP_ConnList_T *p_trpConn, uint16_t status, uint32_t checkedLeng);
+
 /**@brief The structure contains the information about general data format. */
 typedef struct APP_TRP_GenData_T
 {
@@ -272,6 +375,7 @@ typedef struct APP_TRP_TrafficPriority_T
 // *****************************************************************************
 // *****************************************************************************
 extern const char * APP_TRP_TestStageStr[];
+extern const char * APP_TRP_WorkModeStr[];
 
 // *****************************************************************************
 // *****************************************************************************
@@ -289,23 +393,28 @@ bool APP_TRP_COMMON_CheckValidTopology(uint8_t trpRole);
 uint8_t APP_TRP_COMMON_GetConnIndex(APP_TRP_ConnList_T *p_trpConn);
 void APP_TRP_COMMON_CtrlChOpenProc(bool isOpen);
 void APP_TRP_COMMON_TxChOpenProc(bool isOpen);
+void APP_TRP_COMMON_TrcbpChOpenProc(DeviceProxy *p_devProxy, bool isOpen, uint16_t sdu);
 uint16_t APP_TRP_COMMON_SendLeDataUartCircQueue(APP_TRP_ConnList_T *p_trpConn);
 uint16_t APP_TRP_COMMON_SendLastNumber(APP_TRP_ConnList_T *p_trpConn);
 uint16_t APP_TRP_COMMON_SendErrorRsp(APP_TRP_ConnList_T *p_trpConn, uint8_t grpId);
 uint16_t APP_TRP_COMMON_SendUpConnParaStatus(APP_TRP_ConnList_T *p_trpConn, uint8_t grpId, uint8_t commandId, uint8_t upParaStatus);
 uint16_t APP_TRP_COMMON_GetTrpDataLength(APP_TRP_ConnList_T *p_trpConn, uint16_t *p_dataLeng);
 uint16_t APP_TRP_COMMON_GetTrpData(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_data);
+bool APP_TRP_COMMON_IsDlCreditBased(APP_TRP_ConnList_T *p_trpConn);
+void APP_TRP_COMMON_SetDataWriteCommand(APP_TRP_ConnList_T *p_trpConn, bool enable);
 uint16_t APP_TRP_COMMON_FreeLeData(APP_TRP_ConnList_T *p_trpConn);
 void APP_TRP_COMMON_DelAllCircData(APP_UTILITY_CircQueue_T *p_circQueue);
 void APP_TRP_COMMON_DelAllLeCircData(APP_UTILITY_CircQueue_T *p_circQueue);
-uint32_t APP_TRP_COMMON_CalculateCheckSum(uint32_t checkSum, uint32_t *p_dataLeng, APP_TRP_ConnList_T *p_trpConn);
+void APP_TRP_COMMON_ResetRxCheck(APP_TRP_ConnList_T *p_trpConn);
+void APP_TRP_COMMON_CalculateCheckSum(uint32_t *p_dataLeng, APP_TRP_ConnList_T *p_trpConn, APP_TRP_RxCheckCb_T p_cb);
 uint8_t * APP_TRP_COMMON_GenFixPattern(uint16_t *p_startSeqNum, uint16_t *p_patternLeng, uint32_t *p_pattMaxSize, uint32_t *p_checkSum);
 uint16_t APP_TRP_COMMON_UpdateFixPatternLen(APP_TRP_ConnList_T *p_trpConn);
 void APP_TRP_COMMON_InitFixPatternParam(APP_TRP_ConnList_T *p_trpConn);
 uint16_t APP_TRP_COMMON_SendFixPatternFirstPkt(APP_TRP_ConnList_T *p_trpConn);
 uint16_t APP_TRP_COMMON_SendFixPattern(APP_TRP_ConnList_T *p_trpConn);
 uint16_t APP_TRP_COMMON_SendMultiLinkFixPattern(APP_TRP_TrafficPriority_T *p_connToken, APP_TRP_ConnList_T *p_trpConn);
-uint16_t APP_TRP_COMMON_CheckFixPatternData(APP_TRP_ConnList_T *p_trpConn);
+void APP_TRP_COMMON_CheckFixPatternData(APP_TRP_ConnList_T *p_trpConn, APP_TRP_RxCheckCb_T p_cb);
+void APP_TRP_COMMON_FlushRxCheck(APP_TRP_ConnList_T *p_trpConn, APP_TRP_RxCheckCb_T p_cb);
 uint16_t APP_TRP_COMMON_SendLeDataToFile(APP_TRP_ConnList_T *p_trpConn, uint16_t dataLeng, uint8_t *p_rxBuf);
 void APP_TRP_COMMON_SendTrpProfileDataToUART(APP_TRP_ConnList_T *p_trpConn);
 uint16_t APP_TRP_COMMON_InsertUartDataToCircQueue(APP_TRP_ConnList_T *p_trpConn,  APP_TRP_GenData_T *p_rxData);
@@ -314,11 +423,29 @@ uint16_t APP_TRP_COMMON_SendLeDataUartCircQueue(APP_TRP_ConnList_T *p_trpConn);
 uint16_t APP_TRP_COMMON_SendMultiLinkLeDataTrpProfile(APP_TRP_TrafficPriority_T *p_connToken, APP_TRP_ConnList_T *p_trpConn);
 uint16_t APP_TRP_COMMON_UartRxData(APP_TRP_GenData_T *p_rxData, APP_TRP_ConnList_T *p_trpConn);
 void APP_TRP_COMMON_FetchTxData(DeviceProxy *p_devProxy, uint16_t dataLeng);
+uint16_t APP_TRP_COMMON_SetUartHoldTime(uint16_t holdMs);
+uint16_t APP_TRP_COMMON_GetUartHoldTime(void);
+void APP_TRP_COMMON_UartHoldTimeout(APP_TRP_ConnList_T *p_trpConn);
+void APP_TRP_COMMON_ResetUartFillStat(void);
+uint16_t APP_TRP_COMMON_SetCompress(APP_TRP_COMPRESS_CODEC_T codec);
+APP_TRP_COMPRESS_CODEC_T APP_TRP_COMMON_GetCompress(void);
+uint16_t APP_TRP_COMMON_SendCompressCommand(APP_TRP_ConnList_T *p_trpConn, uint8_t commandId);
+uint16_t APP_TRP_COMMON_StartCompress(APP_TRP_ConnList_T *p_trpConn);
+void APP_TRP_COMMON_StopCompress(APP_TRP_ConnList_T *p_trpConn);
+uint32_t APP_TRP_COMMON_GetCompressPending(APP_TRP_ConnList_T *p_trpConn);
+void APP_TRP_COMMON_SetSr(bool enable);
+bool APP_TRP_COMMON_GetSr(void);
+uint16_t APP_TRP_COMMON_SendSrCommand(APP_TRP_ConnList_T *p_trpConn, uint8_t commandId);
+uint16_t APP_TRP_COMMON_StartSr(APP_TRP_ConnList_T *p_trpConn);
+void APP_TRP_COMMON_StopSr(APP_TRP_ConnList_T *p_trpConn);
+void APP_TRP_COMMON_SrAckTimeout(APP_TRP_ConnList_T *p_trpConn);
 APP_TRP_ConnList_T *APP_TRP_COMMON_GetConnListByIndex(uint8_t index);
 APP_TRP_ConnList_T *APP_TRP_COMMON_GetConnListByDevProxy(DeviceProxy *p_devProxy);
 APP_TRP_ConnList_T *APP_TRP_COMMON_ChangeNextLink(uint8_t trpRole, APP_TRP_LINK_TYPE_T linkType, APP_TRP_TrafficPriority_T *p_connToken);
 bool APP_TRP_COMMON_IsWorkModeExist(uint8_t trpRole, APP_TRP_WMODE_T workMode);
 uint16_t APP_TRP_COMMON_SendLengthCommand(APP_TRP_ConnList_T *p_trpConn, uint32_t length);
+uint16_t APP_TRP_COMMON_SendFileLengthCommand(APP_TRP_ConnList_T *p_trpConn, uint32_t length, uint32_t fileId);
+uint16_t APP_TRP_COMMON_SendOffsetCommand(APP_TRP_ConnList_T *p_trpConn, uint32_t fileId, uint32_t offset);
 uint16_t APP_TRP_COMMON_SendCheckSumCommand(APP_TRP_ConnList_T *p_trpConn);
 uint8_t APP_TRP_COMMON_GetRoleNum(uint8_t gapRole);
 void APP_TRP_COMMON_AssignToken(APP_TRP_ConnList_T *p_trpConn, APP_TRP_LINK_TYPE_T linkType, APP_TRP_TrafficPriority_T *p_connToken);
@@ -34,8 +34,12 @@
 #include "app_ble_handler.h"
 #include "app_scan.h"
 #include "app_log.h"
+#include "app_script.h"
+#include "app_replay.h"
+#include "app_tune.h"
 #include "ble_trsp/ble_trsp_defs.h"
 #include "shared/shell.h"
+#include "shared/util.h"
 
 
 // *****************************************************************************
@@ -50,6 +54,8 @@
 #define APP_TRPC_EVENT_LAST_NUMBER      0x04
 #define APP_TRPC_EVENT_RX_LE_DATA       0x08
 #define APP_TRPC_EVENT_TX_LE_DATA       0x10
+#define APP_TRPC_EVENT_COMPRESS         0x20
+#define APP_TRPC_EVENT_SR               0x40
 
 /**@brief Enumeration type of check sum state. */
 enum APP_TRPC_CS_STATE_T
@@ -72,6 +78,7 @@ enum APP_TRPC_FP_STATE_T
 {
     TRPC_FP_STATE_NULL = 0x00,          /**< The null state of fixed pattern state machine. */
     TRPC_FP_STATE_ENABLE_MODE,          /**< The enable mode state of fixed pattern state machine. */
+    TRPC_FP_STATE_SEND_LENGTH,          /**< The send probe length state of fixed pattern state machine. */
     TRPC_FP_STATE_SEND_TYPE,            /**< The send type state of fixed pattern state machine. */
     TRPC_FP_STATE_RX,                   /**< The recieved state of fixed pattern state machine. */
     // TRPC_FP_STATE_WAIT_STOP_RX,         /**< The wait stop state of fixed pattern state machine. */
@@ -101,6 +108,9 @@ enum APP_TRPC_UART_STATE_T
     TRPC_UART_STATE_NULL = 0x00,        /**< The null state of UART state machine. */
     TRPC_UART_STATE_ENABLE_MODE,        /**< The enable mode state of UART state machine. */
     TRPC_UART_STATE_SEND_TYPE,          /**< The send type state of UART state machine. */
+    TRPC_UART_STATE_SR_OFFER,           /**< The selective repeat offer state of UART state machine. */
+    TRPC_UART_STATE_COMPRESS_OFFER,     /**< The compression offer state of UART state machine. */
+    TRPC_UART_STATE_COMPRESS_CONFIRM,   /**< The compression confirm state of UART state machine. */
     TRPC_UART_STATE_RELAY_DATA,         /**< The relay state of UART state machine. */
     TRPC_UART_STATE_DISABLE_MODE,       /**< The disable mode state of UART state machine. */
     TRPC_UART_STATE_END                 /**< The end state of UART state machine. */
@@ -119,6 +129,19 @@ enum APP_TRPC_REV_LB_STATE_T
     TRPC_REV_LB_STATE_END               /**< The end state of loopback state machine. */
 };
 
+/**@brief Enumeration type of duplex state. */
+enum APP_TRPC_DUPLEX_STATE_T
+{
+    TRPC_DUPLEX_STATE_NULL = 0x00,      /**< The null state of duplex state machine. */
+    TRPC_DUPLEX_STATE_ENABLE_MODE,      /**< The enable mode state of duplex state machine. */
+    TRPC_DUPLEX_STATE_SEND_TYPE,        /**< The send type state of duplex state machine. */
+    TRPC_DUPLEX_STATE_START_TX,         /**< The start Tx state of duplex state machine. */
+    TRPC_DUPLEX_STATE_TRX,              /**< The TRx state of duplex state machine. */
+    TRPC_DUPLEX_STATE_SEND_STOP_TX,     /**< The send stop state of duplex state machine. */
+
+    TRPC_DUPLEX_STATE_END               /**< The end state of duplex state machine. */
+};
+
 
 // *****************************************************************************
 // *****************************************************************************
@@ -143,7 +166,31 @@ APP_TRP_TrafficPriority_T       s_trpcTrafficPriority;
 // *****************************************************************************
 
 static void app_trpc_LeRxProc(APP_TRP_ConnList_T *p_trpConn);
+static bool app_trpc_SrResend(APP_TRP_ConnList_T *p_trpConn);
+static void app_trpc_SrSend(APP_TRP_ConnList_T *p_trpConn);
+
 
+static void app_trpc_UartRelayStart(APP_TRP_ConnList_T *p_trpConn)
+{
+    p_trpConn->trpState = TRPC_UART_STATE_RELAY_DATA;
+    p_trpConn->workModeEn = true;
+    APP_TIMER_StopTimer(APP_TIMER_PROTOCOL_RSP, APP_TRP_COMMON_GetConnIndex(p_trpConn));
+}
+
+static void app_trpc_UartCompressOffer(APP_TRP_ConnList_T *p_trpConn)
+{
+    if ((APP_TRP_COMMON_GetCompress() != APP_TRP_COMPRESS_CODEC_NONE)
+        && (APP_TRP_COMMON_StartCompress(p_trpConn) == APP_RES_SUCCESS))
+    {
+        p_trpConn->trpState = TRPC_UART_STATE_COMPRESS_OFFER;
+        APP_TRP_COMMON_SendCompressCommand(p_trpConn, APP_TRP_WMODE_COMPRESS_ENABLE);
+        APP_TIMER_SetTimer(APP_TIMER_PROTOCOL_RSP, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, APP_TIMER_3S);
+    }
+    else
+    {
+        app_trpc_UartRelayStart(p_trpConn);
+    }
+}
 
 static void app_trpc_UartStateMachine(uint8_t event, APP_TRP_ConnList_T *p_trpConn)
 {
@@ -151,6 +198,8 @@ static void app_trpc_UartStateMachine(uint8_t event, APP_TRP_ConnList_T *p_trpCo
     {
         case TRPC_UART_STATE_NULL:
         {
+            APP_TRP_COMMON_StopCompress(p_trpConn);
+            APP_TRP_COMMON_StopSr(p_trpConn);
             p_trpConn->trpState = TRPC_UART_STATE_ENABLE_MODE;
             APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_UART, APP_TRP_WMODE_UART_ENABLE);
             APP_TIMER_SetTimer(APP_TIMER_PROTOCOL_RSP, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, APP_TIMER_3S);
@@ -167,9 +216,69 @@ static void app_trpc_UartStateMachine(uint8_t event, APP_TRP_ConnList_T *p_trpCo
 
         case TRPC_UART_STATE_SEND_TYPE:
         {
-            p_trpConn->trpState = TRPC_UART_STATE_RELAY_DATA;
-            p_trpConn->workModeEn = true;
-            APP_TIMER_StopTimer(APP_TIMER_PROTOCOL_RSP, APP_TRP_COMMON_GetConnIndex(p_trpConn));
+            // Only the Write Request of a downlink without credits needs the framing
+            if ((APP_TRP_COMMON_GetSr()) && (p_trpConn->type == APP_TRP_TYPE_LEGACY)
+                && (!APP_TRP_COMMON_IsDlCreditBased(p_trpConn))
+                && (APP_TRP_COMMON_StartSr(p_trpConn) == APP_RES_SUCCESS))
+            {
+                p_trpConn->trpState = TRPC_UART_STATE_SR_OFFER;
+                APP_TRP_COMMON_SendSrCommand(p_trpConn, APP_TRP_WMODE_SR_ENABLE);
+                APP_TIMER_SetTimer(APP_TIMER_PROTOCOL_RSP, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, APP_TIMER_3S);
+            }
+            else
+            {
+                app_trpc_UartCompressOffer(p_trpConn);
+            }
+        }
+        break;
+
+        case TRPC_UART_STATE_SR_OFFER:
+        {
+            // Wait for both the write response of the offer and the answer of the server
+            if ((p_trpConn->gattcRspWait) || (p_trpConn->p_cold->p_srTx == NULL) || (!p_trpConn->p_cold->p_srTx->answered))
+                break;
+
+            if (p_trpConn->p_cold->p_srTx->active)
+            {
+                APP_TRP_COMMON_SetDataWriteCommand(p_trpConn, true);
+                p_trpConn->lePktLeng = 0;
+                bt_shell_printf("UART mode selective repeat is enabled\n");
+            }
+            else
+            {
+                APP_TRP_COMMON_StopSr(p_trpConn);
+                bt_shell_printf("UART mode selective repeat is declined by the peer\n");
+            }
+            app_trpc_UartCompressOffer(p_trpConn);
+        }
+        break;
+
+        case TRPC_UART_STATE_COMPRESS_OFFER:
+        {
+            // Wait for both the write response of the offer and the answer of the server
+            if ((p_trpConn->gattcRspWait) || (p_trpConn->p_cold->p_compress == NULL) || (!p_trpConn->p_cold->p_compress->answered))
+                break;
+
+            if (p_trpConn->p_cold->p_compress->codec == APP_TRP_COMPRESS_CODEC_NONE)
+            {
+                APP_TRP_COMMON_StopCompress(p_trpConn);
+                bt_shell_printf("UART mode compression is declined by the peer\n");
+                app_trpc_UartRelayStart(p_trpConn);
+                break;
+            }
+
+            // Decode before confirming, the server encodes once it gets the confirmation
+            p_trpConn->p_cold->p_compress->rxEn = true;
+            p_trpConn->p_cold->p_compress->txEn = true;
+            p_trpConn->trpState = TRPC_UART_STATE_COMPRESS_CONFIRM;
+            APP_TRP_COMMON_SendCompressCommand(p_trpConn, APP_TRP_WMODE_COMPRESS_ACCEPT);
+        }
+        break;
+
+        case TRPC_UART_STATE_COMPRESS_CONFIRM:
+        {
+            bt_shell_printf("UART mode compression is enabled\n");
+            app_trpc_UartRelayStart(p_trpConn);
         }
         break;
 
@@ -202,12 +311,16 @@ static void app_trpc_UartStateMachine(uint8_t event, APP_TRP_ConnList_T *p_trpCo
     }
 }
 
-static void app_trpc_LoopbackRxDataCheck(APP_TRP_ConnList_T *p_trpConn)
+static void app_trpc_LoopbackRxChecked(APP_TRP_ConnList_T *p_trpConn, uint16_t status, uint32_t checkedLeng)
 {
     uint16_t result = APP_RES_FAIL;
-    
-    result = APP_TRP_COMMON_CheckFixPatternData(p_trpConn);
-    if (result != APP_RES_SUCCESS)
+
+    (void)checkedLeng;
+
+    if ((p_trpConn->trpState != TRPC_LB_STATE_WAIT_STOP_TX) || (p_trpConn->workModeEn == false))
+        return;
+
+    if (status != APP_RES_SUCCESS)
     {
         APP_LOG_ERROR("Loopback content error !\n");
         result = APP_TRP_COMMON_SendErrorRsp(p_trpConn, TRP_GRPID_LOOPBACK);
@@ -228,6 +341,12 @@ static void app_trpc_LoopbackRxDataCheck(APP_TRP_ConnList_T *p_trpConn)
         p_trpConn->workModeEn = false;
         APP_LOG_INFO("Loopback is successful !\n");
     }
+
+    if ((p_trpConn->trpState == TRPC_LB_STATE_WAIT_STOP_TX) && (p_trpConn->workModeEn == false))
+    {
+        p_trpConn->trpState = TRPC_LB_STATE_SEND_STOP_TX;
+        APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_TRANSMIT, APP_TRP_WMODE_TX_DATA_END);
+    }
 }
 
 static void app_trpc_LoopbackStateMachine(uint8_t event, APP_TRP_ConnList_T *p_trpConn)
@@ -294,10 +413,10 @@ static void app_trpc_LoopbackStateMachine(uint8_t event, APP_TRP_ConnList_T *p_t
         {
             if (event & APP_TRPC_EVENT_RX_LE_DATA)
             {
-                app_trpc_LoopbackRxDataCheck(p_trpConn);
+                APP_TRP_COMMON_CheckFixPatternData(p_trpConn, app_trpc_LoopbackRxChecked);
             }
             
-            if (p_trpConn->workModeEn == false)
+            if ((p_trpConn->trpState == TRPC_LB_STATE_WAIT_STOP_TX) && (p_trpConn->workModeEn == false))
             {
                 p_trpConn->trpState = TRPC_LB_STATE_SEND_STOP_TX;
                 APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_TRANSMIT, APP_TRP_WMODE_TX_DATA_END);
@@ -322,10 +441,284 @@ static void app_trpc_LoopbackStateMachine(uint8_t event, APP_TRP_ConnList_T *p_t
     }
 }
 
-static void app_trpc_FixPatternStateMachine(uint8_t event, APP_TRP_ConnList_T *p_trpConn)
+static void app_trpc_RevLoopbackStop(APP_TRP_ConnList_T *p_trpConn)
 {
     uint16_t result = APP_RES_FAIL;
-    
+
+    p_trpConn->workModeEn = false;
+    APP_TRP_COMMON_DelAllLeCircData(&(p_trpConn->leCircQueue));
+    APP_TRP_COMMON_FreeLeData(p_trpConn);
+
+    //Retried on the data response if an echo write is still in flight
+    result = APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_REV_LOOPBACK, APP_TRP_WMODE_REV_LOOPBACK_DISABLE);
+    if (result == APP_RES_SUCCESS)
+    {
+        p_trpConn->trpState = TRPC_REV_LB_STATE_SEND_STOP_TX;
+    }
+}
+
+static void app_trpc_RevLoopbackTrx(uint8_t event, APP_TRP_ConnList_T *p_trpConn)
+{
+    uint16_t result = APP_RES_FAIL;
+
+    if ((event & APP_TRPC_EVENT_TRX_END) || (p_trpConn->workModeEn == false))
+    {
+        app_trpc_RevLoopbackStop(p_trpConn);
+        return;
+    }
+
+    if (event & (APP_TRPC_EVENT_RX_LE_DATA | APP_TRPC_EVENT_TX_LE_DATA))
+    {
+        // Echo the received pattern, one write is in flight at a time
+        result = APP_TRP_COMMON_SendMultiLinkLeDataTrpProfile(&s_trpcTrafficPriority, p_trpConn);
+        if ((result != APP_RES_SUCCESS) && (result != APP_RES_BUSY))
+        {
+            APP_LOG_ERROR("Reverse loopback echo error(%d) !\n", result);
+        }
+    }
+}
+
+static void app_trpc_RevLoopbackStateMachine(uint8_t event, APP_TRP_ConnList_T *p_trpConn)
+{
+    uint16_t result = APP_RES_FAIL;
+
+    APP_TIMER_SetTimer(APP_TIMER_PROTOCOL_RSP, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, APP_TIMER_3S);
+
+    switch(p_trpConn->trpState)
+    {
+        case TRPC_REV_LB_STATE_NULL:
+        {
+            p_trpConn->trpState = TRPC_REV_LB_STATE_ENABLE_MODE;
+            APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_REV_LOOPBACK, APP_TRP_WMODE_REV_LOOPBACK_ENABLE);
+        }
+        break;
+
+        case TRPC_REV_LB_STATE_ENABLE_MODE:
+        {
+            p_trpConn->trpState = TRPC_REV_LB_STATE_SEND_TYPE;
+            APP_TRP_COMMON_SendTypeCommand(p_trpConn);
+        }
+        break;
+
+        case TRPC_REV_LB_STATE_SEND_TYPE:
+        {
+            // The server starts sourcing the pattern as soon as it gets the start command
+            p_trpConn->trpState = TRPC_REV_LB_STATE_START_TX;
+            p_trpConn->workModeEn = true;
+            p_trpConn->rxAccuLeng = 0;
+            APP_TRP_COMMON_StartLog(p_trpConn);
+            APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_TRANSMIT, APP_TRP_WMODE_TX_DATA_START);
+        }
+        break;
+
+        case TRPC_REV_LB_STATE_START_TX:
+        {
+            if (event == APP_TRPC_EVENT_NULL)
+                p_trpConn->trpState = TRPC_REV_LB_STATE_TRX;
+
+            app_trpc_RevLoopbackTrx(event, p_trpConn);
+        }
+        break;
+
+        case TRPC_REV_LB_STATE_TRX:
+        {
+            app_trpc_RevLoopbackTrx(event, p_trpConn);
+        }
+        break;
+
+        case TRPC_REV_LB_STATE_SEND_STOP_TX:
+        {
+            p_trpConn->trpState = TRPC_REV_LB_STATE_NULL;
+            result = APP_TIMER_StopTimer(APP_TIMER_PROTOCOL_RSP, APP_TRP_COMMON_GetConnIndex(p_trpConn));
+            if (result != APP_RES_SUCCESS)
+            {
+                APP_LOG_ERROR("APP_TIMER_PROTOCOL_RSP stop error ! result=%d\n", result);
+            }
+
+            APP_TRP_COMMON_FinishLog(p_trpConn);
+        }
+        break;
+
+        default:
+            break;
+    }
+}
+
+static void app_trpc_DuplexStop(APP_TRP_ConnList_T *p_trpConn)
+{
+    uint16_t result = APP_RES_FAIL;
+
+    p_trpConn->workModeEn = false;
+    APP_TRP_COMMON_DelAllLeCircData(&(p_trpConn->leCircQueue));
+    APP_TRP_COMMON_FreeLeData(p_trpConn);
+
+    //Retried on the data response if a pattern write is still in flight
+    result = APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_DUPLEX, APP_TRP_WMODE_DUPLEX_DISABLE);
+    if (result == APP_RES_SUCCESS)
+    {
+        p_trpConn->trpState = TRPC_DUPLEX_STATE_SEND_STOP_TX;
+    }
+}
+
+static void app_trpc_DuplexCheckDone(APP_TRP_ConnList_T *p_trpConn)
+{
+    if ((p_trpConn->workModeEn == true) && (p_trpConn->p_cold->txDoneTime > 0) && (p_trpConn->p_cold->rxDoneTime > 0))
+    {
+        p_trpConn->p_cold->testStage = APP_TEST_PASSED;
+        app_trpc_DuplexStop(p_trpConn);
+    }
+}
+
+static void app_trpc_DuplexRxChecked(APP_TRP_ConnList_T *p_trpConn, uint16_t status, uint32_t checkedLeng)
+{
+    (void)checkedLeng;
+
+    if (((p_trpConn->trpState != TRPC_DUPLEX_STATE_START_TX) && (p_trpConn->trpState != TRPC_DUPLEX_STATE_TRX))
+        || (p_trpConn->workModeEn == false))
+        return;
+
+    if (status != APP_RES_SUCCESS)
+    {
+        APP_LOG_ERROR("Duplex pattern content error(%d) !\n", status);
+        p_trpConn->p_cold->testStage = APP_TEST_FAILED;
+        app_trpc_DuplexStop(p_trpConn);
+        return;
+    }
+
+    if ((p_trpConn->p_cold->rxDoneTime == 0) && (p_trpConn->rxAccuLeng >= APP_TRP_WMODE_TX_MAX_SIZE))
+        p_trpConn->p_cold->rxDoneTime = g_timer_elapsed(p_trpConn->p_cold->p_transTimer, NULL);
+
+    app_trpc_DuplexCheckDone(p_trpConn);
+}
+
+static void app_trpc_DuplexTrx(uint8_t event, APP_TRP_ConnList_T *p_trpConn)
+{
+    uint16_t result = APP_RES_FAIL;
+
+    if (p_trpConn->workModeEn == false)
+    {
+        app_trpc_DuplexStop(p_trpConn);
+        return;
+    }
+
+    if (event & APP_TRPC_EVENT_RX_LE_DATA)
+    {
+        // The result comes back from the data plane worker of the link
+        APP_TRP_COMMON_CheckFixPatternData(p_trpConn, app_trpc_DuplexRxChecked);
+        if (p_trpConn->workModeEn == false)
+            return;
+    }
+
+    // The pattern of the client is sent between the received packets, one write is in flight at a time
+    if ((event & APP_TRPC_EVENT_TX_LE_DATA) && (p_trpConn->trpState == TRPC_DUPLEX_STATE_TRX)
+        && (p_trpConn->p_cold->fixPattMaxSize > 0))
+    {
+        result = APP_TRP_COMMON_SendFixPattern(p_trpConn);
+        if (result == APP_RES_OOM)
+        {
+            APP_LOG_ERROR("Duplex pattern send error(%d) !\n", result);
+        }
+    }
+
+    // The server verified all the pattern of the client
+    if ((event & APP_TRPC_EVENT_TRX_END) && (p_trpConn->p_cold->txDoneTime == 0))
+        p_trpConn->p_cold->txDoneTime = g_timer_elapsed(p_trpConn->p_cold->p_transTimer, NULL);
+
+    APP_TRP_COMMON_ProgressingLog(p_trpConn);
+
+    app_trpc_DuplexCheckDone(p_trpConn);
+}
+
+static void app_trpc_DuplexStateMachine(uint8_t event, APP_TRP_ConnList_T *p_trpConn)
+{
+    uint16_t result = APP_RES_FAIL;
+
+    APP_TIMER_SetTimer(APP_TIMER_PROTOCOL_RSP, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, APP_TIMER_3S);
+
+    switch(p_trpConn->trpState)
+    {
+        case TRPC_DUPLEX_STATE_NULL:
+        {
+            p_trpConn->trpState = TRPC_DUPLEX_STATE_ENABLE_MODE;
+            APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_DUPLEX, APP_TRP_WMODE_DUPLEX_ENABLE);
+        }
+        break;
+
+        case TRPC_DUPLEX_STATE_ENABLE_MODE:
+        {
+            p_trpConn->trpState = TRPC_DUPLEX_STATE_SEND_TYPE;
+            APP_TRP_COMMON_SendTypeCommand(p_trpConn);
+        }
+        break;
+
+        case TRPC_DUPLEX_STATE_SEND_TYPE:
+        {
+            // The server starts sourcing its pattern as soon as it gets the start command
+            p_trpConn->trpState = TRPC_DUPLEX_STATE_START_TX;
+            p_trpConn->workModeEn = true;
+            APP_TRP_COMMON_InitFixPatternParam(p_trpConn);
+            p_trpConn->rxAccuLeng = 0;
+            p_trpConn->p_cold->txDoneTime = 0;
+            p_trpConn->p_cold->rxDoneTime = 0;
+            APP_TRP_COMMON_StartLog(p_trpConn);
+            APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_TRANSMIT, APP_TRP_WMODE_TX_DATA_START);
+        }
+        break;
+
+        case TRPC_DUPLEX_STATE_START_TX:
+        {
+            // The client starts sourcing its pattern once the server is ready to verify it
+            if (event == APP_TRPC_EVENT_NULL)
+            {
+                p_trpConn->trpState = TRPC_DUPLEX_STATE_TRX;
+                event = APP_TRPC_EVENT_TX_LE_DATA;
+            }
+
+            app_trpc_DuplexTrx(event, p_trpConn);
+        }
+        break;
+
+        case TRPC_DUPLEX_STATE_TRX:
+        {
+            app_trpc_DuplexTrx(event, p_trpConn);
+        }
+        break;
+
+        case TRPC_DUPLEX_STATE_SEND_STOP_TX:
+        {
+            p_trpConn->trpState = TRPC_DUPLEX_STATE_NULL;
+            result = APP_TIMER_StopTimer(APP_TIMER_PROTOCOL_RSP, APP_TRP_COMMON_GetConnIndex(p_trpConn));
+            if (result != APP_RES_SUCCESS)
+            {
+                APP_LOG_ERROR("APP_TIMER_PROTOCOL_RSP stop error ! result=%d\n", result);
+            }
+
+            APP_TRP_COMMON_FinishLog(p_trpConn);
+        }
+        break;
+
+        default:
+            break;
+    }
+}
+
+static void app_trpc_FixPatternRxChecked(APP_TRP_ConnList_T *p_trpConn, uint16_t status, uint32_t checkedLeng)
+{
+    (void)checkedLeng;
+
+    if ((p_trpConn->trpState != TRPC_FP_STATE_RX) || (status == APP_RES_SUCCESS))
+        return;
+
+    APP_LOG_ERROR("Fix pattern content error(%d) !\n", status);
+    APP_TRP_COMMON_DelAllLeCircData(&(p_trpConn->leCircQueue));
+    p_trpConn->trpState = TRPC_FP_STATE_SEND_LAST_NUMBER;
+    p_trpConn->lastNumber = p_trpConn->rxLastNunber;
+    APP_TRP_COMMON_SendLastNumber(p_trpConn);
+    APP_TRP_COMMON_SendErrorRsp(p_trpConn, TRP_GRPID_FIX_PATTERN);
+}
+
+static void app_trpc_FixPatternStateMachine(uint8_t event, APP_TRP_ConnList_T *p_trpConn)
+{
     APP_TIMER_SetTimer(APP_TIMER_PROTOCOL_RSP, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, APP_TIMER_3S);
 
         
@@ -339,6 +732,21 @@ static void app_trpc_FixPatternStateMachine(uint8_t event, APP_TRP_ConnList_T *p
             break;
 
         case TRPC_FP_STATE_ENABLE_MODE:
+        {
+            // A tuning probe asks the server for a shorter pattern
+            if (APP_TUNE_IsProbing(p_trpConn))
+            {
+                p_trpConn->trpState = TRPC_FP_STATE_SEND_LENGTH;
+                APP_TRP_COMMON_SendLengthCommand(p_trpConn, APP_TUNE_PROBE_SIZE);
+                break;
+            }
+            p_trpConn->trpState = TRPC_FP_STATE_SEND_TYPE;
+            APP_TRP_COMMON_SendTypeCommand(p_trpConn);
+            APP_TRP_COMMON_StartLog(p_trpConn);
+        }
+            break;
+
+        case TRPC_FP_STATE_SEND_LENGTH:
         {
             p_trpConn->trpState = TRPC_FP_STATE_SEND_TYPE;
             APP_TRP_COMMON_SendTypeCommand(p_trpConn);
@@ -351,9 +759,7 @@ static void app_trpc_FixPatternStateMachine(uint8_t event, APP_TRP_ConnList_T *p
             p_trpConn->trpState = TRPC_FP_STATE_RX;
             APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_TRANSMIT, APP_TRP_WMODE_TX_DATA_START);
             p_trpConn->workModeEn = true;
-            p_trpConn->rxLastNunber = 0;
-            p_trpConn->checkSum = 0;
-            p_trpConn->rxAccuLeng = 0;
+            APP_TRP_COMMON_ResetRxCheck(p_trpConn);
         }
             break;
 
@@ -361,22 +767,14 @@ static void app_trpc_FixPatternStateMachine(uint8_t event, APP_TRP_ConnList_T *p
         {
             if (event & APP_TRPC_EVENT_RX_LE_DATA)
             {
-                result = APP_TRP_COMMON_CheckFixPatternData(p_trpConn);
-                if (result != APP_RES_SUCCESS)
-                {
-                    APP_LOG_ERROR("Fix pattern content error(%d) !\n", result);
-                    APP_TRP_COMMON_DelAllLeCircData(&(p_trpConn->leCircQueue));
-                    p_trpConn->trpState = TRPC_FP_STATE_SEND_LAST_NUMBER;
-                    p_trpConn->lastNumber = p_trpConn->rxLastNunber;
-                    APP_TRP_COMMON_SendLastNumber(p_trpConn);
-                    result = APP_TRP_COMMON_SendErrorRsp(p_trpConn, TRP_GRPID_FIX_PATTERN);
-                }
-                APP_TRP_COMMON_ProgressingLog(p_trpConn);
+                // The result comes back from the data plane worker of the link
+                APP_TRP_COMMON_CheckFixPatternData(p_trpConn, app_trpc_FixPatternRxChecked);
+                if (!APP_TUNE_IsProbing(p_trpConn))
+                    APP_TRP_COMMON_ProgressingLog(p_trpConn);
             }
             if (event & APP_TRPC_EVENT_TRX_END)
             {
                 p_trpConn->trpState = TRPC_FP_STATE_WAIT_LAST_NUMBER;
-                (p_trpConn->rxLastNunber)--;
             }
         }
             break;
@@ -385,9 +783,10 @@ static void app_trpc_FixPatternStateMachine(uint8_t event, APP_TRP_ConnList_T *p
         {
             if (event & APP_TRPC_EVENT_LAST_NUMBER)
             {
+                // The last number received is the one before the next expected
                 p_trpConn->trpState = TRPC_FP_STATE_SEND_LAST_NUMBER;
-                p_trpConn->lastNumber = p_trpConn->rxLastNunber;
-                result = APP_TRP_COMMON_SendLastNumber(p_trpConn);
+                p_trpConn->lastNumber = p_trpConn->rxLastNunber - 1;
+                APP_TRP_COMMON_SendLastNumber(p_trpConn);
             }
         }
             break;
@@ -400,7 +799,10 @@ static void app_trpc_FixPatternStateMachine(uint8_t event, APP_TRP_ConnList_T *p
             APP_TIMER_StopTimer(APP_TIMER_PROTOCOL_RSP, APP_TRP_COMMON_GetConnIndex(p_trpConn));
             //APP_TRPC_WmodeStateMachine(p_connList_t);
 
-            APP_TRP_COMMON_FinishLog(p_trpConn);
+            if (APP_TUNE_IsProbing(p_trpConn))
+                APP_TUNE_ProbeDone(p_trpConn);
+            else
+                APP_TRP_COMMON_FinishLog(p_trpConn);
         }
             break;
 
@@ -410,6 +812,29 @@ static void app_trpc_FixPatternStateMachine(uint8_t event, APP_TRP_ConnList_T *p
 
 }
 
+//All the data received before the last number of the server is checked
+static void app_trpc_FixPatternLastNumberChecked(APP_TRP_ConnList_T *p_trpConn, uint16_t status, uint32_t checkedLeng)
+{
+    (void)checkedLeng;
+
+    if ((status == APP_RES_SUCCESS) && ((uint16_t)(p_trpConn->rxLastNunber - 1) == p_trpConn->p_cold->peerLastNumber))
+    {
+        p_trpConn->p_cold->testStage = APP_TEST_PASSED;
+        //bt_shell_printf("Fixed Pattern is successful !\n");
+    }
+    else
+    {
+        p_trpConn->p_cold->testStage = APP_TEST_FAILED;
+        //bt_shell_printf("Fixed Pattern is error. FP_C:%d,FP_S:%d", p_trpConn->rxLastNunber - 1,
+        //    p_trpConn->p_cold->peerLastNumber);
+    }
+
+    if (p_trpConn->trpState == TRPC_FP_STATE_WAIT_LAST_NUMBER)
+        app_trpc_FixPatternStateMachine(APP_TRPC_EVENT_LAST_NUMBER, p_trpConn);
+    else
+        APP_TRP_COMMON_SendErrorRsp(p_trpConn, TRP_GRPID_FIX_PATTERN);
+}
+
 static void app_trpc_CheckSumStateMachine(uint8_t event, APP_TRP_ConnList_T *p_trpConn)
 {
     uint16_t result = APP_RES_FAIL;
@@ -516,12 +941,52 @@ static void app_trpc_CheckSumStateMachine(uint8_t event, APP_TRP_ConnList_T *p_t
 }
 
 
+static void app_trpc_SrCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t commandId, uint8_t length, uint8_t *p_payload)
+{
+    APP_SR_Tx_T *p_srTx = p_trpConn->p_cold->p_srTx;
+    uint8_t inFlight;
+
+    if (p_srTx == NULL)
+        return;
+
+    // The first acknowledgement accepts the offer
+    if (!p_srTx->active)
+    {
+        if ((p_trpConn->workMode == TRP_WMODE_UART) && (p_trpConn->trpState == TRPC_UART_STATE_SR_OFFER))
+        {
+            p_srTx->answered = true;
+            if ((commandId == APP_TRP_WMODE_SR_ACK) && (APP_SR_TxAck(p_srTx, p_payload, length) == APP_RES_SUCCESS))
+                p_srTx->active = true;
+            app_trpc_UartStateMachine(APP_TRPC_EVENT_SR, p_trpConn);
+        }
+        return;
+    }
+
+    if (commandId == APP_TRP_WMODE_SR_DISABLE)
+    {
+        APP_TRP_COMMON_StopSr(p_trpConn);
+        return;
+    }
+
+    inFlight = APP_SR_TxInFlight(p_srTx);
+    if ((commandId != APP_TRP_WMODE_SR_ACK) || (APP_SR_TxAck(p_srTx, p_payload, length) != APP_RES_SUCCESS))
+        return;
+
+    // Restart the retransmission timeout on progress only
+    if (APP_SR_TxInFlight(p_srTx) == 0)
+        APP_TIMER_StopTimer(APP_TIMER_SR_RTO, APP_TRP_COMMON_GetConnIndex(p_trpConn));
+    else if (APP_SR_TxInFlight(p_srTx) < inFlight)
+        APP_TIMER_SetTimer(APP_TIMER_SR_RTO, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, APP_TRP_SR_RTO);
+
+    app_trpc_SrSend(p_trpConn);
+}
+
 static void app_trpc_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t length, uint8_t *p_cmd)
 {
     uint8_t idx, groupId, commandId;
     bool    sendErrCommandFg = false;
     uint8_t grpId[] = {TRP_GRPID_NULL, TRP_GRPID_CHECK_SUM, TRP_GRPID_LOOPBACK, TRP_GRPID_FIX_PATTERN,
-        TRP_GRPID_UART, TRP_GRPID_REV_LOOPBACK};
+        TRP_GRPID_UART, TRP_GRPID_REV_LOOPBACK, TRP_GRPID_DUPLEX};
     uint16_t lastNumberServer;
 
     idx = 1;
@@ -529,6 +994,18 @@ static void app_trpc_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t length
     commandId = p_cmd[idx++];
     //printf("(W=%d)Group ID = %d, Command ID = %d \n", p_trpConn->workMode, groupId, commandId);
 
+    if (groupId == TRP_GRPID_SR)
+    {
+        app_trpc_SrCmdProc(p_trpConn, commandId, (length > idx) ? (length - idx) : 0, &p_cmd[idx]);
+        return;
+    }
+
+    if (groupId == TRP_GRPID_UPDATE_CONN_PARA)
+    {
+        APP_TUNE_ConnParaCmdProc(p_trpConn, commandId, (length > idx) ? p_cmd[idx] : APP_TUNE_STATUS_FAIL);
+        return;
+    }
+
 
     switch(p_trpConn->workMode)
     {
@@ -540,12 +1017,12 @@ static void app_trpc_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t length
                 {
                     if (((uint8_t)(p_trpConn->checkSum)) == p_cmd[idx])
                     {
-                        p_trpConn->testStage = APP_TEST_PASSED;
+                        p_trpConn->p_cold->testStage = APP_TEST_PASSED;
                         //bt_shell_printf("Check sum is successful !\n");
                     }
                     else
                     {
-                        p_trpConn->testStage = APP_TEST_FAILED;
+                        p_trpConn->p_cold->testStage = APP_TEST_FAILED;
                         //bt_shell_printf("Check sum is error. CS_C:%d,CS_S:%d\n", (uint8_t)(p_trpConn->checkSum), p_cmd[idx]);
                     }
                     
@@ -570,21 +1047,9 @@ static void app_trpc_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t length
                 {
                     lastNumberServer = p_cmd[idx++];
                     lastNumberServer = (lastNumberServer << 8) | p_cmd[idx];
-                    if (p_trpConn->rxLastNunber == lastNumberServer)
-                    {
-                        p_trpConn->testStage = APP_TEST_PASSED;
-                        //bt_shell_printf("Fixed Pattern is successful !\n");
-                    }
-                    else
-                    {
-                        p_trpConn->testStage = APP_TEST_FAILED;
-                        //bt_shell_printf("Fixed Pattern is error. FP_C:%d,FP_S:%d", p_trpConn->rxLastNunber, 
-                        //    lastNumberServer);
-                    }
-                    if (p_trpConn->trpState == TRPC_FP_STATE_WAIT_LAST_NUMBER)
-                        app_trpc_FixPatternStateMachine(APP_TRPC_EVENT_LAST_NUMBER, p_trpConn);
-                    else
-                        sendErrCommandFg = true;
+                    // Compared once the data plane worker checked all the data received before
+                    p_trpConn->p_cold->peerLastNumber = lastNumberServer;
+                    APP_TRP_COMMON_FlushRxCheck(p_trpConn, app_trpc_FixPatternLastNumberChecked);
                 }
                 else if (commandId == APP_TRP_WMODE_ERROR_RSP)
                 {
@@ -617,6 +1082,70 @@ static void app_trpc_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t length
                 if ((commandId == APP_TRP_WMODE_UART_DISABLE) && (p_trpConn->trpState == TRPC_UART_STATE_RELAY_DATA))
                     app_trpc_UartStateMachine(APP_TRPC_EVENT_TRX_END, p_trpConn);
             }
+            else if ((groupId == TRP_GRPID_COMPRESS) && (p_trpConn->trpState == TRPC_UART_STATE_COMPRESS_OFFER)
+                && (p_trpConn->p_cold->p_compress != NULL))
+            {
+                if ((commandId == APP_TRP_WMODE_COMPRESS_ACCEPT) && (length > idx)
+                    && (p_cmd[idx] == APP_TRP_COMMON_GetCompress()))
+                {
+                    p_trpConn->p_cold->p_compress->codec = p_cmd[idx];
+                }
+                p_trpConn->p_cold->p_compress->answered = true;
+                app_trpc_UartStateMachine(APP_TRPC_EVENT_COMPRESS, p_trpConn);
+            }
+            else if ((groupId == TRP_GRPID_TRANSMIT) && (length >= idx + 8))
+            {
+                // Resume negotiation of a file sent in UART mode
+                if (commandId == APP_TRP_WMODE_TX_DATA_LENGTH)
+                    APP_RawDataFileInfo(p_trpConn, get_be32(&p_cmd[idx]), get_be32(&p_cmd[idx + 4]));
+                else if (commandId == APP_TRP_WMODE_TX_DATA_OFFSET)
+                    APP_RawDataResume(p_trpConn, get_be32(&p_cmd[idx]), get_be32(&p_cmd[idx + 4]));
+            }
+        }
+        break;
+
+        case TRP_WMODE_REV_LOOPBACK:
+        {
+            // The server verifies the echoed pattern and reports the result
+            if (((groupId == TRP_GRPID_TRANSMIT) && (commandId == APP_TRP_WMODE_TX_DATA_END)) ||
+                ((groupId == TRP_GRPID_REV_LOOPBACK) && (commandId == APP_TRP_WMODE_ERROR_RSP)))
+            {
+                if (groupId == TRP_GRPID_TRANSMIT)
+                {
+                    p_trpConn->p_cold->testStage = APP_TEST_PASSED;
+                }
+                else
+                {
+                    p_trpConn->p_cold->testStage = APP_TEST_FAILED;
+                    bt_shell_printf("Reverse loopback procedure is error!\n");
+                }
+
+                if ((p_trpConn->trpState == TRPC_REV_LB_STATE_START_TX) || (p_trpConn->trpState == TRPC_REV_LB_STATE_TRX))
+                    app_trpc_RevLoopbackStateMachine(APP_TRPC_EVENT_TRX_END, p_trpConn);
+                else
+                    sendErrCommandFg = true;
+            }
+        }
+        break;
+
+        case TRP_WMODE_DUPLEX:
+        {
+            // The server verifies the pattern of the client while it sends its own
+            if (((groupId == TRP_GRPID_TRANSMIT) && (commandId == APP_TRP_WMODE_TX_DATA_END)) ||
+                ((groupId == TRP_GRPID_DUPLEX) && (commandId == APP_TRP_WMODE_ERROR_RSP)))
+            {
+                if (groupId == TRP_GRPID_DUPLEX)
+                {
+                    p_trpConn->p_cold->testStage = APP_TEST_FAILED;
+                    p_trpConn->workModeEn = false;
+                    bt_shell_printf("Duplex procedure is error!\n");
+                }
+
+                if ((p_trpConn->trpState == TRPC_DUPLEX_STATE_START_TX) || (p_trpConn->trpState == TRPC_DUPLEX_STATE_TRX))
+                    app_trpc_DuplexStateMachine(APP_TRPC_EVENT_TRX_END, p_trpConn);
+                else
+                    sendErrCommandFg = true;
+            }
         }
         break;
 
@@ -624,14 +1153,6 @@ static void app_trpc_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t length
             break;
     }
 
-    /*
-    if (groupId == TRP_GRPID_UPDATE_CONN_PARA)
-    {
-        sendErrCommandFg = true;
-    }
-    */
-
-
     if (sendErrCommandFg)
     {
         //printf("VendorCmdProc, SendErrorRsp\n");
@@ -661,6 +1182,14 @@ static void app_trpc_VendorCmdRspProc(APP_TRP_ConnList_T *p_trpConn)
             app_trpc_UartStateMachine(APP_TRPC_EVENT_NULL, p_trpConn);
             break;
 
+        case TRP_WMODE_REV_LOOPBACK:
+            app_trpc_RevLoopbackStateMachine(APP_TRPC_EVENT_NULL, p_trpConn);
+            break;
+
+        case TRP_WMODE_DUPLEX:
+            app_trpc_DuplexStateMachine(APP_TRPC_EVENT_NULL, p_trpConn);
+            break;
+
         default:
             break;
     }
@@ -678,6 +1207,8 @@ void APP_TRPC_EventHandler(BLE_TRSPC_Event_T *p_event)
     APP_TRP_ConnList_T *p_trpcConnLink = NULL;
     uint16_t status;
 
+    APP_REPLAY_RecordTrpcEvt(p_event);
+
     switch(p_event->eventId)
     {
         case BLE_TRSPC_EVT_UL_STATUS:
@@ -695,7 +1226,7 @@ void APP_TRPC_EventHandler(BLE_TRSPC_Event_T *p_event)
                     p_trpcConnLink->workMode = TRP_WMODE_UART;
                     p_trpcConnLink->trpState = TRPC_UART_STATE_NULL;
                     app_trpc_UartStateMachine(APP_TRPC_EVENT_NULL, p_trpcConnLink);
-
+                    APP_SCRIPT_LinkReady(p_trpcConnLink->p_deviceProxy);
                 }
             }
         }
@@ -716,7 +1247,11 @@ void APP_TRPC_EventHandler(BLE_TRSPC_Event_T *p_event)
                 }
                 else
                 {
-                    p_trpcConnLink->type = APP_TRP_TYPE_LEGACY;
+                    //The data path stays on the TRCBP channel once it is opened
+                    if (trpLinkType != APP_TRP_TYPE_TRCBP)
+                    {
+                        p_trpcConnLink->type = APP_TRP_TYPE_LEGACY;
+                    }
                     
                     /*if (p_event->eventField.onDownlinkStatus.status == BLE_TRSPC_DL_STATUS_CBFCENABLED)
                     {
@@ -749,7 +1284,7 @@ void APP_TRPC_EventHandler(BLE_TRSPC_Event_T *p_event)
         case BLE_TRSPC_EVT_RECEIVE_DATA:
         {
             uint8_t grpId[] = {TRP_GRPID_NULL, TRP_GRPID_CHECK_SUM, TRP_GRPID_LOOPBACK, TRP_GRPID_FIX_PATTERN,
-                TRP_GRPID_UART, TRP_GRPID_REV_LOOPBACK};
+                TRP_GRPID_UART, TRP_GRPID_REV_LOOPBACK, TRP_GRPID_DUPLEX};
                 
             p_trpcConnLink = APP_TRP_COMMON_GetConnListByDevProxy(p_event->eventField.onReceiveData.p_dev);
             
@@ -821,15 +1356,21 @@ void APP_TRPC_EventHandler(BLE_TRSPC_Event_T *p_event)
                     //clear waiting
                     p_trpcConnLink->gattcRspWait = 0;
 
+                    //Frames asked again by the server go first
+                    if (app_trpc_SrResend(p_trpcConnLink))
+                        break;
+
                     if (p_trpcConnLink->workMode == TRP_WMODE_LOOPBACK && p_trpcConnLink->workModeEn == true)
                     {
-                        //Fetch pattern data into queue
-                        APP_TIMER_SetTimer(APP_TIMER_FILE_FETCH, transIndex, (void*)p_trpcConnLink->p_deviceProxy, APP_TIMER_10MS);
+                        //Fetch pattern data into queue, the low mark of a paused queue fetches again
+                        if (!p_trpcConnLink->uartCircQueue.isPaused)
+                            APP_TIMER_SetTimer(APP_TIMER_FILE_FETCH, transIndex, (void*)p_trpcConnLink->p_deviceProxy, APP_TIMER_10MS);
                     }
                     else if (p_trpcConnLink->workMode == TRP_WMODE_UART && p_trpcConnLink->workModeEn == true)
                     {
-                        //Fetch console data into queue
-                        APP_TIMER_SetTimer(APP_TIMER_RAW_DATA_FETCH, transIndex, (void*)p_trpcConnLink->p_deviceProxy, APP_TIMER_1MS);
+                        //Fetch console data into queue, the low mark of a paused queue fetches again
+                        if (!p_trpcConnLink->uartCircQueue.isPaused)
+                            APP_TIMER_SetTimer(APP_TIMER_RAW_DATA_FETCH, transIndex, (void*)p_trpcConnLink->p_deviceProxy, APP_TIMER_1MS);
                     }
                     else
                     {
@@ -906,6 +1447,30 @@ void APP_TRPC_TxProc(APP_TRP_ConnList_T * p_trpConn)
             }
             break;
 
+            case TRP_WMODE_REV_LOOPBACK:
+            {
+                if ((sp_trpcCurrentLink->trpState == TRPC_REV_LB_STATE_START_TX) ||
+                    (sp_trpcCurrentLink->trpState == TRPC_REV_LB_STATE_TRX))
+                {
+                    app_trpc_RevLoopbackStateMachine(APP_TRPC_EVENT_TX_LE_DATA, sp_trpcCurrentLink);
+                }
+
+                sp_trpcCurrentLink->maxAvailTxNumber = 0;
+            }
+            break;
+
+            case TRP_WMODE_DUPLEX:
+            {
+                if ((sp_trpcCurrentLink->trpState == TRPC_DUPLEX_STATE_START_TX) ||
+                    (sp_trpcCurrentLink->trpState == TRPC_DUPLEX_STATE_TRX))
+                {
+                    app_trpc_DuplexStateMachine(APP_TRPC_EVENT_TX_LE_DATA, sp_trpcCurrentLink);
+                }
+
+                sp_trpcCurrentLink->maxAvailTxNumber = 0;
+            }
+            break;
+
             default:
             {
                 //Change link
@@ -974,6 +1539,20 @@ static void app_trpc_LeRxProc(APP_TRP_ConnList_T *p_trpConn)
             }
             break;
 
+            case TRP_WMODE_REV_LOOPBACK:
+            {
+                app_trpc_RevLoopbackStateMachine(APP_TRPC_EVENT_RX_LE_DATA, sp_trpcCurrentLink);
+                s_trpcTrafficPriority.validNumber = 0;
+            }
+            break;
+
+            case TRP_WMODE_DUPLEX:
+            {
+                app_trpc_DuplexStateMachine(APP_TRPC_EVENT_RX_LE_DATA, sp_trpcCurrentLink);
+                s_trpcTrafficPriority.validNumber = 0;
+            }
+            break;
+
             case TRP_WMODE_UART:
             {
                 app_trpc_UartStateMachine(APP_TRPC_EVENT_RX_LE_DATA, sp_trpcCurrentLink);
@@ -1015,10 +1594,85 @@ static void app_trpc_LeRxProc(APP_TRP_ConnList_T *p_trpConn)
 
 }
 
-uint16_t APP_TRPC_LeTxData(APP_TRP_ConnList_T *p_trpConn, uint16_t len, uint8_t *p_data)
+static uint16_t app_trpc_LeSend(APP_TRP_ConnList_T *p_trpConn, uint16_t len, uint8_t *p_data)
 {
     uint16_t status = TRSP_RES_SUCCESS;
 
+    if (APP_REPLAY_IsReplaying())
+    {
+        status = APP_REPLAY_GetSendResult(p_trpConn->p_deviceProxy);
+    }
+    else
+    {
+        status = BLE_TRSPC_SendData(p_trpConn->p_deviceProxy, len, p_data);
+        APP_REPLAY_RecordSend(p_trpConn->p_deviceProxy, status);
+    }
+    if (status != TRSP_RES_SUCCESS)
+        return status;
+
+    p_trpConn->gattcRspWait = APP_TRP_SEND_DATA_FAIL;
+
+    return APP_RES_SUCCESS;
+}
+
+//Return true while a frame waits for retransmission, whether it is sent now or not
+static bool app_trpc_SrResend(APP_TRP_ConnList_T *p_trpConn)
+{
+    uint8_t *p_frame;
+    uint16_t frameLeng;
+
+    if ((p_trpConn->p_cold->p_srTx == NULL) || (!p_trpConn->p_cold->p_srTx->active))
+        return false;
+
+    if (APP_SR_TxGetResend(p_trpConn->p_cold->p_srTx, &p_frame, &frameLeng) != APP_RES_SUCCESS)
+        return false;
+
+    if ((p_trpConn->gattcRspWait == 0) && (app_trpc_LeSend(p_trpConn, frameLeng, p_frame) == APP_RES_SUCCESS))
+        APP_SR_TxResent(p_trpConn->p_cold->p_srTx, p_frame[0]);
+
+    return true;
+}
+
+//Send the frames asked again, then the packets held by a full window
+static void app_trpc_SrSend(APP_TRP_ConnList_T *p_trpConn)
+{
+    if ((p_trpConn->gattcRspWait) || (!p_trpConn->workModeEn))
+        return;
+
+    if (app_trpc_SrResend(p_trpConn))
+        return;
+
+    if ((p_trpConn->workMode == TRP_WMODE_UART) && (p_trpConn->uartCircQueue.usedNum > 0))
+        APP_TRP_COMMON_SendLeDataUartCircQueue(p_trpConn);
+}
+
+static uint16_t app_trpc_SrTxData(APP_TRP_ConnList_T *p_trpConn, uint16_t len, uint8_t *p_data)
+{
+    uint8_t *p_frame;
+    uint16_t frameLeng, status;
+    uint8_t inFlight;
+
+    if (app_trpc_SrResend(p_trpConn))
+        return APP_RES_BUSY;
+
+    status = APP_SR_TxFrame(p_trpConn->p_cold->p_srTx, p_data, len, &p_frame, &frameLeng);
+    if (status != APP_RES_SUCCESS)
+        return status;
+
+    status = app_trpc_LeSend(p_trpConn, frameLeng, p_frame);
+    if (status != APP_RES_SUCCESS)
+        return status;
+
+    inFlight = APP_SR_TxInFlight(p_trpConn->p_cold->p_srTx);
+    APP_SR_TxCommit(p_trpConn->p_cold->p_srTx);
+    if (inFlight == 0)
+        APP_TIMER_SetTimer(APP_TIMER_SR_RTO, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, APP_TRP_SR_RTO);
+
+    return APP_RES_SUCCESS;
+}
+
+uint16_t APP_TRPC_LeTxData(APP_TRP_ConnList_T *p_trpConn, uint16_t len, uint8_t *p_data)
+{
     if (p_trpConn == NULL || p_data == NULL || len == 0)
         return APP_RES_FAIL;
 
@@ -1027,22 +1681,47 @@ uint16_t APP_TRPC_LeTxData(APP_TRP_ConnList_T *p_trpConn, uint16_t len, uint8_t
         return APP_RES_BUSY;
     }
 
-    status = BLE_TRSPC_SendData(p_trpConn->p_deviceProxy, len, p_data);
-    if (status != TRSP_RES_SUCCESS)
-        return status;
+    if ((p_trpConn->p_cold->p_srTx != NULL) && (p_trpConn->p_cold->p_srTx->active))
+        return app_trpc_SrTxData(p_trpConn, len, p_data);
 
-    p_trpConn->gattcRspWait = APP_TRP_SEND_DATA_FAIL;
+    return app_trpc_LeSend(p_trpConn, len, p_data);
+}
 
-    return APP_RES_SUCCESS;
+void APP_TRPC_SrRtoTimeout(APP_TRP_ConnList_T *p_trpConn)
+{
+    if ((p_trpConn == NULL) || (p_trpConn->p_cold->p_srTx == NULL) || (APP_SR_TxInFlight(p_trpConn->p_cold->p_srTx) == 0))
+        return;
+
+    APP_SR_TxTimeout(p_trpConn->p_cold->p_srTx);
+    APP_TIMER_SetTimer(APP_TIMER_SR_RTO, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, APP_TRP_SR_RTO);
+    app_trpc_SrSend(p_trpConn);
 }
 
 
 void APP_TRPC_ProtocolErrRsp(APP_TRP_ConnList_T *p_trpConn)
 {
     uint8_t grpId[] = {TRP_GRPID_NULL, TRP_GRPID_CHECK_SUM, TRP_GRPID_LOOPBACK, TRP_GRPID_FIX_PATTERN, 
-        TRP_GRPID_UART, TRP_GRPID_REV_LOOPBACK};
+        TRP_GRPID_UART, TRP_GRPID_REV_LOOPBACK, TRP_GRPID_DUPLEX};
 
 
+    // A server without selective repeat support does not answer the offer, keep the Write Request
+    if ((p_trpConn->workMode == TRP_WMODE_UART) && (p_trpConn->trpState == TRPC_UART_STATE_SR_OFFER))
+    {
+        APP_TRP_COMMON_StopSr(p_trpConn);
+        bt_shell_printf("UART mode selective repeat is not answered by the peer\n");
+        app_trpc_UartCompressOffer(p_trpConn);
+        return;
+    }
+
+    // A server without compression support does not answer the offer, relay the data uncompressed
+    if ((p_trpConn->workMode == TRP_WMODE_UART) && (p_trpConn->trpState == TRPC_UART_STATE_COMPRESS_OFFER))
+    {
+        APP_TRP_COMMON_StopCompress(p_trpConn);
+        bt_shell_printf("UART mode compression is not answered by the peer\n");
+        app_trpc_UartRelayStart(p_trpConn);
+        return;
+    }
+
     APP_TRP_COMMON_SendErrorRsp(p_trpConn, grpId[p_trpConn->workMode]);
     p_trpConn->workModeEn = false;
     
@@ -1076,6 +1755,24 @@ void APP_TRPC_ProtocolErrRsp(APP_TRP_ConnList_T *p_trpConn)
         }
         break;
 
+        case TRP_WMODE_REV_LOOPBACK:
+        {
+            p_trpConn->p_cold->testStage = APP_TEST_FAILED;
+            APP_TRP_COMMON_DelAllLeCircData(&(p_trpConn->leCircQueue));
+            p_trpConn->trpState = TRPC_REV_LB_STATE_SEND_STOP_TX;
+            app_trpc_RevLoopbackStateMachine(APP_TRPC_EVENT_NULL, p_trpConn);
+        }
+        break;
+
+        case TRP_WMODE_DUPLEX:
+        {
+            p_trpConn->p_cold->testStage = APP_TEST_FAILED;
+            APP_TRP_COMMON_DelAllLeCircData(&(p_trpConn->leCircQueue));
+            p_trpConn->trpState = TRPC_DUPLEX_STATE_SEND_STOP_TX;
+            app_trpc_DuplexStateMachine(APP_TRPC_EVENT_NULL, p_trpConn);
+        }
+        break;
+
         default:
             break;
     }
@@ -1133,6 +1830,20 @@ void APP_TRPC_TransmitModeSwitch(uint8_t mode, APP_TRP_ConnList_T *p_trpConn)
             app_trpc_LoopbackStateMachine(APP_TRPC_EVENT_NULL, p_usedLink);
         }
         break;
+        case TRP_WMODE_REV_LOOPBACK:
+        {
+            p_usedLink->workMode = mode;
+            p_usedLink->trpState = TRPC_REV_LB_STATE_NULL;
+            app_trpc_RevLoopbackStateMachine(APP_TRPC_EVENT_NULL, p_usedLink);
+        }
+        break;
+        case TRP_WMODE_DUPLEX:
+        {
+            p_usedLink->workMode = mode;
+            p_usedLink->trpState = TRPC_DUPLEX_STATE_NULL;
+            app_trpc_DuplexStateMachine(APP_TRPC_EVENT_NULL, p_usedLink);
+        }
+        break;
         default:
         {
             bt_shell_printf("TransmitMode switch error\n");
@@ -1145,7 +1856,7 @@ void APP_TRPC_TransmitModeSwitch(uint8_t mode, APP_TRP_ConnList_T *p_trpConn)
 void APP_TRPC_RetryVendorCmd(APP_TRP_ConnList_T *p_trpConn)
 {
     uint8_t grpId[] = {TRP_GRPID_NULL, TRP_GRPID_CHECK_SUM, TRP_GRPID_LOOPBACK, TRP_GRPID_FIX_PATTERN,
-        TRP_GRPID_UART, TRP_GRPID_REV_LOOPBACK};
+        TRP_GRPID_UART, TRP_GRPID_REV_LOOPBACK, TRP_GRPID_DUPLEX};
     uint16_t prevGattcRspWait;
 
     if (p_trpConn != NULL)
@@ -1198,6 +1909,10 @@ void APP_TRPC_RetryVendorCmd(APP_TRP_ConnList_T *p_trpConn)
                     APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_FIX_PATTERN, 
                         APP_TRP_WMODE_FIX_PATTERN_ENABLE);
                 }
+                else if (prevGattcRspWait == APP_TRP_SEND_LENGTH_FAIL)
+                {
+                    APP_TRP_COMMON_SendLengthCommand(p_trpConn, APP_TUNE_PROBE_SIZE);
+                }
                 else if (prevGattcRspWait == APP_TRP_SEND_TYPE_FAIL)
                 {
                     APP_TRP_COMMON_SendTypeCommand(p_trpConn);
@@ -1240,6 +1955,60 @@ void APP_TRPC_RetryVendorCmd(APP_TRP_ConnList_T *p_trpConn)
             }
             break;
 
+            case TRP_WMODE_REV_LOOPBACK:
+            {
+                if ((prevGattcRspWait == APP_TRP_SEND_GID_REV_LB_FAIL)
+                    && (p_trpConn->trpState == TRPC_REV_LB_STATE_ENABLE_MODE))
+                {
+                    APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_REV_LOOPBACK,
+                        APP_TRP_WMODE_REV_LOOPBACK_ENABLE);
+                }
+                else if ((prevGattcRspWait == APP_TRP_SEND_GID_REV_LB_FAIL)
+                    && (p_trpConn->trpState == TRPC_REV_LB_STATE_SEND_STOP_TX))
+                {
+                    APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_REV_LOOPBACK,
+                        APP_TRP_WMODE_REV_LOOPBACK_DISABLE);
+                }
+                else if (prevGattcRspWait == APP_TRP_SEND_TYPE_FAIL)
+                {
+                    APP_TRP_COMMON_SendTypeCommand(p_trpConn);
+                }
+                else if ((prevGattcRspWait == APP_TRP_SEND_GID_TX_FAIL)
+                    && (p_trpConn->trpState == TRPC_REV_LB_STATE_START_TX))
+                {
+                    APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_TRANSMIT,
+                        APP_TRP_WMODE_TX_DATA_START);
+                }
+            }
+            break;
+
+            case TRP_WMODE_DUPLEX:
+            {
+                if ((prevGattcRspWait == APP_TRP_SEND_GID_DUPLEX_FAIL)
+                    && (p_trpConn->trpState == TRPC_DUPLEX_STATE_ENABLE_MODE))
+                {
+                    APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_DUPLEX,
+                        APP_TRP_WMODE_DUPLEX_ENABLE);
+                }
+                else if ((prevGattcRspWait == APP_TRP_SEND_GID_DUPLEX_FAIL)
+                    && (p_trpConn->trpState == TRPC_DUPLEX_STATE_SEND_STOP_TX))
+                {
+                    APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_DUPLEX,
+                        APP_TRP_WMODE_DUPLEX_DISABLE);
+                }
+                else if (prevGattcRspWait == APP_TRP_SEND_TYPE_FAIL)
+                {
+                    APP_TRP_COMMON_SendTypeCommand(p_trpConn);
+                }
+                else if ((prevGattcRspWait == APP_TRP_SEND_GID_TX_FAIL)
+                    && (p_trpConn->trpState == TRPC_DUPLEX_STATE_START_TX))
+                {
+                    APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_TRANSMIT,
+                        APP_TRP_WMODE_TX_DATA_START);
+                }
+            }
+            break;
+
             case TRP_WMODE_UART:
             {
                 if (prevGattcRspWait == APP_TRP_SEND_GID_UART_FAIL)
@@ -1250,6 +2019,20 @@ void APP_TRPC_RetryVendorCmd(APP_TRP_ConnList_T *p_trpConn)
                 {
                     APP_TRP_COMMON_SendTypeCommand(p_trpConn);
                 }
+                else if ((prevGattcRspWait == APP_TRP_SEND_GID_SR_FAIL)
+                    && (p_trpConn->trpState == TRPC_UART_STATE_SR_OFFER))
+                {
+                    APP_TRP_COMMON_SendSrCommand(p_trpConn, APP_TRP_WMODE_SR_ENABLE);
+                }
+                else if (prevGattcRspWait == APP_TRP_SEND_GID_COMPRESS_FAIL)
+                {
+                    APP_TRP_COMMON_SendCompressCommand(p_trpConn,
+                        (p_trpConn->trpState == TRPC_UART_STATE_COMPRESS_OFFER) ? APP_TRP_WMODE_COMPRESS_ENABLE : APP_TRP_WMODE_COMPRESS_ACCEPT);
+                }
+                else if (prevGattcRspWait == APP_TRP_SEND_LENGTH_FAIL)
+                {
+                    APP_RawDataRetryResume(p_trpConn);
+                }
             }
             break;
 
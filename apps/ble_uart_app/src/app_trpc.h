@@ -59,6 +59,7 @@ void APP_TRPC_RetryVendorCmd(APP_TRP_ConnList_T *p_trpConn);
 void APP_TRPC_RetryData(APP_TRP_ConnList_T *p_trpConn);
 void APP_TRPC_TransmitModeSwitch(uint8_t mode, APP_TRP_ConnList_T *p_trpConn);
 void APP_TRPC_TxProc(APP_TRP_ConnList_T *p_trpConn);
+void APP_TRPC_SrRtoTimeout(APP_TRP_ConnList_T *p_trpConn);
 
 
 
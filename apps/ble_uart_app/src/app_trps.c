@@ -33,6 +33,9 @@
 #include "app_error_defs.h"
 #include "app_ble_handler.h"
 #include "app_log.h"
+#include "app_replay.h"
+#include "app_tune.h"
+#include "app_script.h"
 #include "ble_trsp/ble_trsp_defs.h"
 #include "shared/shell.h"
 #include "shared/util.h"
@@ -47,6 +50,8 @@
 #define APP_TRP_WM_LOOPBACK_STR         "Loopback"
 #define APP_TRP_WM_CHECKSUM_STR         "Checksum"
 #define APP_TRP_WM_FIXPATTERN_STR       "Fixed-pattern"
+#define APP_TRP_WM_REV_LOOPBACK_STR     "Reverse-loopback"
+#define APP_TRP_WM_DUPLEX_STR           "Duplex"
 #define APP_TRP_WM_PROGRESS_STR         "progressing"
 #define APP_TRP_WM_START_STR            "start"
 
@@ -106,7 +111,82 @@ static void APP_TRPS_FlushRxDataInAllQueue(APP_TRP_ConnList_T *p_trpConn)
     }
 }
 
-static void app_trps_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_cmd)
+//The server only learns the result of a run from the client commands and its own checks, a later failure overrides a pass
+static void app_trps_SetRunResult(APP_TRP_ConnList_T *p_trpConn, APP_TRP_TestStage_T testStage)
+{
+    if ((p_trpConn->p_cold->testStage != APP_TEST_PROGRESS) && ((testStage != APP_TEST_FAILED) || (p_trpConn->p_cold->testStage != APP_TEST_PASSED)))
+        return;
+
+    if (p_trpConn->p_cold->testStage == APP_TEST_PROGRESS)
+        g_timer_stop(p_trpConn->p_cold->p_transTimer);
+
+    p_trpConn->p_cold->testStage = testStage;
+}
+
+//The result of the data plane worker of the link, for the data queued while the mode is enabled
+static void app_trps_RevLoopbackRxChecked(APP_TRP_ConnList_T *p_trpConn, uint16_t status, uint32_t checkedLeng)
+{
+    (void)checkedLeng;
+
+    if ((p_trpConn->workMode != TRP_WMODE_REV_LOOPBACK) || (p_trpConn->workModeEn == false))
+        return;
+
+    if (status != APP_RES_SUCCESS)
+    {
+        bt_shell_printf("\n%s content error !\n", APP_TRP_WM_REV_LOOPBACK_STR);
+        app_trps_SetRunResult(p_trpConn, APP_TEST_FAILED);
+        p_trpConn->workModeEn = false;
+        APP_TRPS_FlushRxDataInAllQueue(p_trpConn);
+        APP_TRP_COMMON_SendErrorRsp(p_trpConn, TRP_GRPID_REV_LOOPBACK);
+    }
+    else if (p_trpConn->rxAccuLeng >= APP_TRP_WMODE_TX_MAX_SIZE)
+    {
+        //All the pattern is echoed back in order, report the end to the client
+        bt_shell_printf("\n%s is successful !\n", APP_TRP_WM_REV_LOOPBACK_STR);
+        app_trps_SetRunResult(p_trpConn, APP_TEST_PASSED);
+        p_trpConn->workModeEn = false;
+        APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_TRANSMIT, APP_TRP_WMODE_TX_DATA_END);
+    }
+}
+
+//The server keeps sourcing its own pattern once the pattern of the client is verified
+static void app_trps_DuplexRxChecked(APP_TRP_ConnList_T *p_trpConn, uint16_t status, uint32_t checkedLeng)
+{
+    if ((p_trpConn->workMode != TRP_WMODE_DUPLEX) || (p_trpConn->workModeEn == false))
+        return;
+
+    if (status != APP_RES_SUCCESS)
+    {
+        bt_shell_printf("\n%s content error !\n", APP_TRP_WM_DUPLEX_STR);
+        app_trps_SetRunResult(p_trpConn, APP_TEST_FAILED);
+        p_trpConn->workModeEn = false;
+        APP_TRPS_FlushRxDataInAllQueue(p_trpConn);
+        APP_TRP_COMMON_SendErrorRsp(p_trpConn, TRP_GRPID_DUPLEX);
+    }
+    else if ((p_trpConn->rxAccuLeng >= APP_TRP_WMODE_TX_MAX_SIZE) && (p_trpConn->rxAccuLeng - checkedLeng < APP_TRP_WMODE_TX_MAX_SIZE))
+    {
+        bt_shell_printf("\n%s receive is successful !\n", APP_TRP_WM_DUPLEX_STR);
+        APP_TRP_COMMON_SendModeCommand(p_trpConn, TRP_GRPID_TRANSMIT, APP_TRP_WMODE_TX_DATA_END);
+    }
+}
+
+//All the data announced by the client is added to the check sum
+static void app_trps_CheckSumDone(APP_TRP_ConnList_T *p_trpConn, uint16_t status, uint32_t checkedLeng)
+{
+    (void)checkedLeng;
+
+    if (p_trpConn->workMode != TRP_WMODE_CHECK_SUM)
+        return;
+
+    status = APP_TIMER_StopTimer(APP_TIMER_PROTOCOL_RSP, APP_TRP_COMMON_GetConnIndex(p_trpConn));
+
+    if (status != APP_RES_SUCCESS)
+        APP_LOG_ERROR("APP_TIMER_PROTOCOL_RSP stop error ! result=%d\n", status);
+
+    APP_TRP_COMMON_SendCheckSumCommand(p_trpConn);
+}
+
+static void app_trps_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint16_t length, uint8_t *p_cmd)
 {
     uint16_t lastNumber, idx;
     uint8_t groupId, commandId;
@@ -129,17 +209,24 @@ static void app_trps_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_cmd
             {
                 p_trpConn->workMode = TRP_WMODE_CHECK_SUM;
                 p_trpConn->workModeEn = false;
-                p_trpConn->checkSum = 0;
+                APP_TRP_COMMON_ResetRxCheck(p_trpConn);
+            }
+            else if (commandId == APP_TRP_WMODE_ERROR_RSP)
+            {
+                bt_shell_printf("%s error response! \n", APP_TRP_WM_CHECKSUM_STR);
+                app_trps_SetRunResult(p_trpConn, APP_TEST_FAILED);
             }
             else if (commandId == APP_TRP_WMODE_CHECK_SUM)
             {
                 if (p_cmd[idx] == (p_trpConn->checkSum & 0xFF))
                 {
                     bt_shell_printf("\nCheck sum = %x. Check sum is correct. \n", p_cmd[idx]);
+                    app_trps_SetRunResult(p_trpConn, APP_TEST_PASSED);
                 }
                 else
                 {
                     bt_shell_printf("\nCheck sum = %x. Check sum is wrong. \n", p_cmd[idx]);
+                    app_trps_SetRunResult(p_trpConn, APP_TEST_FAILED);
                 }
             }
         }
@@ -156,6 +243,11 @@ static void app_trps_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_cmd
                 p_trpConn->workMode = TRP_WMODE_LOOPBACK;
                 p_trpConn->workModeEn = false;
             }
+            else if (commandId == APP_TRP_WMODE_ERROR_RSP)
+            {
+                bt_shell_printf("%s error response! \n", APP_TRP_WM_LOOPBACK_STR);
+                app_trps_SetRunResult(p_trpConn, APP_TEST_FAILED);
+            }
         }
         break;
 
@@ -170,6 +262,7 @@ static void app_trps_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_cmd
                 p_trpConn->workMode = TRP_WMODE_FIX_PATTERN;
                 p_trpConn->workModeEn = false;
                 p_trpConn->lastNumber = 0;
+                p_trpConn->txTotalLeng = 0;
             }
             else if (commandId == APP_TRP_WMODE_TX_LAST_NUMBER)
             {
@@ -181,12 +274,14 @@ static void app_trps_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_cmd
                 else
                 {
                     bt_shell_printf("\nThe last number = %x. The last number check is fail !\n", lastNumber);
+                    app_trps_SetRunResult(p_trpConn, APP_TEST_FAILED);
                 }
                 p_trpConn->workMode = TRP_WMODE_NULL;
             }
             else if (commandId == APP_TRP_WMODE_ERROR_RSP)
             {
                 bt_shell_printf("Fixed pattern error response! \n");
+                app_trps_SetRunResult(p_trpConn, APP_TEST_FAILED);
             }
         }
         break;
@@ -197,10 +292,15 @@ static void app_trps_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_cmd
             {
                 APP_TRP_COMMON_DelAllCircData(&(p_trpConn->uartCircQueue));
                 APP_TRP_COMMON_DelAllLeCircData(&(p_trpConn->leCircQueue));
+                APP_TRP_COMMON_StopCompress(p_trpConn);
+                APP_TRP_COMMON_StopSr(p_trpConn);
                 p_trpConn->workMode = TRP_WMODE_NULL;
             }
             else if (commandId == APP_TRP_WMODE_UART_ENABLE)
             {
+                // Uncompressed and unframed unless the client offers it again
+                APP_TRP_COMMON_StopCompress(p_trpConn);
+                APP_TRP_COMMON_StopSr(p_trpConn);
                 p_trpConn->workMode = TRP_WMODE_UART;
             }
         }
@@ -214,6 +314,11 @@ static void app_trps_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_cmd
                 {
                     APP_TRP_COMMON_SendLastNumber(p_trpConn);
                 }
+                // The check sum of the client is still to come, an error response of the client overrides the pass
+                if ((p_trpConn->workMode == TRP_WMODE_LOOPBACK) || (p_trpConn->workMode == TRP_WMODE_FIX_PATTERN))
+                {
+                    app_trps_SetRunResult(p_trpConn, APP_TEST_PASSED);
+                }
                 p_trpConn->workMode = TRP_WMODE_NULL;
                 p_trpConn->workModeEn = false;
                 APP_TRP_COMMON_DelAllLeCircData(&(p_trpConn->leCircQueue));
@@ -222,18 +327,29 @@ static void app_trps_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_cmd
             else if (commandId == APP_TRP_WMODE_TX_DATA_START)
             {
                 p_trpConn->workModeEn = true;
+                APP_TRPS_ReportRunResult(p_trpConn);
+                p_trpConn->p_cold->runBytes = APP_TRP_WMODE_TX_MAX_SIZE * ((p_trpConn->workMode == TRP_WMODE_DUPLEX) ? 2 : 1);
                 
-                if (p_trpConn->workMode == TRP_WMODE_FIX_PATTERN)
+                if ((p_trpConn->workMode == TRP_WMODE_FIX_PATTERN) || (p_trpConn->workMode == TRP_WMODE_REV_LOOPBACK)
+                    || (p_trpConn->workMode == TRP_WMODE_DUPLEX))
                 {
                     APP_TRPS_FlushRxDataInAllQueue(p_trpConn);
                     // Send the first packet
                     APP_TRP_COMMON_InitFixPatternParam(p_trpConn);
+                    // A tuning probe of the client asks for a shorter pattern
+                    if ((p_trpConn->workMode == TRP_WMODE_FIX_PATTERN) && (p_trpConn->txTotalLeng > 0)
+                        && (p_trpConn->txTotalLeng < p_trpConn->p_cold->fixPattMaxSize))
+                    {
+                        p_trpConn->p_cold->fixPattMaxSize = p_trpConn->txTotalLeng;
+                    }
+                    p_trpConn->rxAccuLeng = 0;
                     APP_TRP_COMMON_SendFixPatternFirstPkt(p_trpConn);
 
                     p_trpConn->maxAvailTxNumber = APP_TRP_MAX_TX_AVAILABLE_TIMES;
                     APP_TIMER_SetTimer(APP_TIMER_TRPS_RCV_CREDIT, 0, p_trpConn, APP_TIMER_1MS);
                 }
-                if (p_trpConn->workMode == TRP_WMODE_LOOPBACK) 
+                if ((p_trpConn->workMode == TRP_WMODE_LOOPBACK) || (p_trpConn->workMode == TRP_WMODE_REV_LOOPBACK)
+                    || (p_trpConn->workMode == TRP_WMODE_DUPLEX))
                 {
                     APP_TIMER_SetTimer(APP_TIMER_TRPS_PROGRESS_CHECK, 0, NULL, APP_TIMER_3S);
                 }
@@ -247,6 +363,19 @@ static void app_trps_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_cmd
                 //APP_UTILITY_BUF_BE_TO_U32(&(p_trpConn->txTotalLeng), &(p_cmd[idx]));
                 p_trpConn->txTotalLeng = get_be32(&p_cmd[idx]);
                 APP_LOG_DEBUG("Total data length to be transmitted = %d \n", p_trpConn->txTotalLeng);
+
+                // A file sent in UART mode carries its identifier, answer with the offset to resume from
+                if ((p_trpConn->workMode == TRP_WMODE_UART) && (length >= idx + 8))
+                {
+                    APP_RawDataFileInfo(p_trpConn, p_trpConn->txTotalLeng, get_be32(&p_cmd[idx + 4]));
+                }
+            }
+            else if (commandId == APP_TRP_WMODE_TX_DATA_OFFSET)
+            {
+                if ((p_trpConn->workMode == TRP_WMODE_UART) && (length >= idx + 8))
+                {
+                    APP_RawDataResume(p_trpConn, get_be32(&p_cmd[idx]), get_be32(&p_cmd[idx + 4]));
+                }
             }
             else if (commandId == APP_TRP_WMODE_TX_TYPE)
             {
@@ -261,12 +390,15 @@ static void app_trps_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_cmd
                         p_trpConn->lePktLeng = p_trpConn->txMTU;
                 }
                 else if (p_trpConn->channelEn & APP_TRCBP_DATA_CHAN_ENABLE)
-                    p_trpConn->lePktLeng = p_trpConn->fixPattTrcbpMtu;
+                    p_trpConn->lePktLeng = p_trpConn->p_cold->fixPattTrcbpMtu;
             }
         }
         break;
 
-        case TRP_GRPID_UPDATE_CONN_PARA: 
+        case TRP_GRPID_UPDATE_CONN_PARA:
+        {
+            APP_TUNE_ConnParaCmdProc(p_trpConn, commandId, (length > idx) ? p_cmd[idx] : APP_TUNE_STATUS_FAIL);
+        }
         break;
 
         case TRP_GRPID_WMODE_SELECTION:
@@ -282,7 +414,102 @@ static void app_trps_VendorCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t *p_cmd
         {
             if ((commandId == APP_TRP_WMODE_REV_LOOPBACK_DISABLE) || (commandId == APP_TRP_WMODE_ERROR_RSP))
             {
+                if ((commandId == APP_TRP_WMODE_ERROR_RSP) && (p_trpConn->workModeEn))
+                {
+                    bt_shell_printf("%s error response! \n", APP_TRP_WM_REV_LOOPBACK_STR);
+                }
+                app_trps_SetRunResult(p_trpConn, (commandId == APP_TRP_WMODE_ERROR_RSP) ? APP_TEST_FAILED : APP_TEST_PASSED);
+                p_trpConn->workMode = TRP_WMODE_NULL;
+                p_trpConn->workModeEn = false;
+                APP_TRPS_FlushRxDataInAllQueue(p_trpConn);
+            }
+            else if (commandId == APP_TRP_WMODE_REV_LOOPBACK_ENABLE)
+            {
+                p_trpConn->workMode = TRP_WMODE_REV_LOOPBACK;
+                p_trpConn->workModeEn = false;
+                p_trpConn->lastNumber = 0;
+            }
+        }
+        break;
+
+        case TRP_GRPID_DUPLEX:
+        {
+            if ((commandId == APP_TRP_WMODE_DUPLEX_DISABLE) || (commandId == APP_TRP_WMODE_ERROR_RSP))
+            {
+                if ((commandId == APP_TRP_WMODE_ERROR_RSP) && (p_trpConn->workModeEn))
+                {
+                    bt_shell_printf("%s error response! \n", APP_TRP_WM_DUPLEX_STR);
+                }
+                app_trps_SetRunResult(p_trpConn, (commandId == APP_TRP_WMODE_ERROR_RSP) ? APP_TEST_FAILED : APP_TEST_PASSED);
                 p_trpConn->workMode = TRP_WMODE_NULL;
+                p_trpConn->workModeEn = false;
+                APP_TRPS_FlushRxDataInAllQueue(p_trpConn);
+            }
+            else if (commandId == APP_TRP_WMODE_DUPLEX_ENABLE)
+            {
+                p_trpConn->workMode = TRP_WMODE_DUPLEX;
+                p_trpConn->workModeEn = false;
+                p_trpConn->lastNumber = 0;
+            }
+        }
+        break;
+
+        case TRP_GRPID_COMPRESS:
+        {
+            if (commandId == APP_TRP_WMODE_COMPRESS_ENABLE)
+            {
+                // Accept the codec offered by the client if it is the local one. The received data is
+                // decoded from now on, the data to send once the client confirms.
+                if ((p_trpConn->workMode == TRP_WMODE_UART) && (p_cmd[idx] != APP_TRP_COMPRESS_CODEC_NONE)
+                    && (p_cmd[idx] == APP_TRP_COMMON_GetCompress())
+                    && (APP_TRP_COMMON_StartCompress(p_trpConn) == APP_RES_SUCCESS))
+                {
+                    p_trpConn->p_cold->p_compress->codec = p_cmd[idx];
+                    p_trpConn->p_cold->p_compress->rxEn = true;
+                    if (APP_TRP_COMMON_SendCompressCommand(p_trpConn, APP_TRP_WMODE_COMPRESS_ACCEPT) != APP_RES_SUCCESS)
+                        APP_TRP_COMMON_StopCompress(p_trpConn);
+                }
+                else
+                {
+                    APP_TRP_COMMON_StopCompress(p_trpConn);
+                    APP_TRP_COMMON_SendCompressCommand(p_trpConn, APP_TRP_WMODE_COMPRESS_DISABLE);
+                }
+            }
+            else if (commandId == APP_TRP_WMODE_COMPRESS_ACCEPT)
+            {
+                if (p_trpConn->p_cold->p_compress != NULL)
+                {
+                    p_trpConn->p_cold->p_compress->txEn = true;
+                    bt_shell_printf("UART mode compression is enabled\n");
+                }
+            }
+            else if (commandId == APP_TRP_WMODE_COMPRESS_DISABLE)
+            {
+                APP_TRP_COMMON_StopCompress(p_trpConn);
+            }
+        }
+        break;
+
+        case TRP_GRPID_SR:
+        {
+            if (commandId == APP_TRP_WMODE_SR_ENABLE)
+            {
+                // The received data is reordered from now on, the first acknowledgement accepts the offer
+                if ((p_trpConn->workMode == TRP_WMODE_UART) && (p_trpConn->type == APP_TRP_TYPE_LEGACY)
+                    && (APP_TRP_COMMON_StartSr(p_trpConn) == APP_RES_SUCCESS))
+                {
+                    if (APP_TRP_COMMON_SendSrCommand(p_trpConn, APP_TRP_WMODE_SR_ACK) != APP_RES_SUCCESS)
+                        APP_TRP_COMMON_StopSr(p_trpConn);
+                }
+                else
+                {
+                    APP_TRP_COMMON_StopSr(p_trpConn);
+                    APP_TRP_COMMON_SendSrCommand(p_trpConn, APP_TRP_WMODE_SR_DISABLE);
+                }
+            }
+            else if (commandId == APP_TRP_WMODE_SR_DISABLE)
+            {
+                APP_TRP_COMMON_StopSr(p_trpConn);
             }
         }
         break;
@@ -312,7 +539,15 @@ uint16_t APP_TRPS_LeTxData(APP_TRP_ConnList_T *p_trpConn, uint16_t len, uint8_t
         return APP_RES_OOM;
     }
     
-    status = BLE_TRSPS_SendData(p_trpConn->p_deviceProxy, len, p_data);
+    if (APP_REPLAY_IsReplaying())
+    {
+        status = APP_REPLAY_GetSendResult(p_trpConn->p_deviceProxy);
+    }
+    else
+    {
+        status = BLE_TRSPS_SendData(p_trpConn->p_deviceProxy, len, p_data);
+        APP_REPLAY_RecordSend(p_trpConn->p_deviceProxy, status);
+    }
     if (status == TRSP_RES_NO_RESOURCE)
         return APP_RES_NO_RESOURCE;
     else if (status != TRSP_RES_SUCCESS)
@@ -347,17 +582,8 @@ static void app_trps_LeRxProc(APP_TRP_ConnList_T *p_trpConn)
         {
             case TRP_WMODE_CHECK_SUM:
             {
-                p_trpConn->checkSum = APP_TRP_COMMON_CalculateCheckSum(p_trpConn->checkSum, &(p_trpConn->txTotalLeng), p_trpConn);
-                
-                if (p_trpConn->txTotalLeng == 0)
-                {
-                    status = APP_TIMER_StopTimer(APP_TIMER_PROTOCOL_RSP, APP_TRP_COMMON_GetConnIndex(p_trpConn));
-                    
-                    if (status != APP_RES_SUCCESS)
-                        APP_LOG_ERROR("APP_TIMER_PROTOCOL_RSP stop error ! result=%d\n", status);
-                    
-                    APP_TRP_COMMON_SendCheckSumCommand(p_trpConn);
-                }
+                // The sum is made by the data plane worker of the link, it is sent once the last byte is added
+                APP_TRP_COMMON_CalculateCheckSum(&(p_trpConn->txTotalLeng), p_trpConn, app_trps_CheckSumDone);
                 p_trpConn->maxAvailTxNumber = 0;
 
                 APP_TRP_COMMON_ProgressingLog(p_trpConn);
@@ -379,6 +605,39 @@ static void app_trps_LeRxProc(APP_TRP_ConnList_T *p_trpConn)
             }
             break;
 
+            case TRP_WMODE_REV_LOOPBACK:
+            {
+                if (p_trpConn->workModeEn)
+                {
+                    APP_TRP_COMMON_CheckFixPatternData(p_trpConn, app_trps_RevLoopbackRxChecked);
+                }
+                else
+                {
+                    APP_TRPS_FlushRxDataInAllQueue(p_trpConn);
+                }
+
+                APP_TRP_COMMON_ProgressingLog(p_trpConn);
+                //The Tx quota of the link is kept for the pattern
+                s_trpsTrafficPriority.validNumber = 0;
+            }
+            break;
+
+            case TRP_WMODE_DUPLEX:
+            {
+                if ((p_trpConn->workModeEn) && (p_trpConn->rxAccuLeng < APP_TRP_WMODE_TX_MAX_SIZE))
+                {
+                    APP_TRP_COMMON_CheckFixPatternData(p_trpConn, app_trps_DuplexRxChecked);
+                }
+                else
+                {
+                    APP_TRPS_FlushRxDataInAllQueue(p_trpConn);
+                }
+
+                APP_TRP_COMMON_ProgressingLog(p_trpConn);
+                s_trpsTrafficPriority.validNumber = 0;
+            }
+            break;
+
             default:
                 p_trpConn->maxAvailTxNumber = 0;
             break;
@@ -413,6 +672,8 @@ void APP_TRPS_EventHandler(BLE_TRSPS_Event_T *p_event)
 {
     APP_TRP_ConnList_T *p_trpsConnLink = NULL;
 
+    APP_REPLAY_RecordTrpsEvt(p_event);
+
     switch(p_event->eventId)
     {
         case BLE_TRSPS_EVT_CTRL_STATUS:
@@ -483,8 +744,10 @@ void APP_TRPS_EventHandler(BLE_TRSPS_Event_T *p_event)
             p_trpsCurrentLink = APP_TRP_COMMON_GetConnListByIndex(s_trpsTrafficPriority.txToken);
 
             if ((p_creditReturnLink == p_trpsCurrentLink) &&
-                (p_trpsCurrentLink->workMode == TRP_WMODE_FIX_PATTERN) && 
-                (p_trpsCurrentLink->workModeEn == true))
+                ((p_trpsCurrentLink->workMode == TRP_WMODE_FIX_PATTERN) ||
+                (p_trpsCurrentLink->workMode == TRP_WMODE_REV_LOOPBACK) ||
+                (p_trpsCurrentLink->workMode == TRP_WMODE_DUPLEX)) &&
+                (p_trpsCurrentLink->workModeEn == true) && (p_trpsCurrentLink->p_cold->fixPattMaxSize > 0))
             {
                 if (p_trpsCurrentLink->maxAvailTxNumber > 0)
                 {
@@ -492,9 +755,13 @@ void APP_TRPS_EventHandler(BLE_TRSPS_Event_T *p_event)
                     
                     if (status & APP_RES_COMPLETE)
                     {
-                        APP_TRP_COMMON_SendModeCommand(p_trpsCurrentLink, TRP_GRPID_TRANSMIT, APP_TRP_WMODE_TX_DATA_END);
-                        APP_TRP_COMMON_SendLastNumber(p_trpsCurrentLink);
-                        p_trpsCurrentLink->workModeEn = false;
+                        //The reverse loopback and duplex modes end when the pattern of the client is verified
+                        if (p_trpsCurrentLink->workMode == TRP_WMODE_FIX_PATTERN)
+                        {
+                            APP_TRP_COMMON_SendModeCommand(p_trpsCurrentLink, TRP_GRPID_TRANSMIT, APP_TRP_WMODE_TX_DATA_END);
+                            APP_TRP_COMMON_SendLastNumber(p_trpsCurrentLink);
+                            p_trpsCurrentLink->workModeEn = false;
+                        }
                         break;
                     }
     
@@ -521,7 +788,8 @@ void APP_TRPS_EventHandler(BLE_TRSPS_Event_T *p_event)
             
             if ((p_trpsConnLink != NULL) && (p_event->eventField.onVendorCmd.p_payLoad[0] == APP_TRP_VENDOR_OPCODE_BLE_UART))
             {
-                app_trps_VendorCmdProc(p_trpsConnLink, p_event->eventField.onVendorCmd.p_payLoad);
+                app_trps_VendorCmdProc(p_trpsConnLink, p_event->eventField.onVendorCmd.length,
+                    p_event->eventField.onVendorCmd.p_payLoad);
             }
         }
         break;
@@ -531,6 +799,25 @@ void APP_TRPS_EventHandler(BLE_TRSPS_Event_T *p_event)
     }
 }
 
+void APP_TRPS_ProtocolTimeout(APP_TRP_ConnList_T *p_trpConn)
+{
+    bt_shell_printf("%s data of the client timed out ! \n", APP_TRP_WM_CHECKSUM_STR);
+    app_trps_SetRunResult(p_trpConn, APP_TEST_FAILED);
+}
+
+//A run is reported when the next one starts or the link is lost, a run still in progress is a failure
+void APP_TRPS_ReportRunResult(APP_TRP_ConnList_T *p_trpConn)
+{
+    if ((p_trpConn == NULL) || (p_trpConn->p_cold->testStage == APP_TEST_IDLE))
+        return;
+
+    if (p_trpConn->p_cold->testStage == APP_TEST_PROGRESS)
+        app_trps_SetRunResult(p_trpConn, APP_TEST_FAILED);
+    APP_SCRIPT_LinkResult(p_trpConn->p_deviceProxy, p_trpConn->p_cold->testStage, g_timer_elapsed(p_trpConn->p_cold->p_transTimer, NULL),
+        p_trpConn->p_cold->runBytes);
+    p_trpConn->p_cold->testStage = APP_TEST_IDLE;
+}
+
 void APP_TRPS_Init(void)
 {
     memset((uint8_t *) &s_trpsTrafficPriority, 0, sizeof(APP_TRP_TrafficPriority_T));
@@ -588,13 +875,35 @@ void APP_TRPS_TxProc(APP_TRP_ConnList_T * p_trpConn)
                     APP_TRP_COMMON_SendModeCommand(p_trpsTxLeLink, TRP_GRPID_TRANSMIT, APP_TRP_WMODE_TX_DATA_END);
                     APP_TRP_COMMON_SendLastNumber(p_trpsTxLeLink);
                     p_trpsTxLeLink->workModeEn = false;
-                    bt_shell_printf("\rSend Fixed-Pattern last number\n");
+                    APP_LOG_SHELL("\rSend Fixed-Pattern last number\n");
+                    break;
+                }
+
+                if (status != APP_RES_SUCCESS)
+                {
+                    APP_LOG_SHELL("\rSend Fixed-Pattern fail(%d)\n", status);
+                    p_trpsTxLeLink->maxAvailTxNumber = 0;
+                }
+
+                APP_TRP_COMMON_ProgressingLog(p_trpsTxLeLink);
+            }
+        }
+        else if (((p_trpsTxLeLink->workMode == TRP_WMODE_REV_LOOPBACK) || (p_trpsTxLeLink->workMode == TRP_WMODE_DUPLEX))
+            && (p_trpsTxLeLink->workModeEn == true) && (p_trpsTxLeLink->p_cold->fixPattMaxSize > 0))
+        {
+            if (p_trpsTxLeLink->maxAvailTxNumber > 0)
+            {
+                status = APP_TRP_COMMON_SendMultiLinkFixPattern(&s_trpsTrafficPriority, p_trpsTxLeLink);
+                if (status & APP_RES_COMPLETE)
+                {
+                    // Keep the mode enabled until the client stops it
+                    APP_LOG_SHELL("\rSend %s pattern done\n", (p_trpsTxLeLink->workMode == TRP_WMODE_DUPLEX) ?
+                        APP_TRP_WM_DUPLEX_STR : APP_TRP_WM_REV_LOOPBACK_STR);
                     break;
                 }
 
                 if (status != APP_RES_SUCCESS)
                 {
-                    bt_shell_printf("\rSend Fixed-Pattern fail(%d)\n", status);
                     p_trpsTxLeLink->maxAvailTxNumber = 0;
                 }
                 
@@ -618,7 +927,10 @@ void APP_TRPS_TxProc(APP_TRP_ConnList_T * p_trpConn)
                 p_trpsTxLeLink->maxAvailTxNumber--;
                 if (remain > 0)
                 {
-                    APP_TIMER_SetTimer(APP_TIMER_RAW_DATA_FETCH, p_trpsTxLeLink->maxAvailTxNumber, p_trpsTxLeLink->p_deviceProxy, APP_TIMER_1MS);
+                    // The low mark of a paused queue fetches again
+                    if (!p_trpsTxLeLink->uartCircQueue.isPaused)
+                        APP_TIMER_SetTimer(APP_TIMER_RAW_DATA_FETCH, APP_GetFileTransIndex(p_trpsTxLeLink->p_deviceProxy),
+                            p_trpsTxLeLink->p_deviceProxy, APP_TIMER_1MS);
                 }
                 else
                 {
@@ -636,7 +948,9 @@ void APP_TRPS_TxProc(APP_TRP_ConnList_T * p_trpConn)
 
         if (p_trpsTxLeLink->maxAvailTxNumber == 0)
         {
-            if (p_trpsTxLeLink->workMode == TRP_WMODE_FIX_PATTERN)
+            if ((p_trpsTxLeLink->workMode == TRP_WMODE_FIX_PATTERN) ||
+                (((p_trpsTxLeLink->workMode == TRP_WMODE_REV_LOOPBACK) || (p_trpsTxLeLink->workMode == TRP_WMODE_DUPLEX))
+                && (p_trpsTxLeLink->p_cold->fixPattMaxSize > 0)))
             {
                 //uint8_t peripheralNum;
                 //peripheralNum = APP_TRP_COMMON_GetRoleNum(BLE_GAP_ROLE_PERIPHERAL);
@@ -61,5 +61,7 @@ void APP_TRPS_Init(void);
 uint16_t APP_TRPS_LeTxData(APP_TRP_ConnList_T *p_trpConn, uint16_t len, uint8_t *p_data);
 void APP_TRPS_EventHandler(BLE_TRSPS_Event_T *p_event);
 void APP_TRPS_TxProc(APP_TRP_ConnList_T * p_trpConn);
+void APP_TRPS_ProtocolTimeout(APP_TRP_ConnList_T *p_trpConn);
+void APP_TRPS_ReportRunResult(APP_TRP_ConnList_T *p_trpConn);
 
 #endif
@@ -0,0 +1,622 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Connection Auto-tune Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_tune.c
+
+  Summary:
+    This file contains the Application connection auto-tune functions for this project.
+
+  Description:
+    This file contains the Application connection auto-tune functions for this project.
+    For every configuration of the matrix the client sends HCI LE Set PHY and LE Connection
+    Update on the link and waits for the controller to complete both, as reported by the HCI
+    event monitor. The connection parameters are then read back; a configuration the
+    controller refuses or does not apply counts as zero. Otherwise a fixed-pattern probe of
+    APP_TUNE_PROBE_SIZE bytes runs. The goodput is the probe payload over the elapsed time, a
+    failed probe counts as zero. The best configuration is applied at the end and reported
+    to the server with TRP_GRPID_UPDATE_CONN_PARA.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <glib.h>
+
+#include "bluetooth/bluetooth.h"
+#include "bluetooth/hci.h"
+#include "bluetooth/hci_lib.h"
+#include "shared/shell.h"
+
+#include "application.h"
+#include "app_tune.h"
+#include "app_ble_handler.h"
+#include "app_dbp.h"
+#include "app_timer.h"
+#include "app_error_defs.h"
+#include "app_script.h"
+#include "app_trpc.h"
+#include "app_hcimon.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_TUNE_HCI_DEV_ID             0           /**< Same controller as the one used by the management interface. */
+#define APP_TUNE_OCF_LE_SET_PHY         0x0032
+#define APP_TUNE_LE_SET_PHY_CP_SIZE     7
+#define APP_TUNE_PHY_LE_1M              0x01
+#define APP_TUNE_PHY_LE_2M              0x02
+#define APP_TUNE_SUPV_TIMEOUT           400         /**< Supervision timeout, unit: 10 ms. */
+#define APP_TUNE_UPDATE_TIMEOUT         APP_TIMER_3S    /**< Wait for the update events before the parameters are read back. */
+#define APP_TUNE_CONFIG_NUM             6           /**< PHY 1M/2M by connection interval 7.5/15/30 ms. */
+#define APP_TUNE_CONFIG_NONE            0xFF
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief The state of the auto-tune of a link. */
+typedef enum APP_TUNE_State_T
+{
+    APP_TUNE_STATE_IDLE = 0x00,         /**< Not tuned. */
+    APP_TUNE_STATE_SETTLE,              /**< A configuration is requested, wait for the controller to apply it. */
+    APP_TUNE_STATE_PROBE,               /**< The fixed-pattern probe of the configuration is running. */
+    APP_TUNE_STATE_APPLY_BEST,          /**< The best configuration is requested again, wait for the controller to apply it. */
+    APP_TUNE_STATE_DONE                 /**< Tuned. */
+} APP_TUNE_State_T;
+
+/**@brief The structure contains one configuration of the tuning matrix. */
+typedef struct APP_TUNE_Config_T
+{
+    uint8_t     phy;                    /**< HCI PHY bit, used for both directions. */
+    uint16_t    interval;               /**< Connection interval, unit: 1.25 ms. */
+} APP_TUNE_Config_T;
+
+/**@brief The structure contains the auto-tune context of a link. */
+typedef struct APP_TUNE_Link_T
+{
+    APP_TUNE_State_T    state;          /**< See @ref APP_TUNE_State_T. */
+    uint16_t            connHandle;     /**< HCI connection handle. */
+    uint8_t             step;           /**< Index of the configuration being probed. */
+    uint8_t             best;           /**< Index of the selected configuration, APP_TUNE_CONFIG_NONE if none. */
+    uint8_t             pending;        /**< Updates not completed by the controller yet. See @ref APP_TUNE_UPDATE. */
+    uint32_t            goodput[APP_TUNE_CONFIG_NUM]; /**< Goodput per configuration, unit: bps. */
+} APP_TUNE_Link_T;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static const APP_TUNE_Config_T s_tuneMatrix[APP_TUNE_CONFIG_NUM] =
+{
+    { APP_TUNE_PHY_LE_1M, 6 },
+    { APP_TUNE_PHY_LE_1M, 12 },
+    { APP_TUNE_PHY_LE_1M, 24 },
+    { APP_TUNE_PHY_LE_2M, 6 },
+    { APP_TUNE_PHY_LE_2M, 12 },
+    { APP_TUNE_PHY_LE_2M, 24 },
+};
+
+static APP_TUNE_Link_T          *sp_tuneLink = NULL;   /**< Table of APP_TRP_MAX_LINK_NUMBER entries, allocated once by APP_TUNE_Init(). */
+static APP_TRP_ConnList_T       *sp_tuneCurrent = NULL;
+static bool                     s_tuneAll = false;
+static int                      s_tuneHciDd = -1;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static const char *app_tune_PhyStr(uint8_t phy)
+{
+    return (phy == APP_TUNE_PHY_LE_2M) ? "LE2M" : "LE1M";
+}
+
+static int app_tune_DevIndex(APP_TRP_ConnList_T *p_trpConn)
+{
+    APP_DBP_BtDev_T *p_dev = APP_DBP_GetDevInfoByProxy(p_trpConn->p_deviceProxy);
+
+    return p_dev ? p_dev->index : APP_TRP_COMMON_GetConnIndex(p_trpConn);
+}
+
+static APP_TUNE_Link_T *app_tune_GetLink(APP_TRP_ConnList_T *p_trpConn)
+{
+    uint8_t index = APP_TRP_COMMON_GetConnIndex(p_trpConn);
+
+    if (index >= APP_TRP_MAX_LINK_NUMBER)
+        return NULL;
+
+    return &sp_tuneLink[index];
+}
+
+static bool app_tune_GetConnHandle(APP_TRP_ConnList_T *p_trpConn, uint16_t *p_connHandle)
+{
+    struct hci_conn_info_req *p_req;
+    uint8_t buf[sizeof(struct hci_conn_info_req) + sizeof(struct hci_conn_info)];
+    APP_DBP_BtDev_T *p_dev;
+
+    p_dev = APP_DBP_GetDevInfoByProxy(p_trpConn->p_deviceProxy);
+    if ((p_dev == NULL) || (p_dev->p_address == NULL))
+        return false;
+
+    memset(buf, 0, sizeof(buf));
+    p_req = (struct hci_conn_info_req *)buf;
+    str2ba(p_dev->p_address, &p_req->bdaddr);
+    p_req->type = LE_LINK;
+
+    if (ioctl(s_tuneHciDd, HCIGETCONNINFO, (unsigned long)p_req) < 0)
+    {
+        perror("Failed to get connection info");
+        return false;
+    }
+
+    *p_connHandle = p_req->conn_info->handle;
+    return true;
+}
+
+static uint16_t app_tune_Apply(APP_TUNE_Link_T *p_link, const APP_TUNE_Config_T *p_config)
+{
+    uint8_t phyCp[APP_TUNE_LE_SET_PHY_CP_SIZE];
+    le_connection_update_cp connCp;
+
+    phyCp[0] = p_link->connHandle & 0xFF;
+    phyCp[1] = p_link->connHandle >> 8;
+    phyCp[2] = 0x00;                    /* All PHYs: the preference of both directions is given */
+    phyCp[3] = p_config->phy;
+    phyCp[4] = p_config->phy;
+    phyCp[5] = 0x00;                    /* PHY options */
+    phyCp[6] = 0x00;
+
+    if (hci_send_cmd(s_tuneHciDd, OGF_LE_CTL, APP_TUNE_OCF_LE_SET_PHY, APP_TUNE_LE_SET_PHY_CP_SIZE, phyCp) < 0)
+        return APP_RES_FAIL;
+
+    memset(&connCp, 0, sizeof(connCp));
+    connCp.handle = htobs(p_link->connHandle);
+    connCp.min_interval = htobs(p_config->interval);
+    connCp.max_interval = htobs(p_config->interval);
+    connCp.latency = 0;
+    connCp.supervision_timeout = htobs(APP_TUNE_SUPV_TIMEOUT);
+
+    if (hci_send_cmd(s_tuneHciDd, OGF_LE_CTL, OCF_LE_CONN_UPDATE, LE_CONN_UPDATE_CP_SIZE, &connCp) < 0)
+        return APP_RES_FAIL;
+
+    // The commands are only queued to the controller, it reports the result with events
+    p_link->pending = APP_TUNE_UPDATE_PHY | APP_TUNE_UPDATE_CONN;
+
+    return APP_RES_SUCCESS;
+}
+
+static bool app_tune_IsApplied(APP_TUNE_Link_T *p_link, const APP_TUNE_Config_T *p_config)
+{
+    uint16_t interval;
+    uint8_t txPhy, rxPhy;
+
+    if (!APP_HCIMON_GetLinkParams(p_link->connHandle, &interval, &txPhy, &rxPhy))
+        return false;
+
+    // The PHY bit of LE Set PHY and the PHY of the events have the same value for LE 1M and LE 2M
+    return ((interval == p_config->interval) && (txPhy == p_config->phy) && (rxPhy == p_config->phy));
+}
+
+static APP_TRP_ConnList_T *app_tune_NextLink(void)
+{
+    APP_TRP_ConnList_T *p_trpConn;
+    uint8_t i;
+
+    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    {
+        p_trpConn = APP_TRP_COMMON_GetConnListByIndex(i);
+        if ((p_trpConn != NULL) && (p_trpConn->p_deviceProxy != NULL) && (p_trpConn->trpRole == APP_TRP_CLIENT_ROLE)
+            && (sp_tuneLink[i].state == APP_TUNE_STATE_IDLE))
+        {
+            return p_trpConn;
+        }
+    }
+
+    return NULL;
+}
+
+static void app_tune_Next(void)
+{
+    APP_TRP_ConnList_T *p_trpConn;
+
+    sp_tuneCurrent = NULL;
+
+    if (s_tuneHciDd >= 0)
+    {
+        hci_close_dev(s_tuneHciDd);
+        s_tuneHciDd = -1;
+    }
+
+    if (!s_tuneAll)
+        return;
+
+    while ((p_trpConn = app_tune_NextLink()) != NULL)
+    {
+        if (APP_TUNE_Start(p_trpConn) == APP_RES_SUCCESS)
+            return;
+
+        // Not tunable, do not try it again in this round
+        app_tune_GetLink(p_trpConn)->state = APP_TUNE_STATE_DONE;
+    }
+
+    s_tuneAll = false;
+    APP_SCRIPT_TuneFinished();
+}
+
+static void app_tune_Finish(APP_TRP_ConnList_T *p_trpConn, uint8_t status)
+{
+    APP_TUNE_Link_T *p_link = app_tune_GetLink(p_trpConn);
+
+    p_link->state = APP_TUNE_STATE_DONE;
+
+    if ((status != APP_TUNE_STATUS_SUCCESS) && (p_link->best != APP_TUNE_CONFIG_NONE))
+    {
+        bt_shell_printf("Tune [%d] failed, %s, interval %d.%02d ms is not applied by the controller\n",
+            app_tune_DevIndex(p_trpConn), app_tune_PhyStr(s_tuneMatrix[p_link->best].phy),
+            s_tuneMatrix[p_link->best].interval * 125 / 100, s_tuneMatrix[p_link->best].interval * 125 % 100);
+        p_link->best = APP_TUNE_CONFIG_NONE;
+    }
+    else if (p_link->best != APP_TUNE_CONFIG_NONE)
+    {
+        bt_shell_printf("Tune [%d] selected %s, interval %d.%02d ms, %u kbps\n", app_tune_DevIndex(p_trpConn),
+            app_tune_PhyStr(s_tuneMatrix[p_link->best].phy), s_tuneMatrix[p_link->best].interval * 125 / 100,
+            s_tuneMatrix[p_link->best].interval * 125 % 100, p_link->goodput[p_link->best] / 1000);
+    }
+    else
+    {
+        bt_shell_printf("Tune [%d] failed, no configuration could be probed\n", app_tune_DevIndex(p_trpConn));
+    }
+
+    // No work mode state machine may take the write response of the status
+    p_trpConn->workMode = TRP_WMODE_NULL;
+    APP_TRP_COMMON_SendUpConnParaStatus(p_trpConn, TRP_GRPID_UPDATE_CONN_PARA, APP_TRP_WMODE_SNED_UP_CONN_STATUS, status);
+    app_tune_Next();
+}
+
+static void app_tune_Step(APP_TRP_ConnList_T *p_trpConn)
+{
+    APP_TUNE_Link_T *p_link = app_tune_GetLink(p_trpConn);
+    uint8_t i;
+
+    // Configurations the controller refuses are skipped with zero goodput
+    while (p_link->step < APP_TUNE_CONFIG_NUM)
+    {
+        if (app_tune_Apply(p_link, &s_tuneMatrix[p_link->step]) == APP_RES_SUCCESS)
+        {
+            p_link->state = APP_TUNE_STATE_SETTLE;
+            APP_TIMER_SetTimer(APP_TIMER_TUNE, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, APP_TUNE_UPDATE_TIMEOUT);
+            return;
+        }
+        p_link->goodput[p_link->step++] = 0;
+    }
+
+    p_link->best = APP_TUNE_CONFIG_NONE;
+    for (i = 0; i < APP_TUNE_CONFIG_NUM; i++)
+    {
+        if ((p_link->goodput[i] > 0) && ((p_link->best == APP_TUNE_CONFIG_NONE) || (p_link->goodput[i] > p_link->goodput[p_link->best])))
+            p_link->best = i;
+    }
+
+    if ((p_link->best == APP_TUNE_CONFIG_NONE) || (app_tune_Apply(p_link, &s_tuneMatrix[p_link->best]) != APP_RES_SUCCESS))
+    {
+        app_tune_Finish(p_trpConn, APP_TUNE_STATUS_FAIL);
+        return;
+    }
+
+    p_link->state = APP_TUNE_STATE_APPLY_BEST;
+    APP_TIMER_SetTimer(APP_TIMER_TUNE, APP_TRP_COMMON_GetConnIndex(p_trpConn), (void *)p_trpConn, APP_TUNE_UPDATE_TIMEOUT);
+}
+
+//The controller is done with the updates of the requested configuration, or refused one of them
+static void app_tune_Updated(APP_TRP_ConnList_T *p_trpConn, bool refused)
+{
+    APP_TUNE_Link_T *p_link = app_tune_GetLink(p_trpConn);
+    uint8_t config = (p_link->state == APP_TUNE_STATE_APPLY_BEST) ? p_link->best : p_link->step;
+    bool applied;
+
+    APP_TIMER_StopTimer(APP_TIMER_TUNE, APP_TRP_COMMON_GetConnIndex(p_trpConn));
+    p_link->pending = 0;
+
+    // A completed update may still end with other parameters, e.g. a PHY the peer does not support
+    applied = !refused && app_tune_IsApplied(p_link, &s_tuneMatrix[config]);
+
+    if (p_link->state == APP_TUNE_STATE_APPLY_BEST)
+    {
+        app_tune_Finish(p_trpConn, applied ? APP_TUNE_STATUS_SUCCESS : APP_TUNE_STATUS_FAIL);
+        return;
+    }
+
+    if (applied)
+    {
+        p_link->state = APP_TUNE_STATE_PROBE;
+        APP_TRPC_TransmitModeSwitch(TRP_WMODE_FIX_PATTERN, p_trpConn);
+        return;
+    }
+
+    bt_shell_printf("Tune [%d] %s, interval %d.%02d ms: not applied by the controller\n", app_tune_DevIndex(p_trpConn),
+        app_tune_PhyStr(s_tuneMatrix[config].phy), s_tuneMatrix[config].interval * 125 / 100,
+        s_tuneMatrix[config].interval * 125 % 100);
+    p_link->goodput[p_link->step++] = 0;
+    app_tune_Step(p_trpConn);
+}
+
+uint16_t APP_TUNE_Start(APP_TRP_ConnList_T *p_trpConn)
+{
+    APP_TUNE_Link_T *p_link = app_tune_GetLink(p_trpConn);
+
+    if ((p_link == NULL) || (p_trpConn->p_deviceProxy == NULL))
+        return APP_RES_FAIL;
+
+    if (p_trpConn->p_cold->testStage == APP_TEST_PROGRESS)
+        return APP_RES_BUSY;
+
+    // The central owns the connection parameters, the server asks the client to tune the link
+    if (p_trpConn->trpRole == APP_TRP_SERVER_ROLE)
+        return APP_TRP_COMMON_SendUpConnParaStatus(p_trpConn, TRP_GRPID_UPDATE_CONN_PARA, APP_TRP_WMODE_UPDATE_CONN_PARA, 0);
+
+    if (p_trpConn->trpRole != APP_TRP_CLIENT_ROLE)
+        return APP_RES_FAIL;
+
+    if (sp_tuneCurrent != NULL)
+        return APP_RES_BUSY;
+
+    s_tuneHciDd = hci_open_dev(APP_TUNE_HCI_DEV_ID);
+    if (s_tuneHciDd < 0)
+    {
+        perror("Failed to open HCI device");
+        return APP_RES_FAIL;
+    }
+
+    memset(p_link, 0, sizeof(APP_TUNE_Link_T));
+    p_link->best = APP_TUNE_CONFIG_NONE;
+
+    if (!app_tune_GetConnHandle(p_trpConn, &p_link->connHandle))
+    {
+        hci_close_dev(s_tuneHciDd);
+        s_tuneHciDd = -1;
+        return APP_RES_FAIL;
+    }
+
+    sp_tuneCurrent = p_trpConn;
+    bt_shell_printf("Tune [%d] started, %d configurations\n", app_tune_DevIndex(p_trpConn), APP_TUNE_CONFIG_NUM);
+    app_tune_Step(p_trpConn);
+
+    return APP_RES_SUCCESS;
+}
+
+void APP_TUNE_Init(void)
+{
+    if (sp_tuneLink == NULL)
+        sp_tuneLink = g_new0(APP_TUNE_Link_T, APP_TRP_MAX_LINK_NUMBER);
+}
+
+uint16_t APP_TUNE_StartAll(void)
+{
+    uint8_t i;
+
+    if (sp_tuneCurrent != NULL)
+        return APP_RES_BUSY;
+
+    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    {
+        sp_tuneLink[i].state = APP_TUNE_STATE_IDLE;
+    }
+
+    if (app_tune_NextLink() == NULL)
+        return APP_RES_FAIL;
+
+    s_tuneAll = true;
+    app_tune_Next();
+
+    return APP_RES_SUCCESS;
+}
+
+bool APP_TUNE_IsProbing(APP_TRP_ConnList_T *p_trpConn)
+{
+    APP_TUNE_Link_T *p_link = app_tune_GetLink(p_trpConn);
+
+    return ((p_link != NULL) && (p_link->state == APP_TUNE_STATE_PROBE));
+}
+
+void APP_TUNE_ProbeDone(APP_TRP_ConnList_T *p_trpConn)
+{
+    APP_TUNE_Link_T *p_link = app_tune_GetLink(p_trpConn);
+    gdouble elapsed;
+
+    g_timer_stop(p_trpConn->p_cold->p_transTimer);
+    elapsed = g_timer_elapsed(p_trpConn->p_cold->p_transTimer, NULL);
+
+    if ((p_trpConn->p_cold->testStage == APP_TEST_PASSED) && (elapsed > 0))
+        p_link->goodput[p_link->step] = (uint32_t)(p_trpConn->rxAccuLeng * 8 / elapsed);
+    else
+        p_link->goodput[p_link->step] = 0;
+
+    bt_shell_printf("Tune [%d] %s, interval %d.%02d ms: %u kbps\n", app_tune_DevIndex(p_trpConn),
+        app_tune_PhyStr(s_tuneMatrix[p_link->step].phy), s_tuneMatrix[p_link->step].interval * 125 / 100,
+        s_tuneMatrix[p_link->step].interval * 125 % 100, p_link->goodput[p_link->step] / 1000);
+
+    // The probe is not a burst mode run, leave no trace in the test result
+    p_trpConn->p_cold->testStage = APP_TEST_IDLE;
+    p_trpConn->workMode = TRP_WMODE_NULL;
+    p_link->step++;
+
+    app_tune_Step(p_trpConn);
+}
+
+void APP_TUNE_Timeout(APP_TRP_ConnList_T *p_trpConn)
+{
+    APP_TUNE_Link_T *p_link = app_tune_GetLink(p_trpConn);
+
+    if (p_link == NULL)
+        return;
+
+    // Without an event, e.g. for parameters already in use, the parameters read back decide
+    if ((p_link->state == APP_TUNE_STATE_SETTLE) || (p_link->state == APP_TUNE_STATE_APPLY_BEST))
+        app_tune_Updated(p_trpConn, false);
+}
+
+void APP_TUNE_CmdStatus(uint16_t opcode, uint8_t status)
+{
+    APP_TUNE_Link_T *p_link;
+
+    if ((sp_tuneCurrent == NULL) || (status == 0))
+        return;
+
+    if ((opcode != cmd_opcode_pack(OGF_LE_CTL, APP_TUNE_OCF_LE_SET_PHY))
+        && (opcode != cmd_opcode_pack(OGF_LE_CTL, OCF_LE_CONN_UPDATE)))
+        return;
+
+    p_link = app_tune_GetLink(sp_tuneCurrent);
+    if (p_link->pending == 0)
+        return;
+
+    bt_shell_printf("Tune [%d] command %04x refused, status %02x\n", app_tune_DevIndex(sp_tuneCurrent), opcode, status);
+    app_tune_Updated(sp_tuneCurrent, true);
+}
+
+void APP_TUNE_LinkUpdated(uint16_t handle, uint8_t update, uint8_t status)
+{
+    APP_TUNE_Link_T *p_link;
+
+    if (sp_tuneCurrent == NULL)
+        return;
+
+    p_link = app_tune_GetLink(sp_tuneCurrent);
+    if ((p_link->connHandle != handle) || ((p_link->pending & update) == 0))
+        return;
+
+    if (status != 0)
+    {
+        app_tune_Updated(sp_tuneCurrent, true);
+        return;
+    }
+
+    p_link->pending &= ~update;
+    if (p_link->pending == 0)
+        app_tune_Updated(sp_tuneCurrent, false);
+}
+
+void APP_TUNE_ConnParaCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t commandId, uint8_t status)
+{
+    uint16_t result;
+
+    if (commandId == APP_TRP_WMODE_UPDATE_CONN_PARA)
+    {
+        if (p_trpConn->trpRole != APP_TRP_CLIENT_ROLE)
+            return;
+
+        // The write response of the status drives the state machine of a running work mode, stay silent then
+        result = APP_TUNE_Start(p_trpConn);
+        if ((result != APP_RES_SUCCESS) && (p_trpConn->workMode == TRP_WMODE_NULL))
+        {
+            APP_TRP_COMMON_SendUpConnParaStatus(p_trpConn, TRP_GRPID_UPDATE_CONN_PARA, APP_TRP_WMODE_SNED_UP_CONN_STATUS,
+                (result == APP_RES_BUSY) ? APP_TUNE_STATUS_BUSY : APP_TUNE_STATUS_FAIL);
+        }
+    }
+    else if (commandId == APP_TRP_WMODE_SNED_UP_CONN_STATUS)
+    {
+        if (p_trpConn->trpRole != APP_TRP_SERVER_ROLE)
+            return;
+
+        if (status == APP_TUNE_STATUS_SUCCESS)
+            bt_shell_printf("Tune [%d] the peer applied the best connection parameters\n", app_tune_DevIndex(p_trpConn));
+        else
+            bt_shell_printf("Tune [%d] the peer failed to tune the connection (status %d)\n", app_tune_DevIndex(p_trpConn), status);
+    }
+}
+
+void APP_TUNE_LinkDisconnected(APP_TRP_ConnList_T *p_trpConn)
+{
+    APP_TUNE_Link_T *p_link = app_tune_GetLink(p_trpConn);
+
+    if (p_link == NULL)
+        return;
+
+    APP_TIMER_StopTimer(APP_TIMER_TUNE, APP_TRP_COMMON_GetConnIndex(p_trpConn));
+    memset(p_link, 0, sizeof(APP_TUNE_Link_T));
+
+    if (sp_tuneCurrent == p_trpConn)
+    {
+        // Keep the link out of a tune all round, it is cleared when connected again
+        p_link->state = APP_TUNE_STATE_DONE;
+        p_link->best = APP_TUNE_CONFIG_NONE;
+        app_tune_Next();
+        p_link->state = APP_TUNE_STATE_IDLE;
+    }
+}
+
+void APP_TUNE_PrintResult(void)
+{
+    APP_TRP_ConnList_T *p_trpConn;
+    APP_DBP_BtDev_T *p_dev;
+    const APP_TUNE_Config_T *p_best;
+    uint8_t i, j;
+
+    bt_shell_printf("[Index][     Address     ]");
+    for (j = 0; j < APP_TUNE_CONFIG_NUM; j++)
+    {
+        bt_shell_printf("[%s %2d.%02d]", app_tune_PhyStr(s_tuneMatrix[j].phy), s_tuneMatrix[j].interval * 125 / 100,
+            s_tuneMatrix[j].interval * 125 % 100);
+    }
+    bt_shell_printf("[ Selected ]\n");
+    bt_shell_printf("=================================================================================\n");
+
+    for (i = 0; i < APP_TRP_MAX_LINK_NUMBER; i++)
+    {
+        if (sp_tuneLink[i].state == APP_TUNE_STATE_IDLE)
+            continue;
+
+        p_trpConn = APP_TRP_COMMON_GetConnListByIndex(i);
+        p_dev = APP_DBP_GetDevInfoByProxy(p_trpConn->p_deviceProxy);
+
+        bt_shell_printf("dev#%2d\t[%17s]", p_dev ? p_dev->index : i, p_dev ? p_dev->p_address : "-");
+        for (j = 0; j < APP_TUNE_CONFIG_NUM; j++)
+        {
+            if (j < sp_tuneLink[i].step)
+                bt_shell_printf("[%5u kbps]", sp_tuneLink[i].goodput[j] / 1000);
+            else
+                bt_shell_printf("[%10s]", "-");
+        }
+
+        if (sp_tuneLink[i].state != APP_TUNE_STATE_DONE)
+        {
+            bt_shell_printf("[  tuning  ]\n");
+        }
+        else if (sp_tuneLink[i].best == APP_TUNE_CONFIG_NONE)
+        {
+            bt_shell_printf("[   none   ]\n");
+        }
+        else
+        {
+            p_best = &s_tuneMatrix[sp_tuneLink[i].best];
+            bt_shell_printf("[%s %2d.%02d]\n", app_tune_PhyStr(p_best->phy), p_best->interval * 125 / 100,
+                p_best->interval * 125 % 100);
+        }
+    }
+}
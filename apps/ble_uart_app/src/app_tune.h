@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Connection Auto-tune Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_tune.h
+
+  Summary:
+    This file contains the Application connection auto-tune functions for this project.
+
+  Description:
+    This file contains the Application connection auto-tune functions for this project.
+    The TRP client sweeps a small matrix of PHY and connection interval on a link, runs a
+    short fixed-pattern probe with each configuration and keeps the one with the best
+    measured goodput.
+ *******************************************************************************/
+
+#ifndef APP_TUNE_H
+#define APP_TUNE_H
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "app_trp_common.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_TUNE_PROBE_SIZE                     (100 * 0x400)   /**< Fixed-pattern bytes sent by the server per probe. */
+
+/**@defgroup APP_TUNE_STATUS APP_TUNE_STATUS
+ * @brief The status reported to the server with APP_TRP_WMODE_SNED_UP_CONN_STATUS.
+ * @{ */
+#define APP_TUNE_STATUS_SUCCESS                 0x00            /**< The best configuration is applied. */
+#define APP_TUNE_STATUS_BUSY                    0x01            /**< The link or the tuner is busy. */
+#define APP_TUNE_STATUS_FAIL                    0x02            /**< No configuration could be probed. */
+/** @} */
+
+/**@defgroup APP_TUNE_UPDATE APP_TUNE_UPDATE
+ * @brief The link updates requested for a configuration, each completed by its own LE Meta event.
+ * @{ */
+#define APP_TUNE_UPDATE_PHY                     0x01            /**< LE Set PHY, completed by LE PHY Update Complete. */
+#define APP_TUNE_UPDATE_CONN                    0x02            /**< LE Connection Update, completed by LE Connection Update Complete. */
+/** @} */
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Allocate the tuning state of the links. It must be called once the link number is set. */
+void APP_TUNE_Init(void);
+
+/**@brief Tune one link. On a TRP server link the client is asked to tune it.
+ * @param[in] p_trpConn             The link.
+ * @retval APP_RES_SUCCESS          Tuning is started or requested.
+ * @retval APP_RES_BUSY             The link or the tuner is busy.
+ * @retval APP_RES_FAIL             The link can not be tuned.
+ */
+uint16_t APP_TUNE_Start(APP_TRP_ConnList_T *p_trpConn);
+
+/**@brief Tune all the TRP client links, one after the other.
+ * @retval APP_RES_SUCCESS          Tuning is started.
+ * @retval APP_RES_FAIL             No link to tune.
+ */
+uint16_t APP_TUNE_StartAll(void);
+
+/**@brief Check whether the fixed-pattern run of a link is a probe of the tuner.
+ * @param[in] p_trpConn             The link.
+ * @retval true                     The run is a probe.
+ */
+bool APP_TUNE_IsProbing(APP_TRP_ConnList_T *p_trpConn);
+
+/**@brief Report the end of a probe, from the fixed-pattern state machine.
+ *        The goodput is measured from the start log timer and the received bytes.
+ * @param[in] p_trpConn             The link.
+ */
+void APP_TUNE_ProbeDone(APP_TRP_ConnList_T *p_trpConn);
+
+/**@brief Handle the update timer of a link. The controller did not report all the updates in time,
+ *        the connection parameters are read back to tell whether the configuration is applied.
+ * @param[in] p_trpConn             The link.
+ */
+void APP_TUNE_Timeout(APP_TRP_ConnList_T *p_trpConn);
+
+/**@brief Handle an HCI Command Status event. A refused LE Set PHY or LE Connection Update
+ *        scores the configuration being applied as zero.
+ * @param[in] opcode                Opcode of the command.
+ * @param[in] status                HCI status, 0 if the command is accepted.
+ */
+void APP_TUNE_CmdStatus(uint16_t opcode, uint8_t status);
+
+/**@brief Handle an LE PHY Update Complete or LE Connection Update Complete event.
+ * @param[in] handle                HCI connection handle.
+ * @param[in] update                The completed update. See @ref APP_TUNE_UPDATE.
+ * @param[in] status                HCI status, 0 if the update is done.
+ */
+void APP_TUNE_LinkUpdated(uint16_t handle, uint8_t update, uint8_t status);
+
+/**@brief Handle the TRP_GRPID_UPDATE_CONN_PARA vendor commands.
+ * @param[in] p_trpConn             The link.
+ * @param[in] commandId             Command ID.
+ * @param[in] status                Command status. See @ref APP_TUNE_STATUS.
+ */
+void APP_TUNE_ConnParaCmdProc(APP_TRP_ConnList_T *p_trpConn, uint8_t commandId, uint8_t status);
+
+/**@brief Stop tuning a disconnected link.
+ * @param[in] p_trpConn             The link.
+ */
+void APP_TUNE_LinkDisconnected(APP_TRP_ConnList_T *p_trpConn);
+
+/**@brief Print the goodput measured per configuration and the selected one of every tuned link. */
+void APP_TUNE_PrintResult(void);
+
+
+#endif
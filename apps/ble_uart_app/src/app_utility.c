@@ -31,6 +31,7 @@
 #include "app_utility.h"
 #include "application.h"
 #include "app_error_defs.h"
+#include "app_mem.h"
 
 // *****************************************************************************
 // *****************************************************************************
@@ -96,6 +97,12 @@ uint16_t APP_UTILITY_InsertDataToCircQueue(uint16_t dataLeng, uint8_t *p_data,
             p_circQ->writeIdx++;
             if (p_circQ->writeIdx >= p_circQ->size)
                 p_circQ->writeIdx = 0;
+
+            if (p_circQ->p_markCb != NULL && !p_circQ->isPaused && p_circQ->usedNum >= p_circQ->highMark)
+            {
+                p_circQ->isPaused = true;
+                p_circQ->p_markCb(p_circQ, true, p_circQ->p_markParam);
+            }
         }
         else
             return APP_RES_NO_RESOURCE;
@@ -131,15 +138,40 @@ void APP_UTILITY_FreeElemCircQueue(APP_UTILITY_CircQueue_T *p_circQ)
     {
         p_circQ->p_queueElem[p_circQ->readIdx].dataLeng = 0;
         if (p_circQ->p_queueElem[p_circQ->readIdx].p_data != NULL)
-            free(p_circQ->p_queueElem[p_circQ->readIdx].p_data);
+            APP_MEM_Free(p_circQ->p_queueElem[p_circQ->readIdx].p_data);
         if (p_circQ->usedNum > 0)
             p_circQ->usedNum--;
         p_circQ->readIdx++;
         if (p_circQ->readIdx >= p_circQ->size)
             p_circQ->readIdx = 0;
+
+        if (p_circQ->isPaused && p_circQ->usedNum <= p_circQ->lowMark)
+        {
+            p_circQ->isPaused = false;
+            if (p_circQ->p_markCb != NULL)
+                p_circQ->p_markCb(p_circQ, false, p_circQ->p_markParam);
+        }
     }
 }
 
+uint16_t APP_UTILITY_SetCircQueueMark(APP_UTILITY_CircQueue_T *p_circQ, uint8_t highMark, uint8_t lowMark,
+    APP_UTILITY_CircQueueMarkCb_T p_markCb, void *p_param)
+{
+    if (p_circQ == NULL)
+        return APP_RES_INVALID_PARA;
+
+    if (p_markCb != NULL && (highMark == 0 || highMark > p_circQ->size || lowMark >= highMark))
+        return APP_RES_INVALID_PARA;
+
+    p_circQ->highMark = highMark;
+    p_circQ->lowMark = lowMark;
+    p_circQ->p_markCb = p_markCb;
+    p_circQ->p_markParam = p_param;
+    p_circQ->isPaused = (p_markCb != NULL && p_circQ->usedNum >= highMark);
+
+    return APP_RES_SUCCESS;
+}
+
 uint16_t APP_UTILITY_InitCircQueue(APP_UTILITY_CircQueue_T *p_circQ, uint8_t size)
 {
     uint8_t i;
@@ -169,3 +201,23 @@ uint16_t APP_UTILITY_InitCircQueue(APP_UTILITY_CircQueue_T *p_circQ, uint8_t siz
     return APP_RES_SUCCESS;
 }
 
+void APP_UTILITY_WriteJsonString(FILE *p_file, const char *p_str)
+{
+    if (p_str == NULL)
+    {
+        fputs("null", p_file);
+        return;
+    }
+
+    fputc('"', p_file);
+    for (; *p_str; p_str++)
+    {
+        if (*p_str == '"' || *p_str == '\\')
+            fprintf(p_file, "\\%c", *p_str);
+        else if ((unsigned char)*p_str < 0x20)
+            fprintf(p_file, "\\u%04x", (unsigned char)*p_str);
+        else
+            fputc(*p_str, p_file);
+    }
+    fputc('"', p_file);
+}
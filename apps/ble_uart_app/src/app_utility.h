@@ -31,6 +31,8 @@
 // *****************************************************************************
 // *****************************************************************************
 #include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
 
 
 // *****************************************************************************
@@ -55,6 +57,15 @@ typedef struct APP_UTILITY_QueueElem_T
     uint8_t                    *p_data;     /**< Pointer to the data buffer */
 } APP_UTILITY_QueueElem_T;
 
+struct APP_UTILITY_CircQueue_T;
+
+/**@brief The function type of a circular queue watermark callback.
+ * @param[in] p_circQ               The circular queue.
+ * @param[in] isHigh                true when the high mark is reached, false when the queue is back to the low mark.
+ * @param[in] p_param               The parameter given with the callback.
+ */
+typedef void (*APP_UTILITY_CircQueueMarkCb_T)(struct APP_UTILITY_CircQueue_T *p_circQ, bool isHigh, void *p_param);
+
 /**@brief The structure contains information about circular queue format. */
 typedef struct APP_UTILITY_CircQueue_T
 {
@@ -62,7 +73,12 @@ typedef struct APP_UTILITY_CircQueue_T
     uint8_t                     usedNum;                                /**< The number of data list in circular queue. */
     uint8_t                     writeIdx;                               /**< The Index of data, written in circular queue. */
     uint8_t                     readIdx;                                /**< The Index of data, read in circular queue. */
+    uint8_t                     highMark;                               /**< Used number calling the callback with isHigh true, 0 for none. */
+    uint8_t                     lowMark;                                /**< Used number calling the callback with isHigh false once the high mark is reached. */
+    bool                        isPaused;                               /**< The high mark is reached and the low mark is not yet. */
     APP_UTILITY_QueueElem_T     *p_queueElem;   /**< The circular data queue. @ref APP_UTILITY_QueueElem_T.*/
+    APP_UTILITY_CircQueueMarkCb_T p_markCb;                             /**< Watermark callback, NULL for none. */
+    void                        *p_markParam;                           /**< Parameter of the watermark callback. */
 } APP_UTILITY_CircQueue_T;
 
 
@@ -117,5 +133,49 @@ uint16_t APP_UTILITY_InitCircQueue(APP_UTILITY_CircQueue_T *p_circQ, uint8_t siz
 
 uint8_t APP_UTILITY_GetAvailCircQueueNum(APP_UTILITY_CircQueue_T *p_circQ);
 
+/**@brief The function is to set the watermarks of a circular queue. The callback is called once when the used number
+ *        reaches the high mark, then once when it falls back to the low mark. The watermarks are cleared by
+ *        APP_UTILITY_InitCircQueue().
+ *
+ * *@param[in] p_circQ           Point to the circular queue. See @ref APP_UTILITY_CircQueue_T.
+ * *@param[in] highMark          High mark, from 1 to the size of the queue.
+ * *@param[in] lowMark           Low mark, lower than the high mark.
+ * *@param[in] p_markCb          Watermark callback, NULL to remove the watermarks.
+ * *@param[in] p_param           Parameter of the callback.
+ *
+ * @return A status.
+ */
+uint16_t APP_UTILITY_SetCircQueueMark(APP_UTILITY_CircQueue_T *p_circQ, uint8_t highMark, uint8_t lowMark,
+    APP_UTILITY_CircQueueMarkCb_T p_markCb, void *p_param);
+
+/**@brief The function is to write a string as a quoted and escaped JSON string.
+ *
+ * *@param[in] p_file            Output file.
+ * *@param[in] p_str             The string. null is written if it is NULL.
+ *
+ */
+void APP_UTILITY_WriteJsonString(FILE *p_file, const char *p_str);
+
+/**@brief The function is to pick the next set bit of a mask after an index, round robin. It is inline as the
+ *        link schedulers call it for every packet, tools/bench/next_link_bench.c times it as is.
+ *
+ * *@param[in] mask              Bit per candidate, bit 0 for index 0.
+ * *@param[in] index             Index picked last time.
+ *
+ * @return The first set bit after index, else the first set bit from 0, which may be index itself.
+ *         index if the mask is 0.
+ */
+static inline uint8_t APP_UTILITY_NextInMask(uint64_t mask, uint8_t index)
+{
+    uint64_t upperMask;
+
+    if (mask == 0)
+        return index;
+
+    upperMask = (index < 63) ? (mask & (~0ULL << (index + 1))) : 0;
+
+    return (uint8_t)__builtin_ctzll(upperMask != 0 ? upperMask : mask);
+}
+
 
 #endif
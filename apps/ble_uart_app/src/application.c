@@ -46,7 +46,6 @@
 #include "bluetooth/hci.h"
 #include "bluetooth/hci_lib.h"
 #include "shared/mainloop.h"
-#include <poll.h>
 
 
 #include "application.h"
@@ -60,7 +59,15 @@
 #include "app_mgmt.h"
 #include "app_trps.h"
 #include "app_trpc.h"
+#include "app_trcbp.h"
 #include "app_agent.h"
+#include "app_log.h"
+#include "app_script.h"
+#include "app_result.h"
+#include "app_dp.h"
+#include "app_hcimon.h"
+#include "app_tune.h"
+#include "app_mem.h"
 
 
 
@@ -92,8 +99,6 @@
 // *****************************************************************************
 // *****************************************************************************
 GThread *sp_shutdownThread;
-GThread *sp_prevThread;
-GThread *sp_currThread;
 
 static unsigned char * sp_patternData;
 static unsigned int s_patternDataSize;
@@ -113,6 +118,7 @@ static const char * s_appWorkModeDesc[] = {
     "Fixed-pattern",
     "raw",
     "Reverse-loopback",
+    "Duplex",
 };
 
 static const char * s_appPatternFile[] = {
@@ -151,10 +157,96 @@ typedef struct APP_FileTransList_T
     char                *p_rawDataFileName;   //raw mode tx/rx data file name
     GTimer              *p_lbTimer;
     APP_TRP_TestStage_T  testStage;
+    APP_LOG_Throttle_T   progressThrottle; //raw mode progress log rate limiting
+    uint8_t              resumeStage;   //raw mode file resume negotiation, see APP_RAW_DATA_RESUME_T
+    uint32_t             fileId;        //raw mode file identifier, the CRC-32 of the whole file
+    unsigned int         fileSize;      //raw mode rx file size announced by the sender
+    bool                 rxWatchdog;    //the rx stall watchdog is armed
+    unsigned int         rxCheckOffset; //rx offset when the rx stall watchdog was armed
+    uint32_t             runId;         //changed by every clear of the record, a job of an older run is stale
+    bool                 lbSaving;      //loopback receive buffer handed over to the data plane worker
 } APP_FileTransList_T;
 
+enum APP_RAW_DATA_RESUME_T
+{
+    APP_RAW_DATA_RESUME_IDLE = 0x00,    /**< No file resume negotiation. */
+    APP_RAW_DATA_RESUME_TX_WAIT,        /**< The file is announced, waiting for the offset of the receiver. */
+    APP_RAW_DATA_RESUME_RX              /**< The file announced by the sender is being received. */
+};
+
+// File error of a data plane job, reported by its done step as the worker does not print
+enum APP_FILE_ERR_T
+{
+    APP_FILE_ERR_NONE = 0x00,
+    APP_FILE_ERR_OPEN,
+    APP_FILE_ERR_APPEND,
+    APP_FILE_ERR_WRITE
+};
+
+// Partial file kept across a disconnection to be resumed by the next rxf
+typedef struct APP_RawDataResumeRec_T
+{
+    uint32_t             fileId;
+    unsigned int         fileSize;
+    char                *p_fileName;
+} APP_RawDataResumeRec_T;
+
+// Raw mode chunk saving run on the data plane worker. The job owns the chunk buffer and the file name.
+typedef struct APP_RawDataSaveJob_T
+{
+    char                *p_fileName;
+    char                *p_dataBuf;
+    bool                 ownBuf;        //the chunk buffer is freed by the job
+    unsigned int         wsize;
+    bool                 truncate;      //first chunk of the file
+    bool                 verify;        //check the size and the crc of the whole file once saved
+    bool                 compare;       //diff the whole file with the pattern once saved
+    uint32_t             fileId;
+    unsigned int         fileSize;
+    int                  devIdx;
+    unsigned int         patternIndex;
+    bool                 written;
+    uint8_t              fileErr;       //see APP_FILE_ERR_T
+    int                  fileErrno;
+    bool                 crcPassed;
+    uint32_t             crc;
+    unsigned int         crcSize;
+    bool                 comparePassed;
+} APP_RawDataSaveJob_T;
+
+// CRC-32 of a file to send in raw mode, run on the data plane worker. The job owns the file name.
+typedef struct APP_RawDataCrcJob_T
+{
+    uint8_t              transIndex;
+    uint32_t             runId;
+    char                *p_fileName;
+    bool                 crcPassed;
+    uint32_t             crc;
+    unsigned int         crcSize;
+} APP_RawDataCrcJob_T;
+
+// Loopback received data dump and compare run on the data plane worker. The job owns the receive buffer.
+typedef struct APP_LoopbackSaveJob_T
+{
+    uint8_t              transIndex;
+    uint32_t             runId;
+    char                *p_dataBuf;
+    char                 fileName[256];
+    unsigned int         wsize;
+    int                  devIdx;
+    unsigned int         patternIndex;
+    uint8_t              fileErr;       //see APP_FILE_ERR_T
+    APP_TRP_TestStage_T  testStage;
+} APP_LoopbackSaveJob_T;
+
 
-static APP_FileTransList_T s_appFileTransList[BLE_GAP_MAX_LINK_NBR];
+static APP_FileTransList_T *sp_appFileTransList;          /**< Table of BLE_GAP_MAX_LINK_NBR entries, allocated once by APP_Initialize(). */
+static uint8_t *sp_appFileTransFreeNext;                    /**< Next free entry of each free entry, BLE_GAP_MAX_LINK_NBR ends the list. */
+static uint8_t s_appFileTransFreeHead;
+static GHashTable *sp_appFileTransByProxy;                  /**< Used entries by device proxy. */
+static APP_RawDataResumeRec_T *sp_appRawDataResumeRec;      /**< Table of BLE_GAP_MAX_LINK_NBR entries, allocated once by APP_Initialize(). */
+static APP_LOG_Throttle_T  s_lbProgressThrottle;
+static uint32_t s_appFileTransRunId;
 
 
 
@@ -172,33 +264,45 @@ static APP_FileTransList_T s_appFileTransList[BLE_GAP_MAX_LINK_NBR];
 // *****************************************************************************
 // *****************************************************************************
 static APP_FileTransList_T * app_GetFileTransList(DeviceProxy * p_devProxy);
-#ifdef ENABLE_DATA_BUFFER_OVERFLOW_MONITOR
-static void app_HciEvtMonitor(void);
-#endif
-static void app_ClearFileTransRecord(APP_FileTransList_T        * p_fileTrans, uint32_t rxDataSize);
+static void app_ClearFileTransRecord(APP_FileTransList_T        * p_fileTrans, uint32_t rxDataSize, APP_MEM_Cat_T memCat);
 
 
 
 static void app_LoopbackProgressingLog(DeviceProxy * p_devProxy)
 {
     uint8_t i;
+    uint32_t totalLeng = 0;
     APP_DBP_BtDev_T *p_dev;
+    char logBuf[APP_LOG_MSG_MAX_LEN];
+    int logLeng;
 
 
-    printf("\rProgressing: ");
     for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
     {
-        if (s_appFileTransList[i].p_deviceProxy != NULL && s_appFileTransList[i].testStage >= APP_TEST_PROGRESS)
+        if (sp_appFileTransList[i].p_deviceProxy != NULL && sp_appFileTransList[i].testStage >= APP_TEST_PROGRESS)
+        {
+            totalLeng += sp_appFileTransList[i].txOffset + sp_appFileTransList[i].rxOffset;
+        }
+    }
+
+    if (!APP_LOG_ProgressDue(&s_lbProgressThrottle, totalLeng))
+        return;
+
+    logLeng = snprintf(logBuf, sizeof(logBuf), "\rProgressing: ");
+    for (i=0; i<BLE_GAP_MAX_LINK_NBR && logLeng < (int)sizeof(logBuf); i++)
+    {
+        if (sp_appFileTransList[i].p_deviceProxy != NULL && sp_appFileTransList[i].testStage >= APP_TEST_PROGRESS)
         {
-            p_dev = APP_DBP_GetDevInfoByProxy(s_appFileTransList[i].p_deviceProxy);
+            p_dev = APP_DBP_GetDevInfoByProxy(sp_appFileTransList[i].p_deviceProxy);
             if (p_dev == NULL)
                 continue;
             
-            printf("[%s: %3d%%]", p_dev->p_name, s_appFileTransList[i].rxOffset*100/s_patternDataSize);
+            logLeng += snprintf(&logBuf[logLeng], sizeof(logBuf) - logLeng, "[%s: %3d%%]",
+                p_dev->p_name, sp_appFileTransList[i].rxOffset*100/s_patternDataSize);
         }
     }
     
-    fflush(stdout);
+    APP_LOG_Post(APP_LOG_TYPE_RAW, "%s", logBuf);
 }
 
 static void app_LoopbackFinishLog(void)
@@ -211,15 +315,17 @@ static void app_LoopbackFinishLog(void)
 
     for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
     {
-        if (s_appFileTransList[i].p_deviceProxy != NULL)
+        if (sp_appFileTransList[i].p_deviceProxy != NULL)
         {
-            if (s_appFileTransList[i].testStage == APP_TEST_PROGRESS)
+            if (sp_appFileTransList[i].testStage == APP_TEST_PROGRESS)
                 return;
-            if  (s_appFileTransList[i].testStage == APP_TEST_PASSED)
+            if  (sp_appFileTransList[i].testStage == APP_TEST_PASSED)
                 countPass++;
         }
     }
 
+    APP_LOG_Flush();
+
 #ifdef ENABLE_AUTO_RUN
     printf("\nLoopback (%s) test result(%d runs):\n", s_appPatternTypeStr[s_patternFileIndex], APP_GetPassedRun());
 #else
@@ -230,23 +336,29 @@ static void app_LoopbackFinishLog(void)
 
     for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
     {
-        if (s_appFileTransList[i].testStage == APP_TEST_IDLE)
+        if (sp_appFileTransList[i].testStage == APP_TEST_IDLE)
             continue;
             
-        p_dev = APP_DBP_GetDevInfoByProxy(s_appFileTransList[i].p_deviceProxy);
+        p_dev = APP_DBP_GetDevInfoByProxy(sp_appFileTransList[i].p_deviceProxy);
         if (p_dev == NULL)
             continue;
         
-        if (s_appFileTransList[i].testStage == APP_TEST_PASSED)
+        if (sp_appFileTransList[i].testStage == APP_TEST_PASSED)
         {
-            elapseTime = g_timer_elapsed(s_appFileTransList[i].p_lbTimer, NULL);
+            elapseTime = g_timer_elapsed(sp_appFileTransList[i].p_lbTimer, NULL);
         }
         
         printf("dev#%2d\t[%s][%s][%s][%f s]\n", p_dev->index, p_dev->p_address, p_dev->p_name, 
-            APP_TRP_TestStageStr[s_appFileTransList[i].testStage], elapseTime);
+            APP_TRP_TestStageStr[sp_appFileTransList[i].testStage], elapseTime);
+        APP_SCRIPT_LinkResult(sp_appFileTransList[i].p_deviceProxy, sp_appFileTransList[i].testStage,
+            (sp_appFileTransList[i].testStage == APP_TEST_PASSED) ? elapseTime : 0, s_patternDataSize);
+        APP_RESULT_LinkResult(sp_appFileTransList[i].p_deviceProxy, TRP_WMODE_LOOPBACK, sp_appFileTransList[i].testStage,
+            (sp_appFileTransList[i].testStage == APP_TEST_PASSED) ? elapseTime : 0, s_patternDataSize, sp_appFileTransList[i].attMtu);
     }
 
     bt_shell_printf("\n");
+    APP_RESULT_RunFinished();
+    APP_SCRIPT_RunFinished(countPass);
 
 #ifdef ENABLE_AUTO_RUN
     APP_GoNextRun(countPass);
@@ -261,17 +373,17 @@ static void app_RawDataProgressingLog(DeviceProxy * p_devProxy)
     if(p_fileTrans == NULL)
         return;
 
+    if (!APP_LOG_ProgressDue(&p_fileTrans->progressThrottle, p_fileTrans->rxOffset + p_fileTrans->txOffset))
+        return;
+
     if (p_fileTrans->rxOffset)
     {
-        printf("\rProgressing(Rx:%d)", p_fileTrans->rxOffset);
+        APP_LOG_Post(APP_LOG_TYPE_RAW, "\rProgressing(Rx:%d)", p_fileTrans->rxOffset);
     }
     else if (p_fileTrans->txOffset)
     {
-        printf("\rProgressing(Tx:%d)", p_fileTrans->txOffset);
+        APP_LOG_Post(APP_LOG_TYPE_RAW, "\rProgressing(Tx:%d)", p_fileTrans->txOffset);
     }
-
-
-    fflush(stdout);
 }
 
 static APP_FileTransList_T * app_GetFileTransList(DeviceProxy * p_devProxy)
@@ -279,49 +391,66 @@ static APP_FileTransList_T * app_GetFileTransList(DeviceProxy * p_devProxy)
     uint8_t i;
     APP_DBP_BtDev_T *p_Dev;
 
+    APP_FileTransList_T *p_fileTrans;
+
     if (p_devProxy == NULL)
         return NULL;
     
-    for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
-    {
-        if (s_appFileTransList[i].p_deviceProxy == p_devProxy)
-            return &s_appFileTransList[i];
-    }
+    p_fileTrans = g_hash_table_lookup(sp_appFileTransByProxy, p_devProxy);
+    if (p_fileTrans != NULL)
+        return p_fileTrans;
 
     p_Dev = APP_DBP_GetDevInfoByProxy(p_devProxy);
     if (p_Dev == NULL || p_Dev->isConnected == false)
         return NULL;
 
     //allocate free one if not found
-    for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
-    {
-        if (s_appFileTransList[i].p_deviceProxy == NULL)
-        {
-            s_appFileTransList[i].p_deviceProxy = p_devProxy;
-            s_appFileTransList[i].p_lbTimer = g_timer_new();
-            return &s_appFileTransList[i];
-        }
-    }
+    i = s_appFileTransFreeHead;
+    if (i >= BLE_GAP_MAX_LINK_NBR)
+        return NULL;
 
-    return NULL;
+    s_appFileTransFreeHead = sp_appFileTransFreeNext[i];
+    sp_appFileTransList[i].p_deviceProxy = p_devProxy;
+    sp_appFileTransList[i].p_lbTimer = g_timer_new();
+    g_hash_table_insert(sp_appFileTransByProxy, p_devProxy, &sp_appFileTransList[i]);
+
+    return &sp_appFileTransList[i];
 }
 
 static void app_FreeFileTransList(DeviceProxy * p_devProxy)
 {
+    APP_FileTransList_T *p_fileTrans;
     uint8_t i;
     
-    for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
+    p_fileTrans = g_hash_table_lookup(sp_appFileTransByProxy, p_devProxy);
+    if (p_fileTrans == NULL)
+        return;
+
+    g_hash_table_remove(sp_appFileTransByProxy, p_devProxy);
+    if (p_fileTrans->p_lbTimer)
     {
-        if (s_appFileTransList[i].p_deviceProxy == p_devProxy)
-        {
-            if (s_appFileTransList[i].p_lbTimer)
-            {
-                g_timer_destroy(s_appFileTransList[i].p_lbTimer);
-            }
-            memset(&s_appFileTransList[i], 0, sizeof(APP_FileTransList_T));
-            break;
-        }
+        g_timer_destroy(p_fileTrans->p_lbTimer);
     }
+    APP_MEM_Free(p_fileTrans->p_dataBuf);
+    memset(p_fileTrans, 0, sizeof(APP_FileTransList_T));
+
+    i = (uint8_t)(p_fileTrans - sp_appFileTransList);
+    sp_appFileTransFreeNext[i] = s_appFileTransFreeHead;
+    s_appFileTransFreeHead = i;
+}
+
+static void app_InitFileTransList(void)
+{
+    uint8_t i;
+
+    sp_appFileTransList = g_new0(APP_FileTransList_T, BLE_GAP_MAX_LINK_NBR);
+    sp_appFileTransFreeNext = g_new0(uint8_t, BLE_GAP_MAX_LINK_NBR);
+    sp_appFileTransByProxy = g_hash_table_new(g_direct_hash, g_direct_equal);
+    sp_appRawDataResumeRec = g_new0(APP_RawDataResumeRec_T, BLE_GAP_MAX_LINK_NBR);
+
+    for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
+        sp_appFileTransFreeNext[i] = i + 1;
+    s_appFileTransFreeHead = 0;
 }
 
 
@@ -377,7 +506,8 @@ static void app_OpenRawDataByChunk(APP_FileTransList_T * p_fileTrans, const char
 
     if (p_fileTrans->p_dataBuf)
     {
-        free(p_fileTrans->p_dataBuf);
+        APP_MEM_Free(p_fileTrans->p_dataBuf);
+        p_fileTrans->p_dataBuf = NULL;
     }
     
     fd = open(p_filePath, O_RDONLY);
@@ -394,7 +524,7 @@ static void app_OpenRawDataByChunk(APP_FileTransList_T * p_fileTrans, const char
 
     p_fileTrans->rawDataSize = st.st_size;
     p_fileTrans->p_rawDataFileName = strdup(p_filePath);
-    p_fileTrans->p_dataBuf = malloc(chunkSize);
+    p_fileTrans->p_dataBuf = APP_MEM_Alloc(APP_GetFileTransIndex(p_fileTrans->p_deviceProxy), APP_MEM_CAT_RAW_DATA_BUF, chunkSize);
     if (!p_fileTrans->p_dataBuf) {
         fprintf(stderr, "Failed to allocate file buffer\n");
         close(fd);
@@ -426,7 +556,7 @@ static void app_OpenRawDataByChunk(APP_FileTransList_T * p_fileTrans, const char
 }
 
 
-static bool app_LoadRawDataNextChunk(APP_FileTransList_T * p_fileTrans)
+static bool app_LoadRawDataChunk(APP_FileTransList_T * p_fileTrans, unsigned int chunkIndex)
 {
     ssize_t len;
     int fd;
@@ -435,7 +565,7 @@ static bool app_LoadRawDataNextChunk(APP_FileTransList_T * p_fileTrans)
 
     if (p_fileTrans->p_dataBuf == NULL)
         return false;
-    if ((p_fileTrans->rwChunkIndex+1) == p_fileTrans->chunkNumber)
+    if (chunkIndex >= p_fileTrans->chunkNumber)
     {
         fprintf(stderr, "Failed to change chunk: last chunk\n");
         return false;
@@ -447,7 +577,7 @@ static bool app_LoadRawDataNextChunk(APP_FileTransList_T * p_fileTrans)
         return false;
     }
 
-    offset = p_fileTrans->chunkSize*(p_fileTrans->rwChunkIndex+1);
+    offset = p_fileTrans->chunkSize*chunkIndex;
     
     if (lseek(fd, offset, SEEK_SET) >= 0)
     {
@@ -463,7 +593,7 @@ static bool app_LoadRawDataNextChunk(APP_FileTransList_T * p_fileTrans)
             close(fd);
             return false;
         }
-        p_fileTrans->rwChunkIndex++;
+        p_fileTrans->rwChunkIndex = chunkIndex;
     }
     else
     {
@@ -475,199 +605,464 @@ static bool app_LoadRawDataNextChunk(APP_FileTransList_T * p_fileTrans)
     return true;
 }
 
-void app_SaveRawDataByChunk(DeviceProxy * p_devProxy, bool rxFinish) {
+static bool app_LoadRawDataNextChunk(APP_FileTransList_T * p_fileTrans)
+{
+    return app_LoadRawDataChunk(p_fileTrans, p_fileTrans->rwChunkIndex + 1);
+}
+
+static uint32_t app_Crc32(uint32_t crc, const uint8_t * p_data, size_t len)
+{
+    uint8_t i;
+
+    crc = ~crc;
+    while (len--)
+    {
+        crc ^= *p_data++;
+        for (i = 0; i < 8; i++)
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+
+    return ~crc;
+}
+
+static bool app_RawDataFileCrc(const char * p_filePath, uint32_t * p_crc, unsigned int * p_size)
+{
+    uint8_t *p_buf;
+    ssize_t len;
     int fd;
-    int wsize;
-    int devIdx = 1000;
-    int oFlag = 0;
-    APP_DBP_BtDev_T *p_dev;
-    APP_FileTransList_T * p_fileTrans;
+
+    fd = open(p_filePath, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    p_buf = malloc(RAW_DATA_BUFFER_SIZE);
+    if (p_buf == NULL)
+    {
+        close(fd);
+        return false;
+    }
+
+    *p_crc = 0;
+    *p_size = 0;
+    while ((len = read(fd, p_buf, RAW_DATA_BUFFER_SIZE)) > 0)
+    {
+        *p_crc = app_Crc32(*p_crc, p_buf, len);
+        *p_size += len;
+    }
+
+    free(p_buf);
+    close(fd);
+
+    return (len == 0);
+}
+
+static APP_RawDataResumeRec_T * app_RawDataFindResumeRec(uint32_t fileId, unsigned int fileSize, const char * p_fileName)
+{
+    uint8_t i;
+
+    for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
+    {
+        if (sp_appRawDataResumeRec[i].p_fileName != NULL && sp_appRawDataResumeRec[i].fileId == fileId
+            && sp_appRawDataResumeRec[i].fileSize == fileSize && strcmp(sp_appRawDataResumeRec[i].p_fileName, p_fileName) == 0)
+        {
+            return &sp_appRawDataResumeRec[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void app_RawDataDropResumeRec(const char * p_fileName)
+{
+    uint8_t i;
+
+    for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
+    {
+        if (sp_appRawDataResumeRec[i].p_fileName != NULL && strcmp(sp_appRawDataResumeRec[i].p_fileName, p_fileName) == 0)
+        {
+            free(sp_appRawDataResumeRec[i].p_fileName);
+            memset(&sp_appRawDataResumeRec[i], 0, sizeof(APP_RawDataResumeRec_T));
+        }
+    }
+}
+
+static void app_RawDataKeepResumeRec(APP_FileTransList_T * p_fileTrans)
+{
+    uint8_t i;
+
+    app_RawDataDropResumeRec(p_fileTrans->p_rawDataFileName);
+
+    for (i = 0; i < BLE_GAP_MAX_LINK_NBR; i++)
+    {
+        if (sp_appRawDataResumeRec[i].p_fileName == NULL)
+        {
+            sp_appRawDataResumeRec[i].fileId = p_fileTrans->fileId;
+            sp_appRawDataResumeRec[i].fileSize = p_fileTrans->fileSize;
+            sp_appRawDataResumeRec[i].p_fileName = strdup(p_fileTrans->p_rawDataFileName);
+            bt_shell_printf("%s is incomplete(%d/%d bytes), receive it again with rxf to resume.\n",
+                p_fileTrans->p_rawDataFileName, p_fileTrans->rxOffset, p_fileTrans->fileSize);
+            return;
+        }
+    }
+}
+
+// Reload the partial file to resume from. The last chunk on disk goes back to the buffer so that
+// the chunk saving goes on as if the transfer was never interrupted.
+static unsigned int app_RawDataRestoreRx(APP_FileTransList_T * p_fileTrans)
+{
     struct stat st;
-    char diffCmd[512];
-    char rmDiffResultCmd[256];
-    char diffResultFileName[128];
+    unsigned int offset, base;
+    int fd;
 
+    fd = open(p_fileTrans->p_rawDataFileName, O_RDWR);
+    if (fd < 0)
+        return 0;
 
-    p_fileTrans = app_GetFileTransList(p_devProxy);
-    if(p_fileTrans == NULL)
+    if (fstat(fd, &st) < 0 || st.st_size == 0 || st.st_size > p_fileTrans->fileSize)
     {
-        printf("p_fileTrans is NULL\n");
-        return;
+        close(fd);
+        return 0;
     }
 
-    p_dev = APP_DBP_GetDevInfoByProxy(p_fileTrans->p_deviceProxy);
+    offset = st.st_size;
+    base = offset - ((offset % p_fileTrans->chunkSize) ? (offset % p_fileTrans->chunkSize) : p_fileTrans->chunkSize);
 
-    if (p_fileTrans->p_rawDataFileName == NULL)
+    if (pread(fd, p_fileTrans->p_dataBuf, offset - base, base) != (ssize_t)(offset - base) || ftruncate(fd, base) < 0)
     {
-        return;
+        fprintf(stderr, "Failed to restore output file: %s (%s)\n", p_fileTrans->p_rawDataFileName, strerror(errno));
+        close(fd);
+        return 0;
     }
 
-    if (!p_dev)
-        bt_shell_printf("<Text Mode> Received(%d bytes).\n", p_fileTrans->rxOffset);
-    else {
-        devIdx = p_dev->index;
-        bt_shell_printf("<Text Mode> Received(%d bytes) from[%s].\n", p_fileTrans->rxOffset, p_dev->p_address);
+    close(fd);
+
+    p_fileTrans->rxOffset = offset;
+    p_fileTrans->rwChunkIndex = base / p_fileTrans->chunkSize;
+
+    return offset;
+}
+
+static void app_RawDataTxStart(APP_FileTransList_T * p_fileTrans, unsigned int offset)
+{
+    p_fileTrans->resumeStage = APP_RAW_DATA_RESUME_IDLE;
+
+    if (offset > 0)
+    {
+        if (offset < p_fileTrans->rawDataSize
+            && !app_LoadRawDataChunk(p_fileTrans, offset / p_fileTrans->chunkSize))
+        {
+            return;
+        }
+
+        p_fileTrans->txOffset = offset;
+        bt_shell_printf("Resuming from %d of %d bytes.\n", offset, p_fileTrans->rawDataSize);
     }
 
-    if (p_fileTrans->rwChunkIndex == 0)
-        oFlag |= O_TRUNC | O_CREAT;
+    if (p_fileTrans->txOffset == p_fileTrans->rawDataSize)
+    {
+        bt_shell_printf("<Text Mode> The whole file(%d bytes) is already received by the peer.\n", p_fileTrans->rawDataSize);
+        return;
+    }
+
+    APP_TIMER_SetTimer(APP_TIMER_RAW_DATA_FETCH, APP_GetFileTransIndex(p_fileTrans->p_deviceProxy),
+        p_fileTrans->p_deviceProxy, APP_TIMER_1MS);
+}
+
+static bool app_DiffWithPattern(const char * p_fileName, const char * p_resultPrefix, int devIdx, unsigned int patternIndex)
+{
+    struct stat st;
+    char diffCmd[512];
+    char rmDiffResultCmd[256];
+    char diffResultFileName[128];
+
+
+    sprintf(diffResultFileName, "%s%d", p_resultPrefix, devIdx);
+    sprintf(diffCmd, "diff %s %s > %s", p_fileName, s_appPatternFile[patternIndex], diffResultFileName);
+    sprintf(rmDiffResultCmd, "rm -rf %s", diffResultFileName);
+
+    system(rmDiffResultCmd);
+    system(diffCmd);
+
+    return (stat(diffResultFileName, &st) == 0 && st.st_size == 0);
+}
+
+//Data plane worker side, no shell output and no access to the transfer list.
+static void app_RawDataSaveWork(void * p_data)
+{
+    APP_RawDataSaveJob_T * p_job = (APP_RawDataSaveJob_T *)p_data;
+    int fd;
+    int oFlag = O_RDWR;
+
 
-    oFlag |= O_RDWR;
+    if (p_job->truncate)
+        oFlag |= O_TRUNC | O_CREAT;
 
     umask(0);
 
-    fd = open(p_fileTrans->p_rawDataFileName, oFlag, 0755);
+    fd = open(p_job->p_fileName, oFlag, 0755);
     if (fd < 0) {
-        fprintf(stderr, "Failed to open output file: %s (%s)\n", p_fileTrans->p_rawDataFileName, strerror(errno));
+        p_job->fileErr = APP_FILE_ERR_OPEN;
+        p_job->fileErrno = errno;
         return;
     }
     
-    if (p_fileTrans->rwChunkIndex > 0)
+    if (!p_job->truncate)
     {
         if (lseek(fd, 0, SEEK_END) < 0) {
-            fprintf(stderr, "Failed to append output file(%d): %s [%s]\n", errno, p_fileTrans->p_rawDataFileName, strerror(errno));
+            p_job->fileErr = APP_FILE_ERR_APPEND;
+            p_job->fileErrno = errno;
+            close(fd);
             return;
         }
     }
 
-    
-    if (p_fileTrans->rxOffset % p_fileTrans->chunkSize > 0){
-        wsize = p_fileTrans->rxOffset % p_fileTrans->chunkSize;
-    }else{
-        wsize = p_fileTrans->chunkSize;
-    }
-    
-    if (write(fd, p_fileTrans->p_dataBuf, wsize) < 0) {
-        fprintf(stderr, "Failed to write output file: %s\n", p_fileTrans->p_rawDataFileName);
+    if (write(fd, p_job->p_dataBuf, p_job->wsize) < 0) {
+        p_job->fileErr = APP_FILE_ERR_WRITE;
         close(fd);
         return;
     }
 
-    p_fileTrans->rwChunkIndex++;
-    
     close(fd);
+    p_job->written = true;
 
-    if (rxFinish)
+    if (p_job->verify)
     {
-        if(s_patternFileIndex < APP_PATTERN_FILE_TYPE_MAX)
-        {
-            sprintf(diffResultFileName, "%s%d", RAWDATA_DIFF_RESULT, devIdx);
-            sprintf(diffCmd, "diff %s %s > %s", p_fileTrans->p_rawDataFileName, s_appPatternFile[s_patternFileIndex], diffResultFileName);
-            sprintf(rmDiffResultCmd, "rm -rf %s", diffResultFileName);
+        p_job->crcPassed = app_RawDataFileCrc(p_job->p_fileName, &p_job->crc, &p_job->crcSize)
+            && p_job->crcSize == p_job->fileSize && p_job->crc == p_job->fileId;
+    }
 
-            system(rmDiffResultCmd);
-            system(diffCmd);
-            
-            if (stat(diffResultFileName, &st) == 0)
-            {
-                if (st.st_size == 0) {
-                    bt_shell_printf("Raw data compare [%s] successfully.\n", s_appPatternTypeStr[s_patternFileIndex]);
-                } else {
-                    bt_shell_printf("Raw data compare [%s] failed.\n", s_appPatternTypeStr[s_patternFileIndex]);
-                }
-            } else {
-                bt_shell_printf("Raw data compare [%s] failed.\n", s_appPatternTypeStr[s_patternFileIndex]);
-            }
+    if (p_job->compare)
+        p_job->comparePassed = app_DiffWithPattern(p_job->p_fileName, RAWDATA_DIFF_RESULT, p_job->devIdx, p_job->patternIndex);
+}
+
+static void app_RawDataSaveDone(void * p_data)
+{
+    APP_RawDataSaveJob_T * p_job = (APP_RawDataSaveJob_T *)p_data;
+
+
+    if (p_job->fileErr == APP_FILE_ERR_OPEN)
+        fprintf(stderr, "Failed to open output file: %s (%s)\n", p_job->p_fileName, strerror(p_job->fileErrno));
+    else if (p_job->fileErr == APP_FILE_ERR_APPEND)
+        fprintf(stderr, "Failed to append output file(%d): %s [%s]\n", p_job->fileErrno, p_job->p_fileName, strerror(p_job->fileErrno));
+    else if (p_job->fileErr == APP_FILE_ERR_WRITE)
+        fprintf(stderr, "Failed to write output file: %s\n", p_job->p_fileName);
+
+    if (p_job->written && p_job->verify)
+    {
+        if (p_job->crcPassed)
+        {
+            bt_shell_printf("Raw data integrity check(%d bytes, crc32=%08x) successfully.\n", p_job->crcSize, p_job->crc);
         }
         else
         {
-            bt_shell_printf("No comparison due to no pattern selected.\n");
+            bt_shell_printf("Raw data integrity check failed, expected(%d bytes, crc32=%08x).\n",
+                p_job->fileSize, p_job->fileId);
         }
     }
-        
+
+    if (p_job->written && p_job->compare)
+    {
+        if (p_job->comparePassed) {
+            bt_shell_printf("Raw data compare [%s] successfully.\n", s_appPatternTypeStr[p_job->patternIndex]);
+        } else {
+            bt_shell_printf("Raw data compare [%s] failed.\n", s_appPatternTypeStr[p_job->patternIndex]);
+        }
+    }
+
+    if (p_job->ownBuf)
+        APP_MEM_Free(p_job->p_dataBuf);
+    free(p_job->p_fileName);
+    free(p_job);
 }
 
-gpointer app_SaveFileThread(gpointer data) {
-    int fd;
-    int wlen;
+//The full chunk is handed over to the data plane worker together with its buffer, the transfer
+//goes on receiving into a fresh buffer without waiting for the file system.
+void app_SaveRawDataByChunk(DeviceProxy * p_devProxy, bool rxFinish) {
     int devIdx = 1000;
-    struct stat st;
-    unsigned int overSize;
-    char fileNameFull[256];
-    char filenameSuffix[16];
-    char diffCmd[512];
-    char rmDiffResultCmd[256];
-    char diffResultFileName[128];
-    time_t now;
-    struct tm * p_timeStruct;
     APP_DBP_BtDev_T *p_dev;
     APP_FileTransList_T * p_fileTrans;
+    APP_RawDataSaveJob_T * p_job;
 
 
-    if(data == NULL)
+    p_fileTrans = app_GetFileTransList(p_devProxy);
+    if(p_fileTrans == NULL)
     {
-        bt_shell_printf("user data is NULL\n");
-        return NULL;
+        printf("p_fileTrans is NULL\n");
+        return;
     }
 
-    p_fileTrans = (APP_FileTransList_T * )data;
     p_dev = APP_DBP_GetDevInfoByProxy(p_fileTrans->p_deviceProxy);
 
-    now = time(0);
-    p_timeStruct = localtime(&now);
-    strftime(filenameSuffix, 16, "%Y%m%d_%H%M%S", p_timeStruct);
-    
-    if (!p_dev)
-        sprintf(fileNameFull, "Raw-%s", filenameSuffix);
-    else if (p_dev->p_name)
+    if (p_fileTrans->p_rawDataFileName == NULL)
     {
+        return;
+    }
+
+    APP_LOG_Flush();
+
+    if (!p_dev)
+        bt_shell_printf("<Text Mode> Received(%d bytes).\n", p_fileTrans->rxOffset);
+    else {
         devIdx = p_dev->index;
-        sprintf(fileNameFull, "%s-Raw-%s", p_dev->p_name, filenameSuffix);
+        bt_shell_printf("<Text Mode> Received(%d bytes) from[%s].\n", p_fileTrans->rxOffset, p_dev->p_address);
     }
-    else
+
+    p_job = calloc(1, sizeof(APP_RawDataSaveJob_T));
+    if (p_job == NULL)
     {
-        devIdx = p_dev->index;
-        sprintf(fileNameFull, "%s-Raw-%s", p_dev->p_address, filenameSuffix);
+        fprintf(stderr, "Failed to save output file: %s (out of memory)\n", p_fileTrans->p_rawDataFileName);
+        return;
     }
 
-    if (p_fileTrans->rxOffset > s_patternDataSize)
-        overSize = p_fileTrans->rxOffset - s_patternDataSize;
-    else
-        overSize = 0;
+    p_job->p_fileName = strdup(p_fileTrans->p_rawDataFileName);
+    p_job->truncate = (p_fileTrans->rwChunkIndex == 0);
+    p_job->devIdx = devIdx;
+    p_job->patternIndex = s_patternFileIndex;
+
+    if (p_fileTrans->rxOffset % p_fileTrans->chunkSize > 0){
+        p_job->wsize = p_fileTrans->rxOffset % p_fileTrans->chunkSize;
+    }else{
+        p_job->wsize = p_fileTrans->chunkSize;
+    }
+
+    p_fileTrans->rwChunkIndex++;
+
+    if (rxFinish && p_fileTrans->resumeStage == APP_RAW_DATA_RESUME_RX && p_fileTrans->rxOffset < p_fileTrans->fileSize)
+    {
+        app_RawDataKeepResumeRec(p_fileTrans);
+    }
+    else if (rxFinish)
+    {
+        if (p_fileTrans->resumeStage == APP_RAW_DATA_RESUME_RX)
+        {
+            app_RawDataDropResumeRec(p_fileTrans->p_rawDataFileName);
+            p_job->verify = true;
+            p_job->fileId = p_fileTrans->fileId;
+            p_job->fileSize = p_fileTrans->fileSize;
+        }
+
+        if(s_patternFileIndex < APP_PATTERN_FILE_TYPE_MAX)
+            p_job->compare = true;
+        else
+            bt_shell_printf("No comparison due to no pattern selected.\n");
+    }
+
+    p_job->p_dataBuf = p_fileTrans->p_dataBuf;
+    p_job->ownBuf = true;
+    p_fileTrans->p_dataBuf = APP_MEM_Alloc(APP_GetFileTransIndex(p_devProxy), APP_MEM_CAT_RAW_DATA_BUF, p_fileTrans->chunkSize);
+
+    if (p_job->p_fileName == NULL || p_fileTrans->p_dataBuf == NULL)
+    {
+        //Out of memory, save the chunk in place once the queued chunks are saved.
+        if (p_fileTrans->p_dataBuf == NULL)
+        {
+            p_fileTrans->p_dataBuf = p_job->p_dataBuf;
+            p_job->ownBuf = false;
+        }
+        if (p_job->p_fileName == NULL)
+            p_job->p_fileName = strdup(p_fileTrans->p_rawDataFileName);
+
+        APP_DP_Sync();
+        if (p_job->p_fileName != NULL)
+            app_RawDataSaveWork(p_job);
+        app_RawDataSaveDone(p_job);
+        return;
+    }
+
+    APP_DP_Submit(APP_GetFileTransIndex(p_devProxy), app_RawDataSaveWork, app_RawDataSaveDone, p_job);
+}
+
+static void app_LoopbackSaveWork(void * p_data)
+{
+    APP_LoopbackSaveJob_T * p_job = (APP_LoopbackSaveJob_T *)p_data;
+    int fd;
+    int wlen;
+
+
+    p_job->testStage = APP_TEST_FAILED;
+
+    //No receive buffer within the memory budget, nothing was received to compare
+    if (p_job->p_dataBuf == NULL)
+        return;
 
     //bt_shell_printf("Dump received data(%d/%d) to file=%s\n", p_fileTrans->rxOffset, s_patternDataSize, fileNameFull);
-    fd = open(fileNameFull, O_CREAT | O_RDWR, 0755);
+    fd = open(p_job->fileName, O_CREAT | O_RDWR, 0755);
     if (fd < 0) {
-        fprintf(stderr, "Failed to open dump pattern file\n");
-        return NULL;
+        p_job->fileErr = APP_FILE_ERR_OPEN;
+        return;
     }
 
-    wlen = write(fd, p_fileTrans->p_dataBuf, p_fileTrans->rxOffset - overSize);
+    wlen = write(fd, p_job->p_dataBuf, p_job->wsize);
     if (wlen < 0) {
-        fprintf(stderr, "Failed to dump pattern file\n");
+        p_job->fileErr = APP_FILE_ERR_WRITE;
         close(fd);
-        return NULL;
+        return;
     }
 
     close(fd);
 
+    if (app_DiffWithPattern(p_job->fileName, LOOPBACK_DIFF_RESULT, p_job->devIdx, p_job->patternIndex))
+        p_job->testStage = APP_TEST_PASSED;
+}
 
-    sprintf(diffResultFileName, "%s%d", LOOPBACK_DIFF_RESULT, devIdx);
-    sprintf(diffCmd, "diff %s %s > %s", fileNameFull, s_appPatternFile[s_patternFileIndex], diffResultFileName);
-    sprintf(rmDiffResultCmd, "rm -rf %s", diffResultFileName);
+static void app_LoopbackSaveDone(void * p_data)
+{
+    APP_LoopbackSaveJob_T * p_job = (APP_LoopbackSaveJob_T *)p_data;
+    APP_FileTransList_T * p_fileTrans = &sp_appFileTransList[p_job->transIndex];
 
-    system(rmDiffResultCmd);
-    system(diffCmd);
-    
-    if (stat(diffResultFileName, &st) == 0)
-    {
-        if (st.st_size == 0) {
-            p_fileTrans->testStage = APP_TEST_PASSED;
-        } else {
-            p_fileTrans->testStage = APP_TEST_FAILED;
-        }
-    } else {
-        p_fileTrans->testStage = APP_TEST_FAILED;
-    }
 
-    app_LoopbackFinishLog();
+    if (p_job->fileErr == APP_FILE_ERR_OPEN)
+        fprintf(stderr, "Failed to open dump pattern file\n");
+    else if (p_job->fileErr == APP_FILE_ERR_WRITE)
+        fprintf(stderr, "Failed to dump pattern file\n");
+
+    //The link is gone or a new run cleared the record while the job was queued
+    if (p_fileTrans->p_deviceProxy != NULL && p_fileTrans->runId == p_job->runId)
+        p_fileTrans->testStage = p_job->testStage;
+
+    APP_MEM_Free(p_job->p_dataBuf);
+    free(p_job);
+
+    app_LoopbackFinishLog();
+}
+
+//Rx stall watchdog. It is armed by the first packet and armed again on expiry only while data keeps coming,
+//a transfer of known length is finished by its last byte.
+static void app_RxWatchdogStart(APP_FileTransList_T * p_fileTrans, APP_TIMER_TimerId_T tmrId)
+{
+    if (p_fileTrans->rxWatchdog)
+        return;
+
+    p_fileTrans->rxWatchdog = true;
+    p_fileTrans->rxCheckOffset = p_fileTrans->rxOffset;
+    APP_TIMER_SetTimer(tmrId, APP_GetFileTransIndex(p_fileTrans->p_deviceProxy), (void *)p_fileTrans->p_deviceProxy, APP_TIMER_3S);
+}
+
+static void app_RxWatchdogStop(APP_FileTransList_T * p_fileTrans, APP_TIMER_TimerId_T tmrId)
+{
+    p_fileTrans->rxWatchdog = false;
+    APP_TIMER_StopTimer(tmrId, APP_GetFileTransIndex(p_fileTrans->p_deviceProxy));
+}
+
+static bool app_RxWatchdogStalled(APP_FileTransList_T * p_fileTrans, APP_TIMER_TimerId_T tmrId)
+{
+    p_fileTrans->rxWatchdog = false;
 
-    return NULL;
+    if (p_fileTrans->rxOffset == p_fileTrans->rxCheckOffset)
+        return true;
+
+    app_RxWatchdogStart(p_fileTrans, tmrId);
+    return false;
 }
 
 static void app_SaveLoopbackDataToFile(DeviceProxy * p_devProxy)
 {
+    char filenameSuffix[16];
+    time_t now;
+    struct tm * p_timeStruct;
+    APP_DBP_BtDev_T *p_dev;
     APP_FileTransList_T * p_fileTrans;
+    APP_LoopbackSaveJob_T * p_job;
 
     p_fileTrans = app_GetFileTransList(p_devProxy);
     if(p_fileTrans == NULL)
@@ -676,14 +1071,55 @@ static void app_SaveLoopbackDataToFile(DeviceProxy * p_devProxy)
         return;
     }
 
+    //The receive buffer of the run is handed over once
+    if (p_fileTrans->lbSaving)
+        return;
+
     if (p_fileTrans->p_lbTimer)
         g_timer_stop(p_fileTrans->p_lbTimer);
 
-    if (sp_prevThread)
-        g_thread_unref(sp_prevThread);
+    p_job = calloc(1, sizeof(APP_LoopbackSaveJob_T));
+    if (p_job == NULL)
+    {
+        fprintf(stderr, "Failed to dump pattern file (out of memory)\n");
+        return;
+    }
+
+    p_job->transIndex = APP_GetFileTransIndex(p_devProxy);
+    p_job->runId = p_fileTrans->runId;
+    p_job->devIdx = 1000;
+    p_job->patternIndex = s_patternFileIndex;
+
+    p_dev = APP_DBP_GetDevInfoByProxy(p_fileTrans->p_deviceProxy);
+
+    now = time(0);
+    p_timeStruct = localtime(&now);
+    strftime(filenameSuffix, 16, "%Y%m%d_%H%M%S", p_timeStruct);
     
-    sp_currThread = g_thread_new("lpthread", app_SaveFileThread, p_fileTrans);
-    sp_prevThread = sp_currThread;
+    if (!p_dev)
+        sprintf(p_job->fileName, "Raw-%s", filenameSuffix);
+    else if (p_dev->p_name)
+    {
+        p_job->devIdx = p_dev->index;
+        sprintf(p_job->fileName, "%s-Raw-%s", p_dev->p_name, filenameSuffix);
+    }
+    else
+    {
+        p_job->devIdx = p_dev->index;
+        sprintf(p_job->fileName, "%s-Raw-%s", p_dev->p_address, filenameSuffix);
+    }
+
+    if (p_fileTrans->rxOffset > s_patternDataSize)
+        p_job->wsize = s_patternDataSize;
+    else
+        p_job->wsize = p_fileTrans->rxOffset;
+
+    //The data received after the hand over is dropped by app_SaveLoopbackDataToRam()
+    p_job->p_dataBuf = p_fileTrans->p_dataBuf;
+    p_fileTrans->p_dataBuf = NULL;
+    p_fileTrans->lbSaving = true;
+
+    APP_DP_Submit(p_job->transIndex, app_LoopbackSaveWork, app_LoopbackSaveDone, p_job);
 }
 
 
@@ -697,6 +1133,11 @@ static void app_SaveLoopbackDataToRam(DeviceProxy * p_devProxy, const unsigned c
         printf("p_fileTrans is NULL\n");
         return;
     }
+
+    //No receive buffer within the memory budget, the data is dropped and the compare fails.
+    //The buffer is also gone once it is handed over to be saved.
+    if (p_fileTrans->p_dataBuf == NULL)
+        return;
         
     if (len)
     {
@@ -712,7 +1153,7 @@ static void app_SaveLoopbackDataToRam(DeviceProxy * p_devProxy, const unsigned c
         uint8_t transIndex = APP_GetFileTransIndex(p_devProxy);
 
         APP_TIMER_StopTimer(APP_TIMER_FILE_FETCH, transIndex);
-        APP_TIMER_StopTimer(APP_TIMER_LOOPBACK_RX_CHECK, transIndex);
+        app_RxWatchdogStop(p_fileTrans, APP_TIMER_LOOPBACK_RX_CHECK);
 
         app_SaveLoopbackDataToFile(p_devProxy);
     }
@@ -807,6 +1248,10 @@ static uint16_t app_GetPatternDataLength(APP_FileTransList_T * p_fileTrans)
     copyLen = p_fileTrans->attMtu - ATT_WRITE_HEADER_SIZE - ATT_MULTI_EVENT_NOTIFY_SINGLE_VALUE_PAIR;
 #endif
 
+    //TRCBP sends one SDU per packet
+    if (p_trpConn->type == APP_TRP_TYPE_TRCBP)
+        copyLen = p_trpConn->p_cold->fixPattTrcbpMtu;
+
     if (s_patternDataSize - p_fileTrans->txOffset < copyLen)
     {
         copyLen = s_patternDataSize - p_fileTrans->txOffset;
@@ -843,9 +1288,13 @@ static uint16_t app_GetFileDataLength(APP_FileTransList_T * p_fileTrans)
     copyLen = p_fileTrans->attMtu - ATT_WRITE_HEADER_SIZE - ATT_MULTI_EVENT_NOTIFY_SINGLE_VALUE_PAIR;
 #endif
 
-    if (p_fileTrans->rawDataSize - p_fileTrans->txOffset < copyLen)
+    //TRCBP sends one SDU per packet
+    if (p_trpConn->type == APP_TRP_TYPE_TRCBP)
+        copyLen = p_trpConn->p_cold->fixPattTrcbpMtu;
+
+    if (p_fileTrans->rawDataSize - p_fileTrans->txOffset + APP_TRP_COMMON_GetCompressPending(p_trpConn) < copyLen)
     {
-        copyLen = p_fileTrans->rawDataSize - p_fileTrans->txOffset;
+        copyLen = p_fileTrans->rawDataSize - p_fileTrans->txOffset + APP_TRP_COMMON_GetCompressPending(p_trpConn);
     }
 
     return copyLen;
@@ -853,126 +1302,6 @@ static uint16_t app_GetFileDataLength(APP_FileTransList_T * p_fileTrans)
 
 
 
-#ifdef ENABLE_DATA_BUFFER_OVERFLOW_MONITOR
-#define HCI_MAX_EVENT_SIZE  260
-
-static void app_PollEvt(int fd)
-{
-    unsigned char buf[HCI_MAX_EVENT_SIZE];
-    unsigned char control[64];
-    struct msghdr msg;
-    struct iovec iov;
-    int to = 1000;
-
-    iov.iov_base = buf;
-    iov.iov_len = sizeof(buf);
-
-    memset(&msg, 0, sizeof(msg));
-    msg.msg_iov = &iov;
-    msg.msg_iovlen = 1;
-    msg.msg_control = control;
-    msg.msg_controllen = sizeof(control);
-
-    while (1) {
-        ssize_t len;
-
-        if (to) {
-            struct pollfd p;
-            int n;
-
-            p.fd = fd; p.events = POLLIN;
-            while ((n = poll(&p, 1, to)) < 0) {
-                if (errno == EAGAIN || errno == EINTR)
-                    continue;
-            }
-
-            if (!n) {
-                errno = ETIMEDOUT;
-                continue;
-            }
-
-            to -= 10;
-            if (to < 0)
-                to = 0;
-        }
-
-        len = recvmsg(fd, &msg, MSG_DONTWAIT);
-        if (len < 0)
-            continue;
-
-
-        switch (buf[0]) {
-        case HCI_EVENT_PKT:
-            APP_TIMER_SetTimer(APP_TIMER_DATA_BUFFER_OVERFLOW_EVT, 0, NULL, APP_TIMER_1MS);
-            break;
-        }
-    }
-}
-
-
-static int app_OpenHciDev(uint16_t index)
-{
-    struct sockaddr_hci addr;
-    struct hci_filter flt;
-    int fd;
-
-    fd = socket(AF_BLUETOOTH, SOCK_RAW | SOCK_CLOEXEC, BTPROTO_HCI);
-    if (fd < 0) {
-        perror("Failed to open channel");
-        return -1;
-    }
-
-    /* Setup filter */
-    hci_filter_clear(&flt);
-    hci_filter_set_ptype(HCI_EVENT_PKT,  &flt);
-    //hci_filter_set_event(EVT_NUM_COMP_PKTS, &flt);
-    hci_filter_set_event(EVT_DATA_BUFFER_OVERFLOW, &flt);
-
-    if (setsockopt(fd, SOL_HCI, HCI_FILTER, &flt, sizeof(flt)) < 0) {
-        perror("Failed to set HCI filter");
-        close(fd);
-        return -1;
-    }
-
-
-    memset(&addr, 0, sizeof(addr));
-    addr.hci_family = AF_BLUETOOTH;
-    addr.hci_dev = index;
-    addr.hci_channel = HCI_CHANNEL_RAW;
-    
-    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
-        perror("Failed to bind channel");
-        close(fd);
-        return -1;
-    }
-
-    return fd;
-}
-
-
-gpointer app_HciEvtMonitorThread(gpointer data)
-{
-    int fd;
-
-    fd = app_OpenHciDev(0);
-    if (fd < 0) {
-        printf("open_hci_dev fail, create HciEvtMonitorThread failed\n");
-        return NULL;
-    }
-
-    app_PollEvt(fd);
-
-    return NULL;
-}
-
-
-static void app_HciEvtMonitor(void)
-{
-    g_thread_new("hciMonthread", app_HciEvtMonitorThread, NULL);
-}
-#endif
-
-
 uint16_t APP_FileRead(DeviceProxy * p_devProxy, uint8_t *p_buffer, uint16_t len)
 {
     uint16_t copyLen;
@@ -1065,9 +1394,13 @@ uint16_t APP_ConsoleRead(DeviceProxy * p_devProxy, uint8_t *p_buffer, uint16_t l
     if (p_fileTrans->txOffset == p_fileTrans->rawDataSize)
     {
         if (p_trpConn->trpRole == APP_TRP_SERVER_ROLE)
-            bt_shell_printf("<Text Mode> Notify(%d bytes) to all clients successed\n", p_fileTrans->rawDataSize);
+        {
+            APP_LOG_SHELL("<Text Mode> Notify(%d bytes) to all clients successed\n", p_fileTrans->rawDataSize);
+        }
         else if (p_trpConn->trpRole == APP_TRP_CLIENT_ROLE && p_dev != NULL)
-            bt_shell_printf("<Text Mode> Sent(%d bytes) to peer[%s] successed\n", p_fileTrans->rawDataSize, p_dev->p_address);
+        {
+            APP_LOG_SHELL("<Text Mode> Sent(%d bytes) to peer[%s] successed\n", p_fileTrans->rawDataSize, p_dev->p_address);
+        }
     }
 
     if(changeChunk)
@@ -1086,32 +1419,56 @@ uint16_t APP_ConsoleRead(DeviceProxy * p_devProxy, uint8_t *p_buffer, uint16_t l
 
 void APP_FileWriteTimeout(void *p_param)
 {
-    uint8_t transIndex;
     DeviceProxy  *p_devProxy = (DeviceProxy *)p_param;
+    APP_FileTransList_T * p_fileTrans;
 
-    transIndex = APP_GetFileTransIndex(p_devProxy);
+    p_fileTrans = app_GetFileTransList(p_devProxy);
+    if (p_fileTrans == NULL || !app_RxWatchdogStalled(p_fileTrans, APP_TIMER_LOOPBACK_RX_CHECK))
+        return;
 
-    APP_TIMER_StopTimer(APP_TIMER_FILE_FETCH, transIndex);
-    APP_TIMER_StopTimer(APP_TIMER_LOOPBACK_RX_CHECK, transIndex);
+    bt_shell_printf("Loopback Rx timeout\n");
+    APP_TIMER_StopTimer(APP_TIMER_FILE_FETCH, APP_GetFileTransIndex(p_devProxy));
         
     app_SaveLoopbackDataToFile(p_devProxy);
 }
 
+static void app_RawDataRxFinish(DeviceProxy * p_devProxy)
+{
+    APP_FileTransList_T * p_fileTrans = app_GetFileTransList(p_devProxy);
+
+    app_RxWatchdogStop(p_fileTrans, APP_TIMER_RAW_DATA_RX_CHECK);
+    bt_shell_printf("\nRaw Data Rx finished\n");
+    app_SaveRawDataByChunk(p_devProxy, true);
+    app_ClearFileTransRecord(p_fileTrans, RAW_DATA_BUFFER_SIZE, APP_MEM_CAT_RAW_DATA_BUF);
+}
+
 void APP_RawDataFileWriteTimeout(void *p_param)
 {
-    app_SaveRawDataByChunk((DeviceProxy *)p_param, true);
-    app_ClearFileTransRecord(app_GetFileTransList((DeviceProxy *)p_param), RAW_DATA_BUFFER_SIZE);
+    DeviceProxy  *p_devProxy = (DeviceProxy *)p_param;
+    APP_FileTransList_T * p_fileTrans;
+
+    p_fileTrans = app_GetFileTransList(p_devProxy);
+    if (p_fileTrans == NULL)
+        return;
+
+    //A file of announced size ends with its last byte, otherwise the end of the data is only known by its silence
+    if ((p_fileTrans->resumeStage != APP_RAW_DATA_RESUME_RX || p_fileTrans->rxOffset < p_fileTrans->fileSize)
+        && !app_RxWatchdogStalled(p_fileTrans, APP_TIMER_RAW_DATA_RX_CHECK))
+        return;
+
+    if (p_fileTrans->resumeStage == APP_RAW_DATA_RESUME_RX && p_fileTrans->rxOffset < p_fileTrans->fileSize)
+        bt_shell_printf("\nRaw Data Rx stalled(%d/%d bytes)\n", p_fileTrans->rxOffset, p_fileTrans->fileSize);
+
+    app_RawDataRxFinish(p_devProxy);
 }
 
 uint16_t APP_FileWrite(DeviceProxy * p_devProxy, uint16_t length, uint8_t *p_buffer)
 {
     APP_FileTransList_T * p_fileTrans;
     APP_TRP_ConnList_T * p_trpConn;
-    uint8_t transIndex;
 
     p_fileTrans = app_GetFileTransList(p_devProxy);
     p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy(p_devProxy);
-    transIndex = APP_GetFileTransIndex(p_devProxy);
 
     if(p_fileTrans == NULL)
     {
@@ -1127,7 +1484,7 @@ uint16_t APP_FileWrite(DeviceProxy * p_devProxy, uint16_t length, uint8_t *p_buf
     }
     else if (s_bleWorkMode == TRP_WMODE_LOOPBACK)
     {
-        APP_TIMER_SetTimer(APP_TIMER_LOOPBACK_RX_CHECK, transIndex, (void*)p_devProxy, APP_TIMER_3S);
+        app_RxWatchdogStart(p_fileTrans, APP_TIMER_LOOPBACK_RX_CHECK);
         app_SaveLoopbackDataToRam(p_devProxy, p_buffer, length);
         return APP_RES_SUCCESS;
     }
@@ -1144,11 +1501,9 @@ uint16_t APP_ConsoleWrite(DeviceProxy * p_devProxy, uint16_t length, uint8_t *p_
     APP_FileTransList_T * p_fileTrans;
     APP_TRP_ConnList_T * p_trpConn;
     APP_DBP_BtDev_T * p_dev;
-    uint8_t transIndex;
 
     p_fileTrans = app_GetFileTransList(p_devProxy);
     p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy(p_devProxy);
-    transIndex = APP_GetFileTransIndex(p_devProxy);
 
     if(p_fileTrans == NULL)
     {
@@ -1164,8 +1519,11 @@ uint16_t APP_ConsoleWrite(DeviceProxy * p_devProxy, uint16_t length, uint8_t *p_
     }
     else if (s_bleWorkMode == TRP_WMODE_UART && p_fileTrans->p_rawDataFileName != NULL)
     {
-        APP_TIMER_SetTimer(APP_TIMER_RAW_DATA_RX_CHECK, transIndex, (void*)p_devProxy, APP_TIMER_3S);
+        app_RxWatchdogStart(p_fileTrans, APP_TIMER_RAW_DATA_RX_CHECK);
         app_SaveRawDataToRam(p_devProxy, p_buffer, length);
+
+        if (p_fileTrans->resumeStage == APP_RAW_DATA_RESUME_RX && p_fileTrans->rxOffset >= p_fileTrans->fileSize)
+            app_RawDataRxFinish(p_devProxy);
         
         return APP_RES_SUCCESS;
     }
@@ -1238,6 +1596,10 @@ void APP_FetchTxDataFromRawDataFile(DeviceProxy *p_deviceProxy)
         printf("p_fileTrans is NULL\n");
         return;
     }
+
+    //Hold the file until the receiver answers with the offset to resume from
+    if (p_fileTrans->resumeStage == APP_RAW_DATA_RESUME_TX_WAIT)
+        return;
     
     dataLeng = app_GetFileDataLength(p_fileTrans);
 
@@ -1259,9 +1621,9 @@ void APP_FetchTxDataAll(void)
     
     for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
     {
-        if (s_appFileTransList[i].p_deviceProxy != NULL)
+        if (sp_appFileTransList[i].p_deviceProxy != NULL)
         {
-            APP_TIMER_SetTimer(APP_TIMER_FILE_FETCH, i, (void*)s_appFileTransList[i].p_deviceProxy, APP_TIMER_50MS*i);
+            APP_TIMER_SetTimer(APP_TIMER_FILE_FETCH, i, (void*)sp_appFileTransList[i].p_deviceProxy, APP_TIMER_50MS*i);
         }
     }
 }
@@ -1273,7 +1635,7 @@ void APP_PreparePatternData(uint8_t patternFileType)
     s_patternFileIndex = patternFileType;
 }
 
-static void app_ClearFileTransRecord(APP_FileTransList_T        * p_fileTrans, uint32_t rxDataSize)
+static void app_ClearFileTransRecord(APP_FileTransList_T        * p_fileTrans, uint32_t rxDataSize, APP_MEM_Cat_T memCat)
 {
     APP_DBP_BtDev_T * p_dev;
 
@@ -1294,9 +1656,16 @@ static void app_ClearFileTransRecord(APP_FileTransList_T        * p_fileTrans, u
     p_fileTrans->rwChunkIndex = 0;
 
     p_fileTrans->testStage = APP_TEST_IDLE;
+    p_fileTrans->resumeStage = APP_RAW_DATA_RESUME_IDLE;
+    p_fileTrans->fileId = 0;
+    p_fileTrans->fileSize = 0;
+    p_fileTrans->rxWatchdog = false;
+    p_fileTrans->runId = ++s_appFileTransRunId;
+    p_fileTrans->lbSaving = false;
+    APP_LOG_ThrottleReset(&p_fileTrans->progressThrottle);
     if (p_fileTrans->p_dataBuf)
     {
-        free(p_fileTrans->p_dataBuf);
+        APP_MEM_Free(p_fileTrans->p_dataBuf);
     }
     if (p_fileTrans->p_lbTimer)
     {
@@ -1304,7 +1673,7 @@ static void app_ClearFileTransRecord(APP_FileTransList_T        * p_fileTrans, u
     }
 
     if (rxDataSize)
-        p_fileTrans->p_dataBuf = malloc(rxDataSize);
+        p_fileTrans->p_dataBuf = APP_MEM_Alloc(APP_GetFileTransIndex(p_fileTrans->p_deviceProxy), memCat, rxDataSize);
     else
         p_fileTrans->p_dataBuf = NULL;
 }
@@ -1332,9 +1701,9 @@ void APP_LoopbackStart(uint8_t devIndex)
 
     for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
     {
-        if (s_appFileTransList[i].p_deviceProxy != NULL)
+        if (sp_appFileTransList[i].p_deviceProxy != NULL)
         {
-            app_ClearFileTransRecord(&s_appFileTransList[i], s_patternDataSize);
+            app_ClearFileTransRecord(&sp_appFileTransList[i], s_patternDataSize, APP_MEM_CAT_LOOPBACK_BUF);
         }
     }
 
@@ -1403,14 +1772,14 @@ void APP_BurstModeStartAll(void)
 
     for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
     {
-        if (s_appFileTransList[i].p_deviceProxy != NULL)
+        if (sp_appFileTransList[i].p_deviceProxy != NULL)
         {
             if (s_bleWorkMode == TRP_WMODE_LOOPBACK)
             {
-                app_ClearFileTransRecord(&s_appFileTransList[i], s_patternDataSize);
+                app_ClearFileTransRecord(&sp_appFileTransList[i], s_patternDataSize, APP_MEM_CAT_LOOPBACK_BUF);
             }
                 
-            p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy(s_appFileTransList[i].p_deviceProxy);
+            p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy(sp_appFileTransList[i].p_deviceProxy);
             APP_TRPC_TransmitModeSwitch(s_bleWorkMode, p_trpConn);
 #ifdef ENABLE_AUTO_RUN
             s_joinLinks++;
@@ -1428,7 +1797,7 @@ void APP_BurstModeStartAll(void)
 
 void APP_SetWorkMode(uint8_t mode)
 {
-    if (mode >= TRP_WMODE_CHECK_SUM && mode <= TRP_WMODE_UART)
+    if (mode >= TRP_WMODE_CHECK_SUM && mode <= TRP_WMODE_DUPLEX)
         s_bleWorkMode = mode;
 
     bt_shell_printf("set work mode = %s mode\n", s_appWorkModeDesc[s_bleWorkMode]);
@@ -1447,6 +1816,10 @@ bool APP_ConfirmWorkMode(DeviceProxy *p_devProxy)
     if (p_trpConn == NULL)
         return false;
 
+    //Hold the data until the compression being negotiated is in use or declined
+    if ((p_trpConn->p_cold->p_compress != NULL) && (!p_trpConn->p_cold->p_compress->txEn))
+        return false;
+
     return (s_bleWorkMode == p_trpConn->workMode);
 }
 
@@ -1457,10 +1830,10 @@ bool APP_ConfirmWorkModeAll(void)
     
     for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
     {
-        if (s_appFileTransList[i].p_deviceProxy != NULL)
+        if (sp_appFileTransList[i].p_deviceProxy != NULL)
         {
 
-            p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy(s_appFileTransList[i].p_deviceProxy);
+            p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy(sp_appFileTransList[i].p_deviceProxy);
             if (p_trpConn == NULL || 
                 s_bleWorkMode != p_trpConn->workMode)
             {
@@ -1478,6 +1851,8 @@ void APP_DeviceDisconnected(DeviceProxy * p_devProxy)
     APP_FileTransList_T * p_fileTrans;
     uint8_t transIndex;
 
+    APP_SCRIPT_LinkDisconnected(p_devProxy);
+
     p_fileTrans = app_GetFileTransList(p_devProxy);
     if (p_fileTrans == NULL)
     {
@@ -1492,12 +1867,24 @@ void APP_DeviceDisconnected(DeviceProxy * p_devProxy)
         transIndex = APP_GetFileTransIndex(p_devProxy);
         
         APP_TIMER_StopTimer(APP_TIMER_FILE_FETCH, transIndex);
-        APP_TIMER_StopTimer(APP_TIMER_LOOPBACK_RX_CHECK, transIndex);
+        app_RxWatchdogStop(p_fileTrans, APP_TIMER_LOOPBACK_RX_CHECK);
 
         app_SaveLoopbackDataToFile(p_devProxy);
         p_fileTrans->txOffset = 0;
         p_fileTrans->rxOffset = 0;
     }
+
+    transIndex = APP_GetFileTransIndex(p_devProxy);
+    APP_TIMER_StopTimer(APP_TIMER_RAW_DATA_RESUME, transIndex);
+
+    //Keep the part of the file received so far, the next rxf of the same file resumes it
+    if (p_fileTrans->resumeStage == APP_RAW_DATA_RESUME_RX && p_fileTrans->rxOffset > 0
+        && p_fileTrans->rxOffset < p_fileTrans->fileSize)
+    {
+        app_RxWatchdogStop(p_fileTrans, APP_TIMER_RAW_DATA_RX_CHECK);
+        app_SaveRawDataByChunk(p_devProxy, false);
+        app_RawDataKeepResumeRec(p_fileTrans);
+    }
     
 
 
@@ -1507,21 +1894,18 @@ void APP_DeviceDisconnected(DeviceProxy * p_devProxy)
 void APP_DeviceConnected(DeviceProxy * p_devProxy)
 {
     app_GetFileTransList(p_devProxy); //allocate
+    APP_SCRIPT_LinkConnected(p_devProxy);
 }
 
 uint8_t APP_GetFileTransIndex(DeviceProxy * p_devProxy)
 {
-    uint8_t i;
+    APP_FileTransList_T *p_fileTrans;
     
-    for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
-    {
-        if (s_appFileTransList[i].p_deviceProxy == p_devProxy)
-        {
-            return i;
-        }
-    }
+    p_fileTrans = g_hash_table_lookup(sp_appFileTransByProxy, p_devProxy);
+    if (p_fileTrans == NULL)
+        return BLE_GAP_MAX_LINK_NBR;
 
-    return BLE_GAP_MAX_LINK_NBR;
+    return (uint8_t)(p_fileTrans - sp_appFileTransList);
 }
 
 void APP_SendRawData(APP_TRP_ConnList_T *p_trpConn, char * p_data)
@@ -1545,9 +1929,14 @@ void APP_SendRawData(APP_TRP_ConnList_T *p_trpConn, char * p_data)
             return;
         }
 
-        app_ClearFileTransRecord(p_fileTrans, strlen(p_data));
+        app_ClearFileTransRecord(p_fileTrans, strlen(p_data), APP_MEM_CAT_RAW_DATA_BUF);
+        if (p_fileTrans->p_dataBuf == NULL)
+        {
+            bt_shell_printf("Out of memory budget\n");
+            return;
+        }
         p_fileTrans->rawDataSize = strlen(p_data);
-        strcpy(p_fileTrans->p_dataBuf, p_data);
+        memcpy(p_fileTrans->p_dataBuf, p_data, p_fileTrans->rawDataSize);
         
         APP_SetWorkMode(TRP_WMODE_UART);
 
@@ -1570,10 +1959,61 @@ void APP_SendRawData(APP_TRP_ConnList_T *p_trpConn, char * p_data)
 }
 
 
+static void app_RawDataSendStart(APP_TRP_ConnList_T *p_trpConn)
+{
+    uint8_t transIndex;
+
+    APP_SetWorkMode(TRP_WMODE_UART);
+
+    transIndex = APP_GetFileTransIndex(p_trpConn->p_deviceProxy);
+    if (p_trpConn->workMode != TRP_WMODE_UART)
+    {
+        APP_TRPC_TransmitModeSwitch(TRP_WMODE_UART, p_trpConn);
+        APP_TIMER_SetTimer(APP_TIMER_CHECK_MODE, transIndex, p_trpConn->p_deviceProxy, APP_TIMER_500MS);
+    }
+    else
+    {
+        APP_TIMER_SetTimer(APP_TIMER_CHECK_MODE, transIndex, p_trpConn->p_deviceProxy, APP_TIMER_1MS);
+    }
+}
+
+static void app_RawDataCrcWork(void * p_data)
+{
+    APP_RawDataCrcJob_T * p_job = (APP_RawDataCrcJob_T *)p_data;
+
+    p_job->crcPassed = app_RawDataFileCrc(p_job->p_fileName, &p_job->crc, &p_job->crcSize);
+}
+
+//The send starts once the file is identified, the record may have been cleared or reused meanwhile
+static void app_RawDataCrcDone(void * p_data)
+{
+    APP_RawDataCrcJob_T * p_job = (APP_RawDataCrcJob_T *)p_data;
+    APP_FileTransList_T * p_fileTrans = &sp_appFileTransList[p_job->transIndex];
+    APP_TRP_ConnList_T * p_trpConn;
+
+    if (p_fileTrans->p_deviceProxy != NULL && p_fileTrans->runId == p_job->runId)
+    {
+        p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy(p_fileTrans->p_deviceProxy);
+
+        //The CRC-32 identifies the file to the receiver and is checked once the file is received
+        if (p_job->crcPassed && p_job->crcSize == p_fileTrans->rawDataSize)
+        {
+            p_fileTrans->fileId = p_job->crc;
+            p_fileTrans->resumeStage = APP_RAW_DATA_RESUME_TX_WAIT;
+        }
+
+        if (p_trpConn != NULL)
+            app_RawDataSendStart(p_trpConn);
+    }
+
+    free(p_job->p_fileName);
+    free(p_job);
+}
+
 void APP_SendRawDataFromFile(APP_TRP_ConnList_T *p_trpConn, char * p_filePath)
 {
     APP_FileTransList_T * p_fileTrans;
-    uint8_t transIndex;
+    APP_RawDataCrcJob_T * p_job;
     
     if (p_trpConn == NULL || p_filePath == NULL)
     {
@@ -1590,22 +2030,28 @@ void APP_SendRawDataFromFile(APP_TRP_ConnList_T *p_trpConn, char * p_filePath)
             return;
         }
 
-        app_ClearFileTransRecord(p_fileTrans, 0);
+        app_ClearFileTransRecord(p_fileTrans, 0, APP_MEM_CAT_RAW_DATA_BUF);
         app_OpenRawDataByChunk(p_fileTrans, p_filePath, RAW_DATA_BUFFER_SIZE);
-        
-
-        APP_SetWorkMode(TRP_WMODE_UART);
 
-        transIndex = APP_GetFileTransIndex(p_trpConn->p_deviceProxy);
-        if (p_trpConn->workMode != TRP_WMODE_UART)
-        {
-            APP_TRPC_TransmitModeSwitch(TRP_WMODE_UART, p_trpConn);
-            APP_TIMER_SetTimer(APP_TIMER_CHECK_MODE, transIndex, p_trpConn->p_deviceProxy, APP_TIMER_500MS);
-        }
-        else
+        //The whole file is read for its CRC-32 on the data plane worker of the link, the send starts from the done step
+        if (p_fileTrans->p_dataBuf != NULL && p_fileTrans->rawDataSize > 0)
         {
-            APP_TIMER_SetTimer(APP_TIMER_CHECK_MODE, transIndex, p_trpConn->p_deviceProxy, APP_TIMER_1MS);
+            p_job = calloc(1, sizeof(APP_RawDataCrcJob_T));
+            if (p_job != NULL)
+                p_job->p_fileName = strdup(p_filePath);
+
+            if (p_job != NULL && p_job->p_fileName != NULL)
+            {
+                p_job->transIndex = APP_GetFileTransIndex(p_trpConn->p_deviceProxy);
+                p_job->runId = p_fileTrans->runId;
+                APP_DP_Submit(p_job->transIndex, app_RawDataCrcWork, app_RawDataCrcDone, p_job);
+                return;
+            }
+            free(p_job);
         }
+
+        //Sent from the beginning without the file identifier
+        app_RawDataSendStart(p_trpConn);
     }
     else
     {
@@ -1641,7 +2087,7 @@ void APP_ReceiveRawDataToFile(APP_TRP_ConnList_T *p_trpConn, char * p_filePath)
             return;
         }
 
-        app_ClearFileTransRecord(p_fileTrans, RAW_DATA_BUFFER_SIZE);
+        app_ClearFileTransRecord(p_fileTrans, RAW_DATA_BUFFER_SIZE, APP_MEM_CAT_RAW_DATA_BUF);
 
         if (p_fileTrans->p_rawDataFileName)
             free(p_fileTrans->p_rawDataFileName);
@@ -1689,7 +2135,115 @@ uint32_t APP_RawDataRemaining(APP_TRP_ConnList_T *p_trpConn)
         return 0;
     }
 
-    return p_fileTrans->rawDataSize - p_fileTrans->txOffset;
+    //Including the encoded data not sent yet when compressed
+    return p_fileTrans->rawDataSize - p_fileTrans->txOffset + APP_TRP_COMMON_GetCompressPending(p_trpConn);
+}
+
+bool APP_RawDataTxNegotiate(DeviceProxy *p_devProxy)
+{
+    APP_FileTransList_T * p_fileTrans;
+    APP_TRP_ConnList_T * p_trpConn;
+
+    p_fileTrans = app_GetFileTransList(p_devProxy);
+    p_trpConn = APP_TRP_COMMON_GetConnListByDevProxy(p_devProxy);
+    if (p_fileTrans == NULL || p_trpConn == NULL || p_fileTrans->resumeStage != APP_RAW_DATA_RESUME_TX_WAIT)
+        return false;
+
+    //Without the control channel the file is sent from the beginning
+    if (APP_TRP_COMMON_SendFileLengthCommand(p_trpConn, p_fileTrans->rawDataSize, p_fileTrans->fileId) != APP_RES_SUCCESS)
+    {
+        p_fileTrans->resumeStage = APP_RAW_DATA_RESUME_IDLE;
+        return false;
+    }
+
+    APP_TIMER_SetTimer(APP_TIMER_RAW_DATA_RESUME, APP_GetFileTransIndex(p_devProxy), p_devProxy, APP_TIMER_3S);
+
+    return true;
+}
+
+void APP_RawDataFileInfo(APP_TRP_ConnList_T *p_trpConn, uint32_t fileSize, uint32_t fileId)
+{
+    APP_FileTransList_T * p_fileTrans;
+    unsigned int offset = 0;
+
+    p_fileTrans = app_GetFileTransList(p_trpConn->p_deviceProxy);
+    if (p_fileTrans == NULL)
+        return;
+
+    //Only a file received by rxf is checked and resumed, otherwise the data is printed from the beginning
+    if (p_fileTrans->p_rawDataFileName != NULL && p_fileTrans->p_dataBuf != NULL && p_fileTrans->rxOffset == 0)
+    {
+        p_fileTrans->resumeStage = APP_RAW_DATA_RESUME_RX;
+        p_fileTrans->fileId = fileId;
+        p_fileTrans->fileSize = fileSize;
+
+        if (app_RawDataFindResumeRec(fileId, fileSize, p_fileTrans->p_rawDataFileName) != NULL)
+        {
+            //The partial file is read back, its last chunks may still be queued to the worker
+            APP_DP_Sync();
+            offset = app_RawDataRestoreRx(p_fileTrans);
+        }
+    }
+
+    if (APP_TRP_COMMON_SendOffsetCommand(p_trpConn, fileId, offset) != APP_RES_SUCCESS && offset > 0)
+    {
+        //The sender starts from the beginning when it gets no offset
+        p_fileTrans->rxOffset = 0;
+        p_fileTrans->rwChunkIndex = 0;
+        offset = 0;
+    }
+
+    if (offset > 0)
+    {
+        bt_shell_printf("Resuming %s from %d of %d bytes.\n", p_fileTrans->p_rawDataFileName, offset, fileSize);
+
+        //Nothing more is sent for a file already received as a whole, check it now
+        if (offset == fileSize)
+            APP_TIMER_SetTimer(APP_TIMER_RAW_DATA_RX_CHECK, APP_GetFileTransIndex(p_trpConn->p_deviceProxy),
+                p_trpConn->p_deviceProxy, APP_TIMER_100MS);
+    }
+}
+
+void APP_RawDataResume(APP_TRP_ConnList_T *p_trpConn, uint32_t fileId, uint32_t offset)
+{
+    APP_FileTransList_T * p_fileTrans;
+
+    p_fileTrans = app_GetFileTransList(p_trpConn->p_deviceProxy);
+    if (p_fileTrans == NULL || p_fileTrans->resumeStage != APP_RAW_DATA_RESUME_TX_WAIT || p_fileTrans->fileId != fileId)
+        return;
+
+    APP_TIMER_StopTimer(APP_TIMER_RAW_DATA_RESUME, APP_GetFileTransIndex(p_trpConn->p_deviceProxy));
+
+    if (offset > p_fileTrans->rawDataSize)
+        offset = 0;
+
+    app_RawDataTxStart(p_fileTrans, offset);
+}
+
+void APP_RawDataRetryResume(APP_TRP_ConnList_T *p_trpConn)
+{
+    APP_FileTransList_T * p_fileTrans;
+
+    p_fileTrans = app_GetFileTransList(p_trpConn->p_deviceProxy);
+    if (p_fileTrans == NULL)
+        return;
+
+    if (p_fileTrans->resumeStage == APP_RAW_DATA_RESUME_TX_WAIT)
+        APP_TRP_COMMON_SendFileLengthCommand(p_trpConn, p_fileTrans->rawDataSize, p_fileTrans->fileId);
+    else if (p_fileTrans->resumeStage == APP_RAW_DATA_RESUME_RX)
+        APP_TRP_COMMON_SendOffsetCommand(p_trpConn, p_fileTrans->fileId, p_fileTrans->rxOffset);
+}
+
+void APP_RawDataResumeTimeout(void *p_param)
+{
+    APP_FileTransList_T * p_fileTrans;
+
+    p_fileTrans = app_GetFileTransList((DeviceProxy *)p_param);
+    if (p_fileTrans == NULL || p_fileTrans->resumeStage != APP_RAW_DATA_RESUME_TX_WAIT)
+        return;
+
+    //A peer without resume support does not answer
+    app_RawDataTxStart(p_fileTrans, 0);
 }
 
 
@@ -1746,24 +2300,30 @@ void APP_Initialize(void)
     s_patternDataSize = 0;
     s_bleWorkMode = TRP_WMODE_NULL;
     s_patternFileIndex = APP_PATTERN_FILE_TYPE_MAX;
-    sp_currThread = NULL;
-    sp_prevThread = NULL;
 
+    APP_DP_Init();
     APP_DBP_Init();
     APP_SM_Init();
     APP_SM_Handler(APP_SM_EVENT_POWER_ON);
     APP_InitConnList();
+    app_InitFileTransList();
+    BLE_TRSPS_SetMaxConnNbr(BLE_GAP_MAX_LINK_NBR);
+    BLE_TRSPC_SetMaxConnNbr(BLE_GAP_MAX_LINK_NBR);
+    BLE_TRCBP_SetMaxConnNbr(BLE_GAP_MAX_LINK_NBR);
     APP_ADV_Init();
     APP_SCAN_Init();
     APP_MGMT_Init();
     BLE_TRSPS_EventRegister(APP_TRPS_EventHandler);
     BLE_TRSPC_EventRegister(APP_TRPC_EventHandler);
+    BLE_TRCBP_EventRegister(APP_TRCBP_EventHandler);
 
     APP_TRP_COMMON_Init();
+    APP_TUNE_Init();
     APP_TRPS_Init();
     APP_TRPC_Init();
-#ifdef ENABLE_DATA_BUFFER_OVERFLOW_MONITOR
-    app_HciEvtMonitor();
+    APP_TRCBP_Init();
+#ifdef ENABLE_HCI_EVT_MONITOR
+    APP_HCIMON_Init();
 #endif
 }
 
@@ -1799,6 +2359,7 @@ void APP_Deinitialize(void)
 
     APP_AGT_Unregister(APP_DBP_GetPairAgent());
     APP_MGMT_Deinit();
+    APP_LOG_Flush();
 }
 
 
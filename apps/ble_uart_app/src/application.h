@@ -59,7 +59,7 @@ To enable Debug feature in BlueZ, there are two levels enabling. (This method ma
 */
 //#define ENABLE_BLUEZ_DEBUG
 #define ENABLE_AUTO_RUN
-#define ENABLE_DATA_BUFFER_OVERFLOW_MONITOR
+#define ENABLE_HCI_EVT_MONITOR
 //#define ENABLE_EXP_MULTI_ROLE
 
 
@@ -111,6 +111,11 @@ void APP_SendRawData(APP_TRP_ConnList_T *p_trpConn, char * p_data);
 void APP_SendRawDataFromFile(APP_TRP_ConnList_T *p_trpConn, char * p_filePath);
 void APP_ReceiveRawDataToFile(APP_TRP_ConnList_T *p_trpConn, char * p_filePath);
 uint32_t APP_RawDataRemaining(APP_TRP_ConnList_T *p_trpConn);
+bool APP_RawDataTxNegotiate(DeviceProxy *p_devProxy);
+void APP_RawDataFileInfo(APP_TRP_ConnList_T *p_trpConn, uint32_t fileSize, uint32_t fileId);
+void APP_RawDataResume(APP_TRP_ConnList_T *p_trpConn, uint32_t fileId, uint32_t offset);
+void APP_RawDataRetryResume(APP_TRP_ConnList_T *p_trpConn);
+void APP_RawDataResumeTimeout(void *p_param);
 uint16_t APP_OutputWrite(APP_TRP_ConnList_T *p_trpConn, uint16_t length, uint8_t *p_buffer);
 void APP_SetWorkMode(uint8_t mode);
 void APP_FetchTxDataFromPatternFile(DeviceProxy * p_devProxy);
@@ -44,6 +44,9 @@
 #include "app_sm.h"
 #include "app_scan.h"
 #include "app_cmd.h"
+#include "app_script.h"
+#include "app_replay.h"
+#include "app_timer.h"
 
 
 static DBusConnection * sp_dbusConn;
@@ -62,11 +65,28 @@ int main(int argc, char *argv[])
 
     APP_LOG_INIT("BLE_UART");
     
-    bt_shell_init(argc, argv, NULL);
+    bt_shell_init(argc, argv, APP_SCRIPT_GetShellOpt());
     bt_shell_set_menu(APP_CMD_GetCmdMenu());
+    APP_TIMER_Init();
+
+    if (!APP_SCRIPT_Init())
+        return EXIT_FAILURE;
     
     APP_Initialize();
 
+    /*replay a recorded file without D-Bus and BlueZ*/
+    if (APP_REPLAY_IsEnabled())
+    {
+        if (!APP_REPLAY_Start())
+            return EXIT_FAILURE;
+
+        bt_shell_run();
+
+        APP_LOG_Flush();
+
+        return APP_REPLAY_GetExitCode();
+    }
+
     /*set up the dbus connection*/
     sp_dbusConn = g_dbus_setup_bus(DBUS_BUS_SYSTEM, NULL, NULL);
     g_dbus_attach_object_manager(sp_dbusConn);
@@ -93,7 +113,7 @@ int main(int argc, char *argv[])
     g_dbus_client_unref(p_dbusClient);
     dbus_connection_unref(sp_dbusConn);
 
-    return 0;
+    return APP_SCRIPT_GetExitCode();
 }
 
 /*******************************************************************************
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Application Data Plane Worker Test Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_dp_test.c
+
+  Summary:
+    This file contains the test of the Application data plane worker.
+
+  Description:
+    This file contains the test of the Application data plane worker.
+    One worker gets more than twice APP_DP_QUEUE_SIZE jobs of one shard without the main loop
+    running in between, so that both the job ring and the done ring fill up. The submits must
+    return, no done step may run inside them, and APP_DP_Sync() must then run every done step
+    once, in the order of the jobs. A deadlock is ended by the alarm and fails the test.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <glib.h>
+
+#include "app_dp.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_DP_TEST_JOB_NUM             (4 * APP_DP_QUEUE_SIZE + 1)
+#define APP_DP_TEST_TIMEOUT_S           10
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static guint                s_dpTestSeq[APP_DP_TEST_JOB_NUM];
+static guint                s_dpTestWorked;     /**< Jobs worked, worker thread only. */
+static guint                s_dpTestDone;       /**< Done steps run, main loop only. */
+static guint                s_dpTestErrors;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static void app_dp_test_Work(void *p_data)
+{
+    guint *p_seq = (guint *)p_data;
+
+    if (*p_seq != s_dpTestWorked)
+        s_dpTestErrors++;
+    s_dpTestWorked++;
+}
+
+static void app_dp_test_Done(void *p_data)
+{
+    guint *p_seq = (guint *)p_data;
+
+    if (*p_seq != s_dpTestDone)
+    {
+        fprintf(stderr, "done step %u run as %u\n", *p_seq, s_dpTestDone);
+        s_dpTestErrors++;
+    }
+    s_dpTestDone++;
+}
+
+int main(void)
+{
+    guint i;
+
+    alarm(APP_DP_TEST_TIMEOUT_S);
+
+    APP_DP_SetWorkerNum(1);
+    APP_DP_Init();
+
+    for (i = 0; i < APP_DP_TEST_JOB_NUM; i++)
+    {
+        s_dpTestSeq[i] = i;
+        APP_DP_Submit(0, app_dp_test_Work, app_dp_test_Done, &s_dpTestSeq[i]);
+    }
+
+    if (s_dpTestDone != 0)
+    {
+        fprintf(stderr, "%u done steps run inside APP_DP_Submit\n", s_dpTestDone);
+        return EXIT_FAILURE;
+    }
+
+    APP_DP_Sync();
+
+    if (s_dpTestDone != APP_DP_TEST_JOB_NUM || s_dpTestErrors != 0)
+    {
+        fprintf(stderr, "%u of %u done steps, %u out of order\n", s_dpTestDone, APP_DP_TEST_JOB_NUM, s_dpTestErrors);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u jobs done in order\n", s_dpTestDone);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,866 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  BLE Transparent Credit Based Profile Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    ble_trcbp.c
+
+  Summary:
+    This file contains the BLE Transparent Credit Based Profile functions for application user.
+
+  Description:
+    This file contains the BLE Transparent Credit Based Profile functions for application user.
+ *******************************************************************************/
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#include "bluetooth/bluetooth.h"
+#include "bluetooth/l2cap.h"
+
+
+#include "ble_trcbp.h"
+#include "ble_trsp/ble_trsp_defs.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+
+/**@defgroup BLE_TRCBP_SOCKOPT BLE_TRCBP_SOCKOPT
+ * @brief The definition of L2CAP channel mode socket option, for older kernel headers.
+ * @{ */
+#ifndef BT_MODE
+#define BT_MODE                                 (15)       /**< Socket option of the L2CAP channel mode. */
+#endif
+#ifndef BT_MODE_LE_FLOWCTL
+#define BT_MODE_LE_FLOWCTL                      (0x03)     /**< LE credit based flow control mode. */
+#endif
+/** @} */
+
+/**@defgroup BLE_TRCBP_LISTEN_BACKLOG BLE_TRCBP_LISTEN_BACKLOG
+ * @brief The definition of pending incoming channels.
+ * @{ */
+#define BLE_TRCBP_LISTEN_BACKLOG                (s_trcbpMaxConnNbr)    /**< Backlog of the listening socket. */
+/** @} */
+
+/**@defgroup BLE_TRCBP_STATE TRCBP state
+ * @brief The definition of BLE TRCBP channel state
+ * @{ */
+typedef enum BLE_TRCBP_State_T
+{
+    BLE_TRCBP_STATE_IDLE = 0x00,        /**< Default state (Disconnected). */
+    BLE_TRCBP_STATE_CONNECTING,         /**< Socket connect in progress. */
+    BLE_TRCBP_STATE_CONNECTED           /**< Connected. */
+} BLE_TRCBP_State_T;
+/** @} */
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief The structure contains information about BLE transparent credit based profile packetIn. */
+typedef struct BLE_TRCBP_PacketList_T
+{
+    uint16_t                   length;                  /**< Data length. */
+    uint8_t                    *p_packet;               /**< Pointer to the RX data buffer */
+} BLE_TRCBP_PacketList_T;
+
+/**@brief The structure contains information about packet input queue format of BLE transparent credit based profile. */
+typedef struct BLE_TRCBP_QueueIn_T
+{
+    uint8_t                    usedNum;                    /**< The number of data list of packetIn buffer. */
+    uint8_t                    writeIndex;                 /**< The Index of data, written in packet buffer. */
+    uint8_t                    readIndex;                  /**< The Index of data, read in packet buffer. */
+    BLE_TRCBP_PacketList_T     packetList[BLE_TRCBP_INPUT_QUEUE_NUM];  /**< Written in packet buffer. @ref BLE_TRCBP_PacketList_T.*/
+} BLE_TRCBP_QueueIn_T;
+
+/**@brief The structure contains information about BLE transparent credit based profile channel. */
+typedef struct BLE_TRCBP_ConnList_T
+{
+    BLE_TRCBP_State_T           state;                  /**< Channel state. */
+    GDBusProxy                  *p_dev;                 /**< Proxy to org.bluez.device interface. */
+    int                         fd;                     /**< Channel socket. */
+    GIOChannel                  *p_io;                  /**< IO channel of the socket. */
+    guint                       rxWatch;                /**< Source of the input/hangup watch. 0 while the input queue is full. */
+    guint                       txWatch;                /**< Source of the output watch, armed after a blocked send. */
+    guint                       pendingIdle;            /**< Source of the pending connected or TX complete event. */
+    uint16_t                    txSdu;                  /**< Maximum SDU size accepted by the peer. */
+    uint16_t                    rxSdu;                  /**< Maximum SDU size accepted locally. */
+    BLE_TRCBP_QueueIn_T         inputQueue;             /**< Input queue to store Rx packets. */
+} BLE_TRCBP_ConnList_T;
+
+/**@brief The structure contains information about the listening socket. */
+typedef struct BLE_TRCBP_Listener_T
+{
+    int                         fd;                     /**< Listening socket, -1 if not listening. */
+    GIOChannel                  *p_io;                  /**< IO channel of the socket. */
+    guint                       watch;                  /**< Source of the accept watch. */
+    uint16_t                    sdu;                    /**< Receive SDU size of accepted channels. */
+} BLE_TRCBP_Listener_T;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static BLE_TRCBP_EventCb_T      bleTrcbpProcess;
+static BLE_TRCBP_ConnList_T     *sp_trcbpConnList = NULL;   /**< Connection table, allocated once by BLE_TRCBP_Init(). */
+static uint8_t                  s_trcbpMaxConnNbr = BLE_TRCBP_MAX_CONN_NBR;  /**< Number of entries in the connection table. */
+static uint8_t                  *sp_trcbpFreeNext = NULL;   /**< Next free entry of each free entry, s_trcbpMaxConnNbr ends the list. */
+static uint8_t                  s_trcbpFreeHead;             /**< First free entry, s_trcbpMaxConnNbr when the table is full. */
+static GHashTable               *sp_trcbpConnByProxy = NULL; /**< Allocated entries by device proxy. */
+static BLE_TRCBP_Listener_T     s_trcbpListener;
+
+static void ble_trcbp_WatchRx(BLE_TRCBP_ConnList_T *p_conn);
+
+static void ble_trcbp_ConveyEvt(BLE_TRCBP_EventId_T evtId, GDBusProxy *p_dev)
+{
+    if (bleTrcbpProcess != NULL)
+    {
+        BLE_TRCBP_Event_T evtPara;
+
+        evtPara.eventId = evtId;
+        evtPara.eventField.onDisconnected.p_dev = p_dev;
+        bleTrcbpProcess(&evtPara);
+    }
+}
+
+static void ble_trcbp_InitConnList(BLE_TRCBP_ConnList_T *p_conn)
+{
+    memset((uint8_t *)p_conn, 0, sizeof(BLE_TRCBP_ConnList_T));
+    p_conn->fd = -1;
+}
+
+static BLE_TRCBP_ConnList_T *ble_trcbp_GetConnListByProxy(GDBusProxy *p_dev)
+{
+    if (sp_trcbpConnByProxy == NULL)
+    {
+        return NULL;
+    }
+
+    return g_hash_table_lookup(sp_trcbpConnByProxy, p_dev);
+}
+
+static BLE_TRCBP_ConnList_T *ble_trcbp_GetFreeConnList(void)
+{
+    uint8_t index = s_trcbpFreeHead;
+
+    if ((sp_trcbpConnList == NULL) || (index >= s_trcbpMaxConnNbr))
+    {
+        return NULL;
+    }
+
+    s_trcbpFreeHead = sp_trcbpFreeNext[index];
+
+    return &sp_trcbpConnList[index];
+}
+
+static void ble_trcbp_FreeConnList(BLE_TRCBP_ConnList_T *p_conn)
+{
+    uint8_t index = (uint8_t)(p_conn - sp_trcbpConnList);
+
+    if (p_conn->state == BLE_TRCBP_STATE_IDLE)
+    {
+        ble_trcbp_InitConnList(p_conn);
+        return;
+    }
+
+    g_hash_table_remove(sp_trcbpConnByProxy, p_conn->p_dev);
+    ble_trcbp_InitConnList(p_conn);
+
+    sp_trcbpFreeNext[index] = s_trcbpFreeHead;
+    s_trcbpFreeHead = index;
+}
+
+static void ble_trcbp_FreeInputQueue(BLE_TRCBP_ConnList_T *p_conn)
+{
+    uint8_t i;
+
+    for (i = 0; i < BLE_TRCBP_INPUT_QUEUE_NUM; i++)
+    {
+        if (p_conn->inputQueue.packetList[i].p_packet != NULL)
+        {
+            g_free(p_conn->inputQueue.packetList[i].p_packet);
+            p_conn->inputQueue.packetList[i].p_packet = NULL;
+        }
+    }
+}
+
+static void ble_trcbp_Close(BLE_TRCBP_ConnList_T *p_conn)
+{
+    bool isConnected = (p_conn->state == BLE_TRCBP_STATE_CONNECTED);
+    GDBusProxy *p_dev = p_conn->p_dev;
+
+    if (p_conn->rxWatch != 0)
+    {
+        g_source_remove(p_conn->rxWatch);
+    }
+    if (p_conn->txWatch != 0)
+    {
+        g_source_remove(p_conn->txWatch);
+    }
+    if (p_conn->pendingIdle != 0)
+    {
+        g_source_remove(p_conn->pendingIdle);
+    }
+    if (p_conn->p_io != NULL)
+    {
+        g_io_channel_unref(p_conn->p_io);
+    }
+    if (p_conn->fd >= 0)
+    {
+        close(p_conn->fd);
+    }
+
+    ble_trcbp_FreeInputQueue(p_conn);
+    ble_trcbp_FreeConnList(p_conn);
+
+    if (isConnected)
+    {
+        ble_trcbp_ConveyEvt(BLE_TRCBP_EVT_DISCONNECTED, p_dev);
+    }
+}
+
+static int ble_trcbp_CreateSocket(uint16_t psm, uint16_t sdu)
+{
+    struct sockaddr_l2 addr;
+    int fd;
+    int mode = BT_MODE_LE_FLOWCTL;
+
+    fd = socket(PF_BLUETOOTH, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, BTPROTO_L2CAP);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.l2_family = AF_BLUETOOTH;
+    bacpy(&addr.l2_bdaddr, BDADDR_ANY);
+    addr.l2_bdaddr_type = BDADDR_LE_PUBLIC;
+    addr.l2_psm = htobs(psm);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    /* Kernels without BT_MODE select LE flow control for LE sockets already. */
+    if ((setsockopt(fd, SOL_BLUETOOTH, BT_MODE, &mode, sizeof(mode)) < 0) && (errno != ENOPROTOOPT))
+    {
+        close(fd);
+        return -1;
+    }
+
+    /* The MPS is chosen by the kernel from the controller buffer size. */
+    if (setsockopt(fd, SOL_BLUETOOTH, BT_RCVMTU, &sdu, sizeof(sdu)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void ble_trcbp_GetSocketSdu(int fd, uint16_t *p_txSdu, uint16_t *p_rxSdu)
+{
+    uint16_t mtu;
+    socklen_t len;
+
+    len = sizeof(mtu);
+    if (getsockopt(fd, SOL_BLUETOOTH, BT_SNDMTU, &mtu, &len) == 0)
+    {
+        *p_txSdu = mtu;
+    }
+
+    len = sizeof(mtu);
+    if (getsockopt(fd, SOL_BLUETOOTH, BT_RCVMTU, &mtu, &len) == 0)
+    {
+        *p_rxSdu = mtu;
+    }
+}
+
+static void ble_trcbp_Established(BLE_TRCBP_ConnList_T *p_conn)
+{
+    p_conn->state = BLE_TRCBP_STATE_CONNECTED;
+    ble_trcbp_WatchRx(p_conn);
+
+    if (bleTrcbpProcess != NULL)
+    {
+        BLE_TRCBP_Event_T evtPara;
+
+        evtPara.eventId = BLE_TRCBP_EVT_CONNECTED;
+        evtPara.eventField.onConnected.p_dev = p_conn->p_dev;
+        evtPara.eventField.onConnected.txSdu = p_conn->txSdu;
+        evtPara.eventField.onConnected.rxSdu = p_conn->rxSdu;
+        bleTrcbpProcess(&evtPara);
+    }
+}
+
+static bool ble_trcbp_RcvData(BLE_TRCBP_ConnList_T *p_conn)
+{
+    uint8_t *p_buffer;
+    ssize_t len;
+
+    p_buffer = g_malloc(p_conn->rxSdu);
+    if (p_buffer == NULL)
+    {
+        ble_trcbp_ConveyEvt(BLE_TRCBP_EVT_ERR_NO_MEM, p_conn->p_dev);
+        return false;
+    }
+
+    len = recv(p_conn->fd, p_buffer, p_conn->rxSdu, MSG_DONTWAIT);
+    if (len <= 0)
+    {
+        g_free(p_buffer);
+        if ((len < 0) && ((errno == EAGAIN) || (errno == EINTR)))
+        {
+            return false;
+        }
+
+        /* Orderly shutdown or socket error. */
+        ble_trcbp_Close(p_conn);
+        return false;
+    }
+
+    p_conn->inputQueue.packetList[p_conn->inputQueue.writeIndex].length = (uint16_t)len;
+    p_conn->inputQueue.packetList[p_conn->inputQueue.writeIndex].p_packet = p_buffer;
+    p_conn->inputQueue.writeIndex++;
+    if (p_conn->inputQueue.writeIndex >= BLE_TRCBP_INPUT_QUEUE_NUM)
+    {
+        p_conn->inputQueue.writeIndex = 0;
+    }
+    p_conn->inputQueue.usedNum++;
+
+    ble_trcbp_ConveyEvt(BLE_TRCBP_EVT_RECEIVE_DATA, p_conn->p_dev);
+
+    return true;
+}
+
+static gboolean ble_trcbp_RxCb(GIOChannel *p_io, GIOCondition cond, gpointer p_userData)
+{
+    BLE_TRCBP_ConnList_T *p_conn = (BLE_TRCBP_ConnList_T *)p_userData;
+
+    (void)p_io;
+
+    if ((cond & G_IO_IN) != 0)
+    {
+        /* Drain the socket until the input queue is full. The kernel stops returning credits
+         * to the peer while the socket is not read. */
+        while ((p_conn->state == BLE_TRCBP_STATE_CONNECTED) && (p_conn->inputQueue.usedNum < BLE_TRCBP_INPUT_QUEUE_NUM))
+        {
+            if (!ble_trcbp_RcvData(p_conn))
+            {
+                break;
+            }
+        }
+
+        if (p_conn->state != BLE_TRCBP_STATE_CONNECTED)
+        {
+            return FALSE;
+        }
+
+        if (p_conn->inputQueue.usedNum >= BLE_TRCBP_INPUT_QUEUE_NUM)
+        {
+            p_conn->rxWatch = 0;
+            return FALSE;
+        }
+
+        return TRUE;
+    }
+
+    if ((cond & (G_IO_HUP | G_IO_ERR | G_IO_NVAL)) != 0)
+    {
+        p_conn->rxWatch = 0;
+        ble_trcbp_Close(p_conn);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void ble_trcbp_WatchRx(BLE_TRCBP_ConnList_T *p_conn)
+{
+    if (p_conn->rxWatch == 0)
+    {
+        p_conn->rxWatch = g_io_add_watch(p_conn->p_io, G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL, ble_trcbp_RxCb, p_conn);
+    }
+}
+
+static gboolean ble_trcbp_TxCb(GIOChannel *p_io, GIOCondition cond, gpointer p_userData)
+{
+    BLE_TRCBP_ConnList_T *p_conn = (BLE_TRCBP_ConnList_T *)p_userData;
+
+    (void)p_io;
+    (void)cond;
+
+    p_conn->txWatch = 0;
+    ble_trcbp_ConveyEvt(BLE_TRCBP_EVT_CREDIT, p_conn->p_dev);
+
+    return FALSE;
+}
+
+static gboolean ble_trcbp_TxCompleteCb(gpointer p_userData)
+{
+    BLE_TRCBP_ConnList_T *p_conn = (BLE_TRCBP_ConnList_T *)p_userData;
+
+    p_conn->pendingIdle = 0;
+    ble_trcbp_ConveyEvt(BLE_TRCBP_EVT_TX_COMPLETE, p_conn->p_dev);
+
+    return FALSE;
+}
+
+static gboolean ble_trcbp_ConnectCb(GIOChannel *p_io, GIOCondition cond, gpointer p_userData)
+{
+    BLE_TRCBP_ConnList_T *p_conn = (BLE_TRCBP_ConnList_T *)p_userData;
+    int err = 0;
+    socklen_t len = sizeof(err);
+
+    (void)p_io;
+
+    p_conn->txWatch = 0;
+
+    if (((cond & (G_IO_ERR | G_IO_HUP | G_IO_NVAL)) != 0)
+        || (getsockopt(p_conn->fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0) || (err != 0))
+    {
+        printf("TRCBP channel connect failed: %s\n", strerror((err != 0) ? err : ECONNREFUSED));
+        ble_trcbp_Close(p_conn);
+        return FALSE;
+    }
+
+    ble_trcbp_GetSocketSdu(p_conn->fd, &p_conn->txSdu, &p_conn->rxSdu);
+    ble_trcbp_Established(p_conn);
+
+    return FALSE;
+}
+
+static gboolean ble_trcbp_AttachedCb(gpointer p_userData)
+{
+    BLE_TRCBP_ConnList_T *p_conn = (BLE_TRCBP_ConnList_T *)p_userData;
+
+    p_conn->pendingIdle = 0;
+    ble_trcbp_Established(p_conn);
+
+    return FALSE;
+}
+
+static uint16_t ble_trcbp_AllocConn(GDBusProxy *p_proxyDev, int fd, BLE_TRCBP_ConnList_T **pp_conn)
+{
+    BLE_TRCBP_ConnList_T *p_conn;
+
+    if (ble_trcbp_GetConnListByProxy(p_proxyDev) != NULL)
+    {
+        return TRSP_RES_BAD_STATE;
+    }
+
+    p_conn = ble_trcbp_GetFreeConnList();
+    if (p_conn == NULL)
+    {
+        return TRSP_RES_NO_RESOURCE;
+    }
+
+    ble_trcbp_InitConnList(p_conn);
+    p_conn->p_dev = p_proxyDev;
+    p_conn->fd = fd;
+    p_conn->p_io = g_io_channel_unix_new(fd);
+    g_io_channel_set_encoding(p_conn->p_io, NULL, NULL);
+    g_io_channel_set_buffered(p_conn->p_io, FALSE);
+    p_conn->state = BLE_TRCBP_STATE_CONNECTING;
+    g_hash_table_insert(sp_trcbpConnByProxy, p_proxyDev, p_conn);
+
+    *pp_conn = p_conn;
+    return TRSP_RES_SUCCESS;
+}
+
+static gboolean ble_trcbp_AcceptCb(GIOChannel *p_io, GIOCondition cond, gpointer p_userData)
+{
+    struct sockaddr_l2 addr;
+    socklen_t len = sizeof(addr);
+    char address[18];
+    int fd;
+
+    (void)p_io;
+    (void)p_userData;
+
+    if ((cond & (G_IO_ERR | G_IO_HUP | G_IO_NVAL)) != 0)
+    {
+        s_trcbpListener.watch = 0;
+        return FALSE;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    fd = accept(s_trcbpListener.fd, (struct sockaddr *)&addr, &len);
+    if (fd < 0)
+    {
+        return TRUE;
+    }
+    (void)fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    (void)fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    ba2str(&addr.l2_bdaddr, address);
+
+    if (bleTrcbpProcess != NULL)
+    {
+        BLE_TRCBP_Event_T evtPara;
+        BLE_TRCBP_ConnList_T *p_conn;
+
+        evtPara.eventId = BLE_TRCBP_EVT_CONN_IND;
+        evtPara.eventField.onConnInd.p_address = address;
+        evtPara.eventField.onConnInd.isRandom = (addr.l2_bdaddr_type == BDADDR_LE_RANDOM);
+        evtPara.eventField.onConnInd.p_dev = NULL;
+        bleTrcbpProcess(&evtPara);
+
+        if ((evtPara.eventField.onConnInd.p_dev != NULL)
+            && (ble_trcbp_AllocConn(evtPara.eventField.onConnInd.p_dev, fd, &p_conn) == TRSP_RES_SUCCESS))
+        {
+            p_conn->txSdu = BLE_TRCBP_MIN_SDU;
+            p_conn->rxSdu = s_trcbpListener.sdu;
+            ble_trcbp_GetSocketSdu(fd, &p_conn->txSdu, &p_conn->rxSdu);
+            ble_trcbp_Established(p_conn);
+            return TRUE;
+        }
+    }
+
+    close(fd);
+    return TRUE;
+}
+
+static void ble_trcbp_StopListen(void)
+{
+    if (s_trcbpListener.watch != 0)
+    {
+        g_source_remove(s_trcbpListener.watch);
+        s_trcbpListener.watch = 0;
+    }
+    if (s_trcbpListener.p_io != NULL)
+    {
+        g_io_channel_unref(s_trcbpListener.p_io);
+        s_trcbpListener.p_io = NULL;
+    }
+    if (s_trcbpListener.fd >= 0)
+    {
+        close(s_trcbpListener.fd);
+        s_trcbpListener.fd = -1;
+    }
+}
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+void BLE_TRCBP_EventRegister(BLE_TRCBP_EventCb_T bleTrcbpHandler)
+{
+    bleTrcbpProcess = bleTrcbpHandler;
+}
+
+uint16_t BLE_TRCBP_SetMaxConnNbr(uint8_t connNbr)
+{
+    if ((connNbr == 0U) || (connNbr > BLE_TRCBP_CONN_NBR_LIMIT))
+    {
+        return TRSP_RES_INVALID_PARA;
+    }
+
+    if (sp_trcbpConnList != NULL)
+    {
+        return TRSP_RES_BAD_STATE;
+    }
+
+    s_trcbpMaxConnNbr = connNbr;
+
+    return TRSP_RES_SUCCESS;
+}
+
+void BLE_TRCBP_Init(void)
+{
+    uint8_t i;
+
+    if (sp_trcbpConnList == NULL)
+    {
+        sp_trcbpConnList = g_new0(BLE_TRCBP_ConnList_T, s_trcbpMaxConnNbr);
+        sp_trcbpFreeNext = g_new0(uint8_t, s_trcbpMaxConnNbr);
+        sp_trcbpConnByProxy = g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+
+    g_hash_table_remove_all(sp_trcbpConnByProxy);
+
+    for (i = 0; i < s_trcbpMaxConnNbr; i++)
+    {
+        ble_trcbp_InitConnList(&sp_trcbpConnList[i]);
+        sp_trcbpFreeNext[i] = i + 1U;
+    }
+    s_trcbpFreeHead = 0;
+
+    memset(&s_trcbpListener, 0, sizeof(BLE_TRCBP_Listener_T));
+    s_trcbpListener.fd = -1;
+}
+
+uint16_t BLE_TRCBP_Listen(uint16_t psm, uint16_t sdu)
+{
+    int fd;
+
+    ble_trcbp_StopListen();
+
+    if (psm == 0)
+    {
+        return TRSP_RES_SUCCESS;
+    }
+
+    fd = ble_trcbp_CreateSocket(psm, sdu);
+    if (fd < 0)
+    {
+        return TRSP_RES_FAIL;
+    }
+
+    if (listen(fd, BLE_TRCBP_LISTEN_BACKLOG) < 0)
+    {
+        close(fd);
+        return TRSP_RES_FAIL;
+    }
+
+    s_trcbpListener.fd = fd;
+    s_trcbpListener.sdu = sdu;
+    s_trcbpListener.p_io = g_io_channel_unix_new(fd);
+    s_trcbpListener.watch = g_io_add_watch(s_trcbpListener.p_io, G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL, ble_trcbp_AcceptCb, NULL);
+
+    return TRSP_RES_SUCCESS;
+}
+
+uint16_t BLE_TRCBP_Connect(GDBusProxy *p_proxyDev, const char *p_address, bool isRandom, uint16_t psm, uint16_t sdu)
+{
+    BLE_TRCBP_ConnList_T *p_conn;
+    struct sockaddr_l2 addr;
+    uint16_t result;
+    int fd;
+
+    if ((p_proxyDev == NULL) || (p_address == NULL) || (psm == 0))
+    {
+        return TRSP_RES_INVALID_PARA;
+    }
+
+    fd = ble_trcbp_CreateSocket(0, sdu);
+    if (fd < 0)
+    {
+        return TRSP_RES_FAIL;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.l2_family = AF_BLUETOOTH;
+    str2ba(p_address, &addr.l2_bdaddr);
+    addr.l2_bdaddr_type = isRandom ? BDADDR_LE_RANDOM : BDADDR_LE_PUBLIC;
+    addr.l2_psm = htobs(psm);
+    if ((connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) && (errno != EINPROGRESS))
+    {
+        close(fd);
+        return TRSP_RES_FAIL;
+    }
+
+    result = ble_trcbp_AllocConn(p_proxyDev, fd, &p_conn);
+    if (result != TRSP_RES_SUCCESS)
+    {
+        close(fd);
+        return result;
+    }
+
+    p_conn->txSdu = BLE_TRCBP_MIN_SDU;
+    p_conn->rxSdu = sdu;
+    p_conn->txWatch = g_io_add_watch(p_conn->p_io, G_IO_OUT | G_IO_ERR | G_IO_HUP | G_IO_NVAL, ble_trcbp_ConnectCb, p_conn);
+
+    return TRSP_RES_SUCCESS;
+}
+
+uint16_t BLE_TRCBP_Attach(GDBusProxy *p_proxyDev, int fd, uint16_t txSdu, uint16_t rxSdu)
+{
+    BLE_TRCBP_ConnList_T *p_conn;
+    uint16_t result;
+
+    if ((p_proxyDev == NULL) || (fd < 0) || (txSdu == 0) || (rxSdu == 0))
+    {
+        return TRSP_RES_INVALID_PARA;
+    }
+
+    result = ble_trcbp_AllocConn(p_proxyDev, fd, &p_conn);
+    if (result != TRSP_RES_SUCCESS)
+    {
+        return result;
+    }
+
+    p_conn->txSdu = txSdu;
+    p_conn->rxSdu = rxSdu;
+    p_conn->pendingIdle = g_idle_add(ble_trcbp_AttachedCb, p_conn);
+
+    return TRSP_RES_SUCCESS;
+}
+
+uint16_t BLE_TRCBP_CreateLocalPair(GDBusProxy *p_proxyDevA, GDBusProxy *p_proxyDevB, uint16_t sdu)
+{
+    int fds[2];
+    uint16_t result;
+
+    if ((p_proxyDevA == NULL) || (p_proxyDevB == NULL) || (p_proxyDevA == p_proxyDevB) || (sdu == 0))
+    {
+        return TRSP_RES_INVALID_PARA;
+    }
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) < 0)
+    {
+        return TRSP_RES_FAIL;
+    }
+
+    result = BLE_TRCBP_Attach(p_proxyDevA, fds[0], sdu, sdu);
+    if (result != TRSP_RES_SUCCESS)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return result;
+    }
+
+    result = BLE_TRCBP_Attach(p_proxyDevB, fds[1], sdu, sdu);
+    if (result != TRSP_RES_SUCCESS)
+    {
+        close(fds[1]);
+        ble_trcbp_Close(ble_trcbp_GetConnListByProxy(p_proxyDevA));
+        return result;
+    }
+
+    return TRSP_RES_SUCCESS;
+}
+
+void BLE_TRCBP_Disconnect(GDBusProxy *p_proxyDev)
+{
+    BLE_TRCBP_ConnList_T *p_conn;
+
+    p_conn = ble_trcbp_GetConnListByProxy(p_proxyDev);
+    if (p_conn != NULL)
+    {
+        ble_trcbp_Close(p_conn);
+    }
+}
+
+bool BLE_TRCBP_IsConnected(GDBusProxy *p_proxyDev)
+{
+    BLE_TRCBP_ConnList_T *p_conn;
+
+    p_conn = ble_trcbp_GetConnListByProxy(p_proxyDev);
+
+    return ((p_conn != NULL) && (p_conn->state == BLE_TRCBP_STATE_CONNECTED));
+}
+
+uint16_t BLE_TRCBP_SendData(GDBusProxy *p_proxyDev, uint16_t len, uint8_t *p_data)
+{
+    BLE_TRCBP_ConnList_T *p_conn;
+    ssize_t sent;
+
+    p_conn = ble_trcbp_GetConnListByProxy(p_proxyDev);
+    if ((p_conn == NULL) || (p_conn->state != BLE_TRCBP_STATE_CONNECTED))
+    {
+        return TRSP_RES_FAIL;
+    }
+
+    if ((len == 0) || (len > p_conn->txSdu) || (p_data == NULL))
+    {
+        return TRSP_RES_INVALID_PARA;
+    }
+
+    if (p_conn->txWatch != 0)
+    {
+        return TRSP_RES_NO_RESOURCE;
+    }
+
+    sent = send(p_conn->fd, p_data, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (sent < 0)
+    {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == ENOBUFS))
+        {
+            p_conn->txWatch = g_io_add_watch(p_conn->p_io, G_IO_OUT, ble_trcbp_TxCb, p_conn);
+            return TRSP_RES_NO_RESOURCE;
+        }
+        return TRSP_RES_FAIL;
+    }
+
+    if (p_conn->pendingIdle == 0)
+    {
+        p_conn->pendingIdle = g_idle_add(ble_trcbp_TxCompleteCb, p_conn);
+    }
+
+    return TRSP_RES_SUCCESS;
+}
+
+void BLE_TRCBP_GetDataLength(GDBusProxy *p_proxyDev, uint16_t *p_dataLength)
+{
+    BLE_TRCBP_ConnList_T *p_conn = NULL;
+
+    p_conn = ble_trcbp_GetConnListByProxy(p_proxyDev);
+    if ((p_conn != NULL) && ((p_conn->inputQueue.usedNum) > 0U))
+    {
+        *p_dataLength = p_conn->inputQueue.packetList[p_conn->inputQueue.readIndex].length;
+    }
+    else
+    {
+        *p_dataLength = 0;
+    }
+}
+
+uint16_t BLE_TRCBP_GetData(GDBusProxy *p_proxyDev, uint8_t *p_data)
+{
+    BLE_TRCBP_ConnList_T *p_conn = NULL;
+
+    p_conn = ble_trcbp_GetConnListByProxy(p_proxyDev);
+    if ((p_conn == NULL) || ((p_conn->inputQueue.usedNum) == 0U))
+    {
+        return TRSP_RES_FAIL;
+    }
+
+    if (p_conn->inputQueue.packetList[p_conn->inputQueue.readIndex].p_packet != NULL)
+    {
+        (void)memcpy(p_data, p_conn->inputQueue.packetList[p_conn->inputQueue.readIndex].p_packet,
+            p_conn->inputQueue.packetList[p_conn->inputQueue.readIndex].length);
+        g_free(p_conn->inputQueue.packetList[p_conn->inputQueue.readIndex].p_packet);
+        p_conn->inputQueue.packetList[p_conn->inputQueue.readIndex].p_packet = NULL;
+    }
+
+    p_conn->inputQueue.readIndex++;
+    if (p_conn->inputQueue.readIndex >= BLE_TRCBP_INPUT_QUEUE_NUM)
+    {
+        p_conn->inputQueue.readIndex = 0;
+    }
+
+    p_conn->inputQueue.usedNum--;
+
+    /* Resume reading the socket, the kernel returns the credits to the peer as the data is consumed. */
+    if (p_conn->state == BLE_TRCBP_STATE_CONNECTED)
+    {
+        ble_trcbp_WatchRx(p_conn);
+    }
+
+    return TRSP_RES_SUCCESS;
+}
@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  BLE Transparent Credit Based Profile Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    ble_trcbp.h
+
+  Summary:
+    This file contains the BLE Transparent Credit Based Profile functions for application user.
+
+  Description:
+    This file contains the BLE Transparent Credit Based Profile functions for application user.
+    The data channel is carried by an LE L2CAP connection-oriented channel (CoC) socket.
+    The LE credits are managed by the kernel: a channel stops accepting data when the peer
+    runs out of credits and the kernel withholds credits while the input queue is full.
+ *******************************************************************************/
+/** @addtogroup BLE_PROFILE BLE Profile
+ *  @{ */
+
+/**
+ * @defgroup BLE_TRCBP Transparent Credit Based Profile (TRCBP)
+ * @brief Transparent Credit Based Profile (TRCBP)
+ * @{
+ * @brief Header file for the BLE Transparent Credit Based Profile library.
+ * @note Definitions and prototypes for the BLE Transparent Credit Based profile stack layer application programming interface.
+ */
+#ifndef BLE_TRCBP_H
+#define BLE_TRCBP_H
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gdbus/gdbus.h"
+
+
+// DOM-IGNORE-BEGIN
+#ifdef __cplusplus  // Provide C++ Compatibility
+
+extern "C" {
+
+#endif
+// DOM-IGNORE-END
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+/**@addtogroup BLE_TRCBP_DEFINES Defines
+ * @{ */
+
+/**@defgroup BLE_TRCBP_MAX_CONN_NBR Maximum connection number
+ * @brief The definition of Memory size. The connection table is sized at runtime, see @ref BLE_TRCBP_SetMaxConnNbr.
+ * @{ */
+#define BLE_TRCBP_MAX_CONN_NBR                  (0x06U)    /**< Default allowing Conncetion Numbers for the device. */
+#define BLE_TRCBP_CONN_NBR_LIMIT                (0x40U)    /**< Upper limit of the allowing Conncetion Numbers. */
+/** @} */
+
+/**@defgroup BLE_TRCBP_PSM_SDU Default channel parameters
+ * @brief The definition of default channel parameters.
+ * @{ */
+#define BLE_TRCBP_DEFAULT_PSM                   (0x0081U)  /**< Default LE PSM, in the dynamic range 0x0080 - 0x00FF. */
+#define BLE_TRCBP_DEFAULT_SDU                   (0x0800U)  /**< Default receive SDU size. */
+#define BLE_TRCBP_MIN_SDU                       (0x0017U)  /**< Minimum SDU size of an LE credit based channel. */
+/** @} */
+
+/**@defgroup BLE_TRCBP_QUEUE_NUM Input queue size
+ * @brief The definition of the input queue size.
+ * @{ */
+#define BLE_TRCBP_INPUT_QUEUE_NUM               (0x10U)    /**< Number of received SDUs queued before the socket stops being read. */
+/** @} */
+
+/**@} */ //BLE_TRCBP_DEFINES
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+/**@addtogroup BLE_TRCBP_ENUMS Enumerations
+ * @{ */
+
+/**@brief Enumeration type of BLE transparent credit based profile callback events. */
+typedef enum BLE_TRCBP_EventId_T
+{
+    BLE_TRCBP_EVT_NULL = 0x00U,
+    BLE_TRCBP_EVT_CONN_IND,                             /**< Incoming channel accepted on the listening PSM. See @ref BLE_TRCBP_EvtConnInd_T for event details. */
+    BLE_TRCBP_EVT_CONNECTED,                            /**< Channel established. See @ref BLE_TRCBP_EvtConnected_T for event details. */
+    BLE_TRCBP_EVT_DISCONNECTED,                         /**< Channel closed. See @ref BLE_TRCBP_EvtDev_T for event details. */
+    BLE_TRCBP_EVT_RECEIVE_DATA,                         /**< SDU received and queued. See @ref BLE_TRCBP_EvtDev_T for event details. */
+    BLE_TRCBP_EVT_TX_COMPLETE,                          /**< Sent SDUs are handed to the kernel, at most one event per main loop iteration. See @ref BLE_TRCBP_EvtDev_T for event details. */
+    BLE_TRCBP_EVT_CREDIT,                               /**< The channel accepts data again after @ref BLE_TRCBP_SendData returned TRSP_RES_NO_RESOURCE. See @ref BLE_TRCBP_EvtDev_T for event details. */
+    BLE_TRCBP_EVT_ERR_NO_MEM,                           /**< Profile internal error occurs due to insufficient heap memory. */
+    BLE_TRCBP_EVT_END
+} BLE_TRCBP_EventId_T;
+
+/**@} */ //BLE_TRCBP_ENUMS
+
+/**@addtogroup BLE_TRCBP_STRUCTS Structures
+ * @{ */
+
+/**@brief Data structure for @ref BLE_TRCBP_EVT_CONN_IND event. */
+typedef struct BLE_TRCBP_EvtConnInd_T
+{
+    const char       *p_address;                        /**< Peer address string. */
+    bool             isRandom;                          /**< Peer address is a random address. */
+    GDBusProxy       *p_dev;                            /**< Set by the application to the proxy of the peer device. The channel is closed if it is left NULL. */
+}   BLE_TRCBP_EvtConnInd_T;
+
+/**@brief Data structure for @ref BLE_TRCBP_EVT_CONNECTED event. */
+typedef struct BLE_TRCBP_EvtConnected_T
+{
+    GDBusProxy       *p_dev;                            /**< Proxy associated with this remote device interface. */
+    uint16_t         txSdu;                             /**< Maximum SDU size accepted by the peer. */
+    uint16_t         rxSdu;                             /**< Maximum SDU size accepted locally. */
+}   BLE_TRCBP_EvtConnected_T;
+
+/**@brief Data structure for events that only carry the device. */
+typedef struct BLE_TRCBP_EvtDev_T
+{
+    GDBusProxy       *p_dev;                            /**< Proxy associated with this remote device interface. */
+}   BLE_TRCBP_EvtDev_T;
+
+/**@brief The union of BLE Transparent credit based profile event types. */
+typedef union
+{
+    BLE_TRCBP_EvtConnInd_T          onConnInd;          /**< Handle @ref BLE_TRCBP_EVT_CONN_IND. */
+    BLE_TRCBP_EvtConnected_T        onConnected;        /**< Handle @ref BLE_TRCBP_EVT_CONNECTED. */
+    BLE_TRCBP_EvtDev_T              onDisconnected;     /**< Handle @ref BLE_TRCBP_EVT_DISCONNECTED. */
+    BLE_TRCBP_EvtDev_T              onReceiveData;      /**< Handle @ref BLE_TRCBP_EVT_RECEIVE_DATA. */
+    BLE_TRCBP_EvtDev_T              onTxComplete;       /**< Handle @ref BLE_TRCBP_EVT_TX_COMPLETE. */
+    BLE_TRCBP_EvtDev_T              onCredit;           /**< Handle @ref BLE_TRCBP_EVT_CREDIT. */
+} BLE_TRCBP_EventField_T;
+
+/**@brief BLE Transparent credit based profile callback event. */
+typedef struct  BLE_TRCBP_Event_T
+{
+    BLE_TRCBP_EventId_T         eventId;                /**< Event ID.*/
+    BLE_TRCBP_EventField_T      eventField;             /**< Event field. */
+} BLE_TRCBP_Event_T;
+
+/**@brief BLE Transparent credit based profile callback type. This callback function sends BLE Transparent credit based profile events to the application. */
+typedef void(*BLE_TRCBP_EventCb_T)(BLE_TRCBP_Event_T *p_event);
+
+/**@} */ //BLE_TRCBP_STRUCTS
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+/**@addtogroup BLE_TRCBP_FUNS Functions
+ * @{ */
+
+/**@brief Initialize TRCBP profile.
+ *
+ */
+void BLE_TRCBP_Init(void);
+
+/**@brief Set the number of channels the profile can serve. The connection table is allocated
+ *        with this size by the first @ref BLE_TRCBP_Init and is not resized afterwards.
+ *
+ * @param[in] connNbr                       Number of channels, from 1 to @ref BLE_TRCBP_CONN_NBR_LIMIT.
+ *
+ * @retval TRSP_RES_SUCCESS                 Successfully set the number of channels.
+ * @retval TRSP_RES_INVALID_PARA            The number is out of range.
+ * @retval TRSP_RES_BAD_STATE               The connection table is already allocated.
+ *
+ */
+uint16_t BLE_TRCBP_SetMaxConnNbr(uint8_t connNbr);
+
+/**@brief Register BLE Transparent credit based profile callback.
+ *
+ * @param[in] bleTrcbpHandler               Callback function.
+ *
+ */
+void BLE_TRCBP_EventRegister(BLE_TRCBP_EventCb_T bleTrcbpHandler);
+
+/**@brief Listen for incoming channels. A previous listening socket is closed.
+ *
+ * @param[in] psm                           LE PSM. 0 to stop listening.
+ * @param[in] sdu                           Receive SDU size of accepted channels.
+ *
+ * @retval TRSP_RES_SUCCESS                  Listening.
+ * @retval TRSP_RES_FAIL                     The socket can not be created or bound.
+ *
+ */
+uint16_t BLE_TRCBP_Listen(uint16_t psm, uint16_t sdu);
+
+/**@brief Open a channel to a connected peer. @ref BLE_TRCBP_EVT_CONNECTED is sent when established.
+ *
+ * @param[in] p_proxyDev                    Proxy associated with the remote device interface
+ * @param[in] p_address                     Peer address string.
+ * @param[in] isRandom                      Peer address is a random address.
+ * @param[in] psm                           LE PSM of the peer.
+ * @param[in] sdu                           Receive SDU size.
+ *
+ * @retval TRSP_RES_SUCCESS                  Connecting.
+ * @retval TRSP_RES_FAIL                     The socket can not be created or connected.
+ * @retval TRSP_RES_NO_RESOURCE              No free channel.
+ * @retval TRSP_RES_BAD_STATE                A channel to the peer exists.
+ *
+ */
+uint16_t BLE_TRCBP_Connect(GDBusProxy *p_proxyDev, const char *p_address, bool isRandom, uint16_t psm, uint16_t sdu);
+
+/**@brief Attach a connected sequential packet socket as the channel of a device. The profile owns the socket afterwards.
+ *        @ref BLE_TRCBP_EVT_CONNECTED is sent from the main loop.
+ *
+ * @param[in] p_proxyDev                    Proxy associated with the remote device interface
+ * @param[in] fd                            Socket descriptor.
+ * @param[in] txSdu                         Maximum SDU size accepted by the peer.
+ * @param[in] rxSdu                         Maximum SDU size accepted locally.
+ *
+ * @retval TRSP_RES_SUCCESS                  Attached.
+ * @retval TRSP_RES_NO_RESOURCE              No free channel.
+ * @retval TRSP_RES_BAD_STATE                A channel to the peer exists.
+ *
+ */
+uint16_t BLE_TRCBP_Attach(GDBusProxy *p_proxyDev, int fd, uint16_t txSdu, uint16_t rxSdu);
+
+/**@brief Connect two devices back to back over a local socketpair instead of L2CAP.
+ *        Data sent on one device is received on the other, for testing without a controller.
+ *
+ * @param[in] p_proxyDevA                   Proxy of the first device.
+ * @param[in] p_proxyDevB                   Proxy of the second device.
+ * @param[in] sdu                           SDU size of both ends.
+ *
+ * @retval TRSP_RES_SUCCESS                  Connected.
+ * @retval TRSP_RES_FAIL                     The socketpair can not be created.
+ * @retval TRSP_RES_NO_RESOURCE              No free channel.
+ * @retval TRSP_RES_BAD_STATE                A channel to one of the devices exists.
+ *
+ */
+uint16_t BLE_TRCBP_CreateLocalPair(GDBusProxy *p_proxyDevA, GDBusProxy *p_proxyDevB, uint16_t sdu);
+
+/**@brief Close the channel of a device. @ref BLE_TRCBP_EVT_DISCONNECTED is sent if it was established.
+ *
+ * @param[in] p_proxyDev                    Proxy associated with the remote device interface
+ *
+ */
+void BLE_TRCBP_Disconnect(GDBusProxy *p_proxyDev);
+
+/**@brief Check whether the channel of a device is established.
+ *
+ * @param[in] p_proxyDev                    Proxy associated with the remote device interface
+ *
+ * @retval true                              Established.
+ * @retval false                             No channel or connecting.
+ *
+ */
+bool BLE_TRCBP_IsConnected(GDBusProxy *p_proxyDev);
+
+/**@brief Send one SDU.
+ *
+ * @param[in] p_proxyDev                    Proxy associated with the remote device interface
+ * @param[in] len                           Data length, up to the txSdu of @ref BLE_TRCBP_EVT_CONNECTED.
+ * @param[in] p_data                        Pointer to the transparent data.
+ *
+ * @retval TRSP_RES_SUCCESS                  Queued in the kernel.
+ * @retval TRSP_RES_NO_RESOURCE              The channel is out of credits or buffer, wait for @ref BLE_TRCBP_EVT_CREDIT.
+ * @retval TRSP_RES_INVALID_PARA             Parameter does not meet the spec.
+ * @retval TRSP_RES_FAIL                     No established channel or socket error.
+ *
+ */
+uint16_t BLE_TRCBP_SendData(GDBusProxy *p_proxyDev, uint16_t len, uint8_t *p_data);
+
+/**@brief Get queued data length.
+ *
+ * @param[in] p_proxyDev                    Device proxy associated with the queued data
+ * @param[out] p_dataLength                 Data length.
+ *
+ */
+void BLE_TRCBP_GetDataLength(GDBusProxy *p_proxyDev, uint16_t *p_dataLength);
+
+/**@brief Get queued data.
+ *
+ * @param[in] p_proxyDev                    Device proxy associated with the queued data
+ * @param[out] p_data                       Pointer to the data buffer.
+ *
+ * @retval TRSP_RES_SUCCESS                  Successfully get the data.
+ * @retval TRSP_RES_FAIL                     No data in the input queue.
+ *
+ */
+uint16_t BLE_TRCBP_GetData(GDBusProxy *p_proxyDev, uint8_t *p_data);
+
+/**@} */ //BLE_TRCBP_FUNS
+
+
+//DOM-IGNORE-BEGIN
+#ifdef __cplusplus
+}
+#endif
+//DOM-IGNORE-END
+
+#endif
+
+/** @} */
+
+/**
+  @}
+ */
@@ -41,6 +41,7 @@
 
 #include "ble_trspc.h"
 #include "ble_trsp_defs.h"
+#include "dbus_stat/dbus_stat.h"
 
 // *****************************************************************************
 // *****************************************************************************
@@ -75,6 +76,12 @@
 #define BLE_TRSPC_MAX_RETURN_CREDIT             (13U)     /**< Maximum return credit number */
 /** @} */
 
+/**@defgroup BLE_TRSPC_DEFAULT_LOW_WATERMARK BLE_TRSPC_DEFAULT_LOW_WATERMARK
+ * @brief The definition of default credit return low watermark. 0 disables the early return.
+ * @{ */
+#define BLE_TRSPC_DEFAULT_LOW_WATERMARK         (0U)      /**< Default credit return low watermark */
+/** @} */
+
 /**@defgroup BLE_TRSPC_CBFC_PROC BLE_TRSPC_CBFC_PROC
  * @brief The definition of CBFC procedure in connect/disconnect process.
  * @{ */
@@ -186,6 +193,13 @@ typedef struct BLE_TRSPC_ConnList_T
     BLE_TRSPC_State_T           state;                  /**< Connection state. */
     uint8_t                     retryCnt;               /**< Retry counter. */
     uint8_t                     updatingPeerCredit;     /**< The updating peer credit. If updatingPeerCredit > 0, the client return credit procedure is in progress */
+    uint8_t                     grantedCredit;          /**< Credits returned to the server and not used yet. */
+    gint64                      zeroStartUs;            /**< Time the server ran out of credits, 0 if it holds credits. */
+    uint32_t                    creditReturns;          /**< Number of credit returns acknowledged. */
+    uint32_t                    zeroCount;              /**< Number of times the server ran out of credits. */
+    uint64_t                    zeroTimeUs;             /**< Total time the server was out of credits in us. */
+    uint32_t                    maxZeroUs;              /**< Longest time the server was out of credits in us. */
+    bool                        dataWriteCmd;           /**< Send data with Write Without Response on the non credit based downlink. */
 } BLE_TRSPC_ConnList_T;
 
 typedef struct BLE_TRSPC_MethodData_T
@@ -216,13 +230,32 @@ typedef struct BLE_TRSPC_ProxyCache_T
 // *****************************************************************************
 // *****************************************************************************
 static BLE_TRSPC_EventCb_T      bleTrspcProcess;
-static BLE_TRSPC_ConnList_T     s_trspcConnList[BLE_TRSPC_MAX_CONN_NBR];
+static BLE_TRSPC_ConnList_T     *sp_trspcConnList = NULL;   /**< Connection table, allocated once by BLE_TRSPC_Init(). */
+static uint8_t                  s_trspcMaxConnNbr = BLE_TRSPC_MAX_CONN_NBR;  /**< Number of entries in the connection table. */
+static uint8_t                  *sp_trspcFreeNext = NULL;   /**< Next free entry of each free entry, s_trspcMaxConnNbr ends the list. */
+static uint8_t                  s_trspcFreeHead;             /**< First free entry, s_trspcMaxConnNbr when the table is full. */
+static GHashTable               *sp_trspcConnByProxy = NULL; /**< Connected entries by device proxy. */
+static GHashTable               *sp_trspcConnByChrc = NULL;  /**< Connected entries by TUD and TCP characteristic proxy. */
 
 static BLE_TRSPC_ProxyCache_T   s_trspcCache;
+static uint8_t                  s_trspcLowWatermark = BLE_TRSPC_DEFAULT_LOW_WATERMARK;
+static bool                     s_trspcCreditOverlap;
 
 static void ble_trspc_WriteReply(DBusMessage *p_message, void *p_userData);
 static void ble_trspc_WriteSetup(DBusMessageIter *p_iter, void *p_userData);
 
+static gboolean ble_trspc_MethodCall(GDBusProxy *p_proxy, const char *p_method, GDBusSetupFunction setup, GDBusReturnFunction reply, void *p_userData)
+{
+    uint64_t startNs;
+    gboolean result;
+
+    startNs = DBUS_STAT_Begin();
+    result = g_dbus_proxy_method_call(p_proxy, p_method, setup, reply, p_userData, NULL);
+    DBUS_STAT_End(DBUS_STAT_TYPE_METHOD_CALL, p_method, startNs);
+
+    return result;
+}
+
 static void ble_trspc_ConveyErrEvt(BLE_TRSPC_EventId_T evtId)
 {
     if (bleTrspcProcess != NULL)
@@ -279,33 +312,46 @@ static void ble_trspc_InitConnList(BLE_TRSPC_ConnList_T *p_conn)
 
 static BLE_TRSPC_ConnList_T *ble_trspc_GetConnListByProxy(GDBusProxy *p_dev)
 {
-    uint8_t i;
-
-    for(i=0; i<BLE_TRSPC_MAX_CONN_NBR; i++)
+    if (sp_trspcConnByProxy == NULL)
     {
-        if ((s_trspcConnList[i].state == BLE_TRSPC_STATE_CONNECTED) && (s_trspcConnList[i].p_dev == p_dev))
-        {
-            return &s_trspcConnList[i];
-        }
+        return NULL;
     }
 
-    return NULL;
+    return g_hash_table_lookup(sp_trspcConnByProxy, p_dev);
 }
 
 static BLE_TRSPC_ConnList_T *ble_trspc_GetFreeConnList(void)
 {
-    uint8_t i;
+    uint8_t index = s_trspcFreeHead;
 
-    for(i=0; i<BLE_TRSPC_MAX_CONN_NBR; i++)
+    if ((sp_trspcConnList == NULL) || (index >= s_trspcMaxConnNbr))
     {
-        if (s_trspcConnList[i].state == BLE_TRSPC_STATE_IDLE)
-        {
-            s_trspcConnList[i].state = BLE_TRSPC_STATE_CONNECTED;
-            return &s_trspcConnList[i];
-        }
+        return NULL;
     }
 
-    return NULL;
+    s_trspcFreeHead = sp_trspcFreeNext[index];
+    sp_trspcConnList[index].state = BLE_TRSPC_STATE_CONNECTED;
+
+    return &sp_trspcConnList[index];
+}
+
+static void ble_trspc_FreeConnList(BLE_TRSPC_ConnList_T *p_conn)
+{
+    uint8_t index = (uint8_t)(p_conn - sp_trspcConnList);
+
+    g_hash_table_remove(sp_trspcConnByProxy, p_conn->p_dev);
+    if (p_conn->chrc[TRSPC_INDEX_CHARTUD] != NULL)
+    {
+        g_hash_table_remove(sp_trspcConnByChrc, p_conn->chrc[TRSPC_INDEX_CHARTUD]);
+    }
+    if (p_conn->chrc[TRSPC_INDEX_CHARTCP] != NULL)
+    {
+        g_hash_table_remove(sp_trspcConnByChrc, p_conn->chrc[TRSPC_INDEX_CHARTCP]);
+    }
+    ble_trspc_InitConnList(p_conn);
+
+    sp_trspcFreeNext[index] = s_trspcFreeHead;
+    s_trspcFreeHead = index;
 }
 
 
@@ -332,7 +378,7 @@ static void ble_trspc_EnableDownlinkCreditBaseFlowControl(BLE_TRSPC_ConnList_T *
     p_data->p_type = "request";
     p_data->caller = BLE_TRSPC_MD_CALLER_CBFC;
     
-    if (g_dbus_proxy_method_call(p_conn->chrc[TRSPC_INDEX_CHARTCP], "WriteValue", ble_trspc_WriteSetup, ble_trspc_WriteReply, p_data, NULL))
+    if (ble_trspc_MethodCall(p_conn->chrc[TRSPC_INDEX_CHARTCP], "WriteValue", ble_trspc_WriteSetup, ble_trspc_WriteReply, p_data))
     {
         p_conn->cbfcProcedure = CBFC_PROC_ENABLE_TDD_CBFC;
         p_conn->cbfcRetryProcedure = CBFC_PROC_ENABLE_TCP_CCCD;
@@ -358,7 +404,7 @@ static void ble_trspc_EnableControlPointCccd(BLE_TRSPC_ConnList_T *p_conn)
     p_data->p_conn = p_conn;
     p_data->caller = BLE_TRSPC_MD_CALLER_CBFC;
     
-    if (g_dbus_proxy_method_call(p_conn->chrc[TRSPC_INDEX_CHARTCP], "StartNotify", NULL, ble_trspc_WriteReply, p_data, NULL))
+    if (ble_trspc_MethodCall(p_conn->chrc[TRSPC_INDEX_CHARTCP], "StartNotify", NULL, ble_trspc_WriteReply, p_data))
     {
         p_conn->cbfcProcedure = CBFC_PROC_ENABLE_TCP_CCCD;
         p_conn->cbfcRetryProcedure = CBFC_PROC_ENABLE_SESSION;
@@ -397,10 +443,10 @@ static void ble_trspc_ClientReturnCredit(BLE_TRSPC_ConnList_T *p_conn)
     p_data->p_conn = p_conn;
     p_data->iov.iov_base = charValue;
     p_data->iov.iov_len = 2;
-    p_data->p_type = "request";
+    p_data->p_type = s_trspcCreditOverlap ? "command" : "request";
     p_data->caller = BLE_TRSPC_MD_CALLER_CREDIT;
     
-    if (!g_dbus_proxy_method_call(p_conn->chrc[TRSPC_INDEX_CHARTCP], "WriteValue", ble_trspc_WriteSetup, ble_trspc_WriteReply, p_data, NULL))
+    if (!ble_trspc_MethodCall(p_conn->chrc[TRSPC_INDEX_CHARTCP], "WriteValue", ble_trspc_WriteSetup, ble_trspc_WriteReply, p_data))
     {
         ble_trspc_ConveyErrEvt(BLE_TRSPC_EVT_ERR_UNSPECIFIED);
     }
@@ -410,6 +456,15 @@ static void ble_trspc_ClientReturnCredit(BLE_TRSPC_ConnList_T *p_conn)
     }
 }
 
+static void ble_trspc_CheckReturnCredit(BLE_TRSPC_ConnList_T *p_conn)
+{
+    if ((p_conn->peerCredit >= BLE_TRSPC_MAX_RETURN_CREDIT)
+        || ((s_trspcLowWatermark > 0U) && (p_conn->peerCredit > 0U) && (p_conn->grantedCredit <= s_trspcLowWatermark)))
+    {
+        ble_trspc_ClientReturnCredit(p_conn);
+    }
+}
+
 static void ble_trspc_ConfigureUplinkDataCccd(BLE_TRSPC_ConnList_T *p_conn, bool enable)
 {
 
@@ -435,7 +490,7 @@ static void ble_trspc_ConfigureUplinkDataCccd(BLE_TRSPC_ConnList_T *p_conn, bool
     p_data->p_conn = p_conn;
     p_data->caller = BLE_TRSPC_MD_CALLER_CBFC;
 
-    if (g_dbus_proxy_method_call(p_conn->chrc[TRSPC_INDEX_CHARTUD], p_method, NULL, ble_trspc_WriteReply, p_data, NULL))
+    if (ble_trspc_MethodCall(p_conn->chrc[TRSPC_INDEX_CHARTUD], p_method, NULL, ble_trspc_WriteReply, p_data))
     {
         if (enable)
         {
@@ -485,6 +540,20 @@ static void ble_trspc_RcvData(BLE_TRSPC_ConnList_T *p_conn, uint16_t receivedLen
 
         p_conn->inputQueue.usedNum++;
 
+        if (((p_conn->trspState & BLE_TRSPC_UL_STATUS_CBFCENABLED) != 0U) && (p_conn->grantedCredit > 0U))
+        {
+            p_conn->grantedCredit--;
+            if (p_conn->grantedCredit == 0U)
+            {
+                p_conn->zeroStartUs = g_get_monotonic_time();
+                p_conn->zeroCount++;
+            }
+            else if (p_conn->updatingPeerCredit == 0U)
+            {
+                ble_trspc_CheckReturnCredit(p_conn);
+            }
+        }
+
         evtPara.eventId = BLE_TRSPC_EVT_RECEIVE_DATA;
         evtPara.eventField.onReceiveData.p_dev = p_conn->p_dev;
         if (bleTrspcProcess != NULL)
@@ -605,6 +674,8 @@ static void ble_trspc_ProcCbfcReply(BLE_TRSPC_ConnList_T *p_conn)
 
             /* Reset credit */
             p_conn->peerCredit = 0;
+            p_conn->grantedCredit = 0;
+            p_conn->zeroStartUs = 0;
         }
         break;
         default:
@@ -631,12 +702,23 @@ static void ble_trspc_ProcGattWriteResp(BLE_TRSPC_ConnList_T *p_conn, uint8_t ca
             if (p_conn->updatingPeerCredit <= p_conn->peerCredit)
             {
                 p_conn->peerCredit -= p_conn->updatingPeerCredit;
+                p_conn->grantedCredit += p_conn->updatingPeerCredit;
                 p_conn->updatingPeerCredit = 0;
+                p_conn->creditReturns++;
 
-                if (p_conn->peerCredit >= BLE_TRSPC_MAX_RETURN_CREDIT)
+                if (p_conn->zeroStartUs != 0)
                 {
-                    ble_trspc_ClientReturnCredit(p_conn);
+                    gint64 zeroUs = g_get_monotonic_time() - p_conn->zeroStartUs;
+
+                    p_conn->zeroTimeUs += zeroUs;
+                    if (zeroUs > p_conn->maxZeroUs)
+                    {
+                        p_conn->maxZeroUs = (uint32_t)zeroUs;
+                    }
+                    p_conn->zeroStartUs = 0;
                 }
+
+                ble_trspc_CheckReturnCredit(p_conn);
             }
             else /* should not be here */
             {
@@ -891,19 +973,121 @@ void BLE_TRSPC_EventRegister(BLE_TRSPC_EventCb_T bleTranCliHandler)
     bleTrspcProcess = bleTranCliHandler;
 }
 
+uint16_t BLE_TRSPC_SetMaxConnNbr(uint8_t connNbr)
+{
+    if ((connNbr == 0U) || (connNbr > BLE_TRSPC_CONN_NBR_LIMIT))
+    {
+        return TRSP_RES_INVALID_PARA;
+    }
+
+    if (sp_trspcConnList != NULL)
+    {
+        return TRSP_RES_BAD_STATE;
+    }
+
+    s_trspcMaxConnNbr = connNbr;
+
+    return TRSP_RES_SUCCESS;
+}
+
 void BLE_TRSPC_Init(void)
 {
     uint8_t i;
 
+    if (sp_trspcConnList == NULL)
+    {
+        sp_trspcConnList = g_new0(BLE_TRSPC_ConnList_T, s_trspcMaxConnNbr);
+        sp_trspcFreeNext = g_new0(uint8_t, s_trspcMaxConnNbr);
+        sp_trspcConnByProxy = g_hash_table_new(g_direct_hash, g_direct_equal);
+        sp_trspcConnByChrc = g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+
+    g_hash_table_remove_all(sp_trspcConnByProxy);
+    g_hash_table_remove_all(sp_trspcConnByChrc);
+
     /* Reset connection information */
-    for (i = 0; i < BLE_TRSPC_MAX_CONN_NBR; i++)
+    for (i = 0; i < s_trspcMaxConnNbr; i++)
     {
-        ble_trspc_InitConnList(&s_trspcConnList[i]);
+        ble_trspc_InitConnList(&sp_trspcConnList[i]);
+        sp_trspcFreeNext[i] = i + 1U;
     }
+    s_trspcFreeHead = 0;
 
     (void)memset(&s_trspcCache, 0x00, sizeof(s_trspcCache));
 }
 
+uint16_t BLE_TRSPC_SetCreditReturn(uint8_t lowWatermark, bool overlap)
+{
+    if (lowWatermark >= BLE_TRSPC_INIT_CREDIT)
+    {
+        return TRSP_RES_INVALID_PARA;
+    }
+
+    s_trspcLowWatermark = lowWatermark;
+    s_trspcCreditOverlap = overlap;
+
+    return TRSP_RES_SUCCESS;
+}
+
+void BLE_TRSPC_GetCreditReturn(uint8_t *p_lowWatermark, bool *p_overlap)
+{
+    *p_lowWatermark = s_trspcLowWatermark;
+    *p_overlap = s_trspcCreditOverlap;
+}
+
+uint16_t BLE_TRSPC_GetCreditStat(GDBusProxy *p_proxyDev, BLE_TRSPC_CreditStat_T *p_stat)
+{
+    BLE_TRSPC_ConnList_T *p_conn;
+
+    p_conn = ble_trspc_GetConnListByProxy(p_proxyDev);
+    if (p_conn == NULL)
+    {
+        return TRSP_RES_FAIL;
+    }
+
+    p_stat->grantedCredit = p_conn->grantedCredit;
+    p_stat->returns = p_conn->creditReturns;
+    p_stat->zeroCount = p_conn->zeroCount;
+    p_stat->zeroTimeUs = p_conn->zeroTimeUs;
+    p_stat->maxZeroUs = p_conn->maxZeroUs;
+
+    //Count the ongoing period as well
+    if (p_conn->zeroStartUs != 0)
+    {
+        gint64 zeroUs = g_get_monotonic_time() - p_conn->zeroStartUs;
+
+        p_stat->zeroTimeUs += zeroUs;
+        if (zeroUs > p_stat->maxZeroUs)
+        {
+            p_stat->maxZeroUs = (uint32_t)zeroUs;
+        }
+    }
+
+    return TRSP_RES_SUCCESS;
+}
+
+void BLE_TRSPC_ResetCreditStat(void)
+{
+    uint8_t i;
+
+    if (sp_trspcConnList == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < s_trspcMaxConnNbr; i++)
+    {
+        sp_trspcConnList[i].creditReturns = 0;
+        sp_trspcConnList[i].zeroCount = (sp_trspcConnList[i].zeroStartUs != 0) ? 1 : 0;
+        sp_trspcConnList[i].zeroTimeUs = 0;
+        sp_trspcConnList[i].maxZeroUs = 0;
+        if (sp_trspcConnList[i].zeroStartUs != 0)
+        {
+            sp_trspcConnList[i].zeroStartUs = g_get_monotonic_time();
+        }
+    }
+}
+
 void BLE_TRSPC_DevConnected(GDBusProxy *p_proxyDev)
 {
     BLE_TRSPC_ConnList_T    *p_conn;
@@ -912,6 +1096,7 @@ void BLE_TRSPC_DevConnected(GDBusProxy *p_proxyDev)
     if(p_conn!=NULL)
     {
         p_conn->p_dev=p_proxyDev;
+        g_hash_table_insert(sp_trspcConnByProxy, p_proxyDev, p_conn);
     }
 }
 
@@ -940,7 +1125,7 @@ void BLE_TRSPC_DevDisconnected(GDBusProxy *p_proxyDev)
         
             p_conn->inputQueue.usedNum--;
         }
-        ble_trspc_InitConnList(p_conn);
+        ble_trspc_FreeConnList(p_conn);
     }
 
 }
@@ -1060,6 +1245,9 @@ void BLE_TRSPC_PropertyHandler(GDBusProxy *p_proxy, const char *p_name, DBusMess
                 {
                         return;
                 }
+
+                g_hash_table_insert(sp_trspcConnByChrc, p_conn->chrc[TRSPC_INDEX_CHARTUD], p_conn);
+                g_hash_table_insert(sp_trspcConnByChrc, p_conn->chrc[TRSPC_INDEX_CHARTCP], p_conn);
                 
                 if (bleTrspcProcess != NULL)
                 {
@@ -1078,25 +1266,23 @@ void BLE_TRSPC_PropertyHandler(GDBusProxy *p_proxy, const char *p_name, DBusMess
     {
         if (strcmp(g_dbus_proxy_get_interface(p_proxy), "org.bluez.GattCharacteristic1") == 0)
         {
-            uint8_t i;               
+            BLE_TRSPC_ConnList_T * p_conn;
             DBusMessageIter  array;
             uint8_t *p_value;
             int len;
             dbus_message_iter_recurse(p_iter, &array);
             dbus_message_iter_get_fixed_array(&array, &p_value, &len);
 
-            for(i=0; i<BLE_TRSPC_MAX_CONN_NBR; i++)
+            p_conn = (sp_trspcConnByChrc != NULL) ? g_hash_table_lookup(sp_trspcConnByChrc, p_proxy) : NULL;
+            if (p_conn != NULL)
             {
-                if (s_trspcConnList[i].state == BLE_TRSPC_STATE_CONNECTED)
-                {
-                   if (s_trspcConnList[i].chrc[TRSPC_INDEX_CHARTUD] == p_proxy)
-                   {
-                        ble_trspc_RcvData(&s_trspcConnList[i], len, p_value);
-                   }
-                   else if (s_trspcConnList[i].chrc[TRSPC_INDEX_CHARTCP] == p_proxy)
-                   {
-                        ble_trspc_RcvCtrlData(&s_trspcConnList[i], len, p_value);
-                   }
+               if (p_conn->chrc[TRSPC_INDEX_CHARTUD] == p_proxy)
+               {
+                    ble_trspc_RcvData(p_conn, len, p_value);
+               }
+               else if (p_conn->chrc[TRSPC_INDEX_CHARTCP] == p_proxy)
+               {
+                    ble_trspc_RcvCtrlData(p_conn, len, p_value);
                }
            }
        }
@@ -1157,7 +1343,7 @@ uint16_t BLE_TRSPC_SendVendorCommand(GDBusProxy *p_proxyDev, uint8_t commandID,
 
     
 
-    if (g_dbus_proxy_method_call(p_conn->chrc[TRSPC_INDEX_CHARTCP], "WriteValue", ble_trspc_WriteSetup, ble_trspc_WriteReply, p_data, NULL))
+    if (ble_trspc_MethodCall(p_conn->chrc[TRSPC_INDEX_CHARTCP], "WriteValue", ble_trspc_WriteSetup, ble_trspc_WriteReply, p_data))
     {
         p_conn->vendorCmdProc = VENCOM_PROC_ENABLE;
 
@@ -1211,7 +1397,8 @@ uint16_t BLE_TRSPC_SendData(GDBusProxy *p_proxyDev, uint16_t len, uint8_t *p_dat
     }
     else if ((p_conn->trspState & BLE_TRSPC_DL_STATUS_NONCBFCENABLED) != 0U)
     {
-        p_mdData->p_type = "request";
+        //The application recovers the lost packets itself when it asks for Write Without Response
+        p_mdData->p_type = p_conn->dataWriteCmd ? "command" : "request";
     }
     else
     {
@@ -1225,7 +1412,7 @@ uint16_t BLE_TRSPC_SendData(GDBusProxy *p_proxyDev, uint16_t len, uint8_t *p_dat
     p_mdData->caller = BLE_TRSPC_MD_CALLER_DATA;
 
 
-    if (g_dbus_proxy_method_call(p_conn->chrc[TRSPC_INDEX_CHARTDD], "WriteValue", ble_trspc_WriteSetup, ble_trspc_WriteReply, p_mdData, NULL))
+    if (ble_trspc_MethodCall(p_conn->chrc[TRSPC_INDEX_CHARTDD], "WriteValue", ble_trspc_WriteSetup, ble_trspc_WriteReply, p_mdData))
     {
         if ((p_conn->trspState & BLE_TRSPC_DL_STATUS_CBFCENABLED) != 0U)
         {
@@ -1241,6 +1428,34 @@ uint16_t BLE_TRSPC_SendData(GDBusProxy *p_proxyDev, uint16_t len, uint8_t *p_dat
     }
 }
 
+bool BLE_TRSPC_IsDlCreditBased(GDBusProxy *p_proxyDev)
+{
+    BLE_TRSPC_ConnList_T *p_conn;
+
+    p_conn = ble_trspc_GetConnListByProxy(p_proxyDev);
+    if (p_conn == NULL)
+    {
+        return false;
+    }
+
+    return ((p_conn->trspState & BLE_TRSPC_DL_STATUS_CBFCENABLED) != 0U);
+}
+
+uint16_t BLE_TRSPC_SetDataWriteCommand(GDBusProxy *p_proxyDev, bool enable)
+{
+    BLE_TRSPC_ConnList_T *p_conn;
+
+    p_conn = ble_trspc_GetConnListByProxy(p_proxyDev);
+    if (p_conn == NULL)
+    {
+        return TRSP_RES_FAIL;
+    }
+
+    p_conn->dataWriteCmd = enable;
+
+    return TRSP_RES_SUCCESS;
+}
+
 void BLE_TRSPC_GetDataLength(GDBusProxy *p_proxyDev, uint16_t *p_dataLength)
 {
     BLE_TRSPC_ConnList_T *p_conn = NULL;
@@ -1292,10 +1507,7 @@ uint16_t BLE_TRSPC_GetData(GDBusProxy *p_proxyDev, uint8_t *p_data)
             if ((p_conn->trspState & BLE_TRSPC_UL_STATUS_CBFCENABLED) != 0U)
             {
                 p_conn->peerCredit++;
-                if (p_conn->peerCredit >= BLE_TRSPC_MAX_RETURN_CREDIT)
-                {
-                    ble_trspc_ClientReturnCredit(p_conn);
-                }
+                ble_trspc_CheckReturnCredit(p_conn);
             }
 
             return TRSP_RES_SUCCESS;
@@ -42,6 +42,7 @@
 // *****************************************************************************
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "gdbus/gdbus.h"
 
 
@@ -62,9 +63,10 @@ extern "C" {
  * @{ */
 
 /**@defgroup BLE_TRSPC_MAX_CONN_NBR Maximum connection number
- * @brief The definition of Memory size.
+ * @brief The definition of Memory size. The connection table is sized at runtime, see @ref BLE_TRSPC_SetMaxConnNbr.
  * @{ */
-#define BLE_TRSPC_MAX_CONN_NBR                  (0x06U)    /**< Maximum allowing Conncetion Numbers for the device. */
+#define BLE_TRSPC_MAX_CONN_NBR                  (0x06U)    /**< Default allowing Conncetion Numbers for the device. */
+#define BLE_TRSPC_CONN_NBR_LIMIT                (0x40U)    /**< Upper limit of the allowing Conncetion Numbers. */
 /** @} */
 
 
@@ -205,6 +207,16 @@ typedef struct  BLE_TRSPC_Event_T
     BLE_TRSPC_EventField_T      eventField;             /**< Event field. */
 } BLE_TRSPC_Event_T;
 
+/**@brief Credit return statistics of one link. See @ref BLE_TRSPC_GetCreditStat. */
+typedef struct BLE_TRSPC_CreditStat_T
+{
+    uint8_t                     grantedCredit;      /**< Credits returned to the server and not used yet. */
+    uint32_t                    returns;            /**< Number of credit returns acknowledged. */
+    uint32_t                    zeroCount;          /**< Number of times the server ran out of credits. */
+    uint64_t                    zeroTimeUs;         /**< Total time the server was out of credits in us. */
+    uint32_t                    maxZeroUs;          /**< Longest time the server was out of credits in us. */
+} BLE_TRSPC_CreditStat_T;
+
 /**@brief BLE Transparent profile cliet callback type. This callback function sends BLE Transparent profile client events to the application. */
 typedef void(*BLE_TRSPC_EventCb_T)(BLE_TRSPC_Event_T *p_event);
 
@@ -224,6 +236,18 @@ typedef void(*BLE_TRSPC_EventCb_T)(BLE_TRSPC_Event_T *p_event);
  */
 void BLE_TRSPC_Init(void);
 
+/**@brief Set the number of connections the profile can serve. The connection table is allocated
+ *        with this size by the first @ref BLE_TRSPC_Init and is not resized afterwards.
+ *
+ * @param[in] connNbr                       Number of connections, from 1 to @ref BLE_TRSPC_CONN_NBR_LIMIT.
+ *
+ * @retval TRSP_RES_SUCCESS                 Successfully set the number of connections.
+ * @retval TRSP_RES_INVALID_PARA            The number is out of range.
+ * @retval TRSP_RES_BAD_STATE               The connection table is already allocated.
+ *
+ */
+uint16_t BLE_TRSPC_SetMaxConnNbr(uint8_t connNbr);
+
 /**@brief Register BLE Transparent profile client callback. 
  *
  * @param[in] bleTranCliHandler             Client callback function.
@@ -261,6 +285,29 @@ uint16_t BLE_TRSPC_SendVendorCommand(GDBusProxy *p_proxyDev, uint8_t commandID,
  */
 uint16_t BLE_TRSPC_SendData(GDBusProxy *p_proxyDev, uint16_t len, uint8_t *p_data);
 
+/**@brief Check whether the downlink uses credit based flow control.
+ *
+ * @param[in] p_proxyDev                    Device proxy associated with the link
+ *
+ * @retval true                             The downlink is enabled with credit based flow control.
+ * @retval false                            The downlink is disabled, without credit based flow control or the link is not found.
+ *
+ */
+bool BLE_TRSPC_IsDlCreditBased(GDBusProxy *p_proxyDev);
+
+/**@brief Select the write type of the data on a downlink without credit based flow control.
+ * Write Request is used by default. Write Without Response does not wait for the server but a packet
+ * dropped by the server is lost, the caller must recover it.
+ *
+ * @param[in] p_proxyDev                    Device proxy associated with the link
+ * @param[in] enable                        Use Write Without Response.
+ *
+ * @retval TRSP_RES_SUCCESS                  Successfully select the write type.
+ * @retval TRSP_RES_FAIL                     Can not find the link.
+ *
+ */
+uint16_t BLE_TRSPC_SetDataWriteCommand(GDBusProxy *p_proxyDev, bool enable);
+
 /**@brief Get queued data length.
  *
  * @param[in] p_proxyDev                    Device proxy associated with the queued data
@@ -280,6 +327,44 @@ void BLE_TRSPC_GetDataLength(GDBusProxy *p_proxyDev, uint16_t *p_dataLength);
  */
 uint16_t BLE_TRSPC_GetData(GDBusProxy *p_proxyDev, uint8_t *p_data);
 
+/**@brief Configure the credit return of the uplink.
+ * Credits are returned once 13 of them are pending, or as soon as any is
+ * pending while the server holds no more than the low watermark. While one return is in progress the
+ * credits freed in the meantime are returned together on its completion.
+ *
+ * @param[in] lowWatermark                  Credits held by the server at which the return starts, 0 disables the early return.
+ * @param[in] overlap                       Return credits with Write Without Response so the return does not wait for the server.
+ *
+ * @retval TRSP_RES_SUCCESS                  Successfully configure the credit return.
+ * @retval TRSP_RES_INVALID_PARA             The watermark is not below the initial credit.
+ *
+ */
+uint16_t BLE_TRSPC_SetCreditReturn(uint8_t lowWatermark, bool overlap);
+
+/**@brief Get the credit return configuration. See @ref BLE_TRSPC_SetCreditReturn.
+ *
+ * @param[out] p_lowWatermark               Low watermark.
+ * @param[out] p_overlap                    Write Without Response is used.
+ *
+ */
+void BLE_TRSPC_GetCreditReturn(uint8_t *p_lowWatermark, bool *p_overlap);
+
+/**@brief Get the credit return statistics of one link.
+ *
+ * @param[in] p_proxyDev                    Device proxy associated with the link
+ * @param[out] p_stat                       Pointer to the statistics.
+ *
+ * @retval TRSP_RES_SUCCESS                  Successfully get the statistics.
+ * @retval TRSP_RES_FAIL                     Can not find the link.
+ *
+ */
+uint16_t BLE_TRSPC_GetCreditStat(GDBusProxy *p_proxyDev, BLE_TRSPC_CreditStat_T *p_stat);
+
+/**@brief Clear the credit return statistics of all links.
+ *
+ */
+void BLE_TRSPC_ResetCreditStat(void);
+
 /**@brief Notify profile one device is connected.
  *
  * @param[in] p_proxyDev                    Device proxy associated with connected device
@@ -59,23 +59,23 @@
 // *****************************************************************************
 
 /**@defgroup BLE_TRSPS_INIT_CREDIT BLE_TRSPS_INIT_CREDIT
- * @brief The definition of initial credit value.
+ * @brief The definition of the initial credit window of the adaptive credit policy.
  * @{ */
 #define BLE_TRSPS_INIT_CREDIT                   (0x0A)//0x10    /**< Definition of initial credit */
 /** @} */
 
-/**@defgroup BLE_TRSPS_MAX_BUF BLE_TRSPS_MAX_BUF
- * @brief The definition of maximum buffer list.
- * @{ */
-#define BLE_TRSPS_MAX_BUF_IN                    (BLE_TRSPS_INIT_CREDIT*BLE_TRSPS_MAX_CONN_NBR)     /**< Maximum incoming queue number */
-/** @} */
-
 /**@defgroup BLE_TRSPS_MAX_RETURN_CREDIT BLE_TRSPS_MAX_RETURN_CREDIT
  * @brief The definition of maximum return credit number.
  * @{ */
 #define BLE_TRSPS_MAX_RETURN_CREDIT              (0x07)//(13)   /**< Maximum return credit number */
 /** @} */
 
+/**@defgroup BLE_TRSPS_MIN_CREDIT_WINDOW BLE_TRSPS_MIN_CREDIT_WINDOW
+ * @brief The definition of the smallest window of the adaptive credit policy.
+ * @{ */
+#define BLE_TRSPS_MIN_CREDIT_WINDOW             (0x02)         /**< Minimum credit window */
+/** @} */
+
 /**@defgroup BLE_TRSPS_CBFC BLE_TRSPS_CBFC
  * @brief The definition of credit base flow control.
  * @{ */
@@ -127,7 +127,7 @@ typedef struct BLE_TRSPS_QueueIn_T
     uint8_t                    usedNum;                    /**< The number of data list of packetIn buffer. */
     uint8_t                    writeIndex;                 /**< The Index of data, written in packet buffer. */
     uint8_t                    readIndex;                  /**< The Index of data, read in packet buffer. */
-    BLE_TRSPS_PacketList_T     packetList[BLE_TRSPS_INIT_CREDIT];  /**< Written in packet buffer. @ref BLE_TRSPS_PacketBufferIn_T.*/
+    BLE_TRSPS_PacketList_T     packetList[BLE_TRSPS_MAX_QUEUE_DEPTH];  /**< Written in packet buffer. @ref BLE_TRSPS_PacketBufferIn_T.*/
 } BLE_TRSPS_QueueIn_T;
 
 /**@brief The structure contains information about BLE transparent profile connection parameters for recording connection information. */
@@ -139,6 +139,13 @@ typedef struct BLE_TRSPS_ConnList_T
     uint8_t                    cbfcEnable;              /**< Credit based flow enable. @ref BLE_TRSPS_CREDIT_BASED_FLOW_CONTROL. */
     uint8_t                    peerCredit;              /**< Credit number from Central to Peripheral. */
     uint8_t                    localCredit;             /**< Credit number from Peripheral to Central. */
+    uint8_t                    grantedCredit;           /**< Credits returned to Central and not used yet. */
+    uint8_t                    creditWindow;            /**< Credits granted, queued or waiting for return in total. */
+    uint8_t                    queueDepth;              /**< Input queue depth of this link. */
+    uint8_t                    maxQueued;               /**< Peak number of packets in the input queue. */
+    uint32_t                   creditReturns;           /**< Number of credit returns sent. */
+    uint32_t                   windowGrows;             /**< Number of times the window grew. */
+    uint32_t                   windowShrinks;           /**< Number of times the window shrank. */
     BLE_TRSPS_QueueIn_T        inputQueue;              /**< Input queue to store Rx packets. */
 } BLE_TRSPS_ConnList_T;
 
@@ -149,8 +156,15 @@ typedef struct BLE_TRSPS_ConnList_T
 // *****************************************************************************
 
 static BLE_TRSPS_EventCb_T      bleTrspsProcess;
-static BLE_TRSPS_ConnList_T     s_trsConnList[BLE_TRSPS_MAX_CONN_NBR];
+static BLE_TRSPS_ConnList_T     *sp_trsConnList = NULL;   /**< Connection table, allocated once by BLE_TRSPS_Init(). */
+static uint8_t                  s_trsMaxConnNbr = BLE_TRSPS_MAX_CONN_NBR;  /**< Number of entries in the connection table. */
+static uint8_t                  *sp_trsFreeNext = NULL;   /**< Next free entry of each free entry, s_trsMaxConnNbr ends the list. */
+static uint8_t                  s_trsFreeHead;             /**< First free entry, s_trsMaxConnNbr when the table is full. */
+static GHashTable               *sp_trsConnByProxy = NULL; /**< Connected entries by device proxy. */
+static GHashTable               *sp_trsConnByPath = NULL;  /**< Connected entries by device object path. */
 static uint8_t                  s_trsState;                /**< BLE transparent service current state. @ref BLE_TRSPS_STATUS.*/
+static uint8_t                  s_trsQueueDepth;                                     /**< Input queue depth of new links, 0 for the default of the credit policy. */
+static uint8_t                  s_trsCreditPolicy = BLE_TRSPS_CREDIT_POLICY_FIXED;   /**< Credit policy. @ref BLE_TRSPS_CreditPolicy_T. */
 
 
 // *****************************************************************************
@@ -167,49 +181,50 @@ static void ble_trsps_InitConnList(BLE_TRSPS_ConnList_T *p_conn)
 
 static BLE_TRSPS_ConnList_T * ble_trsps_GetConnListByProxy(GDBusProxy *p_dev)
 {
-    uint8_t i;
-
-    for(i=0; i<BLE_TRSPS_MAX_CONN_NBR;i++)
+    if (sp_trsConnByProxy == NULL)
     {
-        if ((s_trsConnList[i].state == BLE_TRSPS_STATE_CONNECTED) && (s_trsConnList[i].p_dev == p_dev))
-        {
-            return &s_trsConnList[i];
-        }
+        return NULL;
     }
 
-    return NULL;
+    return g_hash_table_lookup(sp_trsConnByProxy, p_dev);
 }
 
 static BLE_TRSPS_ConnList_T * ble_trsps_GetConnListByObjPath(char *p_path)
 {
-    uint8_t i;
-
-    for(i=0; i<BLE_TRSPS_MAX_CONN_NBR;i++)
+    if (sp_trsConnByPath == NULL)
     {
-        if ((s_trsConnList[i].state == BLE_TRSPS_STATE_CONNECTED) && (strcmp(g_dbus_proxy_get_path(s_trsConnList[i].p_dev), p_path) == 0))
-        {
-            return &s_trsConnList[i];
-        }
+        return NULL;
     }
 
-    return NULL;
+    return g_hash_table_lookup(sp_trsConnByPath, p_path);
 }
 
 
 static BLE_TRSPS_ConnList_T *ble_trsps_GetFreeConnList(void)
 {
-    uint8_t i;
+    uint8_t index = s_trsFreeHead;
 
-    for(i=0; i<BLE_TRSPS_MAX_CONN_NBR;i++)
+    if ((sp_trsConnList == NULL) || (index >= s_trsMaxConnNbr))
     {
-        if (s_trsConnList[i].state == BLE_TRSPS_STATE_IDLE)
-        {
-            s_trsConnList[i].state = BLE_TRSPS_STATE_CONNECTED;
-            return &s_trsConnList[i];
-        }
+        return NULL;
     }
 
-    return NULL;
+    s_trsFreeHead = sp_trsFreeNext[index];
+    sp_trsConnList[index].state = BLE_TRSPS_STATE_CONNECTED;
+
+    return &sp_trsConnList[index];
+}
+
+static void ble_trsps_FreeConnList(BLE_TRSPS_ConnList_T *p_conn)
+{
+    uint8_t index = (uint8_t)(p_conn - sp_trsConnList);
+
+    g_hash_table_remove(sp_trsConnByProxy, p_conn->p_dev);
+    g_hash_table_remove(sp_trsConnByPath, g_dbus_proxy_get_path(p_conn->p_dev));
+    ble_trsps_InitConnList(p_conn);
+
+    sp_trsFreeNext[index] = s_trsFreeHead;
+    s_trsFreeHead = index;
 }
 
 static void ble_trsps_ServerReturnCredit(BLE_TRSPS_ConnList_T *p_conn)
@@ -229,7 +244,82 @@ static void ble_trsps_ServerReturnCredit(BLE_TRSPS_ConnList_T *p_conn)
         
     BLE_TRS_UpdateValueCtrl(buf, sizeof(buf));
 
+    p_conn->grantedCredit += p_conn->peerCredit;
     p_conn->peerCredit = 0;
+    p_conn->creditReturns++;
+}
+
+static uint8_t ble_trsps_ReturnThreshold(BLE_TRSPS_ConnList_T *p_conn)
+{
+    uint8_t threshold;
+
+    if (s_trsCreditPolicy == BLE_TRSPS_CREDIT_POLICY_ADAPTIVE)
+    {
+        //Return while the peer still has half of the window to send
+        threshold = (p_conn->creditWindow + 1) / 2;
+    }
+    else
+    {
+        threshold = BLE_TRSPS_MAX_RETURN_CREDIT;
+    }
+
+    //A threshold above the window would never be reached
+    if (threshold > p_conn->creditWindow)
+    {
+        threshold = p_conn->creditWindow;
+    }
+
+    return (threshold > 0U) ? threshold : 1U;
+}
+
+static void ble_trsps_UpdateCredit(BLE_TRSPS_ConnList_T *p_conn)
+{
+    uint16_t inUse;
+
+    if (s_trsCreditPolicy != BLE_TRSPS_CREDIT_POLICY_ADAPTIVE)
+    {
+        p_conn->creditWindow = p_conn->queueDepth;
+    }
+
+    //Credits above the window are kept back after the window shrank
+    inUse = p_conn->grantedCredit + p_conn->inputQueue.usedNum + p_conn->peerCredit;
+    if (inUse < p_conn->creditWindow)
+    {
+        p_conn->peerCredit += (p_conn->creditWindow - inUse);
+    }
+
+    if (p_conn->peerCredit >= ble_trsps_ReturnThreshold(p_conn))
+    {
+        ble_trsps_ServerReturnCredit(p_conn);
+    }
+}
+
+static void ble_trsps_AdaptWindow(BLE_TRSPS_ConnList_T *p_conn)
+{
+    uint8_t step;
+
+    if (p_conn->inputQueue.usedNum == 1U)
+    {
+        //The queue was empty, the application keeps up with the peer
+        if (p_conn->creditWindow < p_conn->queueDepth)
+        {
+            p_conn->creditWindow++;
+            p_conn->windowGrows++;
+        }
+    }
+    else if ((p_conn->inputQueue.usedNum >= (p_conn->creditWindow - p_conn->creditWindow / 4U))
+        && (p_conn->creditWindow > BLE_TRSPS_MIN_CREDIT_WINDOW)
+        && ((p_conn->grantedCredit + p_conn->inputQueue.usedNum + p_conn->peerCredit) <= p_conn->creditWindow))
+    {
+        //Backpressure. Shrink once per backlog, the withheld credits are not returned until the queue drains.
+        step = (p_conn->creditWindow / 4U > 0U) ? (p_conn->creditWindow / 4U) : 1U;
+        if ((p_conn->creditWindow - step) < BLE_TRSPS_MIN_CREDIT_WINDOW)
+        {
+            step = p_conn->creditWindow - BLE_TRSPS_MIN_CREDIT_WINDOW;
+        }
+        p_conn->creditWindow -= step;
+        p_conn->windowShrinks++;
+    }
 }
 
 
@@ -238,14 +328,44 @@ void BLE_TRSPS_EventRegister(BLE_TRSPS_EventCb_T bleTranServHandler)
     bleTrspsProcess = bleTranServHandler;
 }
 
+uint16_t BLE_TRSPS_SetMaxConnNbr(uint8_t connNbr)
+{
+    if ((connNbr == 0U) || (connNbr > BLE_TRSPS_CONN_NBR_LIMIT))
+    {
+        return TRSP_RES_INVALID_PARA;
+    }
+
+    if (sp_trsConnList != NULL)
+    {
+        return TRSP_RES_BAD_STATE;
+    }
+
+    s_trsMaxConnNbr = connNbr;
+
+    return TRSP_RES_SUCCESS;
+}
+
 uint16_t BLE_TRSPS_Init(DBusConnection *p_dbusConn, GDBusProxy * p_proxyGattMgr)
 {
     uint8_t i;
 
-    for (i = 0; i < BLE_TRSPS_MAX_CONN_NBR; i++)
+    if (sp_trsConnList == NULL)
+    {
+        sp_trsConnList = g_new0(BLE_TRSPS_ConnList_T, s_trsMaxConnNbr);
+        sp_trsFreeNext = g_new0(uint8_t, s_trsMaxConnNbr);
+        sp_trsConnByProxy = g_hash_table_new(g_direct_hash, g_direct_equal);
+        sp_trsConnByPath = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    }
+
+    g_hash_table_remove_all(sp_trsConnByProxy);
+    g_hash_table_remove_all(sp_trsConnByPath);
+
+    for (i = 0; i < s_trsMaxConnNbr; i++)
     {
-        ble_trsps_InitConnList(&s_trsConnList[i]);
+        ble_trsps_InitConnList(&sp_trsConnList[i]);
+        sp_trsFreeNext[i] = i + 1U;
     }
+    s_trsFreeHead = 0;
 
     if (BLE_TRS_Add(p_dbusConn, p_proxyGattMgr) == true)
     {
@@ -370,7 +490,7 @@ uint16_t BLE_TRSPS_GetData(GDBusProxy *p_proxyDev, uint8_t *p_data)
             }
             
             p_conn->inputQueue.readIndex++;
-            if (p_conn->inputQueue.readIndex >= BLE_TRSPS_INIT_CREDIT)
+            if (p_conn->inputQueue.readIndex >= p_conn->queueDepth)
             {
                 p_conn->inputQueue.readIndex = 0;
             }
@@ -379,11 +499,7 @@ uint16_t BLE_TRSPS_GetData(GDBusProxy *p_proxyDev, uint8_t *p_data)
             
             if ((p_conn->cbfcEnable&BLE_TRSPS_CBFC_RX_ENABLED)!=0U)
             {
-                p_conn->peerCredit++;
-                if (p_conn->peerCredit >= BLE_TRSPS_MAX_RETURN_CREDIT)
-                {
-                    ble_trsps_ServerReturnCredit(p_conn);
-                }
+                ble_trsps_UpdateCredit(p_conn);
             }
 
             return TRSP_RES_SUCCESS;
@@ -515,7 +631,7 @@ DBusMessage *BLE_TRSPS_ChrcStopNotifyTx(DBusConnection *p_dbusConn, DBusMessage
 
 static void ble_trsps_RxValue(BLE_TRSPS_ConnList_T *p_conn, uint16_t receivedLen, uint8_t *p_receivedValue)
 {
-    if (p_conn->inputQueue.usedNum < BLE_TRSPS_INIT_CREDIT)
+    if (p_conn->inputQueue.usedNum < p_conn->queueDepth)
     {
         BLE_TRSPS_Event_T evtPara;
         uint8_t *p_buffer = NULL;
@@ -538,12 +654,29 @@ static void ble_trsps_RxValue(BLE_TRSPS_ConnList_T *p_conn, uint16_t receivedLen
         p_conn->inputQueue.packetList[p_conn->inputQueue.writeIndex].length = receivedLen;
         p_conn->inputQueue.packetList[p_conn->inputQueue.writeIndex].p_packet = p_buffer;
         p_conn->inputQueue.writeIndex++;
-        if (p_conn->inputQueue.writeIndex >= BLE_TRSPS_INIT_CREDIT)
+        if (p_conn->inputQueue.writeIndex >= p_conn->queueDepth)
         {
             p_conn->inputQueue.writeIndex = 0;
         }
 
         p_conn->inputQueue.usedNum++;
+        if (p_conn->inputQueue.usedNum > p_conn->maxQueued)
+        {
+            p_conn->maxQueued = p_conn->inputQueue.usedNum;
+        }
+
+        if ((p_conn->cbfcEnable&BLE_TRSPS_CBFC_RX_ENABLED)!=0U)
+        {
+            if (p_conn->grantedCredit > 0U)
+            {
+                p_conn->grantedCredit--;
+            }
+
+            if (s_trsCreditPolicy == BLE_TRSPS_CREDIT_POLICY_ADAPTIVE)
+            {
+                ble_trsps_AdaptWindow(p_conn);
+            }
+        }
 
         evtPara.eventId=BLE_TRSPS_EVT_RECEIVE_DATA;
         evtPara.eventField.onReceiveData.p_dev = p_conn->p_dev;
@@ -603,7 +736,13 @@ static void ble_trsps_CtrlValue(BLE_TRSPS_ConnList_T *p_conn, uint16_t length, u
         case BLE_TRSPS_CBFC_OPCODE_SERVER_ENABLED:
         {
             p_conn->cbfcEnable |= BLE_TRSPS_CBFC_RX_ENABLED;
-            p_conn->peerCredit = BLE_TRSPS_INIT_CREDIT;
+            p_conn->creditWindow = p_conn->queueDepth;
+            if ((s_trsCreditPolicy == BLE_TRSPS_CREDIT_POLICY_ADAPTIVE) && (p_conn->creditWindow > BLE_TRSPS_INIT_CREDIT))
+            {
+                p_conn->creditWindow = BLE_TRSPS_INIT_CREDIT;
+            }
+            p_conn->grantedCredit = 0;
+            p_conn->peerCredit = p_conn->creditWindow;
             ble_trsps_ServerReturnCredit(p_conn);
             
             if (bleTrspsProcess != NULL)
@@ -741,7 +880,71 @@ void BLE_TRSPS_DevConnected(GDBusProxy *p_proxyDev)
     }
 
     p_conn->p_dev=p_proxyDev;
+    g_hash_table_insert(sp_trsConnByProxy, p_proxyDev, p_conn);
+    g_hash_table_insert(sp_trsConnByPath, g_strdup(g_dbus_proxy_get_path(p_proxyDev)), p_conn);
+    p_conn->queueDepth = BLE_TRSPS_GetQueueDepth();
+    p_conn->creditWindow = p_conn->queueDepth;
+}
+
+uint16_t BLE_TRSPS_SetQueueDepth(uint8_t depth)
+{
+    if ((depth < BLE_TRSPS_MIN_QUEUE_DEPTH) || (depth > BLE_TRSPS_MAX_QUEUE_DEPTH))
+    {
+        return TRSP_RES_INVALID_PARA;
+    }
+
+    s_trsQueueDepth = depth;
 
+    return TRSP_RES_SUCCESS;
+}
+
+uint8_t BLE_TRSPS_GetQueueDepth(void)
+{
+    if (s_trsQueueDepth != 0U)
+    {
+        return s_trsQueueDepth;
+    }
+
+    return (s_trsCreditPolicy == BLE_TRSPS_CREDIT_POLICY_ADAPTIVE) ? BLE_TRSPS_ADAPTIVE_QUEUE_DEPTH : BLE_TRSPS_DEFAULT_QUEUE_DEPTH;
+}
+
+uint16_t BLE_TRSPS_SetCreditPolicy(uint8_t policy)
+{
+    if (policy >= BLE_TRSPS_CREDIT_POLICY_END)
+    {
+        return TRSP_RES_INVALID_PARA;
+    }
+
+    s_trsCreditPolicy = policy;
+
+    return TRSP_RES_SUCCESS;
+}
+
+uint8_t BLE_TRSPS_GetCreditPolicy(void)
+{
+    return s_trsCreditPolicy;
+}
+
+uint16_t BLE_TRSPS_GetCreditInfo(GDBusProxy *p_proxyDev, BLE_TRSPS_CreditInfo_T *p_info)
+{
+    BLE_TRSPS_ConnList_T *p_conn;
+
+    p_conn = ble_trsps_GetConnListByProxy(p_proxyDev);
+    if (p_conn == NULL)
+    {
+        return TRSP_RES_FAIL;
+    }
+
+    p_info->queueDepth = p_conn->queueDepth;
+    p_info->window = p_conn->creditWindow;
+    p_info->grantedCredit = p_conn->grantedCredit;
+    p_info->queued = p_conn->inputQueue.usedNum;
+    p_info->maxQueued = p_conn->maxQueued;
+    p_info->returns = p_conn->creditReturns;
+    p_info->grows = p_conn->windowGrows;
+    p_info->shrinks = p_conn->windowShrinks;
+
+    return TRSP_RES_SUCCESS;
 }
 
 void BLE_TRSPS_DevDisconnected(GDBusProxy *p_proxyDev)
@@ -762,7 +965,7 @@ void BLE_TRSPS_DevDisconnected(GDBusProxy *p_proxyDev)
             }
     
             p_conn->inputQueue.readIndex++;
-            if (p_conn->inputQueue.readIndex >= BLE_TRSPS_INIT_CREDIT)
+            if (p_conn->inputQueue.readIndex >= p_conn->queueDepth)
             {
                 p_conn->inputQueue.readIndex = 0;
             }
@@ -770,7 +973,7 @@ void BLE_TRSPS_DevDisconnected(GDBusProxy *p_proxyDev)
             p_conn->inputQueue.usedNum --;
         }
 
-        ble_trsps_InitConnList(p_conn);
+        ble_trsps_FreeConnList(p_conn);
     }
 
 }
@@ -64,9 +64,10 @@ extern "C" {
  * @{ */
 
 /**@defgroup BLE_TRS_MAX_CONN_NBR Maximum connection number
- * @brief The definition of Memory size.
+ * @brief The definition of Memory size. The connection table is sized at runtime, see @ref BLE_TRSPS_SetMaxConnNbr.
  * @{ */
-#define BLE_TRSPS_MAX_CONN_NBR                  (0x06U)    /**< Maximum allowing Conncetion Numbers for MBADK. */
+#define BLE_TRSPS_MAX_CONN_NBR                  (0x06U)    /**< Default allowing Conncetion Numbers for MBADK. */
+#define BLE_TRSPS_CONN_NBR_LIMIT                (0x40U)    /**< Upper limit of the allowing Conncetion Numbers. */
 /** @} */
 
 /**@defgroup BLE_TRSPS_STATUS TRSPS Status
@@ -78,6 +79,15 @@ extern "C" {
 #define BLE_TRSPS_STATUS_TX_OPENED              (0x01U)    /**< Local ble transparent service TX characteristic CCCD is enable. */
 /** @} */
 
+/**@defgroup BLE_TRSPS_QUEUE_DEPTH Input queue depth
+ * @brief The definition of the input queue depth. The depth is also the largest credit window given to the peer.
+ * @{ */
+#define BLE_TRSPS_MIN_QUEUE_DEPTH               (0x02U)    /**< Minimum input queue depth. */
+#define BLE_TRSPS_MAX_QUEUE_DEPTH               (0x40U)    /**< Maximum input queue depth. */
+#define BLE_TRSPS_DEFAULT_QUEUE_DEPTH           (0x0AU)    /**< Default input queue depth of the fixed credit policy. */
+#define BLE_TRSPS_ADAPTIVE_QUEUE_DEPTH          (0x20U)    /**< Default input queue depth of the adaptive credit policy, above its initial window so that the window can grow. */
+/** @} */
+
 /**@} */ //BLE_TRPS_DEFINES
 
 
@@ -99,6 +109,14 @@ typedef enum BLE_TRSPS_EventId_T
     BLE_TRSPS_EVT_END
 }BLE_TRSPS_EventId_T;
 
+/**@brief Enumeration type of the credit policy. */
+typedef enum BLE_TRSPS_CreditPolicy_T
+{
+    BLE_TRSPS_CREDIT_POLICY_FIXED = 0x00U,              /**< Grant the whole queue depth and return credits in fixed batches. */
+    BLE_TRSPS_CREDIT_POLICY_ADAPTIVE,                   /**< Grow the credit window while the application keeps up, shrink it under backpressure. */
+    BLE_TRSPS_CREDIT_POLICY_END
+}BLE_TRSPS_CreditPolicy_T;
+
 /**@} */ //BLE_TRPS_ENUMS
 
 // *****************************************************************************
@@ -141,6 +159,19 @@ typedef struct BLE_TRSPS_EvtVendorCmd_T
     uint8_t          *p_payLoad;                                            /**< Vendor command payload pointer. */
 }BLE_TRSPS_EvtVendorCmd_T;
 
+/**@brief Credit state and statistics of one link. See @ref BLE_TRSPS_GetCreditInfo. */
+typedef struct BLE_TRSPS_CreditInfo_T
+{
+    uint8_t          queueDepth;                                            /**< Input queue depth of the link. */
+    uint8_t          window;                                                /**< Current credit window. */
+    uint8_t          grantedCredit;                                         /**< Credits held by the peer. */
+    uint8_t          queued;                                                /**< Packets in the input queue. */
+    uint8_t          maxQueued;                                             /**< Peak number of packets in the input queue. */
+    uint32_t         returns;                                               /**< Number of credit returns sent to the peer. */
+    uint32_t         grows;                                                 /**< Number of times the window grew. */
+    uint32_t         shrinks;                                               /**< Number of times the window shrank. */
+}BLE_TRSPS_CreditInfo_T;
+
 /**@brief The union of BLE Transparent profile server event types. */
 typedef union
 {
@@ -200,6 +231,18 @@ void BLE_TRSPS_EventRegister(BLE_TRSPS_EventCb_T bleTranServHandler);
  */
 uint16_t BLE_TRSPS_Init(DBusConnection *p_dbusConn, GDBusProxy * p_proxyGattMgr);
 
+/**@brief Set the number of connections the profile can serve. The connection table is allocated
+ *        with this size by the first @ref BLE_TRSPS_Init and is not resized afterwards.
+ *
+ * @param[in] connNbr                       Number of connections, from 1 to @ref BLE_TRSPS_CONN_NBR_LIMIT.
+ *
+ * @retval TRSP_RES_SUCCESS                 Successfully set the number of connections.
+ * @retval TRSP_RES_INVALID_PARA            The number is out of range.
+ * @retval TRSP_RES_BAD_STATE               The connection table is already allocated.
+ *
+ */
+uint16_t BLE_TRSPS_SetMaxConnNbr(uint8_t connNbr);
+
 
 /**@brief Send vendor command.
  *
@@ -251,6 +294,43 @@ void BLE_TRSPS_GetDataLength(GDBusProxy *p_proxyDev, uint16_t *p_dataLength);
  */
 uint16_t BLE_TRSPS_GetData(GDBusProxy *p_proxyDev, uint8_t *p_data);
 
+/**@brief Set the input queue depth. Links connected afterwards use the new depth instead of the default of the credit policy.
+ *
+ * @param[in] depth                         Queue depth, from @ref BLE_TRSPS_MIN_QUEUE_DEPTH to @ref BLE_TRSPS_MAX_QUEUE_DEPTH.
+ *
+ * @retval TRSP_RES_SUCCESS                 Successfully set the queue depth.
+ * @retval TRSP_RES_INVALID_PARA            The depth is out of range.
+ *
+ */
+uint16_t BLE_TRSPS_SetQueueDepth(uint8_t depth);
+
+/**@brief Get the input queue depth used by new links, the set depth or the default of the credit policy. */
+uint8_t BLE_TRSPS_GetQueueDepth(void);
+
+/**@brief Set the credit policy. The policy takes effect on the next credit return of each link.
+ *
+ * @param[in] policy                        Credit policy. See @ref BLE_TRSPS_CreditPolicy_T.
+ *
+ * @retval TRSP_RES_SUCCESS                 Successfully set the credit policy.
+ * @retval TRSP_RES_INVALID_PARA            Unknown policy.
+ *
+ */
+uint16_t BLE_TRSPS_SetCreditPolicy(uint8_t policy);
+
+/**@brief Get the credit policy. See @ref BLE_TRSPS_CreditPolicy_T. */
+uint8_t BLE_TRSPS_GetCreditPolicy(void);
+
+/**@brief Get the credit state and statistics of one link.
+ *
+ * @param[in] p_proxyDev                    Device proxy associated with the link
+ * @param[out] p_info                       Pointer to the credit information
+ *
+ * @retval TRSP_RES_SUCCESS                 Successfully get the credit information.
+ * @retval TRSP_RES_FAIL                    Can not find the link.
+ *
+ */
+uint16_t BLE_TRSPS_GetCreditInfo(GDBusProxy *p_proxyDev, BLE_TRSPS_CreditInfo_T *p_info);
+
 /**@brief Notify profile one device is connected.
  *
  * @param[in] p_proxyDev                    Device proxy associated with connected device
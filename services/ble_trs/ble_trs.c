@@ -31,6 +31,7 @@
 
 #include "ble_trs/ble_trs.h"
 #include "ble_trsp/ble_trsps.h"
+#include "dbus_stat/dbus_stat.h"
 
 // *****************************************************************************
 // *****************************************************************************
@@ -346,18 +347,26 @@ bool BLE_TRS_Add(DBusConnection *p_dbusConn, GDBusProxy * p_proxyGattMgr)
 
 void BLE_TRS_UpdateValueCtrl(uint8_t *p_value, uint16_t len)
 {
+    uint64_t startNs;
+
     sp_trsChrcValue = p_value;
     s_trsChrcValueLen = len;
 
+    startNs = DBUS_STAT_Begin();
     g_dbus_emit_property_changed_full(sp_trsDbusConn, TRS_CHRC_CTRL_OBJ_PATH, BLUEZ_CHRC_INTERFACE, "Value", G_DBUS_PROPERTY_CHANGED_FLAG_FLUSH);
+    DBUS_STAT_End(DBUS_STAT_TYPE_SIGNAL_EMIT, "PropertiesChanged", startNs);
 }
 
 void BLE_TRS_UpdateValueTx(uint8_t *p_value, uint16_t len)
 {
+    uint64_t startNs;
+
     sp_trsChrcValue = p_value;
     s_trsChrcValueLen = len;
 
+    startNs = DBUS_STAT_Begin();
     g_dbus_emit_property_changed_full(sp_trsDbusConn, TRS_CHRC_TX_OBJ_PATH, BLUEZ_CHRC_INTERFACE, "Value", G_DBUS_PROPERTY_CHANGED_FLAG_FLUSH);
+    DBUS_STAT_End(DBUS_STAT_TYPE_SIGNAL_EMIT, "PropertiesChanged", startNs);
 }
 
 
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  D-Bus Statistics Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    dbus_stat.c
+
+  Summary:
+    This file contains the D-Bus call cost accounting functions.
+
+  Description:
+    This file contains the D-Bus call cost accounting functions.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "dbus_stat/dbus_stat.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static DBUS_STAT_Entry_T    s_dbusStatEntry[DBUS_STAT_MAX_ENTRY_NUM];
+static uint8_t              s_dbusStatEntryNum;
+static uint32_t             s_dbusStatDropped;
+static uint64_t             s_dbusStatWallStart;
+static uint64_t             s_dbusStatCpuStart;
+static bool                 s_dbusStatDisabled;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+static uint64_t dbus_stat_Now(clockid_t clockId)
+{
+    struct timespec ts;
+
+    clock_gettime(clockId, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static DBUS_STAT_Entry_T * dbus_stat_GetEntry(uint8_t type, const char *p_name)
+{
+    uint8_t i;
+    DBUS_STAT_Entry_T *p_entry;
+
+    for (i = 0; i < s_dbusStatEntryNum; i++)
+    {
+        if (s_dbusStatEntry[i].type == type && !strcmp(s_dbusStatEntry[i].name, p_name))
+            return &s_dbusStatEntry[i];
+    }
+
+    if (s_dbusStatEntryNum >= DBUS_STAT_MAX_ENTRY_NUM)
+        return NULL;
+
+    p_entry = &s_dbusStatEntry[s_dbusStatEntryNum++];
+    memset(p_entry, 0, sizeof(DBUS_STAT_Entry_T));
+    p_entry->type = type;
+    snprintf(p_entry->name, sizeof(p_entry->name), "%s", p_name);
+
+    return p_entry;
+}
+
+uint64_t DBUS_STAT_Begin(void)
+{
+    if (s_dbusStatDisabled)
+        return 0;
+
+    return dbus_stat_Now(CLOCK_MONOTONIC);
+}
+
+void DBUS_STAT_End(uint8_t type, const char *p_name, uint64_t startNs)
+{
+    DBUS_STAT_Entry_T *p_entry;
+    uint64_t elapsed;
+
+    if (s_dbusStatDisabled || startNs == 0 || p_name == NULL || type >= DBUS_STAT_TYPE_END)
+        return;
+
+    elapsed = dbus_stat_Now(CLOCK_MONOTONIC) - startNs;
+
+    if (s_dbusStatWallStart == 0)
+    {
+        s_dbusStatWallStart = startNs;
+        s_dbusStatCpuStart = dbus_stat_Now(CLOCK_PROCESS_CPUTIME_ID);
+    }
+
+    p_entry = dbus_stat_GetEntry(type, p_name);
+    if (p_entry == NULL)
+    {
+        s_dbusStatDropped++;
+        return;
+    }
+
+    p_entry->count++;
+    p_entry->totalNs += elapsed;
+    if (elapsed > p_entry->maxNs)
+        p_entry->maxNs = elapsed;
+}
+
+void DBUS_STAT_Enable(bool enable)
+{
+    s_dbusStatDisabled = !enable;
+}
+
+void DBUS_STAT_Reset(void)
+{
+    memset(s_dbusStatEntry, 0, sizeof(s_dbusStatEntry));
+    s_dbusStatEntryNum = 0;
+    s_dbusStatDropped = 0;
+    s_dbusStatWallStart = dbus_stat_Now(CLOCK_MONOTONIC);
+    s_dbusStatCpuStart = dbus_stat_Now(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+const DBUS_STAT_Entry_T * DBUS_STAT_GetEntry(uint8_t index)
+{
+    if (index >= s_dbusStatEntryNum)
+        return NULL;
+
+    return &s_dbusStatEntry[index];
+}
+
+void DBUS_STAT_GetSummary(DBUS_STAT_Summary_T *p_summary)
+{
+    uint8_t i;
+
+    if (p_summary == NULL)
+        return;
+
+    memset(p_summary, 0, sizeof(DBUS_STAT_Summary_T));
+
+    if (s_dbusStatWallStart != 0)
+    {
+        p_summary->wallNs = dbus_stat_Now(CLOCK_MONOTONIC) - s_dbusStatWallStart;
+        p_summary->cpuNs = dbus_stat_Now(CLOCK_PROCESS_CPUTIME_ID) - s_dbusStatCpuStart;
+    }
+
+    for (i = 0; i < s_dbusStatEntryNum; i++)
+    {
+        p_summary->dbusNs += s_dbusStatEntry[i].totalNs;
+    }
+
+    p_summary->dropped = s_dbusStatDropped;
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  D-Bus Statistics Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    dbus_stat.h
+
+  Summary:
+    This file contains the D-Bus call cost accounting functions.
+
+  Description:
+    This file contains the D-Bus call cost accounting functions.
+    Outgoing method calls, outgoing signal emissions and incoming PropertiesChanged
+    dispatches are counted and timed by member name, so the share of CPU spent on
+    D-Bus marshalling and dispatching can be compared with the process CPU time.
+ *******************************************************************************/
+
+
+/**
+ * @addtogroup DBUS_STAT D-Bus Statistics
+ * @{
+ * @brief Header file for the D-Bus call cost accounting.
+ * @note Only called from the main loop context.
+ */
+#ifndef DBUS_STAT_H
+#define DBUS_STAT_H
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+// DOM-IGNORE-BEGIN
+#ifdef __cplusplus  // Provide C++ Compatibility
+
+extern "C" {
+
+#endif
+// DOM-IGNORE-END
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define DBUS_STAT_MAX_ENTRY_NUM                 (32U)       /**< Maximum number of accounted members. */
+#define DBUS_STAT_MAX_NAME_LEN                  (32U)       /**< Maximum length of a member name, including the terminator. */
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief Direction of an accounted D-Bus message. */
+typedef enum DBUS_STAT_Type_T
+{
+    DBUS_STAT_TYPE_METHOD_CALL = 0x00,      /**< Outgoing method call, timed until the message is queued. */
+    DBUS_STAT_TYPE_SIGNAL_EMIT,             /**< Outgoing signal emission, timed until the message is flushed. */
+    DBUS_STAT_TYPE_SIGNAL_RECV,             /**< Incoming PropertiesChanged, timed over the application dispatch. The name is the property. */
+    DBUS_STAT_TYPE_END
+} DBUS_STAT_Type_T;
+
+/**@brief The structure contains the statistics of one member. */
+typedef struct DBUS_STAT_Entry_T
+{
+    uint8_t                 type;                           /**< See @ref DBUS_STAT_Type_T. */
+    char                    name[DBUS_STAT_MAX_NAME_LEN];   /**< Member or property name. */
+    uint32_t                count;                          /**< Number of messages. */
+    uint64_t                totalNs;                        /**< Accumulated time in ns. */
+    uint64_t                maxNs;                          /**< Maximum time of one message in ns. */
+} DBUS_STAT_Entry_T;
+
+/**@brief The structure contains the totals since the last reset. */
+typedef struct DBUS_STAT_Summary_T
+{
+    uint64_t                wallNs;                         /**< Wall time since the last reset in ns. */
+    uint64_t                cpuNs;                          /**< Process CPU time since the last reset in ns. */
+    uint64_t                dbusNs;                         /**< Accumulated time of all entries in ns. */
+    uint32_t                dropped;                        /**< Number of messages not accounted due to a full table. */
+} DBUS_STAT_Summary_T;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+/**
+ *@brief Get the start timestamp of an accounted message.
+ *
+ * @return                                   Monotonic time in ns. 0 if the accounting is disabled.
+ *
+ */
+uint64_t DBUS_STAT_Begin(void);
+
+/**
+ *@brief Account a message started by @ref DBUS_STAT_Begin.
+ *
+ * @param[in] type                           See @ref DBUS_STAT_Type_T.
+ * @param[in] p_name                         Member or property name.
+ * @param[in] startNs                        Return value of @ref DBUS_STAT_Begin.
+ *
+ */
+void DBUS_STAT_End(uint8_t type, const char *p_name, uint64_t startNs);
+
+/**
+ *@brief Enable or disable the accounting. It is enabled by default.
+ *
+ * @param[in] enable                         true to enable.
+ *
+ */
+void DBUS_STAT_Enable(bool enable);
+
+/**
+ *@brief Clear all entries and restart the wall and CPU time reference.
+ *
+ */
+void DBUS_STAT_Reset(void);
+
+/**
+ *@brief Get an entry.
+ *
+ * @param[in] index                          Entry index, from 0.
+ *
+ * @return                                   Pointer to the entry. NULL if the index is not used.
+ *
+ */
+const DBUS_STAT_Entry_T * DBUS_STAT_GetEntry(uint8_t index);
+
+/**
+ *@brief Get the totals since the last reset.
+ *
+ * @param[out] p_summary                     Pointer to the summary.
+ *
+ */
+void DBUS_STAT_GetSummary(DBUS_STAT_Summary_T *p_summary);
+
+//DOM-IGNORE-BEGIN
+#ifdef __cplusplus
+}
+#endif
+//DOM-IGNORE-END
+
+#endif
+
+/**
+  @}
+ */
@@ -0,0 +1,68 @@
+#!/bin/sh
+#
+# Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Benchmark the TRP server credit policies of ble-uart-bluez, see 5.10 of
+# apps/ble_uart_app/readme. Run it on the central host; the peripheral (the TRP
+# server under test) is started over ssh for each policy with its default queue
+# depth, then the central runs the same receive-heavy burst mode against it.
+#
+#   credit_policy.sh <peripheral ssh host> <peripheral address> [out dir]
+#
+# Environment:
+#   APP         Path of ble-uart-bluez on both hosts, default ./ble-uart-bluez
+#   MODE        Work mode in which the server receives, 1: checksum (default), 2: loopback
+#   PATTERN     Pattern file, default 4 (100K)
+#   ITERATIONS  Runs per policy, default 10
+#
+# The per-run results of each policy are kept in <out dir>/<policy>.jsonl and the
+# average throughput of the adaptive policy is compared with the fixed one.
+
+set -e
+
+if [ $# -lt 2 ]; then
+    echo "usage: $0 <peripheral ssh host> <peripheral address> [out dir]" >&2
+    exit 2
+fi
+
+PERIPHERAL=$1
+ADDRESS=$2
+OUT=${3:-credit_policy_$(date +%Y%m%d_%H%M%S)}
+APP=${APP:-./ble-uart-bluez}
+MODE=${MODE:-1}
+PATTERN=${PATTERN:-4}
+ITERATIONS=${ITERATIONS:-10}
+
+mkdir -p "$OUT"
+
+for policy in fixed adaptive; do
+    echo "== $policy"
+    rm -f "$OUT/$policy.jsonl"
+
+    # The peripheral exits once the central disconnected
+    ssh "$PERIPHERAL" "sudo $APP --role peripheral --credit-policy $policy --json /tmp/credit_$policy.json" \
+        > "$OUT/$policy.peripheral.log" 2>&1 &
+    peripheral=$!
+    sleep 5
+
+    sudo "$APP" --role central --filter "$ADDRESS" --mode "$MODE" --pattern "$PATTERN" \
+        --iterations "$ITERATIONS" --result-log "$OUT/$policy.jsonl" --json "$OUT/$policy.json" \
+        || echo "$policy: central run failed, see $OUT/$policy.json" >&2
+
+    wait "$peripheral" || echo "$policy: peripheral run failed, see $OUT/$policy.peripheral.log" >&2
+done
+
+# A failed run is logged with zero throughput and counts in the average, as "rb cmp" does
+avg()
+{
+    sed -n 's/.*"throughputBps":\([0-9.]*\).*/\1/p' "$1" | awk '{ s += $1; n++ } END { if (n) printf "%.0f", s / n; else print 0 }'
+}
+
+fixed=$(avg "$OUT/fixed.jsonl")
+adaptive=$(avg "$OUT/adaptive.jsonl")
+
+echo "fixed    $fixed bytes/s"
+echo "adaptive $adaptive bytes/s"
+awk -v f="$fixed" -v a="$adaptive" 'BEGIN { if (f > 0) printf "adaptive/fixed %.3f\n", a / f }' | tee "$OUT/summary.txt"
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*******************************************************************************
+  Next Link Scheduler Benchmark Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    next_link_bench.c
+
+  Summary:
+    This file contains a microbenchmark of the TRP next-link schedulers.
+
+  Description:
+    This file contains a microbenchmark of the TRP next-link schedulers.
+    It times the round-robin pick of APP_TRP_COMMON_ChangeNextLink as it walked the link
+    table before, on entries of the size of APP_TRP_ConnList_T before and after its cold
+    fields moved to APP_TRP_ConnCold_T, and as it picks the link from the bitmask of
+    connected links now. The table walk is the loop removed from
+    apps/ble_uart_app/src/app_trp_common.c, the bitmask pick is APP_UTILITY_NextInMask()
+    of the application itself.
+
+    usage: next-link-bench [active links] [iterations]
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "app_utility.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define BENCH_MAX_LINK_NBR              64          /**< BLE_GAP_MAX_LINK_NBR_LIMIT. */
+#define BENCH_ENTRY_SIZE                224         /**< Size of APP_TRP_ConnList_T on x86-64 before the split. */
+#define BENCH_HOT_ENTRY_SIZE            128         /**< Size of APP_TRP_ConnList_T on x86-64 since the split. */
+#define BENCH_DEFAULT_ACTIVE            2
+#define BENCH_DEFAULT_ITERATIONS        10000000UL
+
+#define BENCH_STATE_IDLE                0x00        /**< APP_TRP_STATE_IDLE. */
+#define BENCH_STATE_CONNECTED           0x01
+#define BENCH_ROLE_SERVER               0x00        /**< APP_TRP_SERVER_ROLE. */
+
+#define BENCH_LINK(p_table, stride, index)  ((BENCH_Link_T *)((uint8_t *)(p_table) + (size_t)(stride) * (index)))
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+
+/**@brief The structure stands for the head of a link entry, the enum fields read by the table walk as in APP_TRP_ConnList_T. */
+typedef struct BENCH_Link_T
+{
+    uint32_t            connState;
+    uint32_t            trpRole;
+} BENCH_Link_T;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static uint8_t              s_benchLinks[BENCH_MAX_LINK_NBR * BENCH_ENTRY_SIZE] __attribute__((aligned(64)));
+static uint8_t              s_benchHotLinks[BENCH_MAX_LINK_NBR * BENCH_HOT_ENTRY_SIZE] __attribute__((aligned(64)));
+static uint64_t             s_benchRoleMask;
+static volatile uint8_t     s_benchSink;
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+
+//The loop before the bitmasks, walking the table from the token
+static uint8_t bench_NextLinkTable(const void *p_table, size_t stride, uint8_t maxLinkNbr, uint8_t trpRole, uint8_t index)
+{
+    uint8_t i;
+
+    for (i = 0; i < maxLinkNbr; i++)
+    {
+        index++;
+
+        if (index > (maxLinkNbr - 1))
+            index = 0;
+
+        if (BENCH_LINK(p_table, stride, index)->connState != BENCH_STATE_IDLE
+            && BENCH_LINK(p_table, stride, index)->trpRole == trpRole)
+            break;
+    }
+
+    return index;
+}
+
+static double bench_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//Spread the active links over the table, the last one at the end
+static void bench_Setup(uint8_t maxLinkNbr, uint8_t active)
+{
+    uint8_t i, index;
+
+    memset(s_benchLinks, 0, sizeof(s_benchLinks));
+    memset(s_benchHotLinks, 0, sizeof(s_benchHotLinks));
+    s_benchRoleMask = 0;
+
+    for (i = 0; i < active; i++)
+    {
+        index = (uint8_t)((i + 1) * maxLinkNbr / active - 1);
+        BENCH_LINK(s_benchLinks, BENCH_ENTRY_SIZE, index)->connState = BENCH_STATE_CONNECTED;
+        BENCH_LINK(s_benchLinks, BENCH_ENTRY_SIZE, index)->trpRole = BENCH_ROLE_SERVER;
+        BENCH_LINK(s_benchHotLinks, BENCH_HOT_ENTRY_SIZE, index)->connState = BENCH_STATE_CONNECTED;
+        BENCH_LINK(s_benchHotLinks, BENCH_HOT_ENTRY_SIZE, index)->trpRole = BENCH_ROLE_SERVER;
+        s_benchRoleMask |= 1ULL << index;
+    }
+}
+
+static double bench_RunTable(const void *p_table, size_t stride, uint8_t maxLinkNbr, unsigned long iterations)
+{
+    unsigned long n;
+    uint8_t token = 0;
+    double start, ns;
+
+    start = bench_Now();
+    for (n = 0; n < iterations; n++)
+    {
+        token = bench_NextLinkTable(p_table, stride, maxLinkNbr, BENCH_ROLE_SERVER, token);
+    }
+    ns = (bench_Now() - start) * 1e9 / iterations;
+    s_benchSink = token;
+
+    return ns;
+}
+
+static void bench_Run(uint8_t maxLinkNbr, uint8_t active, unsigned long iterations)
+{
+    unsigned long n;
+    uint8_t tableToken = 0, maskToken = 0;
+    double start, tableNs, hotNs, maskNs;
+
+    bench_Setup(maxLinkNbr, active);
+
+    //Both pick the same links in the same order
+    for (n = 0; n < 2U * maxLinkNbr; n++)
+    {
+        tableToken = bench_NextLinkTable(s_benchLinks, BENCH_ENTRY_SIZE, maxLinkNbr, BENCH_ROLE_SERVER, tableToken);
+        maskToken = APP_UTILITY_NextInMask(s_benchRoleMask, maskToken);
+        if (tableToken != maskToken)
+        {
+            fprintf(stderr, "%u links: the schedulers disagree, %u != %u\n", maxLinkNbr, tableToken, maskToken);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    tableNs = bench_RunTable(s_benchLinks, BENCH_ENTRY_SIZE, maxLinkNbr, iterations);
+    hotNs = bench_RunTable(s_benchHotLinks, BENCH_HOT_ENTRY_SIZE, maxLinkNbr, iterations);
+
+    start = bench_Now();
+    for (n = 0; n < iterations; n++)
+    {
+        // The mask is read each time as the scheduler reads the static one
+        maskToken = APP_UTILITY_NextInMask(*(volatile uint64_t *)&s_benchRoleMask, maskToken);
+    }
+    maskNs = (bench_Now() - start) * 1e9 / iterations;
+    s_benchSink = maskToken;
+
+    printf("%2u links, %2u active: table %6.1f ns, hot table %6.1f ns, mask %6.1f ns\n",
+        maxLinkNbr, active, tableNs, hotNs, maskNs);
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint8_t maxLinkNbr[] = {8, 32, 64};
+    unsigned long iterations = BENCH_DEFAULT_ITERATIONS;
+    int active = BENCH_DEFAULT_ACTIVE;
+    size_t i;
+
+    if (argc > 1)
+        active = atoi(argv[1]);
+    if (argc > 2)
+        iterations = strtoul(argv[2], NULL, 0);
+
+    if (active < 1 || active > 8 || iterations == 0)
+    {
+        fprintf(stderr, "usage: %s [active links 1-8] [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < sizeof(maxLinkNbr); i++)
+    {
+        bench_Run(maxLinkNbr[i], (uint8_t)active, iterations);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+#!/bin/sh
+#
+# Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Replay the recordings of this folder, see 5.7 of apps/ble_uart_app/readme.
+# Each one must replay with exit code 0 and print the lines listed below for it,
+# as many times as listed. Run by ctest as the "replay" test.
+#
+#   check.sh <ble-uart-bluez>
+
+if [ $# -lt 1 ]; then
+    echo "usage: $0 <ble-uart-bluez>" >&2
+    exit 2
+fi
+
+APP=$1
+DIR=$(cd "$(dirname "$0")" && pwd)
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+failed=0
+
+# The shell quits once its input is closed, so the input is a fifo kept open
+mkfifo "$TMP/in"
+exec 3<>"$TMP/in"
+
+# <file> <count> <line> [<count> <line>]...
+check()
+{
+    file=$1
+    shift
+
+    "$APP" --replay "$DIR/$file" <&3 > "$TMP/$file.log" 2>&1
+    rc=$?
+    if [ $rc -ne 0 ]; then
+        echo "$file: exit code $rc"
+        failed=1
+    fi
+
+    while [ $# -ge 2 ]; do
+        count=$(grep -cF "$2" "$TMP/$file.log")
+        if [ "$count" -ne "$1" ]; then
+            echo "$file: \"$2\" printed $count times, expected $1"
+            failed=1
+        fi
+        shift 2
+    done
+
+    if [ $failed -ne 0 ]; then
+        cat "$TMP/$file.log"
+    else
+        grep "^Replay " "$TMP/$file.log"
+    fi
+}
+
+check disconnect.trp \
+    1 "Replay link 0 disconnected, run failed" \
+    1 " 0 misses"
+
+check error_rsp.trp \
+    1 "Checksum error response!" \
+    1 "Replay link 0 disconnected, run failed" \
+    1 " 0 misses"
+
+exec 3>&-
+
+exit $failed
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2024 Microchip Technology Inc.  All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Write the TRP recordings of this folder for "ble-uart-bluez --replay".
+# The layout is the one of apps/ble_uart_app/src/app_replay.h: "TRPR", version,
+# 3 reserved bytes, then records of delta us (4), type (1), id (1), link (1),
+# length (2), all little endian, followed by the payload.
+#
+#   disconnect.trp  A server link is lost in the middle of a check sum run, a late
+#                   receive event arrives, then the link reconnects and disconnects idle.
+#                   "Replay link 0 disconnected, run failed" is printed once.
+#   error_rsp.trp   The client answers a check sum run with an error response before
+#                   the link is closed. "Checksum error response!" and
+#                   "Replay link 0 disconnected, run failed" are printed.
+#
+# Both files replay completely with 0 misses, so the exit code is 0. check.sh
+# replays them and checks the lines above.
+
+import os
+import struct
+
+REC_TRPS_EVT = 0x01
+REC_LINK = 0x03
+REC_DATA = 0x04
+
+TRPS_EVT_RECEIVE_DATA = 0x05
+TRPS_EVT_VENDOR_CMD = 0x06
+
+LINK_CONNECTED = 0x00
+LINK_DISCONNECTED = 0x01
+LINK_MTU = 0x02
+
+GAP_ROLE_PERIPHERAL = 0x01
+INVALID_LINK = 0xFF
+
+VENDOR_OPCODE_BLE_UART = 0x80
+GRPID_CHECK_SUM = 0x01
+GRPID_TRANSMIT = 0x05
+WMODE_CHECK_SUM_ENABLE = 0x01
+WMODE_ERROR_RSP = 0x03
+WMODE_TX_DATA_START = 0x01
+
+MTU = 247
+PACKET_SIZE = MTU - 3
+
+
+def rec(delta_us, rec_type, rec_id, link, payload=b""):
+    return struct.pack("<IBBBH", delta_us, rec_type, rec_id, link, len(payload)) + payload
+
+
+def vendor_cmd(delta_us, group_id, command_id):
+    return rec(delta_us, REC_TRPS_EVT, TRPS_EVT_VENDOR_CMD, 0,
+               bytes([VENDOR_OPCODE_BLE_UART, group_id, command_id]))
+
+
+def connect():
+    return (rec(0, REC_LINK, LINK_CONNECTED, 0, bytes([GAP_ROLE_PERIPHERAL]))
+            + rec(35000, REC_LINK, LINK_MTU, 0, struct.pack("<H", MTU)))
+
+
+def check_sum_run(packets):
+    out = vendor_cmd(120000, GRPID_CHECK_SUM, WMODE_CHECK_SUM_ENABLE)
+    out += vendor_cmd(15000, GRPID_TRANSMIT, WMODE_TX_DATA_START)
+    for i in range(packets):
+        # The data is recorded when the event handler fetches it, after the event
+        data = bytes((i * PACKET_SIZE + j) & 0xFF for j in range(PACKET_SIZE))
+        out += rec(7500, REC_TRPS_EVT, TRPS_EVT_RECEIVE_DATA, 0)
+        out += rec(20, REC_DATA, 0, 0, data)
+    return out
+
+
+def write(name, records):
+    path = os.path.join(os.path.dirname(os.path.abspath(__file__)), name)
+    with open(path, "wb") as f:
+        f.write(b"TRPR" + bytes([1, 0, 0, 0]) + records)
+
+
+def main():
+    # A receive event of a lost link is recorded without a link
+    write("disconnect.trp",
+          connect() + check_sum_run(8)
+          + rec(30000, REC_LINK, LINK_DISCONNECTED, 0)
+          + rec(200, REC_TRPS_EVT, TRPS_EVT_RECEIVE_DATA, INVALID_LINK)
+          + rec(2000000, REC_LINK, LINK_CONNECTED, 0, bytes([GAP_ROLE_PERIPHERAL]))
+          + rec(35000, REC_LINK, LINK_MTU, 0, struct.pack("<H", MTU))
+          + rec(500000, REC_LINK, LINK_DISCONNECTED, 0))
+
+    write("error_rsp.trp",
+          connect() + check_sum_run(8)
+          + vendor_cmd(40000, GRPID_CHECK_SUM, WMODE_ERROR_RSP)
+          + rec(1000000, REC_LINK, LINK_DISCONNECTED, 0))
+
+
+if __name__ == "__main__":
+    main()